@@ -0,0 +1,191 @@
+/*
+Benchmark the AMF0 decoding of RTMP commands in a reconnect storm, for example,
+10k publishers reconnect after upstream failover. Build SRS first, then:
+
+cd research/amf0 && make && ./reconnect-storm 10000 1000
+
+The first argument is the number of reconnections, the second is the number of
+connections in flight, whose decoded commands are alive at the same time.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <srs_core_autofree.hpp>
+#include <srs_kernel_buffer.hpp>
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_utility.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_protocol_amf0.hpp>
+
+// The globals required by SRS kernel, no logs for benchmark.
+ISrsLog *_srs_log = NULL;
+ISrsContext *_srs_context = NULL;
+const char *_srs_binary = NULL;
+
+int64_t now_us()
+{
+    timeval now;
+    ::gettimeofday(&now, NULL);
+    return ((int64_t)now.tv_sec) * 1000 * 1000 + (int64_t)now.tv_usec;
+}
+
+// Encode the values to an RTMP command payload.
+string encode(vector<SrsAmf0Any *> &values)
+{
+    int size = 0;
+    for (int i = 0; i < (int)values.size(); i++) {
+        size += values[i]->total_size();
+    }
+
+    string payload(size, 0);
+    SrsBuffer b((char *)payload.data(), size);
+    for (int i = 0; i < (int)values.size(); i++) {
+        srs_error_t err = values[i]->write(&b);
+        srs_assert(err == srs_success);
+        srs_freep(values[i]);
+    }
+    values.clear();
+
+    return payload;
+}
+
+// Build the commands a publisher sends when it connects.
+void build_commands(vector<string> &commands)
+{
+    vector<SrsAmf0Any *> values;
+
+    // connect
+    SrsAmf0Object *obj = SrsAmf0Any::object();
+    obj->set("app", SrsAmf0Any::str("live"));
+    obj->set("type", SrsAmf0Any::str("nonprivate"));
+    obj->set("flashVer", SrsAmf0Any::str("FMLE/3.0 (compatible; FMSc/1.0)"));
+    obj->set("swfUrl", SrsAmf0Any::str("rtmp://127.0.0.1:1935/live"));
+    obj->set("tcUrl", SrsAmf0Any::str("rtmp://127.0.0.1:1935/live"));
+    obj->set("fpad", SrsAmf0Any::boolean(false));
+    obj->set("capabilities", SrsAmf0Any::number(239));
+    obj->set("audioCodecs", SrsAmf0Any::number(3575));
+    obj->set("videoCodecs", SrsAmf0Any::number(252));
+    obj->set("videoFunction", SrsAmf0Any::number(1));
+    obj->set("objectEncoding", SrsAmf0Any::number(0));
+    values.push_back(SrsAmf0Any::str("connect"));
+    values.push_back(SrsAmf0Any::number(1));
+    values.push_back(obj);
+    commands.push_back(encode(values));
+
+    // releaseStream, FCPublish and createStream
+    const char *names[] = {"releaseStream", "FCPublish", "createStream"};
+    for (int i = 0; i < 3; i++) {
+        values.push_back(SrsAmf0Any::str(names[i]));
+        values.push_back(SrsAmf0Any::number(2 + i));
+        values.push_back(SrsAmf0Any::null());
+        if (i < 2) {
+            values.push_back(SrsAmf0Any::str("livestream"));
+        }
+        commands.push_back(encode(values));
+    }
+
+    // publish
+    values.push_back(SrsAmf0Any::str("publish"));
+    values.push_back(SrsAmf0Any::number(5));
+    values.push_back(SrsAmf0Any::null());
+    values.push_back(SrsAmf0Any::str("livestream"));
+    values.push_back(SrsAmf0Any::str("live"));
+    commands.push_back(encode(values));
+
+    // @setDataFrame onMetaData
+    SrsAmf0EcmaArray *meta = SrsAmf0Any::ecma_array();
+    meta->set("duration", SrsAmf0Any::number(0));
+    meta->set("fileSize", SrsAmf0Any::number(0));
+    meta->set("width", SrsAmf0Any::number(1920));
+    meta->set("height", SrsAmf0Any::number(1080));
+    meta->set("videocodecid", SrsAmf0Any::str("avc1"));
+    meta->set("videodatarate", SrsAmf0Any::number(2500));
+    meta->set("framerate", SrsAmf0Any::number(30));
+    meta->set("audiocodecid", SrsAmf0Any::str("mp4a"));
+    meta->set("audiodatarate", SrsAmf0Any::number(160));
+    meta->set("audiosamplerate", SrsAmf0Any::number(48000));
+    meta->set("audiosamplesize", SrsAmf0Any::number(16));
+    meta->set("audiochannels", SrsAmf0Any::number(2));
+    meta->set("stereo", SrsAmf0Any::boolean(true));
+    meta->set("encoder", SrsAmf0Any::str("obs-output module (libobs version 30.0.0)"));
+    values.push_back(SrsAmf0Any::str("@setDataFrame"));
+    values.push_back(SrsAmf0Any::str("onMetaData"));
+    values.push_back(meta);
+    commands.push_back(encode(values));
+}
+
+// Decode all values of a command, like the RTMP packet decoder.
+void decode(const string &payload, vector<SrsAmf0Any *> &values)
+{
+    SrsBuffer b((char *)payload.data(), (int)payload.size());
+    while (!b.empty()) {
+        SrsAmf0Any *any = NULL;
+        srs_error_t err = srs_amf0_read_any(&b, &any);
+        srs_assert(err == srs_success);
+        values.push_back(any);
+    }
+}
+
+void release(vector<SrsAmf0Any *> &values)
+{
+    for (int i = 0; i < (int)values.size(); i++) {
+        srs_freep(values[i]);
+    }
+    values.clear();
+}
+
+// Run the storm, return the commands per second.
+double storm(vector<string> &commands, int reconnects, int inflight, bool pool)
+{
+    vector<vector<SrsAmf0Any *> > conns(inflight);
+
+    int64_t starttime = now_us();
+    for (int i = 0; i < reconnects; i++) {
+        vector<SrsAmf0Any *> &conn = conns[i % inflight];
+        release(conn);
+
+        // Without pool, drop the cached nodes so each node goes to the allocator.
+        if (!pool) {
+            SrsAmf0NodePool::shrink();
+        }
+
+        for (int j = 0; j < (int)commands.size(); j++) {
+            decode(commands[j], conn);
+        }
+    }
+    for (int i = 0; i < inflight; i++) {
+        release(conns[i]);
+    }
+    int64_t elapsed = srs_max(1, now_us() - starttime);
+
+    return (double)reconnects * commands.size() * 1000 * 1000 / elapsed;
+}
+
+int main(int argc, char **argv)
+{
+    int reconnects = argc > 1 ? ::atoi(argv[1]) : 10000;
+    int inflight = argc > 2 ? ::atoi(argv[2]) : 1000;
+    inflight = srs_max(1, srs_min(inflight, reconnects));
+
+    vector<string> commands;
+    build_commands(commands);
+
+    printf("reconnects=%d, inflight=%d, commands=%d per connection\n", reconnects, inflight, (int)commands.size());
+
+    double cold = storm(commands, reconnects, inflight, false);
+    printf("allocator: %.0f commands/s\n", cold);
+
+    SrsAmf0NodePool::shrink();
+    int64_t allocated = SrsAmf0NodePool::nn_allocated();
+    int64_t reused = SrsAmf0NodePool::nn_reused();
+    double warm = storm(commands, reconnects, inflight, true);
+    printf("pool: %.0f commands/s, %.2fx, reused=%" PRId64 ", allocated=%" PRId64 "\n", warm, warm / cold,
+           SrsAmf0NodePool::nn_reused() - reused, SrsAmf0NodePool::nn_allocated() - allocated);
+
+    return 0;
+}
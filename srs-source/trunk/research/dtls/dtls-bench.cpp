@@ -0,0 +1,191 @@
+/*
+Benchmark the DTLS join storm of WebRTC players, that is, many players complete the DTLS
+handshake at the same time, to compare the SSL_CTX built for each session with the SSL_CTX
+shared by all sessions, like SrsDtlsCertificate::get_dtls_ctx. Build it by:
+
+cd research/dtls && make && ./dtls-bench 1000
+
+The argument is the number of players. The context uses the same setup as SRS, that is, the
+ECDSA P-256 certificate, ALL ciphers, verify peer, read ahead and SRTP_AES128_CM_SHA1_80. The
+handshake runs over memory BIOs in one thread, like SRS, so it measures the CPU cost only.
+
+SRS does not offload the handshakes to native threads, because SRS is always built with one
+thread, see auto/options.sh. It's not a limit of OpenSSL, which allows a SSL object to move
+between threads, if only one thread uses it at a time. So a join storm costs the ST thread the
+handshakes in turn, for example, 5000 players by the shared SSL_CTX:
+
+Handshake by shared SSL_CTX x 5000, 0 fails, 19337.139ms, 3867.4us/session
+
+Both peers run in this bench, so about half is the cost of SRS, that is, the last player waits
+about 10s of CPU before its first frame, which is not improved by this bench.
+*/
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <openssl/ec.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+
+// The max size of DTLS fragment, same as SRS.
+#define DTLS_FRAGMENT_MAX_SIZE 1200
+
+EVP_PKEY *pkey = NULL;
+X509 *cert = NULL;
+
+int64_t now_us()
+{
+    timeval now;
+    ::gettimeofday(&now, NULL);
+    return ((int64_t)now.tv_sec) * 1000 * 1000 + (int64_t)now.tv_usec;
+}
+
+int verify_callback(int preverify_ok, X509_STORE_CTX *ctx)
+{
+    // Always OK, we don't check the certificate of peer.
+    return 1;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+// Generate the ECDSA certificate, like SrsDtlsCertificate::initialize.
+void build_cert()
+{
+    EC_KEY *eckey = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1);
+    EC_KEY_set_asn1_flag(eckey, OPENSSL_EC_NAMED_CURVE);
+    EC_KEY_generate_key(eckey);
+
+    pkey = EVP_PKEY_new();
+    EVP_PKEY_assign_EC_KEY(pkey, eckey);
+
+    cert = X509_new();
+    X509_NAME *subject = X509_NAME_new();
+    X509_NAME_add_entry_by_txt(subject, "CN", MBSTRING_ASC, (unsigned char *)"ossrs.net", -1, -1, 0);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert), 1);
+    X509_set_issuer_name(cert, subject);
+    X509_set_subject_name(cert, subject);
+    X509_gmtime_adj(X509_get_notBefore(cert), 0);
+    X509_gmtime_adj(X509_get_notAfter(cert), 365 * 24 * 3600);
+    X509_set_version(cert, 2);
+    X509_set_pubkey(cert, pkey);
+    X509_sign(cert, pkey, EVP_sha1());
+    X509_NAME_free(subject);
+}
+#pragma GCC diagnostic pop
+
+// Build the DTLS context, like srs_build_dtls_ctx.
+SSL_CTX *build_ctx()
+{
+    SSL_CTX *ctx = SSL_CTX_new(DTLS_method());
+    SSL_CTX_set1_curves_list(ctx, "P-521:P-384:P-256");
+    SSL_CTX_set_cipher_list(ctx, "ALL");
+    SSL_CTX_use_certificate(ctx, cert);
+    SSL_CTX_use_PrivateKey(ctx, pkey);
+    SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER | SSL_VERIFY_CLIENT_ONCE, verify_callback);
+    SSL_CTX_set_verify_depth(ctx, 4);
+    SSL_CTX_set_read_ahead(ctx, 1);
+    SSL_CTX_set_tlsext_use_srtp(ctx, "SRTP_AES128_CM_SHA1_80");
+    return ctx;
+}
+
+// Create the DTLS session over memory BIOs, like SrsDtlsImpl::initialize.
+SSL *build_ssl(SSL_CTX *ctx, bool server)
+{
+    SSL *ssl = SSL_new(ctx);
+    SSL_set_options(ssl, SSL_OP_NO_QUERY_MTU);
+    SSL_set_mtu(ssl, DTLS_FRAGMENT_MAX_SIZE);
+    DTLS_set_link_mtu(ssl, DTLS_FRAGMENT_MAX_SIZE);
+    SSL_set_bio(ssl, BIO_new(BIO_s_mem()), BIO_new(BIO_s_mem()));
+    if (server) {
+        SSL_set_accept_state(ssl);
+    } else {
+        SSL_set_connect_state(ssl);
+    }
+    return ssl;
+}
+
+// Move the packets from one session to the other.
+void transfer(SSL *from, SSL *to)
+{
+    char buf[4096];
+    int nn = 0;
+    while ((nn = BIO_read(SSL_get_wbio(from), buf, sizeof(buf))) > 0) {
+        BIO_write(SSL_get_rbio(to), buf, nn);
+    }
+}
+
+// Do the DTLS handshake of a player, return whether done.
+bool handshake(SSL_CTX *server_ctx, SSL_CTX *client_ctx)
+{
+    SSL *server = build_ssl(server_ctx, true);
+    SSL *client = build_ssl(client_ctx, false);
+
+    bool done = false;
+    for (int i = 0; i < 16 && !done; i++) {
+        SSL_do_handshake(client);
+        transfer(client, server);
+        SSL_do_handshake(server);
+        transfer(server, client);
+        done = SSL_is_init_finished(server) && SSL_is_init_finished(client);
+    }
+
+    SSL_free(server);
+    SSL_free(client);
+    return done;
+}
+
+int main(int argc, char **argv)
+{
+    int players = argc > 1 ? ::atoi(argv[1]) : 1000;
+    if (players <= 0) {
+        printf("Usage: %s <players>\n", argv[0]);
+        return -1;
+    }
+
+    build_cert();
+
+    // The client context is same for both cases, it's the browser.
+    SSL_CTX *client_ctx = build_ctx();
+
+    // Build the context only, to show the cost saved for each session.
+    int64_t starttime = now_us();
+    for (int i = 0; i < players; i++) {
+        SSL_CTX_free(build_ctx());
+    }
+    int64_t duration = now_us() - starttime;
+    printf("Build SSL_CTX x %d, %.3fms, %.1fus/session\n", players, duration / 1000.0, duration * 1.0 / players);
+
+    // Each session builds and frees its own context, which is the previous behavior.
+    int nn_fails = 0;
+    starttime = now_us();
+    for (int i = 0; i < players; i++) {
+        SSL_CTX *ctx = build_ctx();
+        nn_fails += handshake(ctx, client_ctx) ? 0 : 1;
+        SSL_CTX_free(ctx);
+    }
+    duration = now_us() - starttime;
+    printf("Handshake by SSL_CTX of session x %d, %d fails, %.3fms, %.1fus/session\n",
+           players, nn_fails, duration / 1000.0, duration * 1.0 / players);
+
+    // All sessions share the context, with session cache off, like SrsDtlsCertificate.
+    SSL_CTX *shared = build_ctx();
+    SSL_CTX_set_session_cache_mode(shared, SSL_SESS_CACHE_OFF);
+
+    nn_fails = 0;
+    starttime = now_us();
+    for (int i = 0; i < players; i++) {
+        nn_fails += handshake(shared, client_ctx) ? 0 : 1;
+    }
+    duration = now_us() - starttime;
+    printf("Handshake by shared SSL_CTX x %d, %d fails, %.3fms, %.1fus/session\n",
+           players, nn_fails, duration / 1000.0, duration * 1.0 / players);
+
+    SSL_CTX_free(shared);
+    SSL_CTX_free(client_ctx);
+    X509_free(cert);
+    EVP_PKEY_free(pkey);
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+Benchmark the RTCP handling of WebRTC players, that is, decoding the compound RTCP packets
+from players, and building the TWCC feedback for publishers. Build SRS first, then:
+
+cd research/rtcp && make && ./rtcp-bench 100000
+
+The first argument is the number of rounds. The optional second argument is a file of
+captured RTCP packets, one plaintext compound RTCP packet per line in hex, for example,
+exported from wireshark by "Copy as Hex Stream" after SRTCP is decrypted:
+
+./rtcp-bench 100000 rtcp.txt
+
+Without the file, it uses the synthetic packets of a player, that is, RR+SDES, TWCC
+feedback of 100 packets, and NACK of a few lost packets.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+using namespace std;
+
+#include <srs_core_autofree.hpp>
+#include <srs_kernel_buffer.hpp>
+#include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_kernel_rtc_rtcp.hpp>
+#include <srs_kernel_utility.hpp>
+
+// The globals required by SRS kernel, no logs for benchmark.
+ISrsLog *_srs_log = NULL;
+ISrsContext *_srs_context = NULL;
+const char *_srs_binary = NULL;
+
+int64_t now_us()
+{
+    timeval now;
+    ::gettimeofday(&now, NULL);
+    return ((int64_t)now.tv_sec) * 1000 * 1000 + (int64_t)now.tv_usec;
+}
+
+// Encode the RTCP to packet, and free it.
+string encode(SrsRtcpCommon *rtcp)
+{
+    char buf[kRtcpPacketSize];
+    SrsBuffer b(buf, sizeof(buf));
+    srs_error_t err = rtcp->encode(&b);
+    srs_assert(err == srs_success);
+    srs_freep(rtcp);
+    return string(buf, b.pos());
+}
+
+// Build the RTCP packets a player sends.
+void build_packets(vector<string> &packets)
+{
+    // RR with an empty SDES, every 1s.
+    SrsRtcpRR *rr = new SrsRtcpRR(0x1);
+    rr->set_rb_ssrc(0x87654321);
+    rr->set_highest_sn(1000);
+    string sdes("\x81\xca\x00\x02\x00\x00\x00\x01\x00\x00\x00\x00", 12);
+    packets.push_back(encode(rr) + sdes);
+
+    // TWCC feedback of 100 packets with 2% lost, every 50ms.
+    SrsRtcpTWCC *twcc = new SrsRtcpTWCC(0x1);
+    twcc->set_media_ssrc(0x87654321);
+    for (int i = 0; i < 100; i++) {
+        if (i % 50 != 7) {
+            srs_error_t err = twcc->recv_packet(1000 + i, 1000000 + i * 500);
+            srs_assert(err == srs_success);
+        }
+    }
+    packets.push_back(encode(twcc));
+
+    // NACK of a few lost packets.
+    SrsRtcpNack *nack = new SrsRtcpNack(0x1);
+    nack->set_media_ssrc(0x87654321);
+    nack->add_lost_sn(1007);
+    nack->add_lost_sn(1009);
+    nack->add_lost_sn(1057);
+    packets.push_back(encode(nack));
+}
+
+// Load the captured packets, one hex packet per line.
+void load_packets(const char *file, vector<string> &packets)
+{
+    ifstream f(file);
+    string line;
+    while (getline(f, line)) {
+        string pkt;
+        for (int i = 0; i + 1 < (int)line.length(); i += 2) {
+            pkt.push_back((char)strtol(line.substr(i, 2).c_str(), NULL, 16));
+        }
+        if (!pkt.empty()) {
+            packets.push_back(pkt);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int rounds = argc > 1 ? ::atoi(argv[1]) : 100000;
+
+    vector<string> packets;
+    if (argc > 2) {
+        load_packets(argv[2], packets);
+    } else {
+        build_packets(packets);
+    }
+    if (packets.empty() || rounds <= 0) {
+        printf("Usage: %s <rounds> [rtcp.txt]\n", argv[0]);
+        return -1;
+    }
+
+    // Decode the compound packets, like SrsRtcConnection::on_rtcp.
+    int64_t nn_rtcps = 0, nn_errors = 0;
+    int64_t starttime = now_us();
+    for (int i = 0; i < rounds; i++) {
+        for (int j = 0; j < (int)packets.size(); j++) {
+            string &pkt = packets[j];
+            SrsBuffer buffer((char *)pkt.data(), (int)pkt.length());
+
+            SrsRtcpCompound compound;
+            srs_error_t err = compound.decode(&buffer);
+            if (err != srs_success) {
+                nn_errors++;
+                srs_freep(err);
+            }
+
+            SrsRtcpCommon *rtcp = NULL;
+            while ((rtcp = compound.get_next_rtcp()) != NULL) {
+                nn_rtcps++;
+                srs_freep(rtcp);
+            }
+        }
+    }
+    int64_t duration = now_us() - starttime;
+    printf("Decode %d packets x %d rounds, %" PRId64 " rtcps, %" PRId64 " errors, %.3fms, %.1fns/packet, pool reused=%" PRId64 ", allocated=%" PRId64 "\n",
+           (int)packets.size(), rounds, nn_rtcps, nn_errors, duration / 1000.0, duration * 1000.0 / rounds / packets.size(),
+           srs_rtcp_pool()->nn_reused(), srs_rtcp_pool()->nn_allocated());
+
+    // Build the TWCC feedback of 100 packets, like SrsRtcPublishStream::send_periodic_twcc.
+    SrsRtcpTWCC twcc(0x1);
+    twcc.set_media_ssrc(0x87654321);
+    uint16_t sn = 0;
+    starttime = now_us();
+    for (int i = 0; i < rounds; i++) {
+        for (int j = 0; j < 100; j++, sn++) {
+            if (j % 50 != 7) {
+                srs_error_t err = twcc.recv_packet(sn, (int64_t)i * 50000 + j * 500);
+                srs_assert(err == srs_success);
+            }
+        }
+
+        while (twcc.need_feedback()) {
+            char buf[kMaxUDPDataSize];
+            SrsBuffer b(buf, sizeof(buf));
+            srs_error_t err = twcc.encode(&b);
+            srs_assert(err == srs_success);
+        }
+    }
+    duration = now_us() - starttime;
+    printf("Build TWCC feedback x %d rounds, %.3fms, %.1fns/feedback\n", rounds, duration / 1000.0, duration * 1000.0 / rounds);
+
+    return 0;
+}
@@ -0,0 +1,86 @@
+#!/bin/bash
+#
+# Test the origin cluster directory by three local origins, see conf/origin.cluster.server{A,B,C}.conf
+# Publish a stream to origin A, then the origin B and C should locate it by directory, rather than
+# querying the co-workers, and remove it after unpublish.
+#
+# Usage:
+#       ./scripts/origin_cluster_directory.sh
+# Requires ffmpeg and curl, and build SRS by:
+#       ./configure && make
+
+TRUNK_DIR=$(dirname $(realpath -q $0))/..
+
+pushd $TRUNK_DIR > /dev/null
+
+SRS_EXE=$(pwd)/objs/srs
+SOURCE=$(pwd)/doc/source.flv
+STREAM=livestream
+
+if [ ! -x ${SRS_EXE} ]; then
+    echo "${SRS_EXE} not exist or not executable"
+    exit -1
+fi
+
+for tool in ffmpeg curl; do
+    if [[ -z $(which $tool 2>/dev/null) ]]; then
+        echo "$tool not found"
+        exit -1
+    fi
+done
+
+PIDS=""
+function cleanup() {
+    for pid in $PIDS; do
+        kill $pid 2>/dev/null
+    done
+    wait 2>/dev/null
+    popd > /dev/null
+}
+trap cleanup EXIT
+
+for server in A B C; do
+    ${SRS_EXE} -c conf/origin.cluster.server${server}.conf > objs/origin.cluster.server${server}.log 2>&1 &
+    PIDS="$PIDS $!"
+done
+
+# Query the origin of stream from the api of origin.
+function query() {
+    curl -s "http://127.0.0.1:$1/api/v1/clusters?vhost=__defaultVhost__&app=live&stream=${STREAM}&coworker=127.0.0.1:$1"
+}
+
+# Wait for the result of query to match the pattern, in seconds.
+function wait_for() {
+    for ((i = 0; i < $3; i++)); do
+        if [[ $(query $1) =~ $2 ]]; then
+            return 0
+        fi
+        sleep 1
+    done
+    echo "Failed, api=$1, expect=$2, got=$(query $1)"
+    exit -1
+}
+
+for port in 9090 9091 9092; do
+    wait_for $port '"code":0' 10
+done
+echo "All origins are started"
+
+ffmpeg -re -stream_loop -1 -i ${SOURCE} -c copy -f flv rtmp://127.0.0.1:19350/live/${STREAM} > objs/origin.cluster.ffmpeg.log 2>&1 &
+FFMPEG=$!
+PIDS="$PIDS $FFMPEG"
+
+# The stream is pushed to B and C, which redirect to the rtmp port of A.
+for port in 9091 9092; do
+    wait_for $port '"origin":\{"ip":"[^"]*","port":19350' 10
+    wait_for $port '"directory":\{[^}]*"streams":1' 1
+done
+echo "Origin B and C locate the stream on A by directory"
+
+kill $FFMPEG
+for port in 9091 9092; do
+    wait_for $port '"origin":null' 10
+done
+echo "Origin B and C remove the stream after unpublish"
+
+echo "OK"
@@ -1390,6 +1390,22 @@ srs_error_t SrsConfDirective::read_token(SrsConfigBuffer *buffer, vector<string>
     return err;
 }
 
+SrsConfVhostSnapshot::SrsConfVhostSnapshot()
+{
+    atc_ = false;
+    atc_auto_ = false;
+    time_jitter_ = 0;
+    mix_correct_ = false;
+    queue_length_ = 0;
+    reduce_sequence_header_ = false;
+    parse_sps_ = true;
+    is_edge_ = false;
+}
+
+SrsConfVhostSnapshot::~SrsConfVhostSnapshot()
+{
+}
+
 ISrsAppConfig::ISrsAppConfig()
 {
 }
@@ -1413,10 +1429,13 @@ SrsConfig::SrsConfig()
 
     env_cache_ = new SrsConfDirective();
     env_cache_->name_ = "env_cache_";
+
+    generation_ = 0;
 }
 
 SrsConfig::~SrsConfig()
 {
+    clear_vhost_snapshots();
     srs_freep(root_);
     srs_freep(env_cache_);
 }
@@ -1488,6 +1507,9 @@ srs_error_t SrsConfig::reload_conf(SrsConfig *conf)
     root_ = conf->root_;
     conf->root_ = NULL;
 
+    // Drop the snapshots of old root, the handlers will get the new config.
+    on_config_changed();
+
     // merge config.
     std::vector<ISrsReloadHandler *>::iterator it;
 
@@ -1637,6 +1659,9 @@ srs_error_t SrsConfig::parse_options(int argc, char **argv)
             root_->get_or_create("vhost", "__defaultVhost__");
     }
 
+    // The vhosts might be changed by transform or env, rebuild the snapshots when used.
+    on_config_changed();
+
     // Ignore any error while detecting docker.
     if ((err = srs_detect_docker()) != srs_success) {
         srs_freep(err);
@@ -1900,7 +1925,7 @@ srs_error_t SrsConfig::check_normal_config()
     for (int i = 0; i < (int)root_->directives_.size(); i++) {
         SrsConfDirective *conf = root_->at(i);
         std::string n = conf->name_;
-        if (n != "pid" && n != "ff_log_dir" && n != "srs_log_tank" && n != "srs_log_level" && n != "srs_log_level_v2" && n != "srs_log_file" && n != "max_connections" && n != "daemon" && n != "heartbeat" && n != "tencentcloud_apm" && n != "http_api" && n != "stats" && n != "vhost" && n != "pithy_print_ms" && n != "http_server" && n != "stream_caster" && n != "rtc_server" && n != "srt_server" && n != "utc_time" && n != "work_dir" && n != "asprocess" && n != "server_id" && n != "ff_log_level" && n != "grace_final_wait" && n != "force_grace_quit" && n != "grace_start_wait" && n != "empty_ip_ok" && n != "disable_daemon_for_docker" && n != "inotify_auto_reload" && n != "auto_reload_for_docker" && n != "tcmalloc_release_rate" && n != "query_latest_version" && n != "first_wait_for_qlv" && n != "circuit_breaker" && n != "is_full" && n != "in_docker" && n != "tencentcloud_cls" && n != "exporter" && n != "rtsp_server" && n != "rtmp" && n != "rtmps") {
+        if (n != "pid" && n != "ff_log_dir" && n != "srs_log_tank" && n != "srs_log_level" && n != "srs_log_level_v2" && n != "srs_log_file" && n != "srs_log_async" && n != "srs_log_limit" && n != "max_connections" && n != "daemon" && n != "heartbeat" && n != "tencentcloud_apm" && n != "http_api" && n != "stats" && n != "vhost" && n != "pithy_print_ms" && n != "http_server" && n != "stream_caster" && n != "rtc_server" && n != "srt_server" && n != "utc_time" && n != "work_dir" && n != "asprocess" && n != "server_id" && n != "ff_log_level" && n != "grace_final_wait" && n != "force_grace_quit" && n != "grace_start_wait" && n != "empty_ip_ok" && n != "disable_daemon_for_docker" && n != "inotify_auto_reload" && n != "auto_reload_for_docker" && n != "tcmalloc_release_rate" && n != "query_latest_version" && n != "first_wait_for_qlv" && n != "circuit_breaker" && n != "supervisor" && n != "is_full" && n != "in_docker" && n != "tencentcloud_cls" && n != "exporter" && n != "rtsp_server" && n != "rtmp" && n != "rtmps") {
             return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal directive %s", n.c_str());
         }
     }
@@ -1972,7 +1997,7 @@ srs_error_t SrsConfig::check_normal_config()
         SrsConfDirective *conf = root_->get("rtc_server");
         for (int i = 0; conf && i < (int)conf->directives_.size(); i++) {
             string n = conf->at(i)->name_;
-            if (n != "enabled" && n != "listen" && n != "dir" && n != "candidate" && n != "ecdsa" && n != "tcp" && n != "encrypt" && n != "reuseport" && n != "merge_nalus" && n != "black_hole" && n != "protocol" && n != "ip_family" && n != "api_as_candidates" && n != "resolve_api_domain" && n != "keep_api_domain" && n != "use_auto_detect_network_ip") {
+            if (n != "enabled" && n != "listen" && n != "dir" && n != "candidate" && n != "ecdsa" && n != "tcp" && n != "encrypt" && n != "reuseport" && n != "recv_batch" && n != "audio_transcoders" && n != "audio_transcoders_drop" && n != "merge_nalus" && n != "black_hole" && n != "protocol" && n != "ip_family" && n != "api_as_candidates" && n != "resolve_api_domain" && n != "keep_api_domain" && n != "use_auto_detect_network_ip") {
                 return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal rtc_server.%s", n.c_str());
             }
         }
@@ -2266,7 +2291,7 @@ srs_error_t SrsConfig::check_normal_config()
             } else if (n == "cluster") {
                 for (int j = 0; j < (int)conf->directives_.size(); j++) {
                     string m = conf->at(j)->name_;
-                    if (m != "mode" && m != "origin" && m != "token_traverse" && m != "vhost" && m != "debug_srs_upnode" && m != "coworkers" && m != "origin_cluster" && m != "protocol" && m != "follow_client") {
+                    if (m != "mode" && m != "origin" && m != "token_traverse" && m != "vhost" && m != "debug_srs_upnode" && m != "coworkers" && m != "origin_cluster" && m != "origin_directory" && m != "origin_directory_ip" && m != "protocol" && m != "follow_client" && m != "token_traverse_ttl" && m != "token_traverse_deny_ttl" && m != "hedge_delay" && m != "warm_pull" && m != "warm_pull_plays") {
                         return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal vhost.cluster.%s of %s", m.c_str(), vhost->arg0().c_str());
                     }
                 }
@@ -2294,7 +2319,7 @@ srs_error_t SrsConfig::check_normal_config()
             } else if (n == "http_remux") {
                 for (int j = 0; j < (int)conf->directives_.size(); j++) {
                     string m = conf->at(j)->name_;
-                    if (m != "enabled" && m != "mount" && m != "fast_cache" && m != "drop_if_not_match" && m != "has_audio" && m != "has_video" && m != "guess_has_av") {
+                    if (m != "enabled" && m != "mount" && m != "fast_cache" && m != "drop_if_not_match" && m != "has_audio" && m != "has_video" && m != "guess_has_av" && m != "ts_shared") {
                         return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal vhost.http_remux.%s of %s", m.c_str(), vhost->arg0().c_str());
                     }
                 }
@@ -2320,7 +2345,7 @@ srs_error_t SrsConfig::check_normal_config()
             } else if (n == "http_hooks") {
                 for (int j = 0; j < (int)conf->directives_.size(); j++) {
                     string m = conf->at(j)->name_;
-                    if (m != "enabled" && m != "on_connect" && m != "on_close" && m != "on_publish" && m != "on_unpublish" && m != "on_play" && m != "on_stop" && m != "on_dvr" && m != "on_hls" && m != "on_hls_notify") {
+                    if (m != "enabled" && m != "on_connect" && m != "on_close" && m != "on_publish" && m != "on_unpublish" && m != "on_play" && m != "on_stop" && m != "on_dvr" && m != "on_hls" && m != "on_hls_notify" && m != "keep_alive" && m != "play_cache") {
                         return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal vhost.http_hooks.%s of %s", m.c_str(), vhost->arg0().c_str());
                     }
                 }
@@ -2358,7 +2383,7 @@ srs_error_t SrsConfig::check_normal_config()
             } else if (n == "rtc") {
                 for (int j = 0; j < (int)conf->directives_.size(); j++) {
                     string m = conf->at(j)->name_;
-                    if (m != "enabled" && m != "nack" && m != "twcc" && m != "nack_no_copy" && m != "bframe" && m != "aac" && m != "stun_timeout" && m != "stun_strict_check" && m != "dtls_role" && m != "dtls_version" && m != "drop_for_pt" && m != "rtc_to_rtmp" && m != "pli_for_rtmp" && m != "rtmp_to_rtc" && m != "keep_bframe" && m != "opus_bitrate" && m != "aac_bitrate" && m != "keep_avc_nalu_sei" && m != "init_rate_from_sdp") {
+                    if (m != "enabled" && m != "nack" && m != "twcc" && m != "nack_no_copy" && m != "nack_cache_size" && m != "bframe" && m != "aac" && m != "stun_timeout" && m != "stun_strict_check" && m != "dtls_role" && m != "dtls_version" && m != "drop_for_pt" && m != "rtc_to_rtmp" && m != "pli_for_rtmp" && m != "rtmp_to_rtc" && m != "keep_bframe" && m != "opus_bitrate" && m != "aac_bitrate" && m != "keep_avc_nalu_sei" && m != "init_rate_from_sdp") {
                         return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "illegal vhost.rtc.%s of %s", m.c_str(), vhost->arg0().c_str());
                     }
                 }
@@ -2517,6 +2542,7 @@ srs_error_t SrsConfig::parse_buffer(SrsConfigBuffer *buffer)
     // We use a new root to parse buffer, to allow parse multiple times.
     srs_freep(root_);
     root_ = new SrsConfDirective();
+    on_config_changed();
 
     // Parse root tree from buffer.
     if ((err = root_->parse(buffer, this)) != srs_success) {
@@ -2579,6 +2605,11 @@ SrsConfDirective *SrsConfig::get_root()
     return root_;
 }
 
+int SrsConfig::get_generation()
+{
+    return generation_;
+}
+
 string srs_server_id_path(string pid_file)
 {
     string path = srs_strings_replace(pid_file, ".pid", ".id");
@@ -3055,6 +3086,123 @@ int SrsConfig::get_dying_pulse()
     return ::atoi(conf->arg0().c_str());
 }
 
+bool SrsConfig::get_supervisor_enabled()
+{
+    SRS_OVERWRITE_BY_ENV_BOOL("srs.supervisor.enabled"); // SRS_SUPERVISOR_ENABLED
+
+    static bool DEFAULT = false;
+
+    SrsConfDirective *conf = root_->get("supervisor");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("enabled");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PREFER_FALSE(conf->arg0());
+}
+
+string SrsConfig::get_supervisor_srs_cpus()
+{
+    SRS_OVERWRITE_BY_ENV_STRING("srs.supervisor.srs_cpus"); // SRS_SUPERVISOR_SRS_CPUS
+
+    static string DEFAULT = "";
+
+    SrsConfDirective *conf = root_->get("supervisor");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("srs_cpus");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    return conf->arg0();
+}
+
+string SrsConfig::get_supervisor_ffmpeg_cpus()
+{
+    SRS_OVERWRITE_BY_ENV_STRING("srs.supervisor.ffmpeg_cpus"); // SRS_SUPERVISOR_FFMPEG_CPUS
+
+    static string DEFAULT = "";
+
+    SrsConfDirective *conf = root_->get("supervisor");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("ffmpeg_cpus");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    return conf->arg0();
+}
+
+int SrsConfig::get_supervisor_ffmpeg_nice()
+{
+    SRS_OVERWRITE_BY_ENV_INT("srs.supervisor.ffmpeg_nice"); // SRS_SUPERVISOR_FFMPEG_NICE
+
+    static int DEFAULT = 10;
+
+    SrsConfDirective *conf = root_->get("supervisor");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("ffmpeg_nice");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    int v = ::atoi(conf->arg0().c_str());
+    v = srs_min(19, v);
+    v = srs_max(-20, v);
+    return v;
+}
+
+int SrsConfig::get_supervisor_threshold()
+{
+    SRS_OVERWRITE_BY_ENV_INT("srs.supervisor.threshold"); // SRS_SUPERVISOR_THRESHOLD
+
+    static int DEFAULT = 85;
+
+    SrsConfDirective *conf = root_->get("supervisor");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("threshold");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    return ::atoi(conf->arg0().c_str());
+}
+
+srs_utime_t SrsConfig::get_supervisor_backoff_max()
+{
+    SRS_OVERWRITE_BY_ENV_SECONDS("srs.supervisor.backoff_max"); // SRS_SUPERVISOR_BACKOFF_MAX
+
+    static srs_utime_t DEFAULT = 60 * SRS_UTIME_SECONDS;
+
+    SrsConfDirective *conf = root_->get("supervisor");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("backoff_max");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    return ::atoi(conf->arg0().c_str()) * SRS_UTIME_SECONDS;
+}
+
 bool SrsConfig::get_exporter_enabled()
 {
     SRS_OVERWRITE_BY_ENV_BOOL("srs.exporter.enabled"); // SRS_EXPORTER_ENABLED
@@ -3658,6 +3806,63 @@ int SrsConfig::get_rtc_server_reuseport2()
     return ::atoi(conf->arg0().c_str());
 }
 
+int SrsConfig::get_rtc_server_recv_batch()
+{
+    SRS_OVERWRITE_BY_ENV_INT("srs.rtc_server.recv_batch"); // SRS_RTC_SERVER_RECV_BATCH
+
+    static int DEFAULT = 1;
+
+    SrsConfDirective *conf = root_->get("rtc_server");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("recv_batch");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return ::atoi(conf->arg0().c_str());
+}
+
+int SrsConfig::get_rtc_server_audio_transcoders()
+{
+    SRS_OVERWRITE_BY_ENV_INT("srs.rtc_server.audio_transcoders"); // SRS_RTC_SERVER_AUDIO_TRANSCODERS
+
+    static int DEFAULT = 0;
+
+    SrsConfDirective *conf = root_->get("rtc_server");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("audio_transcoders");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return ::atoi(conf->arg0().c_str());
+}
+
+bool SrsConfig::get_rtc_server_audio_transcoders_drop()
+{
+    SRS_OVERWRITE_BY_ENV_BOOL("srs.rtc_server.audio_transcoders_drop"); // SRS_RTC_SERVER_AUDIO_TRANSCODERS_DROP
+
+    static bool DEFAULT = false;
+
+    SrsConfDirective *conf = root_->get("rtc_server");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("audio_transcoders_drop");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PREFER_FALSE(conf->arg0());
+}
+
 bool SrsConfig::get_rtc_server_merge_nalus()
 {
     SRS_OVERWRITE_BY_ENV_BOOL("srs.rtc_server.merge_nalus"); // SRS_RTC_SERVER_MERGE_NALUS
@@ -3996,6 +4201,25 @@ bool SrsConfig::get_rtc_nack_no_copy(string vhost)
     return SRS_CONF_PREFER_TRUE(conf->arg0());
 }
 
+int SrsConfig::get_rtc_nack_cache_size(string vhost)
+{
+    SRS_OVERWRITE_BY_ENV_INT("srs.vhost.rtc.nack_cache_size"); // SRS_VHOST_RTC_NACK_CACHE_SIZE
+
+    static int DEFAULT = 0;
+
+    SrsConfDirective *conf = get_rtc(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("nack_cache_size");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return ::atoi(conf->arg0().c_str());
+}
+
 bool SrsConfig::get_rtc_twcc_enabled(string vhost)
 {
     SRS_OVERWRITE_BY_ENV_BOOL2("srs.vhost.rtc.twcc"); // SRS_VHOST_RTC_TWCC
@@ -4125,6 +4349,53 @@ SrsConfDirective *SrsConfig::get_vhost(string vhost, bool try_default_vhost)
     return NULL;
 }
 
+SrsConfVhostSnapshot *SrsConfig::get_vhost_snapshot(string vhost)
+{
+    std::map<std::string, SrsConfVhostSnapshot *>::iterator it = vhost_snapshots_.find(vhost);
+    if (it != vhost_snapshots_.end()) {
+        return it->second;
+    }
+
+    // Use the name of vhost in config, so the unknown vhost, which falls back to the default vhost,
+    // never grows the snapshots.
+    SrsConfDirective *conf = get_vhost(vhost);
+    string name = conf ? conf->arg0() : "";
+    if (name != vhost && (it = vhost_snapshots_.find(name)) != vhost_snapshots_.end()) {
+        return it->second;
+    }
+
+    SrsConfVhostSnapshot *snapshot = new SrsConfVhostSnapshot();
+    snapshot->atc_ = do_get_atc(name);
+    snapshot->atc_auto_ = do_get_atc_auto(name);
+    snapshot->time_jitter_ = do_get_time_jitter(name);
+    snapshot->mix_correct_ = do_get_mix_correct(name);
+    snapshot->queue_length_ = do_get_queue_length(name);
+    snapshot->reduce_sequence_header_ = do_get_reduce_sequence_header(name);
+    snapshot->parse_sps_ = do_get_parse_sps(name);
+    snapshot->is_edge_ = do_get_vhost_is_edge(name);
+
+    vhost_snapshots_[name] = snapshot;
+    return snapshot;
+}
+
+void SrsConfig::on_config_changed()
+{
+    clear_vhost_snapshots();
+
+    // The config is changed, so the other caches compiled from config should be rebuilt.
+    generation_++;
+}
+
+void SrsConfig::clear_vhost_snapshots()
+{
+    std::map<std::string, SrsConfVhostSnapshot *>::iterator it;
+    for (it = vhost_snapshots_.begin(); it != vhost_snapshots_.end(); ++it) {
+        SrsConfVhostSnapshot *snapshot = it->second;
+        srs_freep(snapshot);
+    }
+    vhost_snapshots_.clear();
+}
+
 void SrsConfig::get_vhosts(vector<SrsConfDirective *> &vhosts)
 {
     srs_assert(root_);
@@ -4234,6 +4505,11 @@ bool SrsConfig::get_debug_srs_upnode(string vhost)
 }
 
 bool SrsConfig::get_atc(string vhost)
+{
+    return get_vhost_snapshot(vhost)->atc_;
+}
+
+bool SrsConfig::do_get_atc(string vhost)
 {
     SRS_OVERWRITE_BY_ENV_BOOL("srs.vhost.play.atc"); // SRS_VHOST_PLAY_ATC
 
@@ -4258,6 +4534,11 @@ bool SrsConfig::get_atc(string vhost)
 }
 
 bool SrsConfig::get_atc_auto(string vhost)
+{
+    return get_vhost_snapshot(vhost)->atc_auto_;
+}
+
+bool SrsConfig::do_get_atc_auto(string vhost)
 {
     SRS_OVERWRITE_BY_ENV_BOOL("srs.vhost.play.atc_auto"); // SRS_VHOST_PLAY_ATC_AUTO
 
@@ -4282,6 +4563,11 @@ bool SrsConfig::get_atc_auto(string vhost)
 }
 
 int SrsConfig::get_time_jitter(string vhost)
+{
+    return get_vhost_snapshot(vhost)->time_jitter_;
+}
+
+int SrsConfig::do_get_time_jitter(string vhost)
 {
     if (!srs_getenv("srs.vhost.play.time_jitter").empty()) { // SRS_VHOST_PLAY_TIME_JITTER
         return srs_time_jitter_string2int(srs_getenv("srs.vhost.play.time_jitter"));
@@ -4308,6 +4594,11 @@ int SrsConfig::get_time_jitter(string vhost)
 }
 
 bool SrsConfig::get_mix_correct(string vhost)
+{
+    return get_vhost_snapshot(vhost)->mix_correct_;
+}
+
+bool SrsConfig::do_get_mix_correct(string vhost)
 {
     SRS_OVERWRITE_BY_ENV_BOOL("srs.vhost.play.mix_correct"); // SRS_VHOST_PLAY_MIX_CORRECT
 
@@ -4332,6 +4623,11 @@ bool SrsConfig::get_mix_correct(string vhost)
 }
 
 srs_utime_t SrsConfig::get_queue_length(string vhost)
+{
+    return get_vhost_snapshot(vhost)->queue_length_;
+}
+
+srs_utime_t SrsConfig::do_get_queue_length(string vhost)
 {
     SRS_OVERWRITE_BY_ENV_SECONDS("srs.vhost.play.queue_length"); // SRS_VHOST_PLAY_QUEUE_LENGTH
 
@@ -4492,6 +4788,11 @@ int SrsConfig::get_chunk_size(string vhost)
 }
 
 bool SrsConfig::get_parse_sps(string vhost)
+{
+    return get_vhost_snapshot(vhost)->parse_sps_;
+}
+
+bool SrsConfig::do_get_parse_sps(string vhost)
 {
     SRS_OVERWRITE_BY_ENV_BOOL2("srs.vhost.publish.parse_sps"); // SRS_VHOST_PUBLISH_PARSE_SPS
 
@@ -4746,6 +5047,11 @@ srs_utime_t SrsConfig::get_send_min_interval(string vhost)
 }
 
 bool SrsConfig::get_reduce_sequence_header(string vhost)
+{
+    return get_vhost_snapshot(vhost)->reduce_sequence_header_;
+}
+
+bool SrsConfig::do_get_reduce_sequence_header(string vhost)
 {
     SRS_OVERWRITE_BY_ENV_BOOL("srs.vhost.play.reduce_sequence_header"); // SRS_VHOST_PLAY_REDUCE_SEQUENCE_HEADER
 
@@ -5084,7 +5390,50 @@ SrsConfDirective *SrsConfig::get_vhost_on_hls_notify(string vhost)
     return conf->get("on_hls_notify");
 }
 
+bool SrsConfig::get_vhost_http_hooks_keep_alive(string vhost)
+{
+    SRS_OVERWRITE_BY_ENV_BOOL("srs.vhost.http_hooks.keep_alive"); // SRS_VHOST_HTTP_HOOKS_KEEP_ALIVE
+
+    static bool DEFAULT = false;
+
+    SrsConfDirective *conf = get_vhost_http_hooks(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("keep_alive");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PREFER_FALSE(conf->arg0());
+}
+
+srs_utime_t SrsConfig::get_vhost_http_hooks_play_cache(string vhost)
+{
+    SRS_OVERWRITE_BY_ENV_SECONDS("srs.vhost.http_hooks.play_cache"); // SRS_VHOST_HTTP_HOOKS_PLAY_CACHE
+
+    static srs_utime_t DEFAULT = 0;
+
+    SrsConfDirective *conf = get_vhost_http_hooks(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("play_cache");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return (srs_utime_t)(::atoi(conf->arg0().c_str()) * SRS_UTIME_SECONDS);
+}
+
 bool SrsConfig::get_vhost_is_edge(string vhost)
+{
+    return get_vhost_snapshot(vhost)->is_edge_;
+}
+
+bool SrsConfig::do_get_vhost_is_edge(string vhost)
 {
     SrsConfDirective *conf = get_vhost(vhost);
     return get_vhost_is_edge(conf);
@@ -5193,6 +5542,116 @@ bool SrsConfig::get_vhost_edge_token_traverse(string vhost)
     return SRS_CONF_PREFER_FALSE(conf->arg0());
 }
 
+srs_utime_t SrsConfig::get_vhost_edge_token_traverse_ttl(string vhost)
+{
+    static srs_utime_t DEFAULT = 0;
+
+    SrsConfDirective *conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("cluster");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("token_traverse_ttl");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return (srs_utime_t)(::atoi(conf->arg0().c_str()) * SRS_UTIME_SECONDS);
+}
+
+srs_utime_t SrsConfig::get_vhost_edge_token_traverse_deny_ttl(string vhost)
+{
+    static srs_utime_t DEFAULT = 0;
+
+    SrsConfDirective *conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("cluster");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("token_traverse_deny_ttl");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return (srs_utime_t)(::atoi(conf->arg0().c_str()) * SRS_UTIME_SECONDS);
+}
+
+srs_utime_t SrsConfig::get_vhost_edge_hedge_delay(string vhost)
+{
+    static srs_utime_t DEFAULT = 0;
+
+    SrsConfDirective *conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("cluster");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("hedge_delay");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return (srs_utime_t)(::atoi(conf->arg0().c_str()) * SRS_UTIME_MILLISECONDS);
+}
+
+srs_utime_t SrsConfig::get_vhost_edge_warm_pull(string vhost)
+{
+    static srs_utime_t DEFAULT = 0;
+
+    SrsConfDirective *conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("cluster");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("warm_pull");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return (srs_utime_t)(::atoi(conf->arg0().c_str()) * SRS_UTIME_SECONDS);
+}
+
+int SrsConfig::get_vhost_edge_warm_pull_plays(string vhost)
+{
+    static int DEFAULT = 2;
+
+    SrsConfDirective *conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("cluster");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("warm_pull_plays");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return ::atoi(conf->arg0().c_str());
+}
+
 string SrsConfig::get_vhost_edge_transform_vhost(string vhost)
 {
     static string DEFAULT = "[vhost]";
@@ -5268,6 +5727,50 @@ vector<string> SrsConfig::get_vhost_coworkers(string vhost)
     return coworkers;
 }
 
+bool SrsConfig::get_vhost_origin_directory(string vhost)
+{
+    static bool DEFAULT = false;
+
+    SrsConfDirective *conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("cluster");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("origin_directory");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PREFER_FALSE(conf->arg0());
+}
+
+string SrsConfig::get_vhost_origin_directory_ip(string vhost)
+{
+    static string DEFAULT = "";
+
+    SrsConfDirective *conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("cluster");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("origin_directory_ip");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    return conf->arg0();
+}
+
 bool SrsConfig::get_security_enabled(string vhost)
 {
     static bool DEFAULT = false;
@@ -5980,6 +6483,36 @@ string SrsConfig::get_log_file()
     return conf->arg0();
 }
 
+bool SrsConfig::get_log_async()
+{
+    SRS_OVERWRITE_BY_ENV_BOOL("srs.srs_log_async"); // SRS_SRS_LOG_ASYNC
+    SRS_OVERWRITE_BY_ENV_BOOL("srs.log_async");     // SRS_LOG_ASYNC
+
+    static bool DEFAULT = false;
+
+    SrsConfDirective *conf = root_->get("srs_log_async");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PREFER_FALSE(conf->arg0());
+}
+
+int SrsConfig::get_log_limit()
+{
+    SRS_OVERWRITE_BY_ENV_INT("srs.srs_log_limit"); // SRS_SRS_LOG_LIMIT
+    SRS_OVERWRITE_BY_ENV_INT("srs.log_limit");     // SRS_LOG_LIMIT
+
+    static int DEFAULT = 0;
+
+    SrsConfDirective *conf = root_->get("srs_log_limit");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return ::atoi(conf->arg0().c_str());
+}
+
 bool SrsConfig::get_ff_log_enabled()
 {
     string log = get_ff_log_dir();
@@ -8154,6 +8687,30 @@ bool SrsConfig::get_vhost_http_remux_guess_has_av(string vhost)
     return SRS_CONF_PREFER_TRUE(conf->arg0());
 }
 
+bool SrsConfig::get_vhost_http_remux_ts_shared(string vhost)
+{
+    SRS_OVERWRITE_BY_ENV_BOOL("srs.vhost.http_remux.ts_shared"); // SRS_VHOST_HTTP_REMUX_TS_SHARED
+
+    static bool DEFAULT = false;
+
+    SrsConfDirective *conf = get_vhost(vhost);
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("http_remux");
+    if (!conf) {
+        return DEFAULT;
+    }
+
+    conf = conf->get("ts_shared");
+    if (!conf || conf->arg0().empty()) {
+        return DEFAULT;
+    }
+
+    return SRS_CONF_PREFER_FALSE(conf->arg0());
+}
+
 string SrsConfig::get_vhost_http_remux_mount(string vhost)
 {
     SRS_OVERWRITE_BY_ENV_STRING("srs.vhost.http_remux.mount"); // SRS_VHOST_HTTP_REMUX_MOUNT
@@ -292,6 +292,8 @@ public:
     virtual srs_error_t persistence() = 0;
     virtual std::string config() = 0;
     virtual SrsConfDirective *get_root() = 0;
+    // Get the generation of config, increased when config is parsed or reloaded.
+    virtual int get_generation() = 0;
     // Get the current work directory.
     virtual std::string cwd() = 0;
 
@@ -357,6 +359,9 @@ public:
     virtual std::string get_rtc_server_protocol() = 0;
     virtual std::vector<std::string> get_rtc_server_listens() = 0;
     virtual int get_rtc_server_reuseport() = 0;
+    virtual int get_rtc_server_recv_batch() = 0;
+    virtual int get_rtc_server_audio_transcoders() = 0;
+    virtual bool get_rtc_server_audio_transcoders_drop() = 0;
     virtual bool get_rtc_server_encrypt() = 0;
     virtual bool get_api_as_candidates() = 0;
     virtual bool get_resolve_api_domain() = 0;
@@ -413,6 +418,15 @@ public:
     virtual int get_dying_threshold() = 0;
     virtual int get_dying_pulse() = 0;
 
+public:
+    // Process supervisor config
+    virtual bool get_supervisor_enabled() = 0;
+    virtual std::string get_supervisor_srs_cpus() = 0;
+    virtual std::string get_supervisor_ffmpeg_cpus() = 0;
+    virtual int get_supervisor_ffmpeg_nice() = 0;
+    virtual int get_supervisor_threshold() = 0;
+    virtual srs_utime_t get_supervisor_backoff_max() = 0;
+
 public:
     // RTMPS config
     virtual std::string get_rtmps_ssl_cert() = 0;
@@ -450,7 +464,14 @@ public:
     // Edge config
     virtual bool get_vhost_origin_cluster(std::string vhost) = 0;
     virtual std::vector<std::string> get_vhost_coworkers(std::string vhost) = 0;
+    virtual bool get_vhost_origin_directory(std::string vhost) = 0;
+    virtual std::string get_vhost_origin_directory_ip(std::string vhost) = 0;
     virtual bool get_vhost_edge_token_traverse(std::string vhost) = 0;
+    virtual srs_utime_t get_vhost_edge_token_traverse_ttl(std::string vhost) = 0;
+    virtual srs_utime_t get_vhost_edge_token_traverse_deny_ttl(std::string vhost) = 0;
+    virtual srs_utime_t get_vhost_edge_hedge_delay(std::string vhost) = 0;
+    virtual srs_utime_t get_vhost_edge_warm_pull(std::string vhost) = 0;
+    virtual int get_vhost_edge_warm_pull_plays(std::string vhost) = 0;
     virtual SrsConfDirective *get_vhost_edge_origin(std::string vhost) = 0;
 
 public:
@@ -461,6 +482,8 @@ public:
     virtual SrsConfDirective *get_vhost_on_publish(std::string vhost) = 0;
     virtual SrsConfDirective *get_vhost_on_play(std::string vhost) = 0;
     virtual SrsConfDirective *get_vhost_on_stop(std::string vhost) = 0;
+    virtual bool get_vhost_http_hooks_keep_alive(std::string vhost) = 0;
+    virtual srs_utime_t get_vhost_http_hooks_play_cache(std::string vhost) = 0;
 
 public:
     // RTC config
@@ -478,6 +501,7 @@ public:
 public:
     virtual bool get_rtc_nack_enabled(std::string vhost) = 0;
     virtual bool get_rtc_nack_no_copy(std::string vhost) = 0;
+    virtual int get_rtc_nack_cache_size(std::string vhost) = 0;
     virtual bool get_realtime_enabled(std::string vhost, bool is_rtc) = 0;
     virtual int get_mw_msgs(std::string vhost, bool is_realtime, bool is_rtc) = 0;
     virtual SrsConfDirective *get_vhost_on_unpublish(std::string vhost) = 0;
@@ -562,6 +586,7 @@ public:
     virtual bool get_vhost_http_remux_has_audio(std::string vhost) = 0;
     virtual bool get_vhost_http_remux_has_video(std::string vhost) = 0;
     virtual bool get_vhost_http_remux_guess_has_av(std::string vhost) = 0;
+    virtual bool get_vhost_http_remux_ts_shared(std::string vhost) = 0;
     virtual std::string get_vhost_http_remux_mount(std::string vhost) = 0;
 
 public:
@@ -624,6 +649,26 @@ public:
     virtual SrsConfDirective *get_security_rules(std::string vhost) = 0;
 };
 
+// The compiled config of a vhost, resolved once from the directives and env variables, for the
+// getters on hot path, such as the sequence header and timestamp of each live source. It's
+// immutable and rebuilt after config is parsed or reloaded, @see SrsConfig::get_vhost_snapshot
+class SrsConfVhostSnapshot
+{
+public:
+    bool atc_;
+    bool atc_auto_;
+    int time_jitter_;
+    bool mix_correct_;
+    srs_utime_t queue_length_;
+    bool reduce_sequence_header_;
+    bool parse_sps_;
+    bool is_edge_;
+
+public:
+    SrsConfVhostSnapshot();
+    virtual ~SrsConfVhostSnapshot();
+};
+
 // The config service provider.
 // For the config supports reload, so never keep the reference cross st-thread,
 // that is, never save the SrsConfDirective* get by any api of config,
@@ -670,6 +715,11 @@ SRS_DECLARE_PROTECTED: // clang-format on
 SRS_DECLARE_PRIVATE: // clang-format on
     // The cache for parsing the config from environment variables.
     SrsConfDirective *env_cache_;
+    // The compiled snapshots of vhosts, key is the vhost name in config, empty for no vhost.
+    // @remark Cleared when config is parsed or reloaded, then rebuilt on the next access.
+    std::map<std::string, SrsConfVhostSnapshot *> vhost_snapshots_;
+    // The generation of config, increased when config is parsed or reloaded.
+    int generation_;
     // Reload  section
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
@@ -767,6 +817,8 @@ public:
     // The root directive, no name and args, contains directives.
     // All directive parsed can retrieve from root.
     virtual SrsConfDirective *get_root();
+    // Get the generation of config, for the caches compiled from config to detect the change.
+    virtual int get_generation();
     // Get the daemon config.
     // If  true, SRS will run in daemon mode, fork and fork to reap the
     // grand-child process to init process.
@@ -841,6 +893,21 @@ public:
     virtual int get_dying_threshold();
     virtual int get_dying_pulse();
 
+    // Process supervisor section.
+public:
+    // Whether supervise the FFmpeg of ingest and transcode, to pin cpus, limit and queue them.
+    virtual bool get_supervisor_enabled();
+    // The cpus to pin SRS itself, for example, 0-1, empty to not pin.
+    virtual std::string get_supervisor_srs_cpus();
+    // The cpus to pin the FFmpeg processes, for example, 2-7, empty to not pin.
+    virtual std::string get_supervisor_ffmpeg_cpus();
+    // The nice of FFmpeg processes, in [-20, 19].
+    virtual int get_supervisor_ffmpeg_nice();
+    // The host CPU percent(0, 100) to queue the transcodes, 0 to disable.
+    virtual int get_supervisor_threshold();
+    // The max backoff to restart a crashed FFmpeg.
+    virtual srs_utime_t get_supervisor_backoff_max();
+
     // stream_caster section
 public:
     // Get all stream_caster in config file.
@@ -884,6 +951,12 @@ public:
     virtual bool get_rtc_server_ecdsa();
     virtual bool get_rtc_server_encrypt();
     virtual int get_rtc_server_reuseport();
+    // Get the max number of UDP packets to receive by one recvmmsg, 1 to disable batch.
+    virtual int get_rtc_server_recv_batch();
+    // Get the max number of concurrent audio transcoders for RTC bridge, 0 for no limit.
+    virtual int get_rtc_server_audio_transcoders();
+    // Whether drop the audio of transcoders exceed the max number, or transcode inline.
+    virtual bool get_rtc_server_audio_transcoders_drop();
     virtual bool get_rtc_server_merge_nalus();
 
 public:
@@ -909,6 +982,8 @@ public:
     srs_utime_t get_rtc_pli_for_rtmp(std::string vhost);
     bool get_rtc_nack_enabled(std::string vhost);
     bool get_rtc_nack_no_copy(std::string vhost);
+    // The max size in KB of the shared NACK cache of stream, 0 to disable it.
+    int get_rtc_nack_cache_size(std::string vhost);
     bool get_rtc_twcc_enabled(std::string vhost);
     int get_rtc_opus_bitrate(std::string vhost);
     int get_rtc_aac_bitrate(std::string vhost);
@@ -1125,6 +1200,10 @@ public:
     // Get the on_hls_notify callbacks of vhost.
     // @return the on_hls_notify callback directive, the args is the url to callback.
     virtual SrsConfDirective *get_vhost_on_hls_notify(std::string vhost);
+    // Whether reuse the HTTP connections to the hooks server, by keep-alive.
+    virtual bool get_vhost_http_hooks_keep_alive(std::string vhost);
+    // Get the ttl to cache the allowed on_play, 0 to disable the cache.
+    virtual srs_utime_t get_vhost_http_hooks_play_cache(std::string vhost);
     // vhost cluster section
 public:
     // Whether vhost is edge mode.
@@ -1147,6 +1226,16 @@ public:
     // For example, we verify all clients on the origin FMS by server-side as,
     // all clients connected to edge must be tranverse to origin to verify.
     virtual bool get_vhost_edge_token_traverse(std::string vhost);
+    // Get the ttl to cache the allowed token of edge token traverse, 0 to disable the cache.
+    virtual srs_utime_t get_vhost_edge_token_traverse_ttl(std::string vhost);
+    // Get the ttl to cache the denied token of edge token traverse, 0 to disable the cache.
+    virtual srs_utime_t get_vhost_edge_token_traverse_deny_ttl(std::string vhost);
+    // Get the delay to race the next origin when pulling stream, 0 to disable the hedged connect.
+    virtual srs_utime_t get_vhost_edge_hedge_delay(std::string vhost);
+    // Get the duration to keep pulling the popular stream after the last player quit, 0 to disable.
+    virtual srs_utime_t get_vhost_edge_warm_pull(std::string vhost);
+    // Get the minimum plays in recent minute, for stream to be warm pulled.
+    virtual int get_vhost_edge_warm_pull_plays(std::string vhost);
     // Get the transformed vhost for edge,
     virtual std::string get_vhost_edge_transform_vhost(std::string vhost);
     // Whether enable the origin cluster.
@@ -1156,6 +1245,10 @@ public:
     // Get the co-workers of origin cluster.
     // @see https://ossrs.io/lts/en-us/docs/v7/doc/origin-cluster#legacy
     virtual std::vector<std::string> get_vhost_coworkers(std::string vhost);
+    // Whether push the streams to coworkers, to locate the origin of stream by local lookup.
+    virtual bool get_vhost_origin_directory(std::string vhost);
+    // Get the ip of this origin exposed to coworkers by directory, empty to discover it.
+    virtual std::string get_vhost_origin_directory_ip(std::string vhost);
     // vhost security section
 public:
     // Whether the secrity of vhost enabled.
@@ -1272,6 +1365,10 @@ public:
     virtual std::string get_log_level_v2();
     // Get the log file path.
     virtual std::string get_log_file();
+    // Whether write log to file in batch, buffer the lines and flush them by timer.
+    virtual bool get_log_async();
+    // The max number of logs per second for each log statement, 0 for no limit.
+    virtual int get_log_limit();
     // Whether ffmpeg log enabled
     virtual bool get_ff_log_enabled();
     // The ffmpeg log dir.
@@ -1522,6 +1619,8 @@ public:
     bool get_vhost_http_remux_has_video(std::string vhost);
     // Whether guessing stream about audio or video track
     bool get_vhost_http_remux_guess_has_av(std::string vhost);
+    // Whether HTTP-TS viewers share one TS packetizer of stream.
+    bool get_vhost_http_remux_ts_shared(std::string vhost);
     // Get the http flv live stream mount point for vhost.
     // used to generate the flv stream mount path.
     virtual std::string get_vhost_http_remux_mount(std::string vhost);
@@ -1569,6 +1668,25 @@ public:
     virtual std::string get_exporter_listen();
     virtual std::string get_exporter_label();
     virtual std::string get_exporter_tag();
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Called when the directives or env variables are changed by parse or reload, to drop the
+    // snapshots and increase the generation, so the caches compiled from config are rebuilt.
+    virtual void on_config_changed();
+    // Get the compiled snapshot of vhost, build it on the first access.
+    virtual SrsConfVhostSnapshot *get_vhost_snapshot(std::string vhost);
+    // Free all snapshots.
+    virtual void clear_vhost_snapshots();
+    // Resolve the config from directives and env variables, to build the snapshot.
+    virtual bool do_get_atc(std::string vhost);
+    virtual bool do_get_atc_auto(std::string vhost);
+    virtual int do_get_time_jitter(std::string vhost);
+    virtual bool do_get_mix_correct(std::string vhost);
+    virtual srs_utime_t do_get_queue_length(std::string vhost);
+    virtual bool do_get_reduce_sequence_header(std::string vhost);
+    virtual bool do_get_parse_sps(std::string vhost);
+    virtual bool do_get_vhost_is_edge(std::string vhost);
 };
 
 #endif
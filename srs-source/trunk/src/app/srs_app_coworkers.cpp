@@ -10,10 +10,15 @@
 using namespace std;
 
 #include <srs_app_config.hpp>
+#include <srs_app_factory.hpp>
+#include <srs_app_rtc_server.hpp>
 #include <srs_kernel_error.hpp>
 #include <srs_kernel_utility.hpp>
+#include <srs_protocol_http_client.hpp>
+#include <srs_protocol_http_stack.hpp>
 #include <srs_protocol_json.hpp>
 #include <srs_protocol_rtmp_stack.hpp>
+#include <srs_protocol_st.hpp>
 #include <srs_protocol_utility.hpp>
 
 SrsCoWorkers *SrsCoWorkers::instance_ = NULL;
@@ -45,14 +50,110 @@ SrsJsonAny *SrsCoWorkers::dumps(string vhost, string coworker, string app, strin
 {
     ISrsRequest *r = find_stream_info(vhost, app, stream);
     if (!r) {
-        // TODO: FIXME: Find stream from our origin util return to the start point.
-        return SrsJsonAny::null();
+        // Find the stream in directory, which is pushed by its origin.
+        SrsClusterOrigin *origin = NULL;
+        if (_srs_cluster_directory && _srs_config->get_vhost_origin_directory(vhost)) {
+            origin = _srs_cluster_directory->find(vhost, app, stream);
+        }
+        if (!origin) {
+            // TODO: FIXME: Find stream from our origin util return to the start point.
+            return SrsJsonAny::null();
+        }
+
+        srs_trace("Redirect vhost=%s, path=%s/%s to ip=%s, port=%d, api=%s by directory",
+                  vhost.c_str(), app.c_str(), stream.c_str(), origin->ip_.c_str(), origin->port_, origin->api_.c_str());
+
+        return SrsJsonAny::object()
+            ->set("ip", SrsJsonAny::str(origin->ip_.c_str()))
+            ->set("port", SrsJsonAny::integer(origin->port_))
+            ->set("vhost", SrsJsonAny::str(origin->vhost_.c_str()))
+            ->set("api", SrsJsonAny::str(origin->api_.c_str()))
+            ->set("routers", SrsJsonAny::array()->append(SrsJsonAny::str(origin->api_.c_str())));
+    }
+
+    string service_ip, backend;
+    int listen_port = SRS_CONSTS_RTMP_DEFAULT_PORT;
+    srs_cluster_service(_srs_config, coworker, service_ip, listen_port, backend);
+
+    // The routers to detect loop and identify path.
+    SrsJsonArray *routers = SrsJsonAny::array()->append(SrsJsonAny::str(backend.c_str()));
+
+    srs_trace("Redirect vhost=%s, path=%s/%s to ip=%s, port=%d, api=%s",
+              vhost.c_str(), app.c_str(), stream.c_str(), service_ip.c_str(), listen_port, backend.c_str());
+
+    return SrsJsonAny::object()
+        ->set("ip", SrsJsonAny::str(service_ip.c_str()))
+        ->set("port", SrsJsonAny::integer(listen_port))
+        ->set("vhost", SrsJsonAny::str(r->vhost_.c_str()))
+        ->set("api", SrsJsonAny::str(backend.c_str()))
+        ->set("routers", routers);
+}
+// LCOV_EXCL_STOP
+
+ISrsRequest *SrsCoWorkers::find_stream_info(string vhost, string app, string stream)
+{
+    // First, we should parse the vhost, if not exists, try default vhost instead.
+    SrsConfDirective *conf = _srs_config->get_vhost(vhost, true);
+    if (!conf) {
+        return NULL;
+    }
+
+    // Get stream information from local cache.
+    string url = srs_net_url_encode_sid(conf->arg0(), app, stream);
+    map<string, ISrsRequest *>::iterator it = streams_.find(url);
+    if (it == streams_.end()) {
+        return NULL;
     }
 
+    return it->second;
+}
+
+srs_error_t SrsCoWorkers::on_publish(ISrsRequest *r)
+{
+    srs_error_t err = srs_success;
+
+    string url = r->get_stream_url();
+
+    // Delete the previous stream informations.
+    map<string, ISrsRequest *>::iterator it = streams_.find(url);
+    if (it != streams_.end()) {
+        srs_freep(it->second);
+    }
+
+    // Always use the latest one.
+    streams_[url] = r->copy();
+
+    // Push the stream to coworkers, so they locate it without querying.
+    if (_srs_cluster_directory && _srs_config->get_vhost_origin_directory(r->vhost_)) {
+        if ((err = _srs_cluster_directory->on_publish(r)) != srs_success) {
+            return srs_error_wrap(err, "directory");
+        }
+    }
+
+    return err;
+}
+
+void SrsCoWorkers::on_unpublish(ISrsRequest *r)
+{
+    string url = r->get_stream_url();
+
+    map<string, ISrsRequest *>::iterator it = streams_.find(url);
+    if (it != streams_.end()) {
+        srs_freep(it->second);
+        streams_.erase(it);
+    }
+
+    if (_srs_cluster_directory) {
+        _srs_cluster_directory->on_unpublish(r);
+    }
+}
+
+void srs_cluster_service(ISrsAppConfig *config, string coworker, string &ip, int &port, string &api)
+{
     // The service port parsing from listen port.
     string listen_host;
     int listen_port = SRS_CONSTS_RTMP_DEFAULT_PORT;
-    vector<string> listen_hostports = _srs_config->get_listens();
+    vector<string> listen_hostports = config->get_listens();
     if (!listen_hostports.empty()) {
         string list_hostport = listen_hostports.at(0);
 
@@ -86,69 +187,514 @@ SrsJsonAny *SrsCoWorkers::dumps(string vhost, string coworker, string app, strin
     }
 
     // The backend API endpoint.
-    string backend = _srs_config->get_http_api_listens().at(0);
+    string backend = config->get_http_api_listens().at(0);
     if (backend.find(":") == string::npos) {
         backend = service_ip + ":" + backend;
     }
 
-    // The routers to detect loop and identify path.
-    SrsJsonArray *routers = SrsJsonAny::array()->append(SrsJsonAny::str(backend.c_str()));
+    ip = service_ip;
+    port = listen_port;
+    api = backend;
+}
 
-    srs_trace("Redirect vhost=%s, path=%s/%s to ip=%s, port=%d, api=%s",
-              vhost.c_str(), app.c_str(), stream.c_str(), service_ip.c_str(), listen_port, backend.c_str());
+SrsClusterOrigin::SrsClusterOrigin()
+{
+    port_ = 0;
+    expire_ = 0;
+}
 
-    return SrsJsonAny::object()
-        ->set("ip", SrsJsonAny::str(service_ip.c_str()))
-        ->set("port", SrsJsonAny::integer(listen_port))
-        ->set("vhost", SrsJsonAny::str(r->vhost_.c_str()))
-        ->set("api", SrsJsonAny::str(backend.c_str()))
-        ->set("routers", routers);
+SrsClusterOrigin::~SrsClusterOrigin()
+{
 }
-// LCOV_EXCL_STOP
 
-ISrsRequest *SrsCoWorkers::find_stream_info(string vhost, string app, string stream)
+SrsClusterChange::SrsClusterChange()
 {
-    // First, we should parse the vhost, if not exists, try default vhost instead.
-    SrsConfDirective *conf = _srs_config->get_vhost(vhost, true);
-    if (!conf) {
-        return NULL;
+}
+
+SrsClusterChange::~SrsClusterChange()
+{
+    for (int i = 0; i < (int)streams_.size(); i++) {
+        ISrsRequest *r = streams_.at(i);
+        srs_freep(r);
     }
+}
 
-    // Get stream information from local cache.
-    string url = srs_net_url_encode_sid(conf->arg0(), app, stream);
-    map<string, ISrsRequest *>::iterator it = streams_.find(url);
-    if (it == streams_.end()) {
-        return NULL;
+SrsClusterDirectory *_srs_cluster_directory = NULL;
+
+SrsClusterDirectory::SrsClusterDirectory()
+{
+    config_ = _srs_config;
+    app_factory_ = _srs_app_factory;
+
+    trd_ = new SrsDummyCoroutine();
+    started_ = false;
+    cond_ = new SrsCond();
+    last_sync_ = 0;
+
+    nn_pushed_ = 0;
+    nn_push_errors_ = 0;
+    nn_received_ = 0;
+    nn_hits_ = 0;
+}
+
+SrsClusterDirectory::~SrsClusterDirectory()
+{
+    trd_->stop();
+    srs_freep(trd_);
+    srs_freep(cond_);
+
+    std::map<std::string, ISrsRequest *>::iterator it;
+    for (it = locals_.begin(); it != locals_.end(); ++it) {
+        srs_freep(it->second);
     }
 
-    return it->second;
+    std::vector<SrsClusterChange *>::iterator it2;
+    for (it2 = changes_.begin(); it2 != changes_.end(); ++it2) {
+        srs_freep(*it2);
+    }
+
+    std::map<std::string, ISrsHttpClient *>::iterator it3;
+    for (it3 = peers_.begin(); it3 != peers_.end(); ++it3) {
+        srs_freep(it3->second);
+    }
+
+    std::map<std::string, SrsClusterOrigin *>::iterator it4;
+    for (it4 = origins_.begin(); it4 != origins_.end(); ++it4) {
+        srs_freep(it4->second);
+    }
+
+    config_ = NULL;
+    app_factory_ = NULL;
 }
 
-srs_error_t SrsCoWorkers::on_publish(ISrsRequest *r)
+srs_error_t SrsClusterDirectory::on_publish(ISrsRequest *r)
 {
     srs_error_t err = srs_success;
 
     string url = r->get_stream_url();
 
-    // Delete the previous stream informations.
-    map<string, ISrsRequest *>::iterator it = streams_.find(url);
-    if (it != streams_.end()) {
+    map<string, ISrsRequest *>::iterator it = locals_.find(url);
+    if (it != locals_.end()) {
         srs_freep(it->second);
     }
+    locals_[url] = r->copy();
 
-    // Always use the latest one.
-    streams_[url] = r->copy();
+    vector<ISrsRequest *> streams;
+    streams.push_back(r);
+    enqueue(r->vhost_, "publish", streams);
+
+    if ((err = start()) != srs_success) {
+        return srs_error_wrap(err, "start");
+    }
 
     return err;
 }
 
-void SrsCoWorkers::on_unpublish(ISrsRequest *r)
+void SrsClusterDirectory::on_unpublish(ISrsRequest *r)
 {
     string url = r->get_stream_url();
 
-    map<string, ISrsRequest *>::iterator it = streams_.find(url);
-    if (it != streams_.end()) {
-        srs_freep(it->second);
-        streams_.erase(it);
+    map<string, ISrsRequest *>::iterator it = locals_.find(url);
+    if (it == locals_.end()) {
+        return;
+    }
+
+    vector<ISrsRequest *> streams;
+    streams.push_back(it->second);
+    enqueue(r->vhost_, "unpublish", streams);
+
+    srs_freep(it->second);
+    locals_.erase(it);
+
+    // Wakeup the coroutine to push the change.
+    cond_->signal();
+}
+
+srs_error_t SrsClusterDirectory::on_message(SrsJsonObject *msg, string ip)
+{
+    srs_error_t err = srs_success;
+
+    SrsJsonAny *prop = NULL;
+    if ((prop = msg->ensure_property_string("action")) == NULL) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "no action");
+    }
+    string action = prop->to_str();
+
+    if ((prop = msg->ensure_property_string("vhost")) == NULL) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "no vhost");
+    }
+    string vhost = prop->to_str();
+
+    if ((prop = msg->ensure_property_object("origin")) == NULL) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "no origin");
+    }
+    SrsJsonObject *origin = prop->to_object();
+
+    if ((prop = origin->ensure_property_string("api")) == NULL) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "no origin api");
+    }
+    string api = prop->to_str();
+
+    string origin_ip;
+    if ((prop = origin->ensure_property_string("ip")) != NULL) {
+        origin_ip = prop->to_str();
+    }
+
+    int port = SRS_CONSTS_RTMP_DEFAULT_PORT;
+    if ((prop = origin->ensure_property_integer("port")) != NULL) {
+        port = (int)prop->to_integer();
+    }
+
+    if ((prop = msg->ensure_property_array("streams")) == NULL) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "no streams");
+    }
+    SrsJsonArray *streams = prop->to_array();
+
+    // Ignore the message from this origin, when configured as coworker of itself.
+    if (apis_.find(api) != apis_.end()) {
+        return err;
+    }
+
+    // Ignore the message if directory of vhost is disabled.
+    if (!config_->get_vhost_origin_directory(vhost)) {
+        return err;
+    }
+
+    // Only accept the message from coworkers, or anyone could redirect the clients to any server.
+    if (!is_coworker(vhost, ip)) {
+        return srs_error_new(ERROR_SYSTEM_SECURITY_DENY, "ip=%s is not coworker of vhost=%s", ip.c_str(), vhost.c_str());
+    }
+    nn_received_++;
+
+    // The sync carries all streams of origin in vhost, so remove the streams which are not in it.
+    if (action == "sync") {
+        map<string, SrsClusterOrigin *>::iterator it;
+        for (it = origins_.begin(); it != origins_.end();) {
+            SrsClusterOrigin *o = it->second;
+            if (o->api_ != api || o->vhost_ != vhost) {
+                ++it;
+                continue;
+            }
+
+            srs_freep(o);
+            origins_.erase(it++);
+        }
+    }
+
+    for (int i = 0; i < streams->count(); i++) {
+        SrsJsonAny *stream = streams->at(i);
+        if (!stream->is_object()) {
+            continue;
+        }
+
+        SrsJsonObject *obj = stream->to_object();
+        SrsJsonAny *stream_vhost = obj->ensure_property_string("vhost");
+        SrsJsonAny *app = obj->ensure_property_string("app");
+        SrsJsonAny *name = obj->ensure_property_string("stream");
+        if (!stream_vhost || !app || !name) {
+            continue;
+        }
+
+        // Ignore the stream of other vhost, which is not authorized by the coworkers of it.
+        if (stream_vhost->to_str() != vhost) {
+            continue;
+        }
+
+        string url = srs_net_url_encode_sid(vhost, app->to_str(), name->to_str());
+        map<string, SrsClusterOrigin *>::iterator it = origins_.find(url);
+
+        if (action == "unpublish") {
+            // Only remove by its origin, the stream might be republished on another origin.
+            if (it != origins_.end() && it->second->api_ == api) {
+                srs_freep(it->second);
+                origins_.erase(it);
+            }
+            continue;
+        }
+
+        SrsClusterOrigin *o = (it != origins_.end()) ? it->second : NULL;
+        if (!o) {
+            o = new SrsClusterOrigin();
+            origins_[url] = o;
+        }
+
+        o->ip_ = origin_ip;
+        o->port_ = port;
+        o->api_ = api;
+        o->vhost_ = vhost;
+        o->expire_ = srs_time_now_cached() + SRS_CLUSTER_DIRECTORY_TTL;
+    }
+
+    return err;
+}
+
+SrsClusterOrigin *SrsClusterDirectory::find(string vhost, string app, string stream)
+{
+    // Resolve the vhost, if not exists, try default vhost instead.
+    SrsConfDirective *conf = config_->get_vhost(vhost, true);
+    if (conf) {
+        vhost = conf->arg0();
+    }
+
+    string url = srs_net_url_encode_sid(vhost, app, stream);
+    map<string, SrsClusterOrigin *>::iterator it = origins_.find(url);
+    if (it == origins_.end()) {
+        return NULL;
+    }
+
+    SrsClusterOrigin *o = it->second;
+    if (o->expire_ < srs_time_now_cached()) {
+        srs_freep(o);
+        origins_.erase(it);
+        return NULL;
+    }
+
+    nn_hits_++;
+    return o;
+}
+
+void SrsClusterDirectory::dumps(SrsJsonObject *obj)
+{
+    obj->set("locals", SrsJsonAny::integer((int)locals_.size()));
+    obj->set("streams", SrsJsonAny::integer((int)origins_.size()));
+    obj->set("peers", SrsJsonAny::integer((int)peers_.size()));
+    obj->set("pushed", SrsJsonAny::integer(nn_pushed_));
+    obj->set("push_errors", SrsJsonAny::integer(nn_push_errors_));
+    obj->set("backoffs", SrsJsonAny::integer((int)backoffs_.size()));
+    obj->set("received", SrsJsonAny::integer(nn_received_));
+    obj->set("hits", SrsJsonAny::integer(nn_hits_));
+}
+
+// LCOV_EXCL_START
+srs_error_t SrsClusterDirectory::cycle()
+{
+    srs_error_t err = srs_success;
+
+    while (true) {
+        if ((err = trd_->pull()) != srs_success) {
+            return srs_error_wrap(err, "directory");
+        }
+
+        if (srs_time_now_cached() - last_sync_ >= SRS_CLUSTER_DIRECTORY_SYNC) {
+            sync();
+        }
+
+        flush();
+        expire();
+
+        if (changes_.empty()) {
+            cond_->timedwait(SRS_CLUSTER_DIRECTORY_SYNC);
+        }
     }
+
+    return err;
+}
+
+srs_error_t SrsClusterDirectory::start()
+{
+    srs_error_t err = srs_success;
+
+    if (started_) {
+        cond_->signal();
+        return err;
+    }
+    started_ = true;
+
+    srs_freep(trd_);
+    trd_ = new SrsSTCoroutine("cluster", this);
+    last_sync_ = srs_time_now_cached();
+
+    if ((err = trd_->start()) != srs_success) {
+        return srs_error_wrap(err, "start coroutine");
+    }
+
+    return err;
+}
+// LCOV_EXCL_STOP
+
+void SrsClusterDirectory::enqueue(string vhost, string action, vector<ISrsRequest *> &streams)
+{
+    SrsClusterChange *change = new SrsClusterChange();
+    change->vhost_ = vhost;
+    change->action_ = action;
+    for (int i = 0; i < (int)streams.size(); i++) {
+        change->streams_.push_back(streams.at(i)->copy());
+    }
+    changes_.push_back(change);
+}
+
+string SrsClusterDirectory::encode(SrsClusterChange *change, string coworker)
+{
+    // Use the configured ip as the exposed ip, or the host of coworker like the query of coworkers, because
+    // the origins behind the same NAT are reached by the same ip, see https://github.com/ossrs/srs/issues/1501
+    string ip, api;
+    int port = SRS_CONSTS_RTMP_DEFAULT_PORT;
+    string exposed = config_->get_vhost_origin_directory_ip(change->vhost_);
+    srs_cluster_service(config_, exposed.empty() ? coworker : exposed, ip, port, api);
+    if (!exposed.empty()) {
+        ip = exposed;
+    }
+    apis_.insert(api);
+
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    obj->set("action", SrsJsonAny::str(change->action_.c_str()));
+    obj->set("vhost", SrsJsonAny::str(change->vhost_.c_str()));
+    obj->set("origin", SrsJsonAny::object()
+                           ->set("ip", SrsJsonAny::str(ip.c_str()))
+                           ->set("port", SrsJsonAny::integer(port))
+                           ->set("api", SrsJsonAny::str(api.c_str())));
+
+    SrsJsonArray *arr = SrsJsonAny::array();
+    obj->set("streams", arr);
+    for (int i = 0; i < (int)change->streams_.size(); i++) {
+        ISrsRequest *r = change->streams_.at(i);
+        arr->append(SrsJsonAny::object()
+                        ->set("vhost", SrsJsonAny::str(r->vhost_.c_str()))
+                        ->set("app", SrsJsonAny::str(r->app_.c_str()))
+                        ->set("stream", SrsJsonAny::str(r->stream_.c_str())));
+    }
+
+    return obj->dumps();
+}
+
+void SrsClusterDirectory::sync()
+{
+    last_sync_ = srs_time_now_cached();
+
+    // Retry the failed coworkers by the sync, which recovers the changes dropped for them.
+    backoffs_.clear();
+
+    // Group the streams by vhost, because each vhost has its coworkers.
+    map<string, vector<ISrsRequest *> > vhosts;
+    map<string, ISrsRequest *>::iterator it;
+    for (it = locals_.begin(); it != locals_.end(); ++it) {
+        ISrsRequest *r = it->second;
+        vhosts[r->vhost_].push_back(r);
+    }
+
+    map<string, vector<ISrsRequest *> >::iterator it2;
+    for (it2 = vhosts.begin(); it2 != vhosts.end(); ++it2) {
+        enqueue(it2->first, "sync", it2->second);
+    }
+}
+
+void SrsClusterDirectory::flush()
+{
+    // Take all changes, because new changes might be enqueued when pushing.
+    vector<SrsClusterChange *> changes;
+    changes.swap(changes_);
+
+    for (int i = 0; i < (int)changes.size(); i++) {
+        SrsUniquePtr<SrsClusterChange> change(changes.at(i));
+
+        vector<string> coworkers = config_->get_vhost_coworkers(change->vhost_);
+        for (int j = 0; j < (int)coworkers.size(); j++) {
+            string coworker = coworkers.at(j);
+
+            if (backoffs_.find(coworker) != backoffs_.end()) {
+                continue;
+            }
+
+            srs_error_t err = push(coworker, encode(change.get(), coworker));
+            if (err != srs_success) {
+                nn_push_errors_++;
+                backoffs_.insert(coworker);
+                srs_warn("cluster: push to %s err %s, backoff to next sync", coworker.c_str(), srs_error_desc(err).c_str());
+                srs_freep(err);
+                continue;
+            }
+
+            nn_pushed_++;
+        }
+    }
+}
+
+srs_error_t SrsClusterDirectory::push(string coworker, string body)
+{
+    srs_error_t err = srs_success;
+
+    // Reuse the persistent connection to coworker, created when first push or error.
+    ISrsHttpClient *sdk = NULL;
+    map<string, ISrsHttpClient *>::iterator it = peers_.find(coworker);
+    if (it != peers_.end()) {
+        sdk = it->second;
+    } else {
+        string host = coworker;
+        int port = SRS_DEFAULT_HTTP_PORT;
+        srs_net_split_hostport(coworker, host, port);
+
+        sdk = app_factory_->create_http_client();
+        if ((err = sdk->initialize("http", host, port, SRS_CLUSTER_DIRECTORY_TIMEOUT)) != srs_success) {
+            srs_freep(sdk);
+            return srs_error_wrap(err, "init client");
+        }
+        peers_[coworker] = sdk;
+    }
+
+    ISrsHttpMessage *msg_raw = NULL;
+    if ((err = sdk->post("/api/v1/clusters", body, &msg_raw)) != srs_success) {
+        srs_freep(sdk);
+        peers_.erase(coworker);
+        return srs_error_wrap(err, "post");
+    }
+    SrsUniquePtr<ISrsHttpMessage> msg(msg_raw);
+
+    // Always drain the response, to reuse the connection.
+    string res;
+    if ((err = msg->body_read_all(res)) != srs_success) {
+        srs_freep(sdk);
+        peers_.erase(coworker);
+        return srs_error_wrap(err, "read body");
+    }
+
+    if (msg->status_code() != SRS_CONSTS_HTTP_OK) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "status=%d, res=%s", msg->status_code(), res.c_str());
+    }
+
+    return err;
+}
+
+void SrsClusterDirectory::expire()
+{
+    srs_utime_t now = srs_time_now_cached();
+
+    map<string, SrsClusterOrigin *>::iterator it;
+    for (it = origins_.begin(); it != origins_.end();) {
+        SrsClusterOrigin *o = it->second;
+        if (o->expire_ >= now) {
+            ++it;
+            continue;
+        }
+
+        srs_freep(o);
+        origins_.erase(it++);
+    }
+}
+
+bool SrsClusterDirectory::is_coworker(string vhost, string ip)
+{
+    if (ip.empty()) {
+        return false;
+    }
+
+    vector<string> coworkers = config_->get_vhost_coworkers(vhost);
+    for (int i = 0; i < (int)coworkers.size(); i++) {
+        string host = coworkers.at(i);
+        int port = SRS_DEFAULT_HTTP_PORT;
+        srs_net_split_hostport(coworkers.at(i), host, port);
+
+        if (host == ip) {
+            return true;
+        }
+
+        // The coworker might be configured by domain name, for example, in docker.
+        if (!srs_net_is_ipv4(host)) {
+            int family = 0;
+            if (srs_dns_resolve(host, family) == ip) {
+                return true;
+            }
+        }
+    }
+
+    return false;
 }
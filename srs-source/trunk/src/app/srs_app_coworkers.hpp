@@ -9,12 +9,21 @@
 
 #include <srs_core.hpp>
 
+#include <srs_app_st.hpp>
+
 #include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 class SrsJsonAny;
+class SrsJsonObject;
 class ISrsRequest;
 class SrsLiveSource;
+class ISrsAppConfig;
+class ISrsAppFactory;
+class ISrsHttpClient;
+class SrsCond;
 
 // For origin cluster.
 class SrsCoWorkers
@@ -47,4 +56,134 @@ public:
     virtual void on_unpublish(ISrsRequest *r);
 };
 
+// Discover the RTMP service ip and port, and the HTTP API of this origin.
+// @param coworker The host to reach this origin, used as ip if listen at loopback.
+extern void srs_cluster_service(ISrsAppConfig *config, std::string coworker, std::string &ip, int &port, std::string &api);
+
+// The interval to sync all streams to coworkers, which renews the streams in directory.
+#define SRS_CLUSTER_DIRECTORY_SYNC (10 * SRS_UTIME_SECONDS)
+// The stream in directory expires when not renewed by its origin.
+#define SRS_CLUSTER_DIRECTORY_TTL (3 * SRS_CLUSTER_DIRECTORY_SYNC)
+// The timeout to push to coworker.
+#define SRS_CLUSTER_DIRECTORY_TIMEOUT (3 * SRS_UTIME_SECONDS)
+
+// The origin of stream in cluster directory, which is published on a coworker.
+class SrsClusterOrigin
+{
+public:
+    // The RTMP service of origin, to redirect client to.
+    std::string ip_;
+    int port_;
+    // The HTTP API of origin, to identify the origin.
+    std::string api_;
+    // The vhost of stream on origin.
+    std::string vhost_;
+    // The time to expire, renewed by the origin.
+    srs_utime_t expire_;
+
+public:
+    SrsClusterOrigin();
+    virtual ~SrsClusterOrigin();
+};
+
+// The change of streams to push to the coworkers of vhost.
+class SrsClusterChange
+{
+public:
+    std::string vhost_;
+    // The action of change, publish, unpublish or sync.
+    std::string action_;
+    // The streams of change, which are owned by the change.
+    std::vector<ISrsRequest *> streams_;
+
+public:
+    SrsClusterChange();
+    virtual ~SrsClusterChange();
+};
+
+// The directory of streams in origin cluster. The origin pushes the streams published on it to
+// coworkers over persistent HTTP connections, and keeps the streams pushed by coworkers, so the
+// origin of stream is resolved by a local lookup, rather than querying all coworkers.
+//      POST /api/v1/clusters
+//      {"action": "publish|unpublish|sync", "vhost", "origin": {"ip", "port", "api"},
+//          "streams": [{"vhost", "app", "stream"}]}
+// The sync carries all streams of origin in vhost, which is pushed periodically to renew the
+// directory, so the stream expires when origin is down, and coworker restarted recovers in a while.
+// @remark Only accept the message from the coworkers of vhost, identified by the peer ip.
+class SrsClusterDirectory : public ISrsCoroutineHandler
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsAppConfig *config_;
+    ISrsAppFactory *app_factory_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsCoroutine *trd_;
+    bool started_;
+    SrsCond *cond_;
+    // The HTTP APIs of this origin pushed to coworkers, to ignore the message from itself.
+    std::set<std::string> apis_;
+    srs_utime_t last_sync_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The streams published on this origin, the key is stream url.
+    std::map<std::string, ISrsRequest *> locals_;
+    // The changes to push to coworkers, in order.
+    std::vector<SrsClusterChange *> changes_;
+    // The persistent HTTP connections to coworkers, the key is the endpoint of coworker.
+    std::map<std::string, ISrsHttpClient *> peers_;
+    // The origins of streams on coworkers, the key is stream url.
+    std::map<std::string, SrsClusterOrigin *> origins_;
+    // The coworkers failed to push, which are skipped until the next sync, so a dead coworker
+    // never delays the changes to others by the timeout of each change.
+    std::set<std::string> backoffs_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    int64_t nn_pushed_;
+    int64_t nn_push_errors_;
+    int64_t nn_received_;
+    int64_t nn_hits_;
+
+public:
+    SrsClusterDirectory();
+    virtual ~SrsClusterDirectory();
+
+public:
+    // Push the stream published on this origin to coworkers.
+    virtual srs_error_t on_publish(ISrsRequest *r);
+    virtual void on_unpublish(ISrsRequest *r);
+    // Apply the message pushed by coworker, the ip is the peer of HTTP connection.
+    virtual srs_error_t on_message(SrsJsonObject *msg, std::string ip);
+    // Find the origin of stream on coworkers, NULL if not found or expired.
+    virtual SrsClusterOrigin *find(std::string vhost, std::string app, std::string stream);
+    virtual void dumps(SrsJsonObject *obj);
+
+public:
+    virtual srs_error_t cycle();
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    virtual srs_error_t start();
+    // Queue the change of streams to push to the coworkers of vhost.
+    virtual void enqueue(std::string vhost, std::string action, std::vector<ISrsRequest *> &streams);
+    // Build the message of change for coworker, with the service of this origin exposed to it, which
+    // is the origin_directory_ip if configured, or discovered like the query of coworkers.
+    virtual std::string encode(SrsClusterChange *change, std::string coworker);
+    // Sync all streams of this origin to coworkers.
+    virtual void sync();
+    // Push all changes to coworkers, the failed change is dropped and recovered by sync, and the
+    // failed coworker is backed off until the next sync.
+    virtual void flush();
+    virtual srs_error_t push(std::string coworker, std::string body);
+    // Remove the expired streams in directory.
+    virtual void expire();
+    // Whether the ip is of the coworkers of vhost.
+    virtual bool is_coworker(std::string vhost, std::string ip);
+};
+
+extern SrsClusterDirectory *_srs_cluster_directory;
+
 #endif
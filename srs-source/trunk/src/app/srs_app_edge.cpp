@@ -33,6 +33,7 @@ using namespace std;
 #include <srs_protocol_amf0.hpp>
 #include <srs_protocol_http_client.hpp>
 #include <srs_protocol_io.hpp>
+#include <srs_protocol_json.hpp>
 #include <srs_protocol_rtmp_msg_array.hpp>
 #include <srs_protocol_rtmp_stack.hpp>
 #include <srs_protocol_utility.hpp>
@@ -43,6 +44,29 @@ using namespace std;
 // when edge error, wait for quit
 #define SRS_EDGE_FORWARDER_TIMEOUT (150 * SRS_UTIME_MILLISECONDS)
 
+// The max messages to receive by hedge racer, if no keyframe.
+#define SRS_EDGE_HEDGE_MAX_MSGS 512
+
+// The window of recent plays, to check whether stream is popular for warm pull.
+#define SRS_EDGE_WARM_PULL_WINDOW (60 * SRS_UTIME_SECONDS)
+
+bool srs_edge_is_first_frame(SrsRtmpCommonMessage *msg, bool &has_video)
+{
+    if (msg->header_.is_video()) {
+        if (SrsFlvVideo::sh(msg->payload(), msg->size())) {
+            has_video = true;
+            return false;
+        }
+        return SrsFlvVideo::keyframe(msg->payload(), msg->size());
+    }
+
+    if (msg->header_.is_audio()) {
+        return !has_video && !SrsFlvAudio::sh(msg->payload(), msg->size());
+    }
+
+    return false;
+}
+
 ISrsEdgeUpstream::ISrsEdgeUpstream()
 {
 }
@@ -161,6 +185,138 @@ void SrsEdgeRtmpUpstream::kbps_sample(const char *label, srs_utime_t age)
     sdk_->kbps_sample(label, age);
 }
 
+SrsEdgeFlvDemuxer::SrsEdgeFlvDemuxer(int chunk_size)
+{
+    reader_ = NULL;
+    chunk_size_ = chunk_size;
+    p_ = end_ = NULL;
+
+    nn_reads_ = 0;
+    nn_tags_ = 0;
+}
+
+SrsEdgeFlvDemuxer::~SrsEdgeFlvDemuxer()
+{
+}
+
+void SrsEdgeFlvDemuxer::initialize(ISrsReader *r)
+{
+    reader_ = r;
+
+    chunk_ = SrsSharedPtr<SrsMemoryBlock>();
+    p_ = end_ = NULL;
+}
+
+srs_error_t SrsEdgeFlvDemuxer::read_header(char header[9])
+{
+    srs_error_t err = srs_success;
+
+    // The FLV header, and the 4bytes previous tag size which is always 0.
+    if ((err = grow(9 + 4)) != srs_success) {
+        return srs_error_wrap(err, "read header");
+    }
+
+    memcpy(header, p_, 9);
+    p_ += 9 + 4;
+
+    if (header[0] != 'F' || header[1] != 'L' || header[2] != 'V') {
+        return srs_error_new(ERROR_KERNEL_FLV_HEADER, "flv header must start with FLV");
+    }
+
+    return err;
+}
+
+srs_error_t SrsEdgeFlvDemuxer::read_tag(char *ptype, uint32_t *ptime, SrsMemoryBlock **ppayload)
+{
+    srs_error_t err = srs_success;
+
+    if ((err = grow(SRS_FLV_TAG_HEADER_SIZE)) != srs_success) {
+        return srs_error_wrap(err, "read tag header");
+    }
+
+    SrsBuffer buf(p_, SRS_FLV_TAG_HEADER_SIZE);
+
+    // Reserved UB [2], Filter UB [1], TagType UB [5]
+    char type = buf.read_1bytes() & 0x1F;
+    // DataSize UI24
+    int32_t size = buf.read_3bytes();
+    // Timestamp UI24, TimestampExtended UI8
+    uint32_t time = (uint32_t)buf.read_3bytes();
+    time |= ((uint32_t)(uint8_t)buf.read_1bytes()) << 24;
+
+    // Read the whole tag with the previous tag size, which might switch to a new chunk.
+    int nn_tag = SRS_FLV_TAG_HEADER_SIZE + size + SRS_FLV_PREVIOUS_TAG_SIZE;
+    if ((err = grow(nn_tag)) != srs_success) {
+        return srs_error_wrap(err, "read tag data, size=%d", size);
+    }
+
+    SrsMemoryBlock *payload = new SrsMemoryBlock();
+    payload->attach(chunk_, p_ + SRS_FLV_TAG_HEADER_SIZE, size);
+    p_ += nn_tag;
+    nn_tags_++;
+
+    *ptype = type;
+    *ptime = time;
+    *ppayload = payload;
+
+    return err;
+}
+
+int64_t SrsEdgeFlvDemuxer::nn_reads()
+{
+    return nn_reads_;
+}
+
+int64_t SrsEdgeFlvDemuxer::nn_tags()
+{
+    return nn_tags_;
+}
+
+srs_error_t SrsEdgeFlvDemuxer::grow(int size)
+{
+    srs_error_t err = srs_success;
+
+    if (end_ - p_ >= size) {
+        return err;
+    }
+
+    // Never reuse the parsed bytes of chunk, which might be used by tags, so we switch to a
+    // new chunk and only copy the unparsed bytes, which is a partial tag.
+    char *limit = chunk_.get() ? chunk_->payload() + chunk_->size() : NULL;
+    if (limit - p_ < size) {
+        int nn_left = (int)(end_ - p_);
+        int nn_chunk = srs_max(chunk_size_, size);
+
+        SrsSharedPtr<SrsMemoryBlock> chunk(new SrsMemoryBlock());
+        chunk->attach(new char[nn_chunk], nn_chunk);
+        if (nn_left > 0) {
+            memcpy(chunk->payload(), p_, nn_left);
+        }
+
+        chunk_ = chunk;
+        p_ = chunk_->payload();
+        end_ = p_ + nn_left;
+        limit = p_ + nn_chunk;
+    }
+
+    // Read as many bytes as available, to parse multiple tags from one read.
+    while (end_ - p_ < size) {
+        ssize_t nread = 0;
+        if ((err = reader_->read(end_, limit - end_, &nread)) != srs_success) {
+            return srs_error_wrap(err, "read chunk");
+        }
+
+        if (nread <= 0) {
+            return srs_error_new(ERROR_HTTP_REQUEST_EOF, "EOF");
+        }
+
+        end_ += nread;
+        nn_reads_++;
+    }
+
+    return err;
+}
+
 SrsEdgeFlvUpstream::SrsEdgeFlvUpstream(std::string schema)
 {
     schema_ = schema;
@@ -168,8 +324,8 @@ SrsEdgeFlvUpstream::SrsEdgeFlvUpstream(std::string schema)
 
     sdk_ = NULL;
     hr_ = NULL;
-    reader_ = NULL;
-    decoder_ = NULL;
+    keepalive_ = false;
+    demuxer_ = NULL;
     req_ = NULL;
 
     config_ = _srs_config;
@@ -184,6 +340,11 @@ SrsEdgeFlvUpstream::~SrsEdgeFlvUpstream()
     app_factory_ = NULL;
 }
 
+string SrsEdgeFlvUpstream::schema()
+{
+    return schema_;
+}
+
 srs_error_t SrsEdgeFlvUpstream::connect(ISrsRequest *r, ISrsLbRoundRobin *lb)
 {
     // Because we might modify the r, which cause retry fail, so we must copy it.
@@ -229,9 +390,6 @@ srs_error_t SrsEdgeFlvUpstream::do_connect(ISrsRequest *r, ISrsLbRoundRobin *lb,
         selected_port_ = req->port_;
     }
 
-    srs_freep(sdk_);
-    sdk_ = app_factory_->create_http_client();
-
     string path = "/" + req->app_ + "/" + req->stream_;
     if (!srs_strings_ends_with(req->stream_, ".flv")) {
         path += ".flv";
@@ -240,20 +398,39 @@ srs_error_t SrsEdgeFlvUpstream::do_connect(ISrsRequest *r, ISrsLbRoundRobin *lb,
         path += req->param_;
     }
 
-    string url = schema_ + "://" + selected_ip_ + ":" + srs_strconv_format_int(selected_port_);
-    url += path;
+    string ep = schema_ + "://" + selected_ip_ + ":" + srs_strconv_format_int(selected_port_);
+    string url = ep + path;
 
-    srs_utime_t cto = SRS_EDGE_INGESTER_TIMEOUT;
-    if ((err = sdk_->initialize(schema_, selected_ip_, selected_port_, cto)) != srs_success) {
-        return srs_error_wrap(err, "edge pull %s failed, cto=%dms.", url.c_str(), srsu2msi(cto));
+    // Reuse the HTTP connection to the same origin, if the previous response is drained.
+    bool reuse = sdk_ && keepalive_ && sdk_ep_ == ep;
+    keepalive_ = false;
+    srs_freep(demuxer_);
+    srs_freep(hr_);
+
+    if (reuse && (err = sdk_->get(path, "", &hr_)) != srs_success) {
+        // The origin might close the idle connection, retry with a new one.
+        srs_warn("Edge: Reuse connection to %s failed, %s", url.c_str(), srs_error_desc(err).c_str());
+        srs_freep(err);
+        srs_freep(hr_);
     }
 
-    srs_freep(hr_);
-    if ((err = sdk_->get(path, "", &hr_)) != srs_success) {
-        return srs_error_wrap(err, "edge get %s failed, path=%s", url.c_str(), path.c_str());
+    if (!hr_) {
+        srs_freep(sdk_);
+        sdk_ = app_factory_->create_http_client();
+        sdk_ep_ = ep;
+
+        srs_utime_t cto = SRS_EDGE_INGESTER_TIMEOUT;
+        if ((err = sdk_->initialize(schema_, selected_ip_, selected_port_, cto)) != srs_success) {
+            return srs_error_wrap(err, "edge pull %s failed, cto=%dms.", url.c_str(), srsu2msi(cto));
+        }
+
+        if ((err = sdk_->get(path, "", &hr_)) != srs_success) {
+            return srs_error_wrap(err, "edge get %s failed, path=%s", url.c_str(), path.c_str());
+        }
     }
 
     if (hr_->status_code() == 404) {
+        drain_response();
         return srs_error_new(ERROR_RTMP_STREAM_NOT_FOUND, "Connect to %s, status=%d", url.c_str(), hr_->status_code());
     }
 
@@ -290,27 +467,33 @@ srs_error_t SrsEdgeFlvUpstream::do_connect(ISrsRequest *r, ISrsLbRoundRobin *lb,
     }
     // LCOV_EXCL_STOP
 
-    srs_freep(reader_);
-    reader_ = app_factory_->create_http_file_reader(hr_->body_reader());
-
-    srs_freep(decoder_);
-    decoder_ = app_factory_->create_flv_decoder();
-
-    if ((err = decoder_->initialize(reader_)) != srs_success) {
-        return srs_error_wrap(err, "init decoder");
-    }
+    // Read the body in large chunks, rather than the file reader which reads fully.
+    demuxer_ = new SrsEdgeFlvDemuxer();
+    demuxer_->initialize(hr_->body_reader());
 
     char header[9];
-    if ((err = decoder_->read_header(header)) != srs_success) {
+    if ((err = demuxer_->read_header(header)) != srs_success) {
         return srs_error_wrap(err, "read header");
     }
 
-    char pps[4];
-    if ((err = decoder_->read_previous_tag_size(pps)) != srs_success) {
-        return srs_error_wrap(err, "read pts");
+    return err;
+}
+
+void SrsEdgeFlvUpstream::drain_response()
+{
+    // Only drain the body with specified length, never block on the infinite body.
+    if (!hr_->is_keep_alive() || hr_->content_length() < 0) {
+        return;
+    }
+
+    std::string body;
+    srs_error_t err = hr_->body_read_all(body);
+    if (err != srs_success) {
+        srs_freep(err);
+        return;
     }
 
-    return err;
+    keepalive_ = true;
 }
 
 srs_error_t SrsEdgeFlvUpstream::recv_message(SrsRtmpCommonMessage **pmsg)
@@ -318,26 +501,15 @@ srs_error_t SrsEdgeFlvUpstream::recv_message(SrsRtmpCommonMessage **pmsg)
     srs_error_t err = srs_success;
 
     char type;
-    int32_t size;
     uint32_t time;
-    if ((err = decoder_->read_tag_header(&type, &size, &time)) != srs_success) {
-        return srs_error_wrap(err, "read tag header");
-    }
-
-    char *data = new char[size];
-    if ((err = decoder_->read_tag_data(data, size)) != srs_success) {
-        srs_freepa(data);
-        return srs_error_wrap(err, "read tag data");
-    }
-
-    char pps[4];
-    if ((err = decoder_->read_previous_tag_size(pps)) != srs_success) {
-        return srs_error_wrap(err, "read pts");
+    SrsMemoryBlock *payload = NULL;
+    if ((err = demuxer_->read_tag(&type, &time, &payload)) != srs_success) {
+        return srs_error_wrap(err, "read tag");
     }
 
     int stream_id = 1;
     SrsRtmpCommonMessage *msg = NULL;
-    if ((err = srs_rtmp_create_msg(type, time, data, size, stream_id, &msg)) != srs_success) {
+    if ((err = srs_rtmp_create_msg(type, time, payload, stream_id, &msg)) != srs_success) {
         return srs_error_wrap(err, "create message");
     }
 
@@ -378,9 +550,9 @@ void SrsEdgeFlvUpstream::close()
 {
     srs_freep(sdk_);
     srs_freep(hr_);
-    srs_freep(reader_);
-    srs_freep(decoder_);
+    srs_freep(demuxer_);
     srs_freep(req_);
+    keepalive_ = false;
 }
 
 void SrsEdgeFlvUpstream::selected(string &server, int &port)
@@ -399,6 +571,201 @@ void SrsEdgeFlvUpstream::kbps_sample(const char *label, srs_utime_t age)
     sdk_->kbps_sample(label, age);
 }
 
+SrsEdgePullStat::SrsEdgePullStat()
+{
+    nn_pulls_ = 0;
+    nn_hedged_ = 0;
+    nn_hedge_wins_ = 0;
+    nn_warm_hits_ = 0;
+    nn_ttff_ = 0;
+    ttff_total_ = 0;
+    ttff_max_ = 0;
+    for (int i = 0; i < SRS_EDGE_TTFF_NB_BUCKETS; i++) {
+        ttff_[i] = 0;
+    }
+}
+
+SrsEdgePullStat::~SrsEdgePullStat()
+{
+}
+
+void SrsEdgePullStat::on_pull()
+{
+    nn_pulls_++;
+}
+
+void SrsEdgePullStat::on_hedged()
+{
+    nn_hedged_++;
+}
+
+void SrsEdgePullStat::on_hedge_won()
+{
+    nn_hedge_wins_++;
+}
+
+void SrsEdgePullStat::on_warm_hit()
+{
+    nn_warm_hits_++;
+}
+
+void SrsEdgePullStat::on_ttff(srs_utime_t ttff)
+{
+    if (ttff < 100 * SRS_UTIME_MILLISECONDS) {
+        ttff_[0]++;
+    } else if (ttff < 500 * SRS_UTIME_MILLISECONDS) {
+        ttff_[1]++;
+    } else if (ttff < SRS_UTIME_SECONDS) {
+        ttff_[2]++;
+    } else if (ttff < 3 * SRS_UTIME_SECONDS) {
+        ttff_[3]++;
+    } else {
+        ttff_[4]++;
+    }
+
+    nn_ttff_++;
+    ttff_total_ += ttff;
+    ttff_max_ = srs_max(ttff_max_, ttff);
+}
+
+void SrsEdgePullStat::dumps(SrsJsonObject *obj)
+{
+    obj->set("pulls", SrsJsonAny::integer(nn_pulls_));
+    obj->set("hedged", SrsJsonAny::integer(nn_hedged_));
+    obj->set("hedge_wins", SrsJsonAny::integer(nn_hedge_wins_));
+    obj->set("warm_hits", SrsJsonAny::integer(nn_warm_hits_));
+
+    SrsJsonObject *ttff = SrsJsonAny::object();
+    obj->set("ttff", ttff);
+
+    ttff->set("count", SrsJsonAny::integer(nn_ttff_));
+    ttff->set("avg_ms", SrsJsonAny::integer(nn_ttff_ ? srsu2ms(ttff_total_) / nn_ttff_ : 0));
+    ttff->set("max_ms", SrsJsonAny::integer(srsu2ms(ttff_max_)));
+    ttff->set("100ms", SrsJsonAny::integer(ttff_[0]));
+    ttff->set("500ms", SrsJsonAny::integer(ttff_[1]));
+    ttff->set("1s", SrsJsonAny::integer(ttff_[2]));
+    ttff->set("3s", SrsJsonAny::integer(ttff_[3]));
+    ttff->set("slow", SrsJsonAny::integer(ttff_[4]));
+}
+
+SrsEdgePullStat *_srs_edge_pull_stat = NULL;
+
+SrsEdgeHedgeRacer::SrsEdgeHedgeRacer(ISrsEdgeUpstream *upstream, ISrsRequest *r, ISrsLbRoundRobin *lb, SrsCond *cond)
+{
+    upstream_ = upstream;
+    req_ = r;
+    lb_ = lb;
+    cond_ = cond;
+
+    trd_ = new SrsDummyCoroutine();
+    started_ = false;
+    done_ = false;
+    err_ = srs_success;
+}
+
+SrsEdgeHedgeRacer::~SrsEdgeHedgeRacer()
+{
+    trd_->stop();
+    srs_freep(trd_);
+
+    srs_freep(upstream_);
+    for (int i = 0; i < (int)msgs_.size(); i++) {
+        SrsRtmpCommonMessage *msg = msgs_.at(i);
+        srs_freep(msg);
+    }
+    msgs_.clear();
+
+    srs_freep(err_);
+}
+
+srs_error_t SrsEdgeHedgeRacer::start()
+{
+    srs_error_t err = srs_success;
+
+    started_ = true;
+
+    srs_freep(trd_);
+    trd_ = new SrsSTCoroutine("edge-hedge", this, _srs_context->get_id());
+
+    if ((err = trd_->start()) != srs_success) {
+        return srs_error_wrap(err, "coroutine");
+    }
+
+    return err;
+}
+
+bool SrsEdgeHedgeRacer::started()
+{
+    return started_;
+}
+
+bool SrsEdgeHedgeRacer::ready()
+{
+    return done_ && err_ == srs_success;
+}
+
+bool SrsEdgeHedgeRacer::failed()
+{
+    return done_ && err_ != srs_success;
+}
+
+srs_error_t SrsEdgeHedgeRacer::error()
+{
+    return err_;
+}
+
+ISrsEdgeUpstream *SrsEdgeHedgeRacer::take(std::vector<SrsRtmpCommonMessage *> &msgs)
+{
+    msgs.insert(msgs.end(), msgs_.begin(), msgs_.end());
+    msgs_.clear();
+
+    ISrsEdgeUpstream *upstream = upstream_;
+    upstream_ = NULL;
+    return upstream;
+}
+
+srs_error_t SrsEdgeHedgeRacer::cycle()
+{
+    err_ = do_cycle();
+    done_ = true;
+
+    cond_->signal();
+
+    return srs_success;
+}
+
+srs_error_t SrsEdgeHedgeRacer::do_cycle()
+{
+    srs_error_t err = srs_success;
+
+    if ((err = upstream_->connect(req_, lb_)) != srs_success) {
+        return srs_error_wrap(err, "connect upstream");
+    }
+
+    upstream_->set_recv_timeout(SRS_EDGE_INGESTER_TIMEOUT);
+
+    bool has_video = false;
+    while ((int)msgs_.size() < SRS_EDGE_HEDGE_MAX_MSGS) {
+        if ((err = trd_->pull()) != srs_success) {
+            return srs_error_wrap(err, "hedge racer");
+        }
+
+        SrsRtmpCommonMessage *msg = NULL;
+        if ((err = upstream_->recv_message(&msg)) != srs_success) {
+            return srs_error_wrap(err, "recv message");
+        }
+
+        srs_assert(msg);
+        msgs_.push_back(msg);
+
+        if (srs_edge_is_first_frame(msg, has_video)) {
+            break;
+        }
+    }
+
+    return err;
+}
+
 ISrsEdgeIngester::ISrsEdgeIngester()
 {
 }
@@ -417,6 +784,11 @@ SrsEdgeIngester::SrsEdgeIngester()
     lb_ = new SrsLbRoundRobin();
     trd_ = new SrsDummyCoroutine();
 
+    stat_ = _srs_edge_pull_stat;
+    starttime_ = 0;
+    has_video_ = false;
+    ttff_done_ = false;
+
     config_ = _srs_config;
 }
 
@@ -424,6 +796,7 @@ SrsEdgeIngester::~SrsEdgeIngester()
 {
     stop();
 
+    clear_pending_msgs();
     srs_freep(upstream_);
     srs_freep(lb_);
     srs_freep(trd_);
@@ -457,6 +830,12 @@ srs_error_t SrsEdgeIngester::start()
         return srs_error_wrap(err, "notify source");
     }
 
+    // Start to calculate the time to first frame.
+    starttime_ = srs_time_now_realtime();
+    has_video_ = false;
+    ttff_done_ = false;
+    stat_->on_pull();
+
     srs_freep(trd_);
     trd_ = new SrsSTCoroutine("edge-igs", this);
 
@@ -529,11 +908,17 @@ srs_error_t SrsEdgeIngester::do_cycle()
             edge_protocol = req_->protocol_;
         }
 
-        // Create object by protocol.
-        srs_freep(upstream_);
+        // Create object by protocol, reuse the FLV upstream for its keep-alive connection.
+        clear_pending_msgs();
         if (edge_protocol == "flv" || edge_protocol == "flvs") {
-            upstream_ = new SrsEdgeFlvUpstream(edge_protocol == "flv" ? "http" : "https");
+            string schema = edge_protocol == "flv" ? "http" : "https";
+            SrsEdgeFlvUpstream *flv = dynamic_cast<SrsEdgeFlvUpstream *>(upstream_);
+            if (!flv || flv->schema() != schema) {
+                srs_freep(upstream_);
+                upstream_ = new SrsEdgeFlvUpstream(schema);
+            }
         } else {
+            srs_freep(upstream_);
             upstream_ = new SrsEdgeRtmpUpstream(redirect);
         }
 
@@ -541,7 +926,15 @@ srs_error_t SrsEdgeIngester::do_cycle()
             return srs_error_wrap(err, "on source id changed");
         }
 
-        if ((err = upstream_->connect(req_, lb_)) != srs_success) {
+        // Race the origins for RTMP, if there are more than one origin.
+        srs_utime_t hedge_delay = config_->get_vhost_edge_hedge_delay(req_->vhost_);
+        SrsConfDirective *conf = config_->get_vhost_edge_origin(req_->vhost_);
+        bool is_rtmp = edge_protocol != "flv" && edge_protocol != "flvs";
+        if (hedge_delay > 0 && is_rtmp && redirect.empty() && conf && conf->args_.size() > 1) {
+            if ((err = hedged_connect(hedge_delay)) != srs_success) {
+                return srs_error_wrap(err, "hedged connect upstream");
+            }
+        } else if ((err = upstream_->connect(req_, lb_)) != srs_success) {
             return srs_error_wrap(err, "connect upstream");
         }
 
@@ -577,6 +970,71 @@ srs_error_t SrsEdgeIngester::do_cycle()
     return err;
 }
 
+srs_error_t SrsEdgeIngester::hedged_connect(srs_utime_t delay)
+{
+    srs_error_t err = srs_success;
+
+    // Note that the racers must be freed before cond, to stop the coroutines.
+    SrsUniquePtr<SrsCond> cond(new SrsCond());
+    SrsUniquePtr<SrsEdgeHedgeRacer> primary(new SrsEdgeHedgeRacer(new SrsEdgeRtmpUpstream(""), req_, lb_, cond.get()));
+    SrsUniquePtr<SrsEdgeHedgeRacer> secondary(new SrsEdgeHedgeRacer(new SrsEdgeRtmpUpstream(""), req_, lb_, cond.get()));
+
+    if ((err = primary->start()) != srs_success) {
+        return srs_error_wrap(err, "start primary");
+    }
+
+    SrsEdgeHedgeRacer *winner = NULL;
+    srs_utime_t starttime = srs_time_now_realtime();
+    while (true) {
+        if ((err = trd_->pull()) != srs_success) {
+            return srs_error_wrap(err, "hedge pull");
+        }
+
+        if (primary->ready()) {
+            winner = primary.get();
+            break;
+        }
+        if (secondary->ready()) {
+            winner = secondary.get();
+            break;
+        }
+
+        if (primary->failed() && secondary->failed()) {
+            return srs_error_wrap(srs_error_copy(primary->error()), "all failed, next %s", srs_error_desc(secondary->error()).c_str());
+        }
+
+        // Race the next origin, when primary failed or not ready in delay.
+        srs_utime_t elapsed = srs_time_now_realtime() - starttime;
+        if (!secondary->started() && (primary->failed() || elapsed >= delay)) {
+            srs_trace("edge: hedge to next origin, elapsed=%dms, primary failed=%d", srsu2msi(elapsed), primary->failed());
+            stat_->on_hedged();
+
+            if ((err = secondary->start()) != srs_success) {
+                return srs_error_wrap(err, "start secondary");
+            }
+        }
+
+        // Wait for the racers, or timeout to race the next origin.
+        cond->timedwait(secondary->started() ? SRS_CONSTS_RTMP_PULSE : delay - elapsed);
+    }
+
+    if (winner == secondary.get()) {
+        stat_->on_hedge_won();
+    }
+
+    srs_freep(upstream_);
+    clear_pending_msgs();
+    upstream_ = winner->take(pending_msgs_);
+
+    int port = 0;
+    string server;
+    upstream_->selected(server, port);
+    srs_trace("edge: hedge use origin %s:%d, msgs=%d, cost=%dms", server.c_str(), port, (int)pending_msgs_.size(),
+              srsu2msi(srs_time_now_realtime() - starttime));
+
+    return err;
+}
+
 srs_error_t SrsEdgeIngester::ingest(string &redirect)
 {
     srs_error_t err = srs_success;
@@ -587,6 +1045,24 @@ srs_error_t SrsEdgeIngester::ingest(string &redirect)
     // reset the redirect to empty, for maybe the origin changed.
     redirect = "";
 
+    // Feed the messages of hedged connect winner first.
+    if (!pending_msgs_.empty()) {
+        std::vector<SrsRtmpCommonMessage *> msgs;
+        msgs.swap(pending_msgs_);
+
+        for (int i = 0; i < (int)msgs.size(); i++) {
+            SrsRtmpCommonMessage *msg = msgs.at(i);
+            if (err == srs_success) {
+                err = process_publish_message(msg, redirect);
+            }
+            srs_freep(msg);
+        }
+
+        if (err != srs_success) {
+            return srs_error_wrap(err, "process hedge message");
+        }
+    }
+
     while (true) {
         if ((err = trd_->pull()) != srs_success) {
             return srs_error_wrap(err, "thread quit");
@@ -621,6 +1097,12 @@ srs_error_t SrsEdgeIngester::process_publish_message(SrsRtmpCommonMessage *msg,
 {
     srs_error_t err = srs_success;
 
+    // The time to first frame, since the ingester starts.
+    if (!ttff_done_ && starttime_ > 0 && srs_edge_is_first_frame(msg, has_video_)) {
+        ttff_done_ = true;
+        stat_->on_ttff(srs_time_now_realtime() - starttime_);
+    }
+
     // process audio packet
     if (msg->header_.is_audio()) {
         if ((err = source_->on_audio(msg)) != srs_success) {
@@ -712,6 +1194,15 @@ srs_error_t SrsEdgeIngester::process_publish_message(SrsRtmpCommonMessage *msg,
     return err;
 }
 
+void SrsEdgeIngester::clear_pending_msgs()
+{
+    for (int i = 0; i < (int)pending_msgs_.size(); i++) {
+        SrsRtmpCommonMessage *msg = pending_msgs_.at(i);
+        srs_freep(msg);
+    }
+    pending_msgs_.clear();
+}
+
 ISrsEdgeForwarder::ISrsEdgeForwarder()
 {
 }
@@ -969,11 +1460,19 @@ SrsPlayEdge::SrsPlayEdge()
 {
     state_ = SrsEdgeStateInit;
     ingester_ = new SrsEdgeIngester();
+    req_ = NULL;
+    warm_expire_ = 0;
+
+    config_ = _srs_config;
+    stat_ = _srs_edge_pull_stat;
 }
 
 SrsPlayEdge::~SrsPlayEdge()
 {
     srs_freep(ingester_);
+
+    config_ = NULL;
+    stat_ = NULL;
 }
 
 // CRITICAL: This method is called AFTER the source has been added to the source pool
@@ -986,6 +1485,8 @@ srs_error_t SrsPlayEdge::initialize(SrsSharedPtr<SrsLiveSource> source, ISrsRequ
 {
     srs_error_t err = srs_success;
 
+    req_ = req;
+
     if ((err = ingester_->initialize(source, this, req)) != srs_success) {
         return srs_error_wrap(err, "ingester(pull)");
     }
@@ -997,6 +1498,21 @@ srs_error_t SrsPlayEdge::on_client_play()
 {
     srs_error_t err = srs_success;
 
+    // Remember the recent plays, to check whether stream is popular.
+    srs_utime_t now = srs_time_now_cached();
+    int warm_pull_plays = req_ ? config_->get_vhost_edge_warm_pull_plays(req_->vhost_) : 0;
+    plays_.push_back(now);
+    while ((int)plays_.size() > srs_max(warm_pull_plays, 1)) {
+        plays_.pop_front();
+    }
+
+    // The player joins the warm pulling stream, which already has the GOP cache.
+    if (warm_expire_) {
+        warm_expire_ = 0;
+        stat_->on_warm_hit();
+        srs_trace("edge: warm pull hit, state=%d", state_);
+    }
+
     // start ingest when init state.
     if (state_ == SrsEdgeStateInit) {
         state_ = SrsEdgeStatePlay;
@@ -1009,6 +1525,39 @@ srs_error_t SrsPlayEdge::on_client_play()
 }
 
 void SrsPlayEdge::on_all_client_stop()
+{
+    if (state_ != SrsEdgeStatePlay && state_ != SrsEdgeStateIngestConnected) {
+        return;
+    }
+
+    // Keep pulling the popular stream for a while, which has enough plays in recent window.
+    srs_utime_t warm_pull = req_ ? config_->get_vhost_edge_warm_pull(req_->vhost_) : 0;
+    if (warm_pull > 0) {
+        int warm_pull_plays = config_->get_vhost_edge_warm_pull_plays(req_->vhost_);
+        srs_utime_t now = srs_time_now_cached();
+        if ((int)plays_.size() >= warm_pull_plays && now - plays_.front() <= SRS_EDGE_WARM_PULL_WINDOW) {
+            warm_expire_ = now + warm_pull;
+            srs_trace("edge: warm pull for %dms, plays=%d", srsu2msi(warm_pull), (int)plays_.size());
+            return;
+        }
+    }
+
+    stop_ingest();
+}
+
+void SrsPlayEdge::cycle()
+{
+    if (!warm_expire_ || srs_time_now_cached() < warm_expire_) {
+        return;
+    }
+
+    warm_expire_ = 0;
+    srs_trace("edge: warm pull expired");
+
+    stop_ingest();
+}
+
+void SrsPlayEdge::stop_ingest()
 {
     // when all client disconnected,
     // and edge is ingesting origin stream, abort it.
@@ -1134,3 +1683,147 @@ void SrsPublishEdge::on_proxy_unpublish()
     state_ = SrsEdgeStateInit;
     srs_trace("edge change from %d to state %d (init).", pstate, state_);
 }
+
+// The max number of tokens to cache, the expired verdicts are removed when exceed it.
+#define SRS_EDGE_TOKEN_TRAVERSE_MAX_VERDICTS 10000
+
+SrsEdgeTokenTraverse *_srs_edge_token_traverse = NULL;
+
+ISrsEdgeTokenTraverseHandler::ISrsEdgeTokenTraverseHandler()
+{
+}
+
+ISrsEdgeTokenTraverseHandler::~ISrsEdgeTokenTraverseHandler()
+{
+}
+
+SrsEdgeTokenVerdict::SrsEdgeTokenVerdict()
+{
+    pending_ = true;
+    err_ = srs_success;
+    expire_ = 0;
+    cond_ = new SrsCond();
+}
+
+SrsEdgeTokenVerdict::~SrsEdgeTokenVerdict()
+{
+    srs_freep(err_);
+    srs_freep(cond_);
+}
+
+SrsEdgeTokenTraverse::SrsEdgeTokenTraverse()
+{
+    config_ = _srs_config;
+
+    nn_hits_ = 0;
+    nn_misses_ = 0;
+    nn_coalesced_ = 0;
+}
+
+SrsEdgeTokenTraverse::~SrsEdgeTokenTraverse()
+{
+    config_ = NULL;
+}
+
+srs_error_t SrsEdgeTokenTraverse::check(ISrsRequest *req, ISrsEdgeTokenTraverseHandler *handler)
+{
+    srs_error_t err = srs_success;
+
+    string key = token_key(req);
+
+    std::map<std::string, SrsSharedPtr<SrsEdgeTokenVerdict> >::iterator it = verdicts_.find(key);
+    if (it != verdicts_.end()) {
+        // Hold the verdict, which might be removed from cache by the in-flight check.
+        SrsSharedPtr<SrsEdgeTokenVerdict> verdict = it->second;
+
+        if (verdict->pending_) {
+            nn_coalesced_++;
+            if (verdict->cond_->wait() != 0) {
+                return srs_error_new(ERROR_EDGE_TOKEN_TRAVERSE, "wait for token %s", key.c_str());
+            }
+        } else if (verdict->expire_ > srs_time_now_cached()) {
+            nn_hits_++;
+        } else {
+            verdicts_.erase(it);
+            verdict = SrsSharedPtr<SrsEdgeTokenVerdict>();
+        }
+
+        if (verdict.get()) {
+            if (verdict->err_ != srs_success) {
+                return srs_error_wrap(srs_error_copy(verdict->err_), "token %s denied", key.c_str());
+            }
+            return err;
+        }
+    }
+
+    nn_misses_++;
+
+    SrsSharedPtr<SrsEdgeTokenVerdict> verdict(new SrsEdgeTokenVerdict());
+    verdicts_[key] = verdict;
+
+    err = handler->check_edge_token_traverse_auth();
+
+    // Only cache the genuine rejection of origin for deny ttl, other errors such as origin unreachable, network
+    // failure or interrupted, are only for the connections waiting for it.
+    srs_utime_t ttl = config_->get_vhost_edge_token_traverse_ttl(req->vhost_);
+    if (err != srs_success) {
+        ttl = 0;
+        if (srs_error_code(err) == ERROR_EDGE_TOKEN_REJECTED) {
+            ttl = config_->get_vhost_edge_token_traverse_deny_ttl(req->vhost_);
+        }
+        verdict->err_ = srs_error_copy(err);
+    }
+
+    srs_utime_t now = srs_time_now_cached();
+    verdict->pending_ = false;
+    verdict->expire_ = now + ttl;
+
+    // Without cache, the verdict is only for the connections waiting for it.
+    if (ttl <= 0) {
+        it = verdicts_.find(key);
+        if (it != verdicts_.end() && it->second.get() == verdict.get()) {
+            verdicts_.erase(it);
+        }
+    } else if (verdicts_.size() > SRS_EDGE_TOKEN_TRAVERSE_MAX_VERDICTS) {
+        shrink(now);
+    }
+
+    verdict->cond_->broadcast();
+
+    return err;
+}
+
+void SrsEdgeTokenTraverse::dumps(SrsJsonObject *obj)
+{
+    obj->set("hits", SrsJsonAny::integer(nn_hits_));
+    obj->set("misses", SrsJsonAny::integer(nn_misses_));
+    obj->set("coalesced", SrsJsonAny::integer(nn_coalesced_));
+    obj->set("tokens", SrsJsonAny::integer((int)verdicts_.size()));
+}
+
+string SrsEdgeTokenTraverse::token_key(ISrsRequest *req)
+{
+    string key = srs_fmt_sprintf("%s/%s%s, tcUrl=%s, pageUrl=%s, swfUrl=%s", req->vhost_.c_str(), req->app_.c_str(),
+                                 req->param_.c_str(), req->tcUrl_.c_str(), req->pageUrl_.c_str(), req->swfUrl_.c_str());
+
+    // The args of client is sent to origin by connect_app, which might be the token.
+    if (req->args_) {
+        SrsUniquePtr<SrsJsonAny> args(req->args_->to_json());
+        key += ", args=" + args->dumps();
+    }
+
+    return key;
+}
+
+void SrsEdgeTokenTraverse::shrink(srs_utime_t now)
+{
+    std::map<std::string, SrsSharedPtr<SrsEdgeTokenVerdict> >::iterator it;
+    for (it = verdicts_.begin(); it != verdicts_.end();) {
+        SrsSharedPtr<SrsEdgeTokenVerdict> &verdict = it->second;
+        if (!verdict->pending_ && verdict->expire_ <= now) {
+            verdicts_.erase(it++);
+        } else {
+            ++it;
+        }
+    }
+}
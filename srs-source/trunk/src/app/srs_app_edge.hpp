@@ -12,7 +12,10 @@
 #include <srs_app_st.hpp>
 #include <srs_core_autofree.hpp>
 
+#include <deque>
+#include <map>
 #include <string>
+#include <vector>
 
 class SrsStSocket;
 class SrsRtmpServer;
@@ -42,6 +45,11 @@ class ISrsLiveSource;
 class ISrsPlayEdge;
 class ISrsPublishEdge;
 class ISrsAppFactory;
+class SrsCond;
+class SrsJsonObject;
+class SrsEdgePullStat;
+class ISrsReader;
+class SrsMemoryBlock;
 
 // The state of edge, auto machine
 enum SrsEdgeState {
@@ -122,7 +130,56 @@ public:
     virtual void kbps_sample(const char *label, srs_utime_t age);
 };
 
+// The size of chunk to read the FLV stream from origin, in bytes.
+#define SRS_EDGE_FLV_CHUNK_SIZE (64 * 1024)
+
+// The buffered FLV demuxer for edge upstream, which reads the HTTP body in large chunks and
+// parses multiple tags from each read. The payload of tag is a slice of the chunk, so the
+// tags in a chunk share its memory, and large tags are read directly into their own chunk.
+class SrsEdgeFlvDemuxer
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsReader *reader_;
+    int chunk_size_;
+    // The current chunk, the unparsed bytes are [p_, end_), free space is after end_.
+    SrsSharedPtr<SrsMemoryBlock> chunk_;
+    char *p_;
+    char *end_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The number of reads and tags, for statistic.
+    int64_t nn_reads_;
+    int64_t nn_tags_;
+
+public:
+    SrsEdgeFlvDemuxer(int chunk_size = SRS_EDGE_FLV_CHUNK_SIZE);
+    virtual ~SrsEdgeFlvDemuxer();
+
+public:
+    // Initialize the demuxer to read from the HTTP body reader, which is not freed by demuxer.
+    virtual void initialize(ISrsReader *r);
+    // Read the FLV header and the first previous tag size.
+    virtual srs_error_t read_header(char header[9]);
+    // Read a tag and its previous tag size, output the type, timestamp and payload. The
+    // payload refers to the chunk, user should free it.
+    virtual srs_error_t read_tag(char *ptype, uint32_t *ptime, SrsMemoryBlock **ppayload);
+    // The number of reads and tags.
+    virtual int64_t nn_reads();
+    virtual int64_t nn_tags();
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Ensure at least size bytes unparsed, read more from reader if not enough. Switch to
+    // a new chunk if no space, and the parsed bytes in current chunk are kept by tags.
+    virtual srs_error_t grow(int size);
+};
+
 // The HTTP FLV upstream of edge.
+// @remark The upstream is reused when retry, to reuse the keep-alive HTTP connection if
+//      the previous response is drained, for example, 404 when stream is not ready on
+//      origin, so no TCP connect and DNS resolve for the retry.
 class SrsEdgeFlvUpstream : public ISrsEdgeUpstream
 {
 // clang-format off
@@ -135,11 +192,14 @@ SRS_DECLARE_PRIVATE: // clang-format on
     std::string schema_;
     ISrsHttpClient *sdk_;
     ISrsHttpMessage *hr_;
+    // The endpoint schema://ip:port of sdk, to reuse the HTTP connection.
+    std::string sdk_ep_;
+    // Whether the HTTP connection is reusable, that is, the previous response is drained.
+    bool keepalive_;
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
-    ISrsFileReader *reader_;
-    ISrsFlvDecoder *decoder_;
+    SrsEdgeFlvDemuxer *demuxer_;
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
@@ -154,11 +214,15 @@ public:
     virtual ~SrsEdgeFlvUpstream();
 
 public:
+    // The schema of upstream, http or https.
+    virtual std::string schema();
     virtual srs_error_t connect(ISrsRequest *r, ISrsLbRoundRobin *lb);
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
     virtual srs_error_t do_connect(ISrsRequest *r, ISrsLbRoundRobin *lb, int redirect_depth);
+    // Drain the body of response, to reuse the HTTP connection.
+    virtual void drain_response();
 
 public:
     virtual srs_error_t recv_message(SrsRtmpCommonMessage **pmsg);
@@ -171,6 +235,91 @@ public:
     virtual void kbps_sample(const char *label, srs_utime_t age);
 };
 
+// The number of buckets of the time to first frame of edge.
+#define SRS_EDGE_TTFF_NB_BUCKETS 5
+
+// The stat of edge pull, for the summaries API.
+class SrsEdgePullStat
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The number of ingests to origin.
+    int64_t nn_pulls_;
+    // The number of ingests which raced the next origin, and the next origin won.
+    int64_t nn_hedged_;
+    int64_t nn_hedge_wins_;
+    // The number of players which join a warm pulling stream.
+    int64_t nn_warm_hits_;
+    // The time to first frame, from the ingest starts to the first keyframe of origin.
+    int64_t nn_ttff_;
+    srs_utime_t ttff_total_;
+    srs_utime_t ttff_max_;
+    int64_t ttff_[SRS_EDGE_TTFF_NB_BUCKETS];
+
+public:
+    SrsEdgePullStat();
+    virtual ~SrsEdgePullStat();
+
+public:
+    virtual void on_pull();
+    virtual void on_hedged();
+    virtual void on_hedge_won();
+    virtual void on_warm_hit();
+    virtual void on_ttff(srs_utime_t ttff);
+    virtual void dumps(SrsJsonObject *obj);
+};
+
+// Global edge pull stat.
+extern SrsEdgePullStat *_srs_edge_pull_stat;
+
+// Whether the message is the first frame to play, the video keyframe, or the audio frame if no video.
+// @param has_video Set to true when got the video sequence header.
+extern bool srs_edge_is_first_frame(SrsRtmpCommonMessage *msg, bool &has_video);
+
+// The racer of hedged connect, which connects to an origin and receives the messages until the
+// first keyframe, then the edge ingests from the first ready racer, and closes the others.
+class SrsEdgeHedgeRacer : public ISrsCoroutineHandler
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsRequest *req_;
+    ISrsLbRoundRobin *lb_;
+    // Signal when racer is done, ready or failed.
+    SrsCond *cond_;
+    ISrsCoroutine *trd_;
+    bool started_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsEdgeUpstream *upstream_;
+    // The messages received before and include the first keyframe.
+    std::vector<SrsRtmpCommonMessage *> msgs_;
+    bool done_;
+    srs_error_t err_;
+
+public:
+    SrsEdgeHedgeRacer(ISrsEdgeUpstream *upstream, ISrsRequest *r, ISrsLbRoundRobin *lb, SrsCond *cond);
+    virtual ~SrsEdgeHedgeRacer();
+
+public:
+    virtual srs_error_t start();
+    virtual bool started();
+    // Whether got the first keyframe.
+    virtual bool ready();
+    // Whether failed to connect or receive.
+    virtual bool failed();
+    virtual srs_error_t error();
+    // Take the upstream and messages of the ready racer.
+    virtual ISrsEdgeUpstream *take(std::vector<SrsRtmpCommonMessage *> &msgs);
+    // Interface ISrsCoroutineHandler
+public:
+    virtual srs_error_t cycle();
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    virtual srs_error_t do_cycle();
+};
+
 // The interface for edge ingester.
 class ISrsEdgeIngester
 {
@@ -206,6 +355,16 @@ SRS_DECLARE_PRIVATE: // clang-format on
     ISrsCoroutine *trd_;
     ISrsLbRoundRobin *lb_;
     ISrsEdgeUpstream *upstream_;
+    // The messages of the hedged connect winner, to feed the source before ingest.
+    std::vector<SrsRtmpCommonMessage *> pending_msgs_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    SrsEdgePullStat *stat_;
+    // To calculate the time to first frame, since the ingester starts.
+    srs_utime_t starttime_;
+    bool has_video_;
+    bool ttff_done_;
 
 public:
     SrsEdgeIngester();
@@ -226,8 +385,11 @@ SRS_DECLARE_PRIVATE: // clang-format on
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
+    // Race the origins, use the first one which delivers a keyframe.
+    virtual srs_error_t hedged_connect(srs_utime_t delay);
     virtual srs_error_t ingest(std::string &redirect);
     virtual srs_error_t process_publish_message(SrsRtmpCommonMessage *msg, std::string &redirect);
+    virtual void clear_pending_msgs();
 };
 
 // The interface for edge forwarder.
@@ -315,10 +477,20 @@ public:
 // The play edge control service.
 class SrsPlayEdge : public ISrsPlayEdge
 {
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsAppConfig *config_;
+    SrsEdgePullStat *stat_;
+
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
     SrsEdgeState state_;
     ISrsEdgeIngester *ingester_;
+    ISrsRequest *req_;
+    // The time of recent plays, to check whether stream is popular.
+    std::deque<srs_utime_t> plays_;
+    // When to stop the warm pull, 0 if not warm pulling.
+    srs_utime_t warm_expire_;
 
 public:
     SrsPlayEdge();
@@ -331,8 +503,14 @@ public:
     virtual srs_error_t initialize(SrsSharedPtr<SrsLiveSource> source, ISrsRequest *req);
     // When client play stream on edge.
     virtual srs_error_t on_client_play();
-    // When all client stopped play, disconnect to origin.
+    // When all client stopped play, disconnect to origin, or keep warm pulling the popular stream.
     virtual void on_all_client_stop();
+    // Stop the warm pull when expired.
+    virtual void cycle();
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    virtual void stop_ingest();
 
 public:
     // When ingester start to play stream.
@@ -375,4 +553,76 @@ public:
     virtual void on_proxy_unpublish();
 };
 
+// The handler to check the token by origin, for edge token traverse.
+class ISrsEdgeTokenTraverseHandler
+{
+public:
+    ISrsEdgeTokenTraverseHandler();
+    virtual ~ISrsEdgeTokenTraverseHandler();
+
+public:
+    // Connect to origin to check the token, return ERROR_EDGE_TOKEN_REJECTED if rejected by origin, or other
+    // error if failed to check, for example, origin is unreachable.
+    virtual srs_error_t check_edge_token_traverse_auth() = 0;
+};
+
+// The verdict of edge token traverse, shared by the connections with the same token.
+class SrsEdgeTokenVerdict
+{
+public:
+    // Whether the check is in-flight, the other connections wait for it.
+    bool pending_;
+    // The error of check, NULL if the token is allowed.
+    srs_error_t err_;
+    // The time when the verdict expires.
+    srs_utime_t expire_;
+    // To wakeup the connections waiting for the in-flight check.
+    SrsCond *cond_;
+
+public:
+    SrsEdgeTokenVerdict();
+    virtual ~SrsEdgeTokenVerdict();
+};
+
+// The edge token traverse, which merges the concurrent checks of the same token to one check
+// of origin, and caches the verdicts, to protect the origin from the flash crowd of viewers.
+// The token is identified by everything the edge sends to origin by connect_app, that is the vhost,
+// app, param, tcUrl, pageUrl, swfUrl and args of client, so the clients differ in any of them are
+// never served by the verdict of each other.
+class SrsEdgeTokenTraverse
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsAppConfig *config_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    std::map<std::string, SrsSharedPtr<SrsEdgeTokenVerdict> > verdicts_;
+    // The stat of token traverse. The hits are served by cache, the misses are checked by origin,
+    // and the coalesced are waiting for the in-flight check of other connection.
+    int64_t nn_hits_;
+    int64_t nn_misses_;
+    int64_t nn_coalesced_;
+
+public:
+    SrsEdgeTokenTraverse();
+    virtual ~SrsEdgeTokenTraverse();
+
+public:
+    // Check the token of req, by the cached verdict, or by the in-flight check, or by the handler.
+    virtual srs_error_t check(ISrsRequest *req, ISrsEdgeTokenTraverseHandler *handler);
+    // Dumps the stat of token traverse, for the summaries API.
+    virtual void dumps(SrsJsonObject *obj);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Remove the expired verdicts, when there are too many tokens.
+    void shrink(srs_utime_t now);
+    // Build the key of token of req.
+    std::string token_key(ISrsRequest *req);
+};
+
+// Global edge token traverse.
+extern SrsEdgeTokenTraverse *_srs_edge_token_traverse;
+
 #endif
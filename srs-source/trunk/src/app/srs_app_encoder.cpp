@@ -325,6 +325,9 @@ srs_error_t SrsEncoder::initialize_ffmpeg(ISrsFFMPEG *ffmpeg, ISrsRequest *req,
         return srs_error_wrap(err, "init transcode");
     }
 
+    // The transcode is queued by supervisor, when host is saturated.
+    ffmpeg->set_task("transcode", output, true);
+
     return err;
 }
 
@@ -66,8 +66,10 @@ SrsFFMPEG::SrsFFMPEG(std::string ffmpeg_bin)
     achannels_ = 0;
 
     process_ = new SrsProcess();
+    task_ = NULL;
 
     config_ = _srs_config;
+    supervisor_ = _srs_process_supervisor;
 }
 
 SrsFFMPEG::~SrsFFMPEG()
@@ -76,7 +78,13 @@ SrsFFMPEG::~SrsFFMPEG()
 
     srs_freep(process_);
 
+    if (task_) {
+        supervisor_->detach(task_);
+        srs_freep(task_);
+    }
+
     config_ = NULL;
+    supervisor_ = NULL;
 }
 
 void SrsFFMPEG::append_iparam(string iparam)
@@ -94,6 +102,22 @@ string SrsFFMPEG::output()
     return output_;
 }
 
+void SrsFFMPEG::set_task(string kind, string uri, bool low_priority)
+{
+    // Ignore if no supervisor, for example, the utest without global objects.
+    if (!supervisor_) {
+        return;
+    }
+
+    if (task_) {
+        supervisor_->detach(task_);
+        srs_freep(task_);
+    }
+
+    task_ = new SrsProcessTask(kind, uri, low_priority);
+    supervisor_->attach(task_);
+}
+
 srs_error_t SrsFFMPEG::initialize(string in, string out, string log)
 {
     srs_error_t err = srs_success;
@@ -217,6 +241,11 @@ srs_error_t SrsFFMPEG::start()
         return err;
     }
 
+    // Not start when restart in backoff, or queued for host is saturated.
+    if (task_ && !supervisor_->can_start(task_)) {
+        return err;
+    }
+
     // the argv for process.
     params_.clear();
 
@@ -400,17 +429,48 @@ srs_error_t SrsFFMPEG::start()
         return srs_error_wrap(err, "init process");
     }
 
-    return process_->start();
+    if (task_) {
+        supervisor_->limit(process_);
+    }
+
+    if ((err = process_->start()) != srs_success) {
+        return err;
+    }
+
+    if (task_) {
+        supervisor_->on_start(task_, process_->get_pid());
+    }
+
+    return err;
 }
 
 srs_error_t SrsFFMPEG::cycle()
 {
-    return process_->cycle();
+    srs_error_t err = srs_success;
+
+    bool started = process_->started();
+    if ((err = process_->cycle()) != srs_success) {
+        return err;
+    }
+
+    if (task_) {
+        // The process exits unexpectedly, restart it with backoff.
+        if (started && !process_->started()) {
+            supervisor_->on_stop(task_, true);
+        }
+        supervisor_->sample();
+    }
+
+    return err;
 }
 
 void SrsFFMPEG::stop()
 {
     process_->stop();
+
+    if (task_) {
+        supervisor_->on_stop(task_, false);
+    }
 }
 
 void SrsFFMPEG::fast_stop()
@@ -20,6 +20,8 @@ class ISrsPithyPrint;
 class SrsProcess;
 class ISrsProcess;
 class ISrsAppConfig;
+class ISrsProcessSupervisor;
+class SrsProcessTask;
 
 // The ffmpeg interface.
 class ISrsFFMPEG
@@ -32,6 +34,8 @@ public:
     virtual void append_iparam(std::string iparam) = 0;
     virtual void set_oformat(std::string format) = 0;
     virtual std::string output() = 0;
+    // Supervise the process as a task, see SrsProcessSupervisor.
+    virtual void set_task(std::string kind, std::string uri, bool low_priority) = 0;
 
 public:
     virtual srs_error_t initialize(std::string in, std::string out, std::string log) = 0;
@@ -54,10 +58,13 @@ class SrsFFMPEG : public ISrsFFMPEG
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
     ISrsAppConfig *config_;
+    ISrsProcessSupervisor *supervisor_;
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
     ISrsProcess *process_;
+    // The supervised task, NULL if not supervised.
+    SrsProcessTask *task_;
     std::vector<std::string> params_;
 
 // clang-format off
@@ -97,6 +104,7 @@ public:
     virtual void append_iparam(std::string iparam);
     virtual void set_oformat(std::string format);
     virtual std::string output();
+    virtual void set_task(std::string kind, std::string uri, bool low_priority);
 
 public:
     virtual srs_error_t initialize(std::string in, std::string out, std::string log);
@@ -11,6 +11,8 @@
 #include <stdlib.h>
 #include <sys/socket.h>
 
+#include <algorithm>
+
 using namespace std;
 
 #include <srs_app_config.hpp>
@@ -27,10 +29,143 @@ using namespace std;
 #include <srs_kernel_pithy_print.hpp>
 #include <srs_kernel_utility.hpp>
 #include <srs_protocol_amf0.hpp>
+#include <srs_protocol_json.hpp>
 #include <srs_protocol_rtmp_msg_array.hpp>
 #include <srs_protocol_rtmp_stack.hpp>
 #include <srs_protocol_utility.hpp>
 
+SrsForwardCursor::SrsForwardCursor()
+{
+    seq_ = 0;
+    nn_dropped_ = 0;
+}
+
+SrsForwardCursor::~SrsForwardCursor()
+{
+}
+
+SrsForwardQueue::SrsForwardQueue()
+{
+    head_ = 0;
+    max_queue_size_ = 0;
+}
+
+SrsForwardQueue::~SrsForwardQueue()
+{
+    std::deque<SrsMediaPacket *>::iterator it;
+    for (it = msgs_.begin(); it != msgs_.end(); ++it) {
+        SrsMediaPacket *msg = *it;
+        srs_freep(msg);
+    }
+    msgs_.clear();
+}
+
+void SrsForwardQueue::set_queue_size(srs_utime_t queue_size)
+{
+    max_queue_size_ = queue_size;
+}
+
+void SrsForwardQueue::attach(SrsForwardCursor *cursor)
+{
+    cursor->seq_ = head_ + (int64_t)msgs_.size();
+    cursors_.push_back(cursor);
+}
+
+void SrsForwardQueue::detach(SrsForwardCursor *cursor)
+{
+    std::vector<SrsForwardCursor *>::iterator it = std::find(cursors_.begin(), cursors_.end(), cursor);
+    if (it != cursors_.end()) {
+        cursors_.erase(it);
+    }
+
+    shrink();
+}
+
+srs_error_t SrsForwardQueue::enqueue(SrsMediaPacket *shared)
+{
+    srs_error_t err = srs_success;
+
+    msgs_.push_back(shared->copy());
+    shrink();
+
+    return err;
+}
+
+void SrsForwardQueue::fetch(SrsForwardCursor *cursor, int max, SrsMediaPacket **pmsgs, int &count, int &dropped)
+{
+    count = dropped = 0;
+
+    // The packets are removed by shrink, skip them.
+    if (cursor->seq_ < head_) {
+        dropped = (int)(head_ - cursor->seq_);
+        cursor->nn_dropped_ += dropped;
+        cursor->seq_ = head_;
+    }
+
+    int64_t tail = head_ + (int64_t)msgs_.size();
+    while (count < max && cursor->seq_ < tail) {
+        SrsMediaPacket *msg = msgs_.at(cursor->seq_ - head_);
+        pmsgs[count++] = msg->copy();
+        cursor->seq_++;
+    }
+
+    shrink();
+}
+
+int SrsForwardQueue::size(SrsForwardCursor *cursor)
+{
+    int64_t tail = head_ + (int64_t)msgs_.size();
+    return (int)(tail - srs_max(cursor->seq_, head_));
+}
+
+srs_utime_t SrsForwardQueue::duration(SrsForwardCursor *cursor)
+{
+    if (size(cursor) <= 0) {
+        return 0;
+    }
+
+    SrsMediaPacket *first = msgs_.at(srs_max(cursor->seq_, head_) - head_);
+    int64_t diff = msgs_.back()->timestamp_ - first->timestamp_;
+    return diff > 0 ? diff * SRS_UTIME_MILLISECONDS : 0;
+}
+
+void SrsForwardQueue::shrink()
+{
+    // Remove the packets consumed by all cursors.
+    int64_t tail = head_ + (int64_t)msgs_.size();
+    int64_t min_seq = tail;
+    for (int i = 0; i < (int)cursors_.size(); i++) {
+        min_seq = srs_min(min_seq, cursors_.at(i)->seq_);
+    }
+
+    while (head_ < min_seq && !msgs_.empty()) {
+        SrsMediaPacket *msg = msgs_.front();
+        msgs_.pop_front();
+        srs_freep(msg);
+        head_++;
+    }
+
+    if (max_queue_size_ <= 0 || msgs_.size() <= 1) {
+        return;
+    }
+
+    // Remove the overflow packets, the slow cursors will skip them.
+    int64_t end = msgs_.back()->timestamp_;
+    while (msgs_.size() > 1) {
+        SrsMediaPacket *msg = msgs_.front();
+
+        // Ignore the zero timestamp of the first sequence header, like SrsMessageQueue.
+        int64_t start = msg->timestamp_ ? msg->timestamp_ : msgs_.at(1)->timestamp_;
+        if (end - start <= srsu2ms(max_queue_size_)) {
+            break;
+        }
+
+        msgs_.pop_front();
+        srs_freep(msg);
+        head_++;
+    }
+}
+
 ISrsForwarder::ISrsForwarder()
 {
 }
@@ -44,12 +179,16 @@ SrsForwarder::SrsForwarder(ISrsOriginHub *h)
     hub_ = h;
 
     req_ = NULL;
+    metadata_ = NULL;
     sh_video_ = sh_audio_ = NULL;
+    nn_sent_ = 0;
 
     sdk_ = NULL;
     trd_ = new SrsDummyCoroutine();
-    queue_ = new SrsMessageQueue();
-    jitter_ = new SrsRtmpJitter();
+    queue_ = new SrsForwardQueue();
+    own_queue_ = true;
+    cursor_ = new SrsForwardCursor();
+    queue_->attach(cursor_);
 
     app_factory_ = _srs_app_factory;
     config_ = _srs_config;
@@ -59,9 +198,14 @@ SrsForwarder::~SrsForwarder()
 {
     srs_freep(sdk_);
     srs_freep(trd_);
-    srs_freep(queue_);
-    srs_freep(jitter_);
 
+    queue_->detach(cursor_);
+    if (own_queue_) {
+        srs_freep(queue_);
+    }
+    srs_freep(cursor_);
+
+    srs_freep(metadata_);
     srs_freep(sh_video_);
     srs_freep(sh_audio_);
 
@@ -99,6 +243,44 @@ void SrsForwarder::set_queue_size(srs_utime_t queue_size)
     queue_->set_queue_size(queue_size);
 }
 
+void SrsForwarder::set_queue(SrsForwardQueue *queue)
+{
+    queue_->detach(cursor_);
+    if (own_queue_) {
+        srs_freep(queue_);
+    }
+
+    queue_ = queue;
+    own_queue_ = false;
+    queue_->attach(cursor_);
+}
+
+void SrsForwarder::dumps(SrsJsonObject *obj)
+{
+    obj->set("stream", SrsJsonAny::str(req_ ? req_->get_stream_url().c_str() : ""));
+    obj->set("ep", SrsJsonAny::str(ep_forward_.c_str()));
+    obj->set("queue", SrsJsonAny::integer(queue_->size(cursor_)));
+    obj->set("lag_ms", SrsJsonAny::integer(srsu2ms(queue_->duration(cursor_))));
+    obj->set("sent", SrsJsonAny::integer(nn_sent_));
+    obj->set("dropped", SrsJsonAny::integer(cursor_->nn_dropped_));
+}
+
+void SrsForwarder::on_start_packets(SrsMediaPacket *metadata, SrsMediaPacket *sh_video, SrsMediaPacket *sh_audio)
+{
+    if (metadata) {
+        srs_freep(metadata_);
+        metadata_ = metadata->copy();
+    }
+    if (sh_video) {
+        srs_freep(sh_video_);
+        sh_video_ = sh_video->copy();
+    }
+    if (sh_audio) {
+        srs_freep(sh_audio_);
+        sh_audio_ = sh_audio->copy();
+    }
+}
+
 srs_error_t SrsForwarder::on_publish()
 {
     srs_error_t err = srs_success;
@@ -123,14 +305,8 @@ srs_error_t SrsForwarder::on_meta_data(SrsMediaPacket *shared_metadata)
 {
     srs_error_t err = srs_success;
 
-    SrsMediaPacket *metadata = shared_metadata->copy();
-
-    // TODO: FIXME: config the jitter of Forwarder.
-    if ((err = jitter_->correct(metadata, SrsRtmpJitterAlgorithmOFF)) != srs_success) {
-        return srs_error_wrap(err, "jitter");
-    }
-
-    if ((err = queue_->enqueue(metadata)) != srs_success) {
+    // The shared queue is enqueued by hub.
+    if (own_queue_ && (err = queue_->enqueue(shared_metadata)) != srs_success) {
         return srs_error_wrap(err, "enqueue metadata");
     }
 
@@ -141,19 +317,13 @@ srs_error_t SrsForwarder::on_audio(SrsMediaPacket *shared_audio)
 {
     srs_error_t err = srs_success;
 
-    SrsMediaPacket *msg = shared_audio->copy();
-
-    // TODO: FIXME: config the jitter of Forwarder.
-    if ((err = jitter_->correct(msg, SrsRtmpJitterAlgorithmOFF)) != srs_success) {
-        return srs_error_wrap(err, "jitter");
-    }
-
-    if (SrsFlvAudio::sh(msg->payload(), msg->size())) {
+    if (SrsFlvAudio::sh(shared_audio->payload(), shared_audio->size())) {
         srs_freep(sh_audio_);
-        sh_audio_ = msg->copy();
+        sh_audio_ = shared_audio->copy();
     }
 
-    if ((err = queue_->enqueue(msg)) != srs_success) {
+    // The shared queue is enqueued by hub.
+    if (own_queue_ && (err = queue_->enqueue(shared_audio)) != srs_success) {
         return srs_error_wrap(err, "enqueue audio");
     }
 
@@ -164,19 +334,13 @@ srs_error_t SrsForwarder::on_video(SrsMediaPacket *shared_video)
 {
     srs_error_t err = srs_success;
 
-    SrsMediaPacket *msg = shared_video->copy();
-
-    // TODO: FIXME: config the jitter of Forwarder.
-    if ((err = jitter_->correct(msg, SrsRtmpJitterAlgorithmOFF)) != srs_success) {
-        return srs_error_wrap(err, "jitter");
-    }
-
-    if (SrsFlvVideo::sh(msg->payload(), msg->size())) {
+    if (SrsFlvVideo::sh(shared_video->payload(), shared_video->size())) {
         srs_freep(sh_video_);
-        sh_video_ = msg->copy();
+        sh_video_ = shared_video->copy();
     }
 
-    if ((err = queue_->enqueue(msg)) != srs_success) {
+    // The shared queue is enqueued by hub.
+    if (own_queue_ && (err = queue_->enqueue(shared_video)) != srs_success) {
         return srs_error_wrap(err, "enqueue video");
     }
 
@@ -273,17 +437,18 @@ srs_error_t SrsForwarder::forward()
 
     SrsMessageArray msgs(SYS_MAX_FORWARD_SEND_MSGS);
 
-    // update sequence header
-    // TODO: FIXME: maybe need to zero the sequence header timestamp.
-    if (sh_video_) {
-        if ((err = sdk_->send_and_free_message(sh_video_->copy())) != srs_success) {
-            return srs_error_wrap(err, "send video sh");
+    // The metadata fed by hub, only sent once when forwarding starts.
+    if (metadata_) {
+        SrsMediaPacket *metadata = metadata_;
+        metadata_ = NULL;
+        if ((err = sdk_->send_and_free_message(metadata)) != srs_success) {
+            return srs_error_wrap(err, "send metadata");
         }
     }
-    if (sh_audio_) {
-        if ((err = sdk_->send_and_free_message(sh_audio_->copy())) != srs_success) {
-            return srs_error_wrap(err, "send audio sh");
-        }
+
+    // update sequence header
+    if ((err = send_sequence_headers()) != srs_success) {
+        return srs_error_wrap(err, "send sh");
     }
 
     while (true) {
@@ -306,27 +471,78 @@ srs_error_t SrsForwarder::forward()
             srs_freep(msg);
         }
 
-        // forward all messages.
-        // each msg in msgs.msgs_ must be free, for the SrsMessageArray never free them.
+        // Forward all messages in queue, in one pass.
         int count = 0;
-        if ((err = queue_->dump_packets(msgs.max_, msgs.msgs_, count)) != srs_success) {
-            return srs_error_wrap(err, "dump packets");
+        if ((err = flush(msgs, count)) != srs_success) {
+            return srs_error_wrap(err, "flush");
         }
 
         // pithy print
         if (pprint->can_print()) {
             sdk_->kbps_sample(SRS_CONSTS_LOG_FOWARDER, pprint->age(), count);
         }
+    }
+
+    return err;
+}
+
+srs_error_t SrsForwarder::flush(SrsMessageArray &msgs, int &count)
+{
+    srs_error_t err = srs_success;
+
+    while (true) {
+        // each msg in msgs.msgs_ must be free, for the SrsMessageArray never free them.
+        int nn = 0, dropped = 0;
+        queue_->fetch(cursor_, msgs.max_, msgs.msgs_, nn, dropped);
+
+        // The sequence headers maybe skipped, so we resend them.
+        if (dropped > 0) {
+            srs_warn("Forwarder: %s drop %d packets, queue=%dms", ep_forward_.c_str(), dropped, srsu2msi(queue_->duration(cursor_)));
+            if ((err = send_sequence_headers()) != srs_success) {
+                for (int i = 0; i < nn; i++) {
+                    SrsMediaPacket *msg = msgs.msgs_[i];
+                    srs_freep(msg);
+                }
+                return srs_error_wrap(err, "send sh");
+            }
+        }
 
         // ignore when no messages.
-        if (count <= 0) {
-            continue;
+        if (nn <= 0) {
+            break;
         }
 
         // sendout messages, all messages are freed by send_and_free_messages().
-        if ((err = sdk_->send_and_free_messages(msgs.msgs_, count)) != srs_success) {
+        if ((err = sdk_->send_and_free_messages(msgs.msgs_, nn)) != srs_success) {
             return srs_error_wrap(err, "send messages");
         }
+
+        count += nn;
+        nn_sent_ += nn;
+
+        // The queue is drained.
+        if (nn < msgs.max_) {
+            break;
+        }
+    }
+
+    return err;
+}
+
+srs_error_t SrsForwarder::send_sequence_headers()
+{
+    srs_error_t err = srs_success;
+
+    // TODO: FIXME: maybe need to zero the sequence header timestamp.
+    if (sh_video_) {
+        if ((err = sdk_->send_and_free_message(sh_video_->copy())) != srs_success) {
+            return srs_error_wrap(err, "send video sh");
+        }
+    }
+    if (sh_audio_) {
+        if ((err = sdk_->send_and_free_message(sh_audio_->copy())) != srs_success) {
+            return srs_error_wrap(err, "send audio sh");
+        }
     }
 
     return err;
@@ -9,15 +9,16 @@
 
 #include <srs_core.hpp>
 
+#include <deque>
 #include <string>
+#include <vector>
 
 #include <srs_app_st.hpp>
 
 class ISrsProtocolReadWriter;
 class SrsMediaPacket;
 class SrsOnMetaDataPacket;
-class SrsMessageQueue;
-class SrsRtmpJitter;
+class SrsMessageArray;
 class SrsRtmpClient;
 class ISrsRequest;
 class SrsLiveSource;
@@ -28,6 +29,60 @@ class SrsSimpleRtmpClient;
 class ISrsBasicRtmpClient;
 class ISrsAppFactory;
 class ISrsAppConfig;
+class SrsJsonObject;
+
+// The cursor of a forwarder in the forward queue.
+class SrsForwardCursor
+{
+public:
+    // The sequence of the next packet to forward.
+    int64_t seq_;
+    // The number of packets skipped, because the forwarder fell behind.
+    int64_t nn_dropped_;
+
+public:
+    SrsForwardCursor();
+    virtual ~SrsForwardCursor();
+};
+
+// The packets to forward, shared by all forwarders of a stream. Each packet is copied once
+// for all destinations, and each forwarder consumes the queue by its own cursor. Packets
+// are removed when all cursors passed them, or when the queue exceeds the queue size, so
+// the slowest forwarder skips them.
+class SrsForwardQueue
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    std::deque<SrsMediaPacket *> msgs_;
+    // The sequence of the first packet in msgs_.
+    int64_t head_;
+    srs_utime_t max_queue_size_;
+    std::vector<SrsForwardCursor *> cursors_;
+
+public:
+    SrsForwardQueue();
+    virtual ~SrsForwardQueue();
+
+public:
+    virtual void set_queue_size(srs_utime_t queue_size);
+    // Attach the cursor to the end of queue, which only gets the packets after it.
+    virtual void attach(SrsForwardCursor *cursor);
+    virtual void detach(SrsForwardCursor *cursor);
+    // Enqueue a copy of the packet.
+    virtual srs_error_t enqueue(SrsMediaPacket *shared);
+    // Fetch at most max packets for the cursor, and move the cursor. Each packet is a copy
+    // which shares the payload, because the RTMP stream id is set by each connection, so
+    // caller should free it. The dropped is the number of packets skipped by this fetch.
+    virtual void fetch(SrsForwardCursor *cursor, int max, SrsMediaPacket **pmsgs, int &count, int &dropped);
+    // The number of packets to forward for the cursor.
+    virtual int size(SrsForwardCursor *cursor);
+    // The duration of packets to forward for the cursor, that is the lag.
+    virtual srs_utime_t duration(SrsForwardCursor *cursor);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    virtual void shrink();
+};
 
 // The forward interface.
 class ISrsForwarder
@@ -73,11 +128,17 @@ SRS_DECLARE_PRIVATE: // clang-format on
 SRS_DECLARE_PRIVATE: // clang-format on
     ISrsOriginHub *hub_;
     ISrsBasicRtmpClient *sdk_;
-    SrsRtmpJitter *jitter_;
-    SrsMessageQueue *queue_;
+    // The queue to consume, shared by the forwarders of hub, or owned by the forwarder.
+    SrsForwardQueue *queue_;
+    bool own_queue_;
+    SrsForwardCursor *cursor_;
+    // The metadata fed by hub when forwarder starts, sent before the packets in queue.
+    SrsMediaPacket *metadata_;
     // Cache the sequence header for retry when slave is failed.
     SrsMediaPacket *sh_audio_;
     SrsMediaPacket *sh_video_;
+    // The number of packets sent to the destination.
+    int64_t nn_sent_;
 
 public:
     SrsForwarder(ISrsOriginHub *h);
@@ -86,6 +147,15 @@ public:
 public:
     virtual srs_error_t initialize(ISrsRequest *r, std::string ep);
     virtual void set_queue_size(srs_utime_t queue_size);
+    // Consume the shared queue of hub, which enqueues each packet before the forwarders.
+    // Should be called before publish.
+    virtual void set_queue(SrsForwardQueue *queue);
+    // Dumps the destination, queue depth and lag of forwarder.
+    virtual void dumps(SrsJsonObject *obj);
+    // Feed the cached metadata and sequence headers by hub when forwarder starts, which are sent
+    // by the forward coroutine before the packets in queue, so it never writes to the destination.
+    // @param metadata, sh_video and sh_audio, directly ptr and maybe NULL, copy it if need to save it.
+    virtual void on_start_packets(SrsMediaPacket *metadata, SrsMediaPacket *sh_video, SrsMediaPacket *sh_audio);
 
 public:
     virtual srs_error_t on_publish();
@@ -110,6 +180,9 @@ SRS_DECLARE_PRIVATE: // clang-format on
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
     virtual srs_error_t forward();
+    // Send all packets in queue, in batches of msgs.
+    virtual srs_error_t flush(SrsMessageArray &msgs, int &count);
+    virtual srs_error_t send_sequence_headers();
 };
 
 #endif
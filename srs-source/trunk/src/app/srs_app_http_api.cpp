@@ -16,7 +16,9 @@ using namespace std;
 #include <srs_app_coworkers.hpp>
 #include <srs_app_dvr.hpp>
 #include <srs_app_http_conn.hpp>
+#include <srs_app_process.hpp>
 #include <srs_app_rtmp_source.hpp>
+#include <srs_app_security.hpp>
 #include <srs_app_server.hpp>
 #include <srs_app_st.hpp>
 #include <srs_app_statistic.hpp>
@@ -147,6 +149,114 @@ srs_error_t srs_api_response_code(ISrsHttpResponseWriter *w, ISrsHttpMessage *r,
     return srs_api_response_jsonp_code(w, callback, code);
 }
 
+// When page exceed this count, response in streaming JSON.
+#define SRS_HTTP_API_STREAMING_COUNT 100
+// The size of chunk for streaming JSON.
+#define SRS_HTTP_API_STREAMING_CHUNK (16 * 1024)
+
+srs_error_t srs_api_parse_page(ISrsHttpMessage *r, SrsStatisticPage *page, const char **known, bool &streaming)
+{
+    srs_error_t err = srs_success;
+
+    std::string rstart = r->query_get("start");
+    std::string rcount = r->query_get("count");
+    page->start_ = srs_max(0, atoi(rstart.c_str()));
+    page->count_ = srs_max(1, atoi(rcount.c_str()));
+    page->cursor_ = r->query_get("cursor");
+
+    // Note that the comma is also a separator of query, so we parse the fields from raw query. All
+    // the fields= in query are merged, and each one is unescaped, for example, fields=id%2Cip.
+    std::vector<std::string> queries = srs_strings_split(r->query(), "&");
+    for (int i = 0; i < (int)queries.size(); i++) {
+        const std::string &q = queries[i];
+        if (q.find("fields=") != 0) {
+            continue;
+        }
+
+        std::string fields;
+        if ((err = SrsHttpUri::query_unescape(q.substr(7), fields)) != srs_success) {
+            return srs_error_wrap(err, "unescape fields %s", q.c_str());
+        }
+
+        std::vector<std::string> vs = srs_strings_split(fields, ",");
+        for (int j = 0; j < (int)vs.size(); j++) {
+            if (!vs[j].empty()) {
+                page->fields_.push_back(vs[j]);
+            }
+        }
+    }
+
+    if ((err = page->check_fields(known)) != srs_success) {
+        return srs_error_wrap(err, "check fields");
+    }
+
+    // For JSONP, always use the JSON object.
+    if (r->is_jsonp()) {
+        streaming = false;
+        return err;
+    }
+
+    streaming = !page->cursor_.empty() || !page->fields_.empty() || page->count_ > SRS_HTTP_API_STREAMING_COUNT;
+    return err;
+}
+
+// Write the common fields of streaming JSON for page.
+void srs_api_page_header(SrsJsonWriter *jw, ISrsStatistic *stat, int64_t total)
+{
+    jw->object_start();
+    jw->key("code");
+    jw->integer(ERROR_SUCCESS);
+    jw->key("server");
+    jw->str(stat->server_id());
+    jw->key("service");
+    jw->str(stat->service_id());
+    jw->key("pid");
+    jw->str(stat->service_pid());
+    jw->key("total");
+    jw->integer(total);
+}
+
+// Write the cursor for next page, and finish the streaming JSON.
+srs_error_t srs_api_page_footer(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    srs_error_t err = srs_success;
+
+    if (!page->next_.empty()) {
+        jw->key("next");
+        jw->str(page->next_);
+    }
+    jw->object_end();
+
+    if ((err = jw->flush(true)) != srs_success) {
+        return srs_error_wrap(err, "flush");
+    }
+
+    return err;
+}
+
+SrsHttpApiJsonSink::SrsHttpApiJsonSink(ISrsHttpResponseWriter *w)
+{
+    w_ = w;
+}
+
+SrsHttpApiJsonSink::~SrsHttpApiJsonSink()
+{
+}
+
+srs_error_t SrsHttpApiJsonSink::write_json(const std::string &chunk)
+{
+    srs_error_t err = srs_success;
+
+    if ((err = w_->write((char *)chunk.data(), (int)chunk.length())) != srs_success) {
+        return srs_error_wrap(err, "write json");
+    }
+
+    // Yield to other coroutines, for example, to deliver media packets.
+    srs_thread_yield();
+
+    return err;
+}
+
 // @remark we will free the code.
 srs_error_t srs_api_response_code(ISrsHttpResponseWriter *w, ISrsHttpMessage *r, srs_error_t code)
 {
@@ -270,6 +380,9 @@ srs_error_t SrsGoApiV1::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r
     urls->set("clients", SrsJsonAny::str("manage all clients or specified client, default query top 10 clients"));
     urls->set("raw", SrsJsonAny::str("raw api for srs, support CUID srs for instance the config"));
     urls->set("clusters", SrsJsonAny::str("origin cluster server API"));
+    urls->set("security", SrsJsonAny::str("the blocklist of security, POST to update without reload"));
+    urls->set("forwards", SrsJsonAny::str("the forwarders of streams, with queue depth and lag of each destination"));
+    urls->set("processes", SrsJsonAny::str("the FFmpeg processes of ingest and transcode, with cpu, memory and restarts"));
     urls->set("perf", SrsJsonAny::str("System performance stat"));
     urls->set("tcmalloc", SrsJsonAny::str("tcmalloc api with params ?page=summary|api"));
 #ifdef SRS_VALGRIND
@@ -790,15 +903,23 @@ srs_error_t SrsGoApiStreams::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessa
             }
             obj->set("total", SrsJsonAny::integer(nstreams));
 
+            // For large page, response in streaming JSON, to avoid building a huge JSON tree.
+            SrsStatisticPage page;
+            bool streaming = false;
+            if ((err = srs_api_parse_page(r, &page, srs_stat_stream_fields, streaming)) != srs_success) {
+                int code = srs_error_code(err);
+                srs_freep(err);
+                return srs_api_response_code(w, r, code);
+            }
+            if (streaming) {
+                return serve_page(w, &page, nstreams);
+            }
+
             // Add streams
             SrsJsonArray *data = SrsJsonAny::array();
             obj->set("streams", data);
 
-            std::string rstart = r->query_get("start");
-            std::string rcount = r->query_get("count");
-            int start = srs_max(0, atoi(rstart.c_str()));
-            int count = srs_max(1, atoi(rcount.c_str()));
-            if ((err = stat_->dumps_streams(data, start, count)) != srs_success) {
+            if ((err = stat_->dumps_streams(data, page.start_, page.count_)) != srs_success) {
                 int code = srs_error_code(err);
                 srs_freep(err);
                 return srs_api_response_code(w, r, code);
@@ -821,6 +942,33 @@ srs_error_t SrsGoApiStreams::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessa
     return srs_api_response(w, r, obj->dumps());
 }
 
+srs_error_t SrsGoApiStreams::serve_page(ISrsHttpResponseWriter *w, SrsStatisticPage *page, int64_t total)
+{
+    srs_error_t err = srs_success;
+
+    // Write header without content length, to response in chunked encoding.
+    w->header()->set_content_type("application/json");
+    w->write_header(SRS_CONSTS_HTTP_OK);
+
+    SrsHttpApiJsonSink sink(w);
+    SrsJsonWriter jw(&sink, SRS_HTTP_API_STREAMING_CHUNK);
+
+    srs_api_page_header(&jw, stat_, total);
+
+    jw.key("streams");
+    jw.array_start();
+    if ((err = stat_->dumps_streams(&jw, page)) != srs_success) {
+        return srs_error_wrap(err, "dumps streams");
+    }
+    jw.array_end();
+
+    if ((err = srs_api_page_footer(&jw, page)) != srs_success) {
+        return srs_error_wrap(err, "footer");
+    }
+
+    return w->final_request();
+}
+
 SrsGoApiClients::SrsGoApiClients()
 {
     stat_ = _srs_stat;
@@ -862,15 +1010,23 @@ srs_error_t SrsGoApiClients::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessa
             }
             obj->set("total", SrsJsonAny::integer(nclients));
 
+            // For large page, response in streaming JSON, to avoid building a huge JSON tree.
+            SrsStatisticPage page;
+            bool streaming = false;
+            if ((err = srs_api_parse_page(r, &page, srs_stat_client_fields, streaming)) != srs_success) {
+                int code = srs_error_code(err);
+                srs_freep(err);
+                return srs_api_response_code(w, r, code);
+            }
+            if (streaming) {
+                return serve_page(w, &page, nclients);
+            }
+
             // Add clients
             SrsJsonArray *data = SrsJsonAny::array();
             obj->set("clients", data);
 
-            std::string rstart = r->query_get("start");
-            std::string rcount = r->query_get("count");
-            int start = srs_max(0, atoi(rstart.c_str()));
-            int count = srs_max(1, atoi(rcount.c_str()));
-            if ((err = stat_->dumps_clients(data, start, count)) != srs_success) {
+            if ((err = stat_->dumps_clients(data, page.start_, page.count_)) != srs_success) {
                 int code = srs_error_code(err);
                 srs_freep(err);
                 return srs_api_response_code(w, r, code);
@@ -904,6 +1060,33 @@ srs_error_t SrsGoApiClients::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessa
     return srs_api_response(w, r, obj->dumps());
 }
 
+srs_error_t SrsGoApiClients::serve_page(ISrsHttpResponseWriter *w, SrsStatisticPage *page, int64_t total)
+{
+    srs_error_t err = srs_success;
+
+    // Write header without content length, to response in chunked encoding.
+    w->header()->set_content_type("application/json");
+    w->write_header(SRS_CONSTS_HTTP_OK);
+
+    SrsHttpApiJsonSink sink(w);
+    SrsJsonWriter jw(&sink, SRS_HTTP_API_STREAMING_CHUNK);
+
+    srs_api_page_header(&jw, stat_, total);
+
+    jw.key("clients");
+    jw.array_start();
+    if ((err = stat_->dumps_clients(&jw, page)) != srs_success) {
+        return srs_error_wrap(err, "dumps clients");
+    }
+    jw.array_end();
+
+    if ((err = srs_api_page_footer(&jw, page)) != srs_success) {
+        return srs_error_wrap(err, "footer");
+    }
+
+    return w->final_request();
+}
+
 SrsGoApiRaw::SrsGoApiRaw(ISrsSignalHandler *handler)
 {
     handler_ = handler;
@@ -1003,6 +1186,18 @@ SrsGoApiClusters::~SrsGoApiClusters()
 
 srs_error_t SrsGoApiClusters::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r)
 {
+    srs_error_t err = srs_success;
+
+    if (r->is_http_post()) {
+        if ((err = do_update(r)) != srs_success) {
+            srs_warn("cluster: update directory err %s", srs_error_desc(err).c_str());
+            int code = srs_error_code(err);
+            srs_freep(err);
+            return srs_api_response_code(w, r, code);
+        }
+        return srs_api_response_code(w, r, ERROR_SUCCESS);
+    }
+
     SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
 
     obj->set("code", SrsJsonAny::integer(ERROR_SUCCESS));
@@ -1023,9 +1218,182 @@ srs_error_t SrsGoApiClusters::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMess
     SrsCoWorkers *coworkers = SrsCoWorkers::instance();
     data->set("origin", coworkers->dumps(vhost, coworker, app, stream));
 
+    if (_srs_cluster_directory) {
+        SrsJsonObject *directory = SrsJsonAny::object();
+        data->set("directory", directory);
+        _srs_cluster_directory->dumps(directory);
+    }
+
     return srs_api_response(w, r, obj->dumps());
 }
 
+srs_error_t SrsGoApiClusters::do_update(ISrsHttpMessage *r)
+{
+    srs_error_t err = srs_success;
+
+    string body;
+    if ((err = r->body_read_all(body)) != srs_success) {
+        return srs_error_wrap(err, "read body");
+    }
+
+    SrsUniquePtr<SrsJsonAny> json(SrsJsonAny::loads(body));
+    if (!json.get() || !json->is_object()) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "invalid body %s", body.c_str());
+    }
+
+    if (!_srs_cluster_directory) {
+        return srs_error_new(ERROR_OCLUSTER_DISCOVER, "no directory");
+    }
+
+    // The peer ip to identify the coworker, never use the ip from proxy, which is set by client.
+    string ip;
+    SrsHttpMessage *hm = dynamic_cast<SrsHttpMessage *>(r);
+    if (hm && hm->connection()) {
+        ip = hm->connection()->remote_ip();
+    }
+
+    if ((err = _srs_cluster_directory->on_message(json->to_object(), ip)) != srs_success) {
+        return srs_error_wrap(err, "directory");
+    }
+
+    return err;
+}
+
+SrsGoApiForwards::SrsGoApiForwards()
+{
+    sources_ = _srs_sources;
+}
+
+SrsGoApiForwards::~SrsGoApiForwards()
+{
+    sources_ = NULL;
+}
+
+srs_error_t SrsGoApiForwards::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r)
+{
+    if (!r->is_http_get()) {
+        return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
+    }
+
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    obj->set("code", SrsJsonAny::integer(ERROR_SUCCESS));
+
+    SrsJsonArray *data = SrsJsonAny::array();
+    obj->set("forwards", data);
+    sources_->dumps_forwarders(data);
+
+    return srs_api_response(w, r, obj->dumps());
+}
+
+SrsGoApiProcesses::SrsGoApiProcesses()
+{
+    supervisor_ = _srs_process_supervisor;
+}
+
+SrsGoApiProcesses::~SrsGoApiProcesses()
+{
+    supervisor_ = NULL;
+}
+
+srs_error_t SrsGoApiProcesses::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r)
+{
+    if (!r->is_http_get()) {
+        return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
+    }
+
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    obj->set("code", SrsJsonAny::integer(ERROR_SUCCESS));
+
+    SrsJsonObject *data = SrsJsonAny::object();
+    obj->set("supervisor", data);
+    supervisor_->dumps(data);
+
+    return srs_api_response(w, r, obj->dumps());
+}
+
+SrsGoApiSecurity::SrsGoApiSecurity()
+{
+    manager_ = _srs_security_rules;
+}
+
+SrsGoApiSecurity::~SrsGoApiSecurity()
+{
+    manager_ = NULL;
+}
+
+srs_error_t SrsGoApiSecurity::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r)
+{
+    srs_error_t err = srs_success;
+
+    if (r->is_http_post()) {
+        if ((err = do_update(r)) != srs_success) {
+            srs_warn("security: update blocklist err %s", srs_error_desc(err).c_str());
+            int code = srs_error_code(err);
+            srs_freep(err);
+            return srs_api_response_code(w, r, code);
+        }
+    } else if (!r->is_http_get()) {
+        return srs_go_http_error(w, SRS_CONSTS_HTTP_MethodNotAllowed);
+    }
+
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    obj->set("code", SrsJsonAny::integer(ERROR_SUCCESS));
+
+    SrsJsonObject *data = SrsJsonAny::object();
+    obj->set("blocklists", data);
+    manager_->dumps(data);
+
+    return srs_api_response(w, r, obj->dumps());
+}
+
+srs_error_t SrsGoApiSecurity::do_update(ISrsHttpMessage *r)
+{
+    srs_error_t err = srs_success;
+
+    string body;
+    if ((err = r->body_read_all(body)) != srs_success) {
+        return srs_error_wrap(err, "read body");
+    }
+
+    SrsUniquePtr<SrsJsonAny> json(SrsJsonAny::loads(body));
+    if (!json.get() || !json->is_object()) {
+        return srs_error_new(ERROR_SYSTEM_SECURITY, "invalid body %s", body.c_str());
+    }
+
+    SrsJsonObject *req = json->to_object();
+
+    string vhost = SRS_CONSTS_RTMP_DEFAULT_VHOST;
+    SrsJsonAny *prop = req->get_property("vhost");
+    if (prop && prop->is_string()) {
+        vhost = prop->to_str();
+    }
+
+    string action;
+    if ((prop = req->get_property("action")) != NULL && prop->is_string()) {
+        action = prop->to_str();
+    }
+
+    vector<string> ips;
+    if ((prop = req->get_property("deny")) == NULL || !prop->is_array()) {
+        return srs_error_new(ERROR_SYSTEM_SECURITY, "no deny array");
+    }
+
+    SrsJsonArray *deny = prop->to_array();
+    for (int i = 0; i < deny->count(); i++) {
+        SrsJsonAny *ip = deny->at(i);
+        if (!ip->is_string()) {
+            return srs_error_new(ERROR_SYSTEM_SECURITY, "deny[%d] not string", i);
+        }
+        ips.push_back(ip->to_str());
+    }
+
+    if ((err = manager_->update_blocklist(vhost, action, ips)) != srs_success) {
+        return srs_error_wrap(err, "update vhost=%s, action=%s", vhost.c_str(), action.c_str());
+    }
+
+    return err;
+}
+
 SrsGoApiError::SrsGoApiError()
 {
     stat_ = _srs_stat;
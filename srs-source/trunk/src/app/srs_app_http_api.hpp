@@ -22,6 +22,10 @@ class SrsHttpConn;
 class ISrsSignalHandler;
 class ISrsStatistic;
 class ISrsAppConfig;
+class SrsStatisticPage;
+class SrsSecurityRuleManager;
+class SrsLiveSourceManager;
+class SrsProcessSupervisor;
 
 #include <string>
 
@@ -30,11 +34,35 @@ class ISrsAppConfig;
 #include <srs_app_st.hpp>
 #include <srs_protocol_conn.hpp>
 #include <srs_protocol_http_stack.hpp>
+#include <srs_protocol_json.hpp>
 
 extern srs_error_t srs_api_response(ISrsHttpResponseWriter *w, ISrsHttpMessage *r, std::string json);
 extern srs_error_t srs_api_response_code(ISrsHttpResponseWriter *w, ISrsHttpMessage *r, int code);
 extern srs_error_t srs_api_response_code(ISrsHttpResponseWriter *w, ISrsHttpMessage *r, srs_error_t code);
 
+// Parse the page of streams or clients from query, return whether response in streaming JSON, which
+// is used for large page, or cursor based page, or field selection, for example:
+//      /api/v1/clients?count=100000
+//      /api/v1/clients?cursor=7g2q1x8&count=1000&fields=id,ip,kbps
+// Note that the fields must be in the known fields, ended by NULL, or return error.
+extern srs_error_t srs_api_parse_page(ISrsHttpMessage *r, SrsStatisticPage *page, const char **known, bool &streaming);
+
+// The sink to write streaming JSON to HTTP response, which yields to other coroutines after
+// each chunk, so a large response never blocks the media.
+class SrsHttpApiJsonSink : public ISrsJsonSink
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsHttpResponseWriter *w_;
+
+public:
+    SrsHttpApiJsonSink(ISrsHttpResponseWriter *w);
+    virtual ~SrsHttpApiJsonSink();
+
+public:
+    virtual srs_error_t write_json(const std::string &chunk);
+};
+
 // For http root.
 class SrsGoApiRoot : public ISrsHttpHandler
 {
@@ -230,6 +258,11 @@ public:
 
 public:
     virtual srs_error_t serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Response a page of streams in streaming JSON.
+    virtual srs_error_t serve_page(ISrsHttpResponseWriter *w, SrsStatisticPage *page, int64_t total);
 };
 
 class SrsGoApiClients : public ISrsHttpHandler
@@ -244,6 +277,11 @@ public:
 
 public:
     virtual srs_error_t serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Response a page of clients in streaming JSON.
+    virtual srs_error_t serve_page(ISrsHttpResponseWriter *w, SrsStatisticPage *page, int64_t total);
 };
 
 class SrsGoApiRaw : public ISrsHttpHandler, public ISrsReloadHandler
@@ -285,6 +323,65 @@ public:
 
 public:
     virtual srs_error_t serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Apply the streams pushed by coworker, see SrsClusterDirectory.
+    virtual srs_error_t do_update(ISrsHttpMessage *r);
+};
+
+// The forwarders of all streams, with the queue depth and lag of each destination.
+//      GET /api/v1/forwards
+class SrsGoApiForwards : public ISrsHttpHandler
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    SrsLiveSourceManager *sources_;
+
+public:
+    SrsGoApiForwards();
+    virtual ~SrsGoApiForwards();
+
+public:
+    virtual srs_error_t serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r);
+};
+
+// The FFmpeg processes of ingest and transcode, with the cpu, memory and restarts of each.
+//      GET /api/v1/processes
+class SrsGoApiProcesses : public ISrsHttpHandler
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    SrsProcessSupervisor *supervisor_;
+
+public:
+    SrsGoApiProcesses();
+    virtual ~SrsGoApiProcesses();
+
+public:
+    virtual srs_error_t serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r);
+};
+
+// The blocklist of security, to deny the clients without reloading config.
+//      GET /api/v1/security to query the blocklist of all vhosts.
+//      POST /api/v1/security with {"vhost":"__defaultVhost__","action":"play","deny":["10.0.0.0/8"]}
+//          to replace the blocklist of vhost for action, empty deny to clear it.
+class SrsGoApiSecurity : public ISrsHttpHandler
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    SrsSecurityRuleManager *manager_;
+
+public:
+    SrsGoApiSecurity();
+    virtual ~SrsGoApiSecurity();
+
+public:
+    virtual srs_error_t serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage *r);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    virtual srs_error_t do_update(ISrsHttpMessage *r);
 };
 
 class SrsGoApiError : public ISrsHttpHandler
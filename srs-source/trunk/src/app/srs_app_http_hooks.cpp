@@ -34,6 +34,14 @@ using namespace std;
 // the timeout for hls notify, in srs_utime_t.
 #define SRS_HLS_NOTIFY_TIMEOUT (10 * SRS_UTIME_SECONDS)
 
+// The max idle clients for each hooks server.
+#define SRS_HTTP_HOOKS_MAX_IDLE 16
+// The idle client is dropped if not used for a while, because the server may close it, for
+// example, the keepalive_timeout of nginx is 75s.
+#define SRS_HTTP_HOOKS_IDLE_TIMEOUT (30 * SRS_UTIME_SECONDS)
+// The max number of allowed on_play in cache.
+#define SRS_HTTP_HOOKS_MAX_PLAY_CACHE 4096
+
 // Global HTTP hooks instance
 ISrsHttpHooks *_srs_hooks = NULL;
 
@@ -45,15 +53,31 @@ ISrsHttpHooks::~ISrsHttpHooks()
 {
 }
 
+SrsHttpHooksIdleClient::SrsHttpHooksIdleClient(ISrsHttpClient *client, srs_utime_t starttime)
+{
+    client_ = client;
+    starttime_ = starttime;
+}
+
 SrsHttpHooks::SrsHttpHooks()
 {
     factory_ = _srs_app_factory;
     stat_ = _srs_stat;
     config_ = _srs_config;
+
+    nn_requests_ = 0;
+    nn_errors_ = 0;
+    nn_reused_ = 0;
+    nn_play_hits_ = 0;
+    for (int i = 0; i < SRS_HTTP_HOOKS_NB_BUCKETS; i++) {
+        latency_[i] = 0;
+    }
 }
 
 SrsHttpHooks::~SrsHttpHooks()
 {
+    clear_idle_clients();
+
     factory_ = NULL;
     stat_ = NULL;
     config_ = NULL;
@@ -83,8 +107,7 @@ srs_error_t SrsHttpHooks::on_connect(string url, ISrsRequest *req)
     std::string res;
     int status_code;
 
-    SrsUniquePtr<ISrsHttpClient> http(factory_->create_http_client());
-    if ((err = do_post(http.get(), url, data, status_code, res)) != srs_success) {
+    if ((err = post(req->vhost_, url, data, status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http: on_connect failed, client_id=%s, url=%s, request=%s, response=%s, code=%d",
                               cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code);
     }
@@ -117,8 +140,7 @@ void SrsHttpHooks::on_close(string url, ISrsRequest *req, int64_t send_bytes, in
     std::string res;
     int status_code;
 
-    SrsUniquePtr<ISrsHttpClient> http(factory_->create_http_client());
-    if ((err = do_post(http.get(), url, data, status_code, res)) != srs_success) {
+    if ((err = post(req->vhost_, url, data, status_code, res)) != srs_success) {
         int ret = srs_error_code(err);
         srs_freep(err);
         srs_warn("http: ignore on_close failed, client_id=%s, url=%s, request=%s, response=%s, code=%d, ret=%d",
@@ -161,8 +183,7 @@ srs_error_t SrsHttpHooks::on_publish(string url, ISrsRequest *req)
     std::string res;
     int status_code;
 
-    SrsUniquePtr<ISrsHttpClient> http(factory_->create_http_client());
-    if ((err = do_post(http.get(), url, data, status_code, res)) != srs_success) {
+    if ((err = post(req->vhost_, url, data, status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http: on_publish failed, client_id=%s, url=%s, request=%s, response=%s, code=%d",
                               cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code);
     }
@@ -202,8 +223,7 @@ void SrsHttpHooks::on_unpublish(string url, ISrsRequest *req)
     std::string res;
     int status_code;
 
-    SrsUniquePtr<ISrsHttpClient> http(factory_->create_http_client());
-    if ((err = do_post(http.get(), url, data, status_code, res)) != srs_success) {
+    if ((err = post(req->vhost_, url, data, status_code, res)) != srs_success) {
         int ret = srs_error_code(err);
         srs_freep(err);
         srs_warn("http: ignore on_unpublish failed, client_id=%s, url=%s, request=%s, response=%s, status=%d, ret=%d",
@@ -221,6 +241,14 @@ srs_error_t SrsHttpHooks::on_play(string url, ISrsRequest *req)
 {
     srs_error_t err = srs_success;
 
+    // Allow the play by the cache of allowed on_play, to absorb the reconnecting players.
+    if (play_cache_hit(url, req)) {
+        nn_play_hits_++;
+        srs_trace("http: on_play ok by cache, url=%s, stream=%s, param=%s", url.c_str(),
+                  req->get_stream_url().c_str(), req->param_.c_str());
+        return err;
+    }
+
     SrsContextId cid = _srs_context->get_id();
     ISrsStatistic *stat = stat_;
     SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
@@ -248,12 +276,13 @@ srs_error_t SrsHttpHooks::on_play(string url, ISrsRequest *req)
     std::string res;
     int status_code;
 
-    SrsUniquePtr<ISrsHttpClient> http(factory_->create_http_client());
-    if ((err = do_post(http.get(), url, data, status_code, res)) != srs_success) {
+    if ((err = post(req->vhost_, url, data, status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http: on_play failed, client_id=%s, url=%s, request=%s, response=%s, status=%d",
                               cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code);
     }
 
+    play_cache_update(url, req);
+
     srs_trace("http: on_play ok, client_id=%s, url=%s, request=%s, response=%s",
               cid.c_str(), url.c_str(), data.c_str(), res.c_str());
 
@@ -290,8 +319,7 @@ void SrsHttpHooks::on_stop(string url, ISrsRequest *req)
     std::string res;
     int status_code;
 
-    SrsUniquePtr<ISrsHttpClient> http(factory_->create_http_client());
-    if ((err = do_post(http.get(), url, data, status_code, res)) != srs_success) {
+    if ((err = post(req->vhost_, url, data, status_code, res)) != srs_success) {
         int ret = srs_error_code(err);
         srs_freep(err);
         srs_warn("http: ignore on_stop failed, client_id=%s, url=%s, request=%s, response=%s, code=%d, ret=%d",
@@ -338,8 +366,7 @@ srs_error_t SrsHttpHooks::on_dvr(SrsContextId c, string url, ISrsRequest *req, s
     std::string res;
     int status_code;
 
-    SrsUniquePtr<ISrsHttpClient> http(factory_->create_http_client());
-    if ((err = do_post(http.get(), url, data, status_code, res)) != srs_success) {
+    if ((err = post(req->vhost_, url, data, status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http post on_dvr uri failed, client_id=%s, url=%s, request=%s, response=%s, code=%d",
                               cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code);
     }
@@ -395,8 +422,7 @@ srs_error_t SrsHttpHooks::on_hls(SrsContextId c, string url, ISrsRequest *req, s
     std::string res;
     int status_code;
 
-    SrsUniquePtr<ISrsHttpClient> http(factory_->create_http_client());
-    if ((err = do_post(http.get(), url, data, status_code, res)) != srs_success) {
+    if ((err = post(req->vhost_, url, data, status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http: post %s with %s, status=%d, res=%s", url.c_str(), data.c_str(), status_code, res.c_str());
     }
 
@@ -554,8 +580,7 @@ srs_error_t SrsHttpHooks::on_forward_backend(string url, ISrsRequest *req, std::
     std::string res;
     int status_code;
 
-    SrsUniquePtr<ISrsHttpClient> http(factory_->create_http_client());
-    if ((err = do_post(http.get(), url, data, status_code, res)) != srs_success) {
+    if ((err = post(req->vhost_, url, data, status_code, res)) != srs_success) {
         return srs_error_wrap(err, "http: on_forward_backend failed, client_id=%s, url=%s, request=%s, response=%s, code=%d",
                               cid.c_str(), url.c_str(), data.c_str(), res.c_str(), status_code);
     }
@@ -598,6 +623,68 @@ srs_error_t SrsHttpHooks::on_forward_backend(string url, ISrsRequest *req, std::
     return err;
 }
 
+void SrsHttpHooks::dumps(SrsJsonObject *obj)
+{
+    obj->set("requests", SrsJsonAny::integer(nn_requests_));
+    obj->set("errors", SrsJsonAny::integer(nn_errors_));
+    obj->set("reused", SrsJsonAny::integer(nn_reused_));
+    obj->set("play_hits", SrsJsonAny::integer(nn_play_hits_));
+
+    int idles = 0;
+    std::map<std::string, std::vector<SrsHttpHooksIdleClient> >::iterator it;
+    for (it = idle_clients_.begin(); it != idle_clients_.end(); ++it) {
+        idles += (int)it->second.size();
+    }
+    obj->set("idles", SrsJsonAny::integer(idles));
+    obj->set("play_cache", SrsJsonAny::integer((int)play_cache_.size()));
+
+    SrsJsonObject *latency = SrsJsonAny::object();
+    obj->set("latency", latency);
+
+    latency->set("10ms", SrsJsonAny::integer(latency_[0]));
+    latency->set("50ms", SrsJsonAny::integer(latency_[1]));
+    latency->set("100ms", SrsJsonAny::integer(latency_[2]));
+    latency->set("500ms", SrsJsonAny::integer(latency_[3]));
+    latency->set("1s", SrsJsonAny::integer(latency_[4]));
+    latency->set("slow", SrsJsonAny::integer(latency_[5]));
+}
+
+srs_error_t SrsHttpHooks::post(std::string vhost, std::string url, std::string req, int &code, string &res)
+{
+    srs_error_t err = srs_success;
+
+    srs_utime_t starttime = srs_time_now_realtime();
+
+    if (config_->get_vhost_http_hooks_keep_alive(vhost)) {
+        err = do_post_keep_alive(url, req, code, res);
+    } else {
+        SrsUniquePtr<ISrsHttpClient> http(factory_->create_http_client());
+        err = do_post(http.get(), url, req, code, res);
+    }
+
+    srs_utime_t duration = srs_time_now_realtime() - starttime;
+    if (duration < 10 * SRS_UTIME_MILLISECONDS) {
+        latency_[0]++;
+    } else if (duration < 50 * SRS_UTIME_MILLISECONDS) {
+        latency_[1]++;
+    } else if (duration < 100 * SRS_UTIME_MILLISECONDS) {
+        latency_[2]++;
+    } else if (duration < 500 * SRS_UTIME_MILLISECONDS) {
+        latency_[3]++;
+    } else if (duration < SRS_UTIME_SECONDS) {
+        latency_[4]++;
+    } else {
+        latency_[5]++;
+    }
+
+    nn_requests_++;
+    if (err != srs_success) {
+        nn_errors_++;
+    }
+
+    return err;
+}
+
 srs_error_t SrsHttpHooks::do_post(ISrsHttpClient *hc, std::string url, std::string req, int &code, string &res)
 {
     srs_error_t err = srs_success;
@@ -616,6 +703,78 @@ srs_error_t SrsHttpHooks::do_post(ISrsHttpClient *hc, std::string url, std::stri
         path += "?" + uri.get_query();
     }
 
+    bool keep_alive = false;
+    if ((err = do_request(hc, path, req, code, res, keep_alive)) != srs_success) {
+        return srs_error_wrap(err, "http: request");
+    }
+
+    return check_response(code, res);
+}
+
+srs_error_t SrsHttpHooks::do_post_keep_alive(std::string url, std::string req, int &code, string &res)
+{
+    srs_error_t err = srs_success;
+
+    SrsHttpUri uri;
+    if ((err = uri.initialize(url)) != srs_success) {
+        return srs_error_wrap(err, "http: post failed. url=%s", url.c_str());
+    }
+
+    string path = uri.get_path();
+    if (!uri.get_query().empty()) {
+        path += "?" + uri.get_query();
+    }
+
+    string server = srs_fmt_sprintf("%s://%s:%d", uri.get_schema().c_str(), uri.get_host().c_str(), uri.get_port());
+
+    // Reuse the idle connection, which might be closed by server, so retry with a new connection. We only retry
+    // when the request is not handled by server, that is, failed to write, or EOF or reset before any response
+    // byte. For other errors, such as timeout, the server might have handled the request, so never retry.
+    ISrsHttpClient *hc = fetch_idle(server);
+    bool keep_alive = false;
+    if (hc) {
+        if ((err = do_request(hc, path, req, code, res, keep_alive)) == srs_success) {
+            nn_reused_++;
+        } else {
+            int ret = srs_error_code(err);
+            srs_freep(hc);
+
+            if (ret != ERROR_SOCKET_WRITE && ret != ERROR_HTTP_NO_RESPONSE) {
+                return srs_error_wrap(err, "http: request by idle connection");
+            }
+
+            srs_warn("http: idle connection of %s failed, retry by new connection, %s", server.c_str(), srs_error_desc(err).c_str());
+            srs_freep(err);
+        }
+    }
+
+    if (!hc) {
+        hc = factory_->create_http_client();
+        if ((err = hc->initialize(uri.get_schema(), uri.get_host(), uri.get_port())) != srs_success) {
+            srs_freep(hc);
+            return srs_error_wrap(err, "http: init client");
+        }
+
+        if ((err = do_request(hc, path, req, code, res, keep_alive)) != srs_success) {
+            srs_freep(hc);
+            return srs_error_wrap(err, "http: request");
+        }
+    }
+
+    // The response is read completely, so the connection is idle and reusable, if server supports it.
+    if (keep_alive) {
+        give_back(server, hc);
+    } else {
+        srs_freep(hc);
+    }
+
+    return check_response(code, res);
+}
+
+srs_error_t SrsHttpHooks::do_request(ISrsHttpClient *hc, std::string path, std::string req, int &code, string &res, bool &keep_alive)
+{
+    srs_error_t err = srs_success;
+
     ISrsHttpMessage *msg_raw = NULL;
     if ((err = hc->post(path, req, &msg_raw)) != srs_success) {
         return srs_error_wrap(err, "http: client post");
@@ -627,6 +786,15 @@ srs_error_t SrsHttpHooks::do_post(ISrsHttpClient *hc, std::string url, std::stri
         return srs_error_wrap(err, "http: body read");
     }
 
+    keep_alive = msg->is_keep_alive();
+
+    return err;
+}
+
+srs_error_t SrsHttpHooks::check_response(int code, std::string res)
+{
+    srs_error_t err = srs_success;
+
     // ensure the http status is ok.
     if (code != SRS_CONSTS_HTTP_OK && code != SRS_CONSTS_HTTP_Created) {
         return srs_error_new(ERROR_HTTP_STATUS_INVALID, "http: status %d", code);
@@ -664,3 +832,101 @@ srs_error_t SrsHttpHooks::do_post(ISrsHttpClient *hc, std::string url, std::stri
 
     return err;
 }
+
+ISrsHttpClient *SrsHttpHooks::fetch_idle(std::string server)
+{
+    std::map<std::string, std::vector<SrsHttpHooksIdleClient> >::iterator it = idle_clients_.find(server);
+    if (it == idle_clients_.end()) {
+        return NULL;
+    }
+
+    // Use the most recent idle client, which is less likely to be closed by server.
+    std::vector<SrsHttpHooksIdleClient> &clients = it->second;
+    srs_utime_t now = srs_time_now_cached();
+    while (!clients.empty()) {
+        SrsHttpHooksIdleClient idle = clients.back();
+        clients.pop_back();
+
+        if (now - idle.starttime_ < SRS_HTTP_HOOKS_IDLE_TIMEOUT) {
+            return idle.client_;
+        }
+        srs_freep(idle.client_);
+    }
+
+    return NULL;
+}
+
+void SrsHttpHooks::give_back(std::string server, ISrsHttpClient *hc)
+{
+    std::vector<SrsHttpHooksIdleClient> &clients = idle_clients_[server];
+    if (clients.size() >= SRS_HTTP_HOOKS_MAX_IDLE) {
+        srs_freep(hc);
+        return;
+    }
+
+    clients.push_back(SrsHttpHooksIdleClient(hc, srs_time_now_cached()));
+}
+
+void SrsHttpHooks::clear_idle_clients()
+{
+    std::map<std::string, std::vector<SrsHttpHooksIdleClient> >::iterator it;
+    for (it = idle_clients_.begin(); it != idle_clients_.end(); ++it) {
+        std::vector<SrsHttpHooksIdleClient> &clients = it->second;
+        for (int i = 0; i < (int)clients.size(); i++) {
+            srs_freep(clients[i].client_);
+        }
+    }
+    idle_clients_.clear();
+}
+
+bool SrsHttpHooks::play_cache_hit(std::string url, ISrsRequest *req)
+{
+    if (config_->get_vhost_http_hooks_play_cache(req->vhost_) <= 0) {
+        return false;
+    }
+
+    std::map<std::string, srs_utime_t>::iterator it = play_cache_.find(play_cache_key(url, req));
+    if (it == play_cache_.end()) {
+        return false;
+    }
+
+    if (it->second < srs_time_now_cached()) {
+        play_cache_.erase(it);
+        return false;
+    }
+
+    return true;
+}
+
+void SrsHttpHooks::play_cache_update(std::string url, ISrsRequest *req)
+{
+    srs_utime_t ttl = config_->get_vhost_http_hooks_play_cache(req->vhost_);
+    if (ttl <= 0) {
+        return;
+    }
+
+    srs_utime_t now = srs_time_now_cached();
+
+    // Remove the expired items, or reset the cache if too many streams.
+    if (play_cache_.size() >= SRS_HTTP_HOOKS_MAX_PLAY_CACHE) {
+        std::map<std::string, srs_utime_t>::iterator it;
+        for (it = play_cache_.begin(); it != play_cache_.end();) {
+            if (it->second < now) {
+                play_cache_.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (play_cache_.size() >= SRS_HTTP_HOOKS_MAX_PLAY_CACHE) {
+        play_cache_.clear();
+    }
+
+    play_cache_[play_cache_key(url, req)] = now + ttl;
+}
+
+std::string SrsHttpHooks::play_cache_key(std::string url, ISrsRequest *req)
+{
+    // The backend might authenticate by client IP, so never share the verdict between clients.
+    return url + " " + req->ip_ + " " + req->get_stream_url() + req->param_;
+}
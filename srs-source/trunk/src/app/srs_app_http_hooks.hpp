@@ -9,6 +9,7 @@
 
 #include <srs_core.hpp>
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -21,6 +22,10 @@ class ISrsAppFactory;
 class ISrsHttpClient;
 class ISrsStatistic;
 class ISrsAppConfig;
+class SrsJsonObject;
+
+// The number of buckets of hooks latency histogram, which is <10ms, <50ms, <100ms, <500ms, <1s and others.
+#define SRS_HTTP_HOOKS_NB_BUCKETS 6
 
 // HTTP hooks interface for SRS server event callbacks.
 //
@@ -151,6 +156,18 @@ public:
     virtual void on_close(std::string url, ISrsRequest *req, int64_t send_bytes, int64_t recv_bytes) = 0;
 };
 
+// The idle HTTP client to the hooks server, which is reused by keep-alive.
+class SrsHttpHooksIdleClient
+{
+public:
+    ISrsHttpClient *client_;
+    // The time when the client is idle, to drop the stale connections.
+    srs_utime_t starttime_;
+
+public:
+    SrsHttpHooksIdleClient(ISrsHttpClient *client, srs_utime_t starttime);
+};
+
 class SrsHttpHooks : public ISrsHttpHooks
 {
 // clang-format off
@@ -159,6 +176,19 @@ SRS_DECLARE_PRIVATE: // clang-format on
     ISrsStatistic *stat_;
     ISrsAppConfig *config_;
 
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The idle clients for keep-alive, the key is the schema://host:port of hooks server.
+    std::map<std::string, std::vector<SrsHttpHooksIdleClient> > idle_clients_;
+    // The allowed on_play, the key is the url, client ip and stream url with param, the value is the expire time.
+    std::map<std::string, srs_utime_t> play_cache_;
+    // The stat of hooks, to check the latency and how many connections are reused.
+    int64_t nn_requests_;
+    int64_t nn_errors_;
+    int64_t nn_reused_;
+    int64_t nn_play_hits_;
+    int64_t latency_[SRS_HTTP_HOOKS_NB_BUCKETS];
+
 public:
     SrsHttpHooks();
     virtual ~SrsHttpHooks();
@@ -177,9 +207,27 @@ public:
     srs_error_t discover_co_workers(std::string url, std::string &host, int &port);
     srs_error_t on_forward_backend(std::string url, ISrsRequest *req, std::vector<std::string> &rtmp_urls);
 
+public:
+    // Dumps the stat of hooks, for the summaries API.
+    void dumps(SrsJsonObject *obj);
+
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
+    // Post the request to url, reuse the idle connection if keep-alive of vhost is enabled.
+    srs_error_t post(std::string vhost, std::string url, std::string req, int &code, std::string &res);
     srs_error_t do_post(ISrsHttpClient *hc, std::string url, std::string req, int &code, std::string &res);
+    srs_error_t do_post_keep_alive(std::string url, std::string req, int &code, std::string &res);
+    srs_error_t do_request(ISrsHttpClient *hc, std::string path, std::string req, int &code, std::string &res, bool &keep_alive);
+    srs_error_t check_response(int code, std::string res);
+    // Fetch an idle client of server, or NULL if no idle client.
+    ISrsHttpClient *fetch_idle(std::string server);
+    // Give back the client to the idle pool of server, free it if the pool is full.
+    void give_back(std::string server, ISrsHttpClient *hc);
+    void clear_idle_clients();
+    // Whether the on_play is allowed by cache, and cache the allowed on_play.
+    bool play_cache_hit(std::string url, ISrsRequest *req);
+    void play_cache_update(std::string url, ISrsRequest *req);
+    std::string play_cache_key(std::string url, ISrsRequest *req);
 };
 
 // Global HTTP hooks instance
@@ -8,6 +8,11 @@
 
 #define SRS_STREAM_CACHE_CYCLE (30 * SRS_UTIME_SECONDS)
 
+// The max chunks of shared TS muxer, to limit the memory if no keyframe.
+#define SRS_TS_SHARED_MAX_CHUNKS 4096
+// For pure audio stream, refresh the PAT/PMT in ms, as start point for new viewers.
+#define SRS_TS_SHARED_AUDIO_REFRESH 1000
+
 #include <fcntl.h>
 #include <stdlib.h>
 #include <sys/stat.h>
@@ -209,6 +214,277 @@ srs_error_t SrsBufferCache::cycle()
     return err;
 }
 
+SrsTsSharedChunk::SrsTsSharedChunk()
+{
+    seq_ = 0;
+    keyframe_ = false;
+}
+
+SrsTsSharedChunk::~SrsTsSharedChunk()
+{
+}
+
+SrsTsSharedMuxer::SrsTsSharedMuxer(ISrsRequest *r)
+{
+    req_ = r->copy()->as_http();
+    trd_ = new SrsSTCoroutine("http-ts", this);
+    enc_ = new SrsTsTransmuxer();
+    packets_ = new SrsSimpleStream();
+    next_seq_ = 1;
+    has_video_ = false;
+    last_refresh_ = -1;
+
+    config_ = _srs_config;
+    live_sources_ = _srs_sources;
+}
+
+SrsTsSharedMuxer::~SrsTsSharedMuxer()
+{
+    srs_freep(trd_);
+
+    clear();
+    srs_freep(enc_);
+    srs_freep(packets_);
+    srs_freep(req_);
+
+    config_ = NULL;
+    live_sources_ = NULL;
+}
+
+srs_error_t SrsTsSharedMuxer::start()
+{
+    srs_error_t err = srs_success;
+
+    enc_->set_has_audio(config_->get_vhost_http_remux_has_audio(req_->vhost_));
+    enc_->set_has_video(config_->get_vhost_http_remux_has_video(req_->vhost_));
+    enc_->set_guess_has_av(config_->get_vhost_http_remux_guess_has_av(req_->vhost_));
+
+    if ((err = enc_->initialize(this)) != srs_success) {
+        return srs_error_wrap(err, "init encoder");
+    }
+
+    if ((err = trd_->start()) != srs_success) {
+        return srs_error_wrap(err, "coroutine");
+    }
+
+    return err;
+}
+
+void SrsTsSharedMuxer::stop()
+{
+    trd_->stop();
+}
+
+srs_error_t SrsTsSharedMuxer::pull()
+{
+    return trd_->pull();
+}
+
+void SrsTsSharedMuxer::fetch(uint64_t &cursor, std::vector<SrsSharedPtr<SrsMemoryBlock> > &chunks)
+{
+    if (chunks_.empty()) {
+        return;
+    }
+
+    // Start from the latest keyframe, for new viewer or the chunks are evicted.
+    uint64_t first = chunks_.front()->seq_;
+    if (cursor == 0 || cursor < first) {
+        uint64_t start = 0;
+        for (std::deque<SrsTsSharedChunk *>::reverse_iterator it = chunks_.rbegin(); it != chunks_.rend(); ++it) {
+            SrsTsSharedChunk *chunk = *it;
+            if (chunk->keyframe_) {
+                start = chunk->seq_;
+                break;
+            }
+        }
+
+        // Wait for keyframe.
+        if (!start) {
+            return;
+        }
+
+        if (cursor) {
+            srs_warn("TS: Viewer lag, skip chunks %" PRId64 " to keyframe %" PRId64, cursor, start);
+        }
+        cursor = start;
+    }
+
+    for (int i = (int)(cursor - first); i < (int)chunks_.size(); i++) {
+        SrsTsSharedChunk *chunk = chunks_.at(i);
+        chunks.push_back(chunk->data_);
+        cursor = chunk->seq_ + 1;
+    }
+}
+
+srs_error_t SrsTsSharedMuxer::write(void *buf, size_t size, ssize_t *nwrite)
+{
+    packets_->append((const char *)buf, (int)size);
+
+    if (nwrite) {
+        *nwrite = size;
+    }
+
+    return srs_success;
+}
+
+srs_error_t SrsTsSharedMuxer::cycle()
+{
+    srs_error_t err = do_cycle();
+
+    // Free the chunks, to notify the viewers to quit.
+    clear();
+
+    return err;
+}
+
+srs_error_t SrsTsSharedMuxer::do_cycle()
+{
+    srs_error_t err = srs_success;
+
+    SrsSharedPtr<SrsLiveSource> live_source;
+    if ((err = live_sources_->fetch_or_create(req_, live_source)) != srs_success) {
+        return srs_error_wrap(err, "source create");
+    }
+    srs_assert(live_source.get() != NULL);
+
+    // The muxer creates consumer to mux the stream, which will trigger to fetch stream
+    // from origin for edge.
+    SrsLiveConsumer *consumer_raw = NULL;
+    if ((err = live_source->create_consumer(consumer_raw)) != srs_success) {
+        return srs_error_wrap(err, "create consumer");
+    }
+    SrsUniquePtr<SrsLiveConsumer> consumer(consumer_raw);
+
+    if ((err = live_source->consumer_dumps(consumer.get(), true, true, true)) != srs_success) {
+        return srs_error_wrap(err, "dumps consumer");
+    }
+
+    SrsUniquePtr<SrsPithyPrint> pprint(SrsPithyPrint::create_http_stream_cache());
+
+    SrsMessageArray msgs(SRS_PERF_MW_MSGS);
+
+    srs_utime_t mw_sleep = config_->get_mw_sleep(req_->vhost_);
+    if (mw_sleep == 0) {
+        mw_sleep = 10 * SRS_UTIME_MILLISECONDS;
+    }
+
+    while (true) {
+        if ((err = trd_->pull()) != srs_success) {
+            return srs_error_wrap(err, "ts muxer");
+        }
+
+        pprint->elapse();
+
+        // Each msg in msgs.msgs must be free, for the SrsMessageArray never free them.
+        int count = 0;
+        if ((err = consumer->dump_packets(&msgs, count)) != srs_success) {
+            return srs_error_wrap(err, "consumer dump packets");
+        }
+
+        if (count <= 0) {
+            srs_usleep(mw_sleep);
+            continue;
+        }
+
+        if (pprint->can_print()) {
+            srs_trace("-> " SRS_CONSTS_LOG_HTTP_STREAM_CACHE " http: ts muxer got %d msgs, chunks=%d, seq=%" PRId64 ", age=%d",
+                      count, (int)chunks_.size(), next_seq_, pprint->age());
+        }
+
+        for (int i = 0; i < count; i++) {
+            SrsMediaPacket *msg = msgs.msgs_[i];
+            if (err == srs_success) {
+                err = on_message(msg);
+            }
+            srs_freep(msg);
+        }
+
+        if (err != srs_success) {
+            return srs_error_wrap(err, "mux messages");
+        }
+    }
+
+    return err;
+}
+
+srs_error_t SrsTsSharedMuxer::on_message(SrsMediaPacket *msg)
+{
+    srs_error_t err = srs_success;
+
+    // Refresh PAT/PMT before keyframe, or by time for pure audio, as start point for viewers.
+    bool keyframe = false;
+    if (msg->is_video()) {
+        has_video_ = true;
+        keyframe = SrsFlvVideo::keyframe(msg->payload(), msg->size()) && !SrsFlvVideo::sh(msg->payload(), msg->size());
+    } else if (msg->is_audio() && !has_video_) {
+        keyframe = last_refresh_ < 0 || msg->timestamp_ - last_refresh_ >= SRS_TS_SHARED_AUDIO_REFRESH;
+        keyframe = keyframe && !SrsFlvAudio::sh(msg->payload(), msg->size());
+    }
+
+    if (keyframe) {
+        enc_->refresh();
+        last_refresh_ = msg->timestamp_;
+    }
+
+    if (msg->is_audio()) {
+        err = enc_->write_audio(msg->timestamp_, msg->payload(), msg->size());
+    } else if (msg->is_video()) {
+        err = enc_->write_video(msg->timestamp_, msg->payload(), msg->size());
+    }
+
+    if (err != srs_success) {
+        packets_->erase(packets_->length());
+        return srs_error_wrap(err, "ts mux");
+    }
+
+    // Ignore if no TS packets, for example, the sequence header.
+    if (packets_->length() <= 0) {
+        return err;
+    }
+
+    SrsTsSharedChunk *chunk = new SrsTsSharedChunk();
+    chunk->seq_ = next_seq_++;
+    chunk->keyframe_ = keyframe;
+    chunk->data_ = SrsSharedPtr<SrsMemoryBlock>(new SrsMemoryBlock());
+    chunk->data_->create(packets_->bytes(), packets_->length());
+    packets_->erase(packets_->length());
+
+    // Only keep chunks from the previous keyframe, to serve the new and slow viewers.
+    if (keyframe) {
+        int previous = -1;
+        for (int i = (int)chunks_.size() - 1; i >= 0 && previous < 0; i--) {
+            if (chunks_.at(i)->keyframe_) {
+                previous = i;
+            }
+        }
+        for (int i = 0; i < previous; i++) {
+            SrsTsSharedChunk *evicted = chunks_.front();
+            chunks_.pop_front();
+            srs_freep(evicted);
+        }
+    }
+
+    chunks_.push_back(chunk);
+
+    while ((int)chunks_.size() > SRS_TS_SHARED_MAX_CHUNKS) {
+        SrsTsSharedChunk *evicted = chunks_.front();
+        chunks_.pop_front();
+        srs_freep(evicted);
+    }
+
+    return err;
+}
+
+void SrsTsSharedMuxer::clear()
+{
+    std::deque<SrsTsSharedChunk *>::iterator it;
+    for (it = chunks_.begin(); it != chunks_.end(); ++it) {
+        SrsTsSharedChunk *chunk = *it;
+        srs_freep(chunk);
+    }
+    chunks_.clear();
+}
+
 ISrsBufferEncoder::ISrsBufferEncoder()
 {
 }
@@ -622,6 +898,7 @@ SrsLiveStream::SrsLiveStream(ISrsRequest *r, ISrsBufferCache *c)
     cache_ = c;
     req_ = r->copy()->as_http();
     security_ = new SrsSecurity();
+    ts_muxer_ = NULL;
 
     config_ = _srs_config;
     live_sources_ = _srs_sources;
@@ -633,6 +910,7 @@ SrsLiveStream::~SrsLiveStream()
 {
     srs_freep(req_);
     srs_freep(security_);
+    srs_freep(ts_muxer_);
 
     // The live stream should never be destroyed when it's serving any viewers.
     srs_assert(viewers_.empty());
@@ -668,6 +946,12 @@ srs_error_t SrsLiveStream::serve_http(ISrsHttpResponseWriter *w, ISrsHttpMessage
     srs_assert(it != viewers_.end());
     viewers_.erase(it);
 
+    // Free the shared TS muxer when all viewers are gone.
+    if (viewers_.empty() && ts_muxer_) {
+        ts_muxer_->stop();
+        srs_freep(ts_muxer_);
+    }
+
     return err;
 }
 
@@ -728,6 +1012,14 @@ srs_error_t SrsLiveStream::serve_http_impl(ISrsHttpResponseWriter *w, ISrsHttpMe
     live_source->set_cache(enabled_cache);
     live_source->set_gop_cache_max_frames(gcmf);
 
+    // For HTTP-TS with shared packetizer, the viewer only sends the shared TS chunks, so it
+    // doesn't need a consumer.
+    if (srs_strings_ends_with(entry_->pattern, ".ts") && config_->get_vhost_http_remux_ts_shared(req->vhost_)) {
+        err = do_serve_http_ts_shared(req.get(), w, r);
+        http_hooks_on_stop(r);
+        return err;
+    }
+
     // Create consumer of source, ignore gop cache, use the audio gop cache.
     SrsLiveConsumer *consumer_raw = NULL;
     if ((err = live_source->create_consumer(consumer_raw)) != srs_success) {
@@ -918,6 +1210,98 @@ srs_error_t SrsLiveStream::do_serve_http(SrsLiveSource *source, ISrsLiveConsumer
     return srs_error_new(ERROR_HTTP_STREAM_EOF, "Stream EOF");
 }
 
+srs_error_t SrsLiveStream::do_serve_http_ts_shared(ISrsRequest *req, ISrsHttpResponseWriter *w, ISrsHttpMessage *r)
+{
+    srs_error_t err = srs_success;
+
+    // The first viewer creates the shared muxer, which consumes the source.
+    if (!ts_muxer_) {
+        SrsTsSharedMuxer *muxer = new SrsTsSharedMuxer(req);
+        if ((err = muxer->start()) != srs_success) {
+            srs_freep(muxer);
+            return srs_error_wrap(err, "start ts muxer");
+        }
+        ts_muxer_ = muxer;
+    }
+
+    w->header()->set_content_type("video/MP2T");
+
+    // Enter chunked mode, because we didn't set the content-length.
+    w->write_header(SRS_CONSTS_HTTP_OK);
+
+    SrsUniquePtr<SrsPithyPrint> pprint(SrsPithyPrint::create_http_stream());
+
+    // Use receive thread to accept the close event to avoid FD leak.
+    SrsHttpMessage *hr = dynamic_cast<SrsHttpMessage *>(r);
+    SrsHttpConn *hc = dynamic_cast<SrsHttpConn *>(hr->connection());
+    SrsHttpxConn *hxc = dynamic_cast<SrsHttpxConn *>(hc->handler());
+    srs_assert(hxc);
+
+    SrsUniquePtr<SrsHttpRecvThread> trd(new SrsHttpRecvThread(hxc));
+    if ((err = trd->start()) != srs_success) {
+        return srs_error_wrap(err, "start recv thread");
+    }
+
+    srs_utime_t mw_sleep = config_->get_mw_sleep(req_->vhost_);
+    if (mw_sleep == 0) {
+        mw_sleep = 10 * SRS_UTIME_MILLISECONDS;
+    }
+
+    srs_trace("FLV %s, encoder=TS, shared=1, mw_sleep=%dms", entry_->pattern.c_str(), srsu2msi(mw_sleep));
+
+    // The next chunk to send, start from the latest keyframe.
+    uint64_t cursor = 0;
+    vector<SrsSharedPtr<SrsMemoryBlock> > chunks;
+    vector<iovec> iovs;
+
+    while (entry_->enabled) {
+        // Whether client closed the FD.
+        if ((err = trd->pull()) != srs_success) {
+            return srs_error_wrap(err, "recv thread");
+        }
+
+        // Whether the shared muxer is still working, note that it's never freed when serving viewers.
+        if ((err = ts_muxer_->pull()) != srs_success) {
+            return srs_error_wrap(err, "ts muxer");
+        }
+
+        pprint->elapse();
+
+        chunks.clear();
+        ts_muxer_->fetch(cursor, chunks);
+
+        if (chunks.empty()) {
+            srs_usleep(mw_sleep);
+            continue;
+        }
+
+        if (pprint->can_print()) {
+            srs_trace("-> " SRS_CONSTS_LOG_HTTP_STREAM " http: got %d ts chunks, cursor=%" PRId64 ", age=%d, mw=%d",
+                      (int)chunks.size(), cursor, pprint->age(), srsu2msi(mw_sleep));
+        }
+
+        // Send out the shared chunks, never exceed the max iovs of a writev.
+        for (int i = 0; i < (int)chunks.size(); i += SRS_CONSTS_IOVS_MAX) {
+            int nn = srs_min(SRS_CONSTS_IOVS_MAX, (int)chunks.size() - i);
+
+            iovs.resize(nn);
+            for (int j = 0; j < nn; j++) {
+                SrsMemoryBlock *chunk = chunks.at(i + j).get();
+                iovs[j].iov_base = chunk->payload();
+                iovs[j].iov_len = chunk->size();
+            }
+
+            if ((err = w->writev(&iovs[0], nn, NULL)) != srs_success) {
+                return srs_error_wrap(err, "send ts chunks");
+            }
+        }
+    }
+
+    // Here, the entry is disabled by encoder un-publishing or reloading,
+    // so we must return a io.EOF error to disconnect the client, or the client will never quit.
+    return srs_error_new(ERROR_HTTP_STREAM_EOF, "Stream EOF");
+}
+
 srs_error_t SrsLiveStream::http_hooks_on_play(ISrsHttpMessage *r)
 {
     srs_error_t err = srs_success;
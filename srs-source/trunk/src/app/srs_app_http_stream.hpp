@@ -11,7 +11,11 @@
 #include <srs_app_http_conn.hpp>
 #include <srs_app_security.hpp>
 #include <srs_core.hpp>
+#include <srs_core_autofree.hpp>
+#include <srs_kernel_buffer.hpp>
+#include <srs_kernel_io.hpp>
 
+#include <deque>
 #include <vector>
 
 class SrsAacTransmuxer;
@@ -30,6 +34,7 @@ class ISrsAacTransmuxer;
 class ISrsBufferCache;
 class ISrsMp3Transmuxer;
 class ISrsCommonHttpHandler;
+class SrsSimpleStream;
 
 // The cache for HTTP Live Streaming encoder.
 class ISrsBufferCache
@@ -81,6 +86,76 @@ public:
     virtual srs_error_t cycle();
 };
 
+// A chunk of TS packets muxed from one media message, shared by all HTTP-TS viewers.
+class SrsTsSharedChunk
+{
+public:
+    // The sequence of chunk, monotonically increasing from 1.
+    uint64_t seq_;
+    // Whether chunk starts with PAT/PMT, so a new viewer could start from it.
+    bool keyframe_;
+    // The TS packets, each is 188 bytes.
+    SrsSharedPtr<SrsMemoryBlock> data_;
+
+public:
+    SrsTsSharedChunk();
+    virtual ~SrsTsSharedChunk();
+};
+
+// The shared TS packetizer of a HTTP-TS stream, which consumes the live source and does
+// the PES packetization, continuity counters and PAT/PMT once, into a ring of chunks.
+// Each viewer only streams the chunks from its cursor, so the per viewer cost is only
+// the socket writes.
+class SrsTsSharedMuxer : public ISrsCoroutineHandler, public ISrsStreamWriter
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsAppConfig *config_;
+    ISrsLiveSourceManager *live_sources_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsRequest *req_;
+    ISrsCoroutine *trd_;
+    ISrsTsTransmuxer *enc_;
+    // The TS packets of current message.
+    SrsSimpleStream *packets_;
+    // The ring of chunks, evicted by keyframe.
+    std::deque<SrsTsSharedChunk *> chunks_;
+    uint64_t next_seq_;
+    // Whether got any video frame, refresh PAT/PMT by time for pure audio stream.
+    bool has_video_;
+    int64_t last_refresh_;
+
+public:
+    SrsTsSharedMuxer(ISrsRequest *r);
+    virtual ~SrsTsSharedMuxer();
+
+public:
+    virtual srs_error_t start();
+    virtual void stop();
+    // Check whether the muxer coroutine is still working.
+    virtual srs_error_t pull();
+    // Fetch the chunks after cursor, and update the cursor.
+    // @param cursor The next sequence to send, 0 to start from the latest keyframe. If the
+    //       viewer is too slow and the chunks are evicted, skip to the latest keyframe.
+    // @param chunks The chunks to send, which are referenced so it's safe to write them
+    //       even when the muxer evicts chunks.
+    virtual void fetch(uint64_t &cursor, std::vector<SrsSharedPtr<SrsMemoryBlock> > &chunks);
+    // Interface ISrsStreamWriter
+public:
+    virtual srs_error_t write(void *buf, size_t size, ssize_t *nwrite);
+    // Interface ISrsCoroutineHandler
+public:
+    virtual srs_error_t cycle();
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    virtual srs_error_t do_cycle();
+    virtual srs_error_t on_message(SrsMediaPacket *msg);
+    virtual void clear();
+};
+
 // The encoder to transmux RTMP stream.
 class ISrsBufferEncoder
 {
@@ -272,6 +347,9 @@ SRS_DECLARE_PRIVATE: // clang-format on
     ISrsRequest *req_;
     ISrsBufferCache *cache_;
     ISrsSecurity *security_;
+    // The shared TS packetizer for HTTP-TS viewers, created by the first viewer, and
+    // freed when all viewers are gone.
+    SrsTsSharedMuxer *ts_muxer_;
     // For multiple viewers, which means there will more than one alive viewers for a live stream, so we must
     // use an int value to represent if there is any viewer is alive. We should never do cleanup unless all
     // viewers closed the connection.
@@ -298,6 +376,7 @@ public:
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
     virtual srs_error_t do_serve_http(SrsLiveSource *source, ISrsLiveConsumer *consumer, ISrsHttpResponseWriter *w, ISrsHttpMessage *r);
+    virtual srs_error_t do_serve_http_ts_shared(ISrsRequest *req, ISrsHttpResponseWriter *w, ISrsHttpMessage *r);
     virtual srs_error_t http_hooks_on_play(ISrsHttpMessage *r);
     virtual void http_hooks_on_stop(ISrsHttpMessage *r);
     virtual srs_error_t streaming_send_messages(ISrsBufferEncoder *enc, SrsMediaPacket **msgs, int nb_msgs);
@@ -490,6 +490,9 @@ srs_error_t SrsIngester::initialize_ffmpeg(ISrsFFMPEG *ffmpeg, SrsConfDirective
         }
     }
 
+    // The ingest is the source of stream, never queued by supervisor.
+    ffmpeg->set_task("ingest", vhost->arg0() + "/" + ingest->arg0(), false);
+
     srs_trace("parse success, ingest=%s, vhost=%s", ingest->arg0().c_str(), vhost->arg0().c_str());
 
     return err;
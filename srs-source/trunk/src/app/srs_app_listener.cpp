@@ -6,6 +6,7 @@
 
 #include <srs_app_listener.hpp>
 
+#include <algorithm>
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <netdb.h>
@@ -37,6 +38,11 @@ SrsPps *_srs_pps_spkts = NULL;
 // set the max packet size.
 #define SRS_UDP_MAX_PACKET_SIZE 65535
 
+// The max number of packets to receive by one recvmmsg.
+#define SRS_UDP_MAX_BATCH 64
+// The size of each slot for batch receiving, the MTU of ethernet.
+#define SRS_UDP_BATCH_SLOT_SIZE 1500
+
 // sleep in srs_utime_t for udp recv packet.
 #define SrsUdpPacketRecvCycleInterval 0
 
@@ -450,10 +456,10 @@ ISrsUdpMuxSocket::~ISrsUdpMuxSocket()
 {
 }
 
-SrsUdpMuxSocket::SrsUdpMuxSocket(srs_netfd_t fd)
+SrsUdpMuxSocket::SrsUdpMuxSocket(srs_netfd_t fd, int size)
 {
     nn_msgs_for_yield_ = 0;
-    nb_buf_ = SRS_UDP_MAX_PACKET_SIZE;
+    nb_buf_ = size > 0 ? size : SRS_UDP_MAX_PACKET_SIZE;
     buf_ = new char[nb_buf_];
     nread_ = 0;
 
@@ -475,8 +481,27 @@ SrsUdpMuxSocket::~SrsUdpMuxSocket()
 
 int SrsUdpMuxSocket::recvfrom(srs_utime_t timeout)
 {
-    fromlen_ = sizeof(from_);
-    nread_ = srs_recvfrom(lfd_, buf_, nb_buf_, (sockaddr *)&from_, &fromlen_, timeout);
+    int fromlen = sizeof(from_);
+    int nread = srs_recvfrom(lfd_, buf_, nb_buf_, (sockaddr *)&from_, &fromlen, timeout);
+    return on_recvfrom(nread, fromlen);
+}
+
+void SrsUdpMuxSocket::prepare(msghdr *msg, iovec *iov)
+{
+    iov->iov_base = buf_;
+    iov->iov_len = nb_buf_;
+
+    memset(msg, 0, sizeof(msghdr));
+    msg->msg_name = (sockaddr *)&from_;
+    msg->msg_namelen = sizeof(from_);
+    msg->msg_iov = iov;
+    msg->msg_iovlen = 1;
+}
+
+int SrsUdpMuxSocket::on_recvfrom(int nread, int fromlen)
+{
+    nread_ = nread;
+    fromlen_ = fromlen;
     if (nread_ <= 0) {
         return nread_;
     }
@@ -667,6 +692,9 @@ SrsUdpMuxListener::SrsUdpMuxListener(ISrsUdpMuxHandler *h, std::string i, int p)
     nb_buf_ = SRS_UDP_MAX_PACKET_SIZE;
     buf_ = new char[nb_buf_];
 
+    batch_ = 1;
+    nn_truncated_ = 0;
+
     trd_ = new SrsDummyCoroutine();
     cid_ = _srs_context->generate_id();
 
@@ -679,6 +707,11 @@ SrsUdpMuxListener::~SrsUdpMuxListener()
     srs_close_stfd(lfd_);
     srs_freepa(buf_);
 
+    for (int i = 0; i < (int)skts_.size(); i++) {
+        SrsUdpMuxSocket *skt = skts_.at(i);
+        srs_freep(skt);
+    }
+
     factory_ = NULL;
 }
 
@@ -692,6 +725,13 @@ srs_netfd_t SrsUdpMuxListener::stfd()
     return lfd_;
 }
 
+void SrsUdpMuxListener::set_recv_batch(int v)
+{
+#ifdef __linux__
+    batch_ = srs_max(1, srs_min(v, SRS_UDP_MAX_BATCH));
+#endif
+}
+
 srs_error_t SrsUdpMuxListener::listen()
 {
     srs_error_t err = srs_success;
@@ -753,6 +793,82 @@ void SrsUdpMuxListener::set_socket_buffer()
               srs_netfd_fileno(lfd_), ip_.c_str(), port_, default_sndbuf, expect_sndbuf, actual_sndbuf, r0_sndbuf, default_rcvbuf, expect_rcvbuf, actual_rcvbuf, r0_rcvbuf);
 }
 
+int SrsUdpMuxListener::recv_packets()
+{
+    pkts_.clear();
+
+    // Because we have to decrypt the cipher of received packet payload,
+    // and the size is not determined, so we think there is at least one copy,
+    // and we can reuse the plaintext h264/opus with players when got plaintext.
+    if (skts_.empty()) {
+        int size = batch_ > 1 ? SRS_UDP_BATCH_SLOT_SIZE : 0;
+        for (int i = 0; i < batch_; i++) {
+            skts_.push_back(new SrsUdpMuxSocket(lfd_, size));
+        }
+    }
+
+    if (batch_ > 1) {
+        return recv_batch();
+    }
+
+    SrsUdpMuxSocket *skt = skts_.at(0);
+    int nread = skt->recvfrom(SRS_UTIME_NO_TIMEOUT);
+    if (nread > 0) {
+        pkts_.push_back(skt);
+    }
+
+    return nread < 0 ? nread : (int)pkts_.size();
+}
+
+int SrsUdpMuxListener::recv_batch()
+{
+#ifdef __linux__
+    mmsghdr msgs[SRS_UDP_MAX_BATCH];
+    iovec iovs[SRS_UDP_MAX_BATCH];
+    for (int i = 0; i < batch_; i++) {
+        skts_.at(i)->prepare(&msgs[i].msg_hdr, &iovs[i]);
+        msgs[i].msg_len = 0;
+    }
+
+    int nn = srs_recvmmsg(lfd_, msgs, batch_, 0, SRS_UTIME_NO_TIMEOUT);
+    if (nn <= 0) {
+        return nn;
+    }
+
+    // Sort packets by client address and arrival order, so the packets of a session
+    // are handled back-to-back, while the order in each session is kept.
+    std::vector<std::pair<uint64_t, int> > keys;
+    for (int i = 0; i < nn; i++) {
+        mmsghdr &msg = msgs[i];
+        if ((msg.msg_hdr.msg_flags & MSG_TRUNC) != 0) {
+            nn_truncated_++;
+            continue;
+        }
+
+        SrsUdpMuxSocket *skt = skts_.at(i);
+        if (skt->on_recvfrom((int)msg.msg_len, (int)msg.msg_hdr.msg_namelen) <= 0) {
+            continue;
+        }
+
+        uint64_t key = 0;
+        sockaddr_in *addr = skt->peer_addr();
+        if (addr->sin_family == AF_INET) {
+            key = uint64_t(addr->sin_port) << 48 | uint64_t(addr->sin_addr.s_addr);
+        }
+        keys.push_back(std::make_pair(key, i));
+    }
+    std::sort(keys.begin(), keys.end());
+
+    for (int i = 0; i < (int)keys.size(); i++) {
+        pkts_.push_back(skts_.at(keys[i].second));
+    }
+
+    return (int)pkts_.size();
+#else
+    return -1;
+#endif
+}
+
 srs_error_t SrsUdpMuxListener::cycle()
 {
     srs_error_t err = srs_success;
@@ -763,18 +879,14 @@ srs_error_t SrsUdpMuxListener::cycle()
     uint64_t nn_msgs_stage = 0;
     uint64_t nn_msgs_last = 0;
     uint64_t nn_loop = 0;
+    uint64_t nn_batches_stage = 0;
+    int nn_batch_max = 0;
     srs_utime_t time_last = srs_time_now_cached();
 
     SrsUniquePtr<SrsErrorPithyPrint> pp_pkt_handler_err(new SrsErrorPithyPrint());
 
     set_socket_buffer();
 
-    // Because we have to decrypt the cipher of received packet payload,
-    // and the size is not determined, so we think there is at least one copy,
-    // and we can reuse the plaintext h264/opus with players when got plaintext.
-    SrsUniquePtr<SrsUdpMuxSocket> skt_ptr(new SrsUdpMuxSocket(lfd_));
-    ISrsUdpMuxSocket *skt = skt_ptr.get();
-
     // How many messages to run a yield.
     uint32_t nn_msgs_for_yield = 0;
 
@@ -785,33 +897,40 @@ srs_error_t SrsUdpMuxListener::cycle()
 
         nn_loop++;
 
-        int nread = skt->recvfrom(SRS_UTIME_NO_TIMEOUT);
-        if (nread <= 0) {
-            if (nread < 0) {
-                srs_warn("udp recv error nn=%d", nread);
+        int nn_pkts = recv_packets();
+        if (nn_pkts <= 0) {
+            if (nn_pkts < 0) {
+                srs_warn("udp recv error nn=%d", nn_pkts);
             }
             // remux udp never return
             continue;
         }
 
-        nn_msgs++;
-        nn_msgs_stage++;
+        nn_batches_stage++;
+        nn_batch_max = srs_max(nn_batch_max, nn_pkts);
+
+        for (int i = 0; i < nn_pkts; i++) {
+            ISrsUdpMuxSocket *skt = pkts_.at(i);
+
+            nn_msgs++;
+            nn_msgs_stage++;
 
-        // Handle the UDP packet.
-        err = handler_->on_udp_packet(skt);
+            // Handle the UDP packet.
+            err = handler_->on_udp_packet(skt);
 
-        // Use pithy print to show more smart information.
-        if (err != srs_success) {
-            uint32_t nn = 0;
-            if (pp_pkt_handler_err->can_print(err, &nn)) {
-                // For performance, only restore context when output log.
-                _srs_context->set_id(cid_);
+            // Use pithy print to show more smart information.
+            if (err != srs_success) {
+                uint32_t nn = 0;
+                if (pp_pkt_handler_err->can_print(err, &nn)) {
+                    // For performance, only restore context when output log.
+                    _srs_context->set_id(cid_);
 
-                // Append more information.
-                err = srs_error_wrap(err, "size=%u, data=[%s]", skt->size(), srs_strings_dumps_hex(skt->data(), skt->size(), 8).c_str());
-                srs_warn("handle udp pkt, count=%u/%u, err: %s", pp_pkt_handler_err->nn_count_, nn, srs_error_desc(err).c_str());
+                    // Append more information.
+                    err = srs_error_wrap(err, "size=%u, data=[%s]", skt->size(), srs_strings_dumps_hex(skt->data(), skt->size(), 8).c_str());
+                    srs_warn("handle udp pkt, count=%u/%u, err: %s", pp_pkt_handler_err->nn_count_, nn, srs_error_desc(err).c_str());
+                }
+                srs_freep(err);
             }
-            srs_freep(err);
         }
 
         pprint->elapse();
@@ -843,12 +962,18 @@ srs_error_t SrsUdpMuxListener::cycle()
                 pps_average /= 1000;
             }
 
-            srs_trace("<- RTC RECV #%d, udp %" PRId64 ", pps %d/%d%s, schedule %" PRId64,
-                      srs_netfd_fileno(lfd_), nn_msgs_stage, pps_average, pps_last, pps_unit.c_str(), nn_loop);
+            // The average and max number of packets received by one batch.
+            double batch_average = nn_batches_stage ? (double)nn_msgs_stage / nn_batches_stage : 0;
+
+            srs_trace("<- RTC RECV #%d, udp %" PRId64 ", pps %d/%d%s, schedule %" PRId64 ", batch %.1f/%d/%d, truncated %" PRId64,
+                      srs_netfd_fileno(lfd_), nn_msgs_stage, pps_average, pps_last, pps_unit.c_str(), nn_loop,
+                      batch_average, nn_batch_max, batch_, nn_truncated_);
             nn_msgs_last = nn_msgs;
             time_last = srs_time_now_cached();
             nn_loop = 0;
             nn_msgs_stage = 0;
+            nn_batches_stage = 0;
+            nn_batch_max = 0;
 
             // LCOV_EXCL_STOP
         }
@@ -859,7 +984,8 @@ srs_error_t SrsUdpMuxListener::cycle()
 
         // Yield to another coroutines.
         // @see https://github.com/ossrs/srs/issues/2194#issuecomment-777485531
-        if (++nn_msgs_for_yield > 10) {
+        nn_msgs_for_yield += nn_pkts;
+        if (nn_msgs_for_yield > 10) {
             nn_msgs_for_yield = 0;
             srs_thread_yield();
         }
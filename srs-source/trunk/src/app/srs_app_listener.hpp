@@ -267,11 +267,16 @@ SRS_DECLARE_PRIVATE: // clang-format on
     uint64_t fast_id_;
 
 public:
-    SrsUdpMuxSocket(srs_netfd_t fd);
+    // @param size The size of buffer, 0 for the max UDP packet size.
+    SrsUdpMuxSocket(srs_netfd_t fd, int size = 0);
     virtual ~SrsUdpMuxSocket();
 
 public:
     int recvfrom(srs_utime_t timeout);
+    // Setup the msghdr to receive a packet to this socket, for recvmmsg.
+    void prepare(msghdr *msg, iovec *iov);
+    // Parse the packet received by recvfrom or recvmmsg, return the size, or 0 to ignore it.
+    int on_recvfrom(int nread, int fromlen);
     srs_error_t sendto(void *data, int size, srs_utime_t timeout);
     srs_netfd_t stfd();
     sockaddr_in *peer_addr();
@@ -303,6 +308,17 @@ SRS_DECLARE_PRIVATE: // clang-format on
     char *buf_;
     int nb_buf_;
 
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The max number of packets to receive by one recvmmsg, 1 to use recvfrom.
+    int batch_;
+    // The sockets to receive packets to, each is a slot of batch.
+    std::vector<SrsUdpMuxSocket *> skts_;
+    // The received packets of current batch, grouped by client address.
+    std::vector<SrsUdpMuxSocket *> pkts_;
+    // The number of packets dropped because truncated by the slot size.
+    uint64_t nn_truncated_;
+
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
     ISrsUdpMuxHandler *handler_;
@@ -316,6 +332,8 @@ public:
 public:
     virtual int fd();
     virtual srs_netfd_t stfd();
+    // Set the max number of packets to receive by one recvmmsg, before listen.
+    virtual void set_recv_batch(int v);
 
 public:
     virtual srs_error_t listen();
@@ -326,6 +344,9 @@ public:
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
     void set_socket_buffer();
+    // Receive packets to pkts_, return the number of packets, or -1 for error.
+    int recv_packets();
+    int recv_batch();
 };
 
 #endif
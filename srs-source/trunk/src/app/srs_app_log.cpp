@@ -12,12 +12,14 @@
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 #include <srs_app_config.hpp>
 #include <srs_app_utility.hpp>
 #include <srs_kernel_error.hpp>
 #include <srs_kernel_utility.hpp>
+#include <srs_protocol_json.hpp>
 
 // the max size of a line of log.
 #define LOG_MAX_SIZE 8192
@@ -27,6 +29,20 @@
 // reserved for the end of log data, it must be strlen(LOG_TAIL)
 #define LOG_TAIL_SIZE 1
 
+// The window of limiter for each log statement.
+#define LOG_LIMIT_WINDOW (1 * SRS_UTIME_SECONDS)
+
+SrsLogLimiter::SrsLogLimiter()
+{
+    starttime_ = 0;
+    nn_logs_ = 0;
+    nn_suppressed_ = 0;
+}
+
+SrsLogLimiter::~SrsLogLimiter()
+{
+}
+
 SrsFileLog::SrsFileLog()
 {
     level_ = SrsLogLevelTrace;
@@ -35,10 +51,37 @@ SrsFileLog::SrsFileLog()
     fd_ = -1;
     log_to_file_tank_ = false;
     utc_ = false;
+
+    async_ = false;
+    cache_ = NULL;
+    head_ = 0;
+    nn_cache_ = 0;
+    timer_ = NULL;
+    limit_ = 0;
+
+    nn_lines_ = 0;
+    nn_bytes_ = 0;
+    nn_writes_ = 0;
+    nn_dropped_ = 0;
+    nn_suppressed_ = 0;
 }
 
 SrsFileLog::~SrsFileLog()
 {
+    if (timer_) {
+        timer_->unsubscribe(this);
+    }
+
+    // Never lose the buffered lines when quit.
+    flush();
+    srs_freepa(cache_);
+
+    std::map<const char *, SrsLogLimiter *>::iterator it;
+    for (it = limiters_.begin(); it != limiters_.end(); ++it) {
+        SrsLogLimiter *limiter = it->second;
+        srs_freep(limiter);
+    }
+
     srs_freepa(log_data_);
 
     if (fd_ > 0) {
@@ -63,6 +106,9 @@ srs_error_t SrsFileLog::initialize()
         std::string level = _srs_config->get_log_level();
         std::string level_v2 = _srs_config->get_log_level_v2();
         level_ = level_v2.empty() ? srs_get_log_level(level) : srs_get_log_level_v2(level_v2);
+
+        async_ = _srs_config->get_log_async();
+        limit_ = _srs_config->get_log_limit();
     }
 
     return srs_success;
@@ -70,6 +116,9 @@ srs_error_t SrsFileLog::initialize()
 
 void SrsFileLog::reopen()
 {
+    // Write the buffered lines to the old file, which is rotated.
+    flush();
+
     if (fd_ > 0) {
         ::close(fd_);
     }
@@ -87,6 +136,10 @@ void SrsFileLog::log(SrsLogLevel level, const char *tag, const SrsContextId &con
         return;
     }
 
+    if (limit_ > 0 && is_suppressed(level, tag, context_id, fmt)) {
+        return;
+    }
+
     int size = 0;
     bool header_ok = srs_log_header(
         log_data_, LOG_MAX_SIZE, utc_, level >= SrsLogLevelWarn, tag, context_id, srs_log_level_strings[level], &size);
@@ -115,6 +168,88 @@ void SrsFileLog::log(SrsLogLevel level, const char *tag, const SrsContextId &con
     write_log(fd_, log_data_, size, level);
 }
 
+void SrsFileLog::flush()
+{
+    while (nn_cache_ > 0 && fd_ > 0) {
+        // The lines might wrap around the end of ring.
+        iovec iovs[2];
+        int nn_iovs = 1;
+        iovs[0].iov_base = cache_ + head_;
+        iovs[0].iov_len = srs_min(nn_cache_, SRS_LOG_CACHE_SIZE - head_);
+        if ((int)iovs[0].iov_len < nn_cache_) {
+            iovs[1].iov_base = cache_;
+            iovs[1].iov_len = nn_cache_ - iovs[0].iov_len;
+            nn_iovs = 2;
+        }
+
+        ssize_t nn = ::writev(fd_, iovs, nn_iovs);
+        if (nn <= 0) {
+            return;
+        }
+        nn_writes_++;
+
+        head_ = (head_ + (int)nn) % SRS_LOG_CACHE_SIZE;
+        nn_cache_ -= (int)nn;
+    }
+
+    if (nn_cache_ == 0) {
+        head_ = 0;
+    }
+}
+
+void SrsFileLog::dumps(SrsJsonObject *obj)
+{
+    obj->set("async", SrsJsonAny::boolean(async_));
+    obj->set("lines", SrsJsonAny::integer(nn_lines_));
+    obj->set("bytes", SrsJsonAny::integer(nn_bytes_));
+    obj->set("writes", SrsJsonAny::integer(nn_writes_));
+    obj->set("dropped", SrsJsonAny::integer(nn_dropped_));
+    obj->set("suppressed", SrsJsonAny::integer(nn_suppressed_));
+}
+
+srs_error_t SrsFileLog::on_timer(srs_utime_t interval)
+{
+    flush();
+    return srs_success;
+}
+
+bool SrsFileLog::is_suppressed(SrsLogLevel level, const char *tag, const SrsContextId &context_id, const char *fmt)
+{
+    SrsLogLimiter *limiter = NULL;
+    std::map<const char *, SrsLogLimiter *>::iterator it = limiters_.find(fmt);
+    if (it != limiters_.end()) {
+        limiter = it->second;
+    } else {
+        limiter = limiters_[fmt] = new SrsLogLimiter();
+    }
+
+    srs_utime_t now = srs_time_now_cached();
+    if (now - limiter->starttime_ >= LOG_LIMIT_WINDOW) {
+        int nn_suppressed = limiter->nn_suppressed_;
+        limiter->starttime_ = now;
+        limiter->nn_logs_ = 0;
+        limiter->nn_suppressed_ = 0;
+
+        // Write the number of suppressed logs of last window, before the new log.
+        int size = 0;
+        if (nn_suppressed > 0 && srs_log_header(log_data_, LOG_MAX_SIZE, utc_, level >= SrsLogLevelWarn, tag, context_id, srs_log_level_strings[level], &size)) {
+            int r0 = snprintf(log_data_ + size, LOG_MAX_SIZE - size, "suppressed %d logs like: %s", nn_suppressed, fmt);
+            if (r0 > 0 && r0 < LOG_MAX_SIZE - size) {
+                write_log(fd_, log_data_, size + r0, level);
+            }
+        }
+    }
+
+    if (limiter->nn_logs_ < limit_) {
+        limiter->nn_logs_++;
+        return false;
+    }
+
+    limiter->nn_suppressed_++;
+    nn_suppressed_++;
+    return true;
+}
+
 void SrsFileLog::write_log(int &fd, char *str_log, int size, int level)
 {
     // ensure the tail and EOF of string
@@ -149,10 +284,58 @@ void SrsFileLog::write_log(int &fd, char *str_log, int size, int level)
         open_log_file();
     }
 
+    if (async_) {
+        write_cache(str_log, size);
+
+        // Write the error logs and the lines before immediately, because the process might abort.
+        if (level >= SrsLogLevelError) {
+            flush();
+        }
+        return;
+    }
+
     // write log to file.
     if (fd > 0) {
         ::write(fd, str_log, size);
+
+        nn_lines_++;
+        nn_bytes_ += size;
+        nn_writes_++;
+    }
+}
+
+void SrsFileLog::write_cache(char *str_log, int size)
+{
+    if (!cache_) {
+        cache_ = new char[SRS_LOG_CACHE_SIZE];
+    }
+
+    // Flush the cache by the shared timer, which is created after log.
+    if (!timer_ && _srs_shared_timer) {
+        timer_ = _srs_shared_timer->timer100ms();
+        timer_->subscribe(this);
+    }
+
+    // Make room for the line, drop it if the file is not writable.
+    if (nn_cache_ + size > SRS_LOG_CACHE_SIZE) {
+        flush();
+    }
+    if (nn_cache_ + size > SRS_LOG_CACHE_SIZE) {
+        nn_dropped_++;
+        return;
+    }
+
+    // Copy the line to the ring, might wrap around the end.
+    int tail = (head_ + nn_cache_) % SRS_LOG_CACHE_SIZE;
+    int nn = srs_min(size, SRS_LOG_CACHE_SIZE - tail);
+    memcpy(cache_ + tail, str_log, nn);
+    if (nn < size) {
+        memcpy(cache_, str_log + nn, size - nn);
     }
+    nn_cache_ += size;
+
+    nn_lines_++;
+    nn_bytes_ += size;
 }
 
 void SrsFileLog::open_log_file()
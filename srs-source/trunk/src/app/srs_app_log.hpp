@@ -10,15 +10,42 @@
 #include <srs_core.hpp>
 
 #include <string.h>
+#include <map>
 #include <string>
 
 #include <srs_app_reload.hpp>
+#include <srs_kernel_hourglass.hpp>
 #include <srs_protocol_log.hpp>
 
+// The size of ring to buffer lines for async log, flushed by timer or when full.
+#define SRS_LOG_CACHE_SIZE (256 * 1024)
+
+class ISrsFastTimer;
+class SrsJsonObject;
+
+// The counter of a log statement, to limit the logs per second.
+class SrsLogLimiter
+{
+public:
+    // The start time of current window.
+    srs_utime_t starttime_;
+    // The number of logs in current window.
+    int nn_logs_;
+    // The number of suppressed logs in current window.
+    int nn_suppressed_;
+
+public:
+    SrsLogLimiter();
+    virtual ~SrsLogLimiter();
+};
+
 // Use memory/disk cache and donot flush when write log.
 // it's ok to use it without config, which will log to console, and default trace level.
 // when you want to use different level, override this classs, set the protected _level.
-class SrsFileLog : public ISrsLog, public ISrsReloadHandler
+// When srs_log_async is on, the lines are buffered in a ring and flushed by the 100ms timer in
+// batch by one writev, for fewer syscalls. Note that the writev still blocks, so a slow disk
+// still blocks the flush.
+class SrsFileLog : public ISrsLog, public ISrsReloadHandler, public ISrsFastTimerHandler
 {
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
@@ -35,6 +62,32 @@ SRS_DECLARE_PRIVATE: // clang-format on
     // Whether use utc time.
     bool utc_;
 
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Whether write log to file in batch.
+    bool async_;
+    // The ring of buffered lines, write at (head_ + nn_cache_), flush from head_.
+    char *cache_;
+    int head_;
+    int nn_cache_;
+    // The timer to flush the cache, subscribed when buffer the first line.
+    ISrsFastTimer *timer_;
+    // The max logs per second for each log statement, 0 for no limit.
+    int limit_;
+    // The limiters, key is the address of fmt of log statement, which is a string literal. Note
+    // that the statements with the same fmt might share one literal, so share one limiter, and
+    // the fmt should never be a dynamic buffer, or each log gets a new limiter.
+    std::map<const char *, SrsLogLimiter *> limiters_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The stat of log, @see srs_api_dump_summaries
+    int64_t nn_lines_;
+    int64_t nn_bytes_;
+    int64_t nn_writes_;
+    int64_t nn_dropped_;
+    int64_t nn_suppressed_;
+
 public:
     SrsFileLog();
     virtual ~SrsFileLog();
@@ -42,11 +95,25 @@ public:
 public:
     virtual srs_error_t initialize();
     virtual void reopen();
+    // Write the buffered lines to file.
+    virtual void flush();
     virtual void log(SrsLogLevel level, const char *tag, const SrsContextId &context_id, const char *fmt, va_list args);
 
+public:
+    // Dumps the stat of log to json, @see srs_api_dump_summaries
+    virtual void dumps(SrsJsonObject *obj);
+    // Interface ISrsFastTimerHandler
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    virtual srs_error_t on_timer(srs_utime_t interval);
+
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
+    // Whether the log statement exceeds the limit, and write the number of suppressed logs when
+    // the window of limiter is expired.
+    virtual bool is_suppressed(SrsLogLevel level, const char *tag, const SrsContextId &context_id, const char *fmt);
     virtual void write_log(int &fd, char *str_log, int size, int level);
+    virtual void write_cache(char *str_log, int size);
     virtual void open_log_file();
 };
 
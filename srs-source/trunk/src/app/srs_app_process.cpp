@@ -6,9 +6,11 @@
 
 #include <srs_app_process.hpp>
 
+#include <algorithm>
 #include <fcntl.h>
 #include <signal.h>
 #include <stdlib.h>
+#include <sys/resource.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -25,6 +27,7 @@ using namespace std;
 #include <srs_kernel_error.hpp>
 #include <srs_kernel_log.hpp>
 #include <srs_kernel_utility.hpp>
+#include <srs_protocol_json.hpp>
 #include <srs_protocol_utility.hpp>
 
 ISrsProcess::ISrsProcess()
@@ -40,6 +43,7 @@ SrsProcess::SrsProcess()
     is_started_ = false;
     fast_stopped_ = false;
     pid_ = -1;
+    nice_ = 0;
 }
 
 SrsProcess::~SrsProcess()
@@ -135,6 +139,12 @@ srs_error_t SrsProcess::initialize(string binary, vector<string> argv)
     return err;
 }
 
+void SrsProcess::set_limits(string cpus, int nice)
+{
+    cpus_ = cpus;
+    nice_ = nice;
+}
+
 // LCOV_EXCL_START
 srs_error_t srs_redirect_output(string from_file, int to_fd)
 {
@@ -225,6 +235,15 @@ srs_error_t SrsProcess::start()
             exit(-1);
         }
 
+        // Apply the limits before exec, so all threads of process inherit them.
+        if (nice_ != 0 && setpriority(PRIO_PROCESS, 0, nice_) < 0) {
+            fprintf(stdout, "process set nice=%d failed, errno=%d(%s)\n", nice_, errno, strerror(errno));
+        }
+        if ((err = srs_set_cpu_affinity(0, cpus_)) != srs_success) {
+            fprintf(stdout, "process set cpus=%s failed, %s\n", cpus_.c_str(), srs_error_desc(err).c_str());
+            srs_freep(err);
+        }
+
         // should never close the fd 3+, for it myabe used.
         // for fd should close at exec, use fnctl to set it.
 
@@ -372,3 +391,283 @@ void SrsProcess::fast_kill()
 }
 // LCOV_EXCL_STOP
 
+
+SrsProcessTask::SrsProcessTask(string kind, string uri, bool low_priority)
+{
+    kind_ = kind;
+    uri_ = uri;
+    low_priority_ = low_priority;
+
+    pid_ = -1;
+    starttime_ = 0;
+    queued_ = false;
+    restarts_ = 0;
+    backoff_ = 0;
+    next_start_ = 0;
+
+    cpu_percent_ = 0;
+    rss_kb_ = 0;
+    ticks_ = 0;
+    sample_time_ = 0;
+}
+
+SrsProcessTask::~SrsProcessTask()
+{
+}
+
+void SrsProcessTask::dumps(SrsJsonObject *obj)
+{
+    srs_utime_t alive = (pid_ > 0) ? srs_time_now_cached() - starttime_ : 0;
+
+    obj->set("kind", SrsJsonAny::str(kind_.c_str()));
+    obj->set("uri", SrsJsonAny::str(uri_.c_str()));
+    obj->set("pid", SrsJsonAny::integer(pid_));
+    obj->set("alive_ms", SrsJsonAny::integer(srsu2msi(alive)));
+    obj->set("queued", SrsJsonAny::boolean(queued_));
+    obj->set("restarts", SrsJsonAny::integer(restarts_));
+    obj->set("backoff_ms", SrsJsonAny::integer(srsu2msi(backoff_)));
+    obj->set("cpu", SrsJsonAny::number(cpu_percent_ * 100));
+    obj->set("rss_kb", SrsJsonAny::integer(rss_kb_));
+}
+
+ISrsProcessSupervisor::ISrsProcessSupervisor()
+{
+}
+
+ISrsProcessSupervisor::~ISrsProcessSupervisor()
+{
+}
+
+SrsProcessSupervisor *_srs_process_supervisor = NULL;
+
+SrsProcessSupervisor::SrsProcessSupervisor()
+{
+    config_ = _srs_config;
+
+    last_sample_ = 0;
+    last_dequeue_ = 0;
+    user_hz_ = (int)sysconf(_SC_CLK_TCK);
+    page_kb_ = (int)(sysconf(_SC_PAGESIZE) / 1024);
+}
+
+SrsProcessSupervisor::~SrsProcessSupervisor()
+{
+    // The tasks are owned by the FFmpeg.
+    tasks_.clear();
+
+    config_ = NULL;
+}
+
+// LCOV_EXCL_START
+srs_error_t SrsProcessSupervisor::initialize()
+{
+    srs_error_t err = srs_success;
+
+    if (!config_->get_supervisor_enabled()) {
+        return err;
+    }
+
+    string cpus = config_->get_supervisor_srs_cpus();
+    if ((err = srs_set_cpu_affinity(0, cpus)) != srs_success) {
+        return srs_error_wrap(err, "pin srs");
+    }
+
+    srs_trace("supervisor: srs cpus=%s, ffmpeg cpus=%s, nice=%d, threshold=%d%%, backoff_max=%dms",
+              cpus.c_str(), config_->get_supervisor_ffmpeg_cpus().c_str(), config_->get_supervisor_ffmpeg_nice(),
+              config_->get_supervisor_threshold(), srsu2msi(config_->get_supervisor_backoff_max()));
+
+    return err;
+}
+// LCOV_EXCL_STOP
+
+void SrsProcessSupervisor::attach(SrsProcessTask *task)
+{
+    vector<SrsProcessTask *>::iterator it = std::find(tasks_.begin(), tasks_.end(), task);
+    if (it == tasks_.end()) {
+        tasks_.push_back(task);
+    }
+}
+
+void SrsProcessSupervisor::detach(SrsProcessTask *task)
+{
+    vector<SrsProcessTask *>::iterator it = std::find(tasks_.begin(), tasks_.end(), task);
+    if (it != tasks_.end()) {
+        tasks_.erase(it);
+    }
+}
+
+bool SrsProcessSupervisor::can_start(SrsProcessTask *task)
+{
+    if (!config_->get_supervisor_enabled()) {
+        task->queued_ = false;
+        return true;
+    }
+
+    srs_utime_t now = srs_time_now_cached();
+    if (now < task->next_start_) {
+        return false;
+    }
+
+    if (!task->low_priority_) {
+        return true;
+    }
+
+    if (saturated()) {
+        if (!task->queued_) {
+            srs_warn("supervisor: queue %s %s, host cpu=%.1f%%", task->kind_.c_str(), task->uri_.c_str(),
+                     srs_get_system_proc_stat()->percent_ * 100);
+        }
+        task->queued_ = true;
+        return false;
+    }
+
+    // Start the queued tasks one by one, to sample the cpu of host again before next one.
+    if (task->queued_) {
+        if (now - last_dequeue_ < SRS_SUPERVISOR_SAMPLE_INTERVAL) {
+            return false;
+        }
+
+        last_dequeue_ = now;
+        task->queued_ = false;
+        srs_trace("supervisor: dequeue %s %s, host cpu=%.1f%%", task->kind_.c_str(), task->uri_.c_str(),
+                  srs_get_system_proc_stat()->percent_ * 100);
+    }
+
+    return true;
+}
+
+void SrsProcessSupervisor::limit(ISrsProcess *process)
+{
+    if (!config_->get_supervisor_enabled()) {
+        return;
+    }
+
+    string cpus = config_->get_supervisor_ffmpeg_cpus();
+
+    // The process inherits the affinity of SRS, so use all cpus if SRS is pinned.
+    if (cpus.empty() && !config_->get_supervisor_srs_cpus().empty()) {
+        int nn_cpus = (int)sysconf(_SC_NPROCESSORS_CONF);
+        cpus = "0-" + srs_strconv_format_int(srs_max(1, nn_cpus) - 1);
+    }
+
+    process->set_limits(cpus, config_->get_supervisor_ffmpeg_nice());
+}
+
+void SrsProcessSupervisor::on_start(SrsProcessTask *task, int pid)
+{
+    task->pid_ = pid;
+    task->starttime_ = srs_time_now_cached();
+    task->queued_ = false;
+
+    task->cpu_percent_ = 0;
+    task->rss_kb_ = 0;
+    task->ticks_ = 0;
+    task->sample_time_ = 0;
+}
+
+void SrsProcessSupervisor::on_stop(SrsProcessTask *task, bool terminated)
+{
+    if (task->pid_ <= 0) {
+        return;
+    }
+
+    srs_utime_t now = srs_time_now_cached();
+    srs_utime_t alive = now - task->starttime_;
+
+    task->pid_ = -1;
+    task->cpu_percent_ = 0;
+    task->rss_kb_ = 0;
+
+    if (!terminated) {
+        return;
+    }
+
+    task->restarts_++;
+
+    if (!config_->get_supervisor_enabled()) {
+        return;
+    }
+
+    // Reset the backoff if process runs stable, or double it for crashing again.
+    srs_utime_t backoff_max = srs_max(SRS_SUPERVISOR_BACKOFF_MIN, config_->get_supervisor_backoff_max());
+    if (!task->backoff_ || alive >= SRS_SUPERVISOR_STABLE) {
+        task->backoff_ = SRS_SUPERVISOR_BACKOFF_MIN;
+    } else {
+        task->backoff_ = srs_min(backoff_max, task->backoff_ * 2);
+    }
+    task->next_start_ = now + task->backoff_;
+
+    srs_warn("supervisor: %s %s terminated, alive=%dms, restarts=%d, backoff=%dms", task->kind_.c_str(),
+             task->uri_.c_str(), srsu2msi(alive), task->restarts_, srsu2msi(task->backoff_));
+}
+
+void SrsProcessSupervisor::sample()
+{
+    srs_utime_t now = srs_time_now_cached();
+    if (last_sample_ && now - last_sample_ < SRS_SUPERVISOR_SAMPLE_INTERVAL) {
+        return;
+    }
+    last_sample_ = now;
+
+    for (int i = 0; i < (int)tasks_.size(); i++) {
+        SrsProcessTask *task = tasks_.at(i);
+        if (task->pid_ <= 0) {
+            continue;
+        }
+
+        SrsProcSelfStat r;
+        if (!get_proc_stat(task->pid_, r)) {
+            continue;
+        }
+
+        // The usage of one core, see srs_update_proc_stat.
+        int64_t ticks = (int64_t)(r.utime_ + r.stime_);
+        if (task->sample_time_ > 0 && now > task->sample_time_ && user_hz_ > 0) {
+            double elapsed = (now - task->sample_time_) / (double)SRS_UTIME_SECONDS;
+            task->cpu_percent_ = (float)((ticks - task->ticks_) / (double)user_hz_ / elapsed);
+        }
+
+        task->ticks_ = ticks;
+        task->sample_time_ = now;
+        task->rss_kb_ = (int64_t)r.rss_ * page_kb_;
+    }
+}
+
+void SrsProcessSupervisor::dumps(SrsJsonObject *obj)
+{
+    sample();
+
+    SrsProcSystemStat *s = srs_get_system_proc_stat();
+    obj->set("enabled", SrsJsonAny::boolean(config_->get_supervisor_enabled()));
+    obj->set("cpu", SrsJsonAny::number(s->percent_ * 100));
+    obj->set("saturated", SrsJsonAny::boolean(saturated()));
+
+    SrsJsonArray *arr = SrsJsonAny::array();
+    obj->set("tasks", arr);
+
+    float cpu = 0;
+    int64_t rss_kb = 0;
+    for (int i = 0; i < (int)tasks_.size(); i++) {
+        SrsProcessTask *task = tasks_.at(i);
+        cpu += task->cpu_percent_;
+        rss_kb += task->rss_kb_;
+
+        SrsJsonObject *item = SrsJsonAny::object();
+        arr->append(item);
+        task->dumps(item);
+    }
+
+    obj->set("tasks_cpu", SrsJsonAny::number(cpu * 100));
+    obj->set("tasks_rss_kb", SrsJsonAny::integer(rss_kb));
+}
+
+bool SrsProcessSupervisor::saturated()
+{
+    int threshold = config_->get_supervisor_threshold();
+    if (threshold <= 0) {
+        return false;
+    }
+
+    SrsProcSystemStat *s = srs_get_system_proc_stat();
+    return s->ok_ && s->percent_ * 100 >= threshold;
+}
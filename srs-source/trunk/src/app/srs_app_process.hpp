@@ -12,6 +12,10 @@
 #include <string>
 #include <vector>
 
+class ISrsAppConfig;
+class SrsJsonArray;
+class SrsJsonObject;
+
 // The process interface.
 class ISrsProcess
 {
@@ -26,6 +30,8 @@ public:
     virtual bool started() = 0;
     // Initialize the process with binary and argv.
     virtual srs_error_t initialize(std::string binary, std::vector<std::string> argv) = 0;
+    // Set the cpus and nice to apply in child process, before exec.
+    virtual void set_limits(std::string cpus, int nice) = 0;
 
 public:
     // Start the process, ignore when already started.
@@ -73,6 +79,9 @@ SRS_DECLARE_PRIVATE: // clang-format on
     // The cli to fork process.
     std::string cli_;
     std::string actual_cli_;
+    // The limits applied in child process, see SrsProcessSupervisor.
+    std::string cpus_;
+    int nice_;
 
 public:
     SrsProcess();
@@ -88,6 +97,9 @@ public:
     // @param argv the argv for binary path, the argv[0] generally is the binary.
     // @remark the argv[0] must be the binary.
     virtual srs_error_t initialize(std::string binary, std::vector<std::string> argv);
+    // Set the cpus and nice to apply in child process, before exec, so all threads of the process
+    // inherit them. Empty cpus or zero nice to ignore.
+    virtual void set_limits(std::string cpus, int nice);
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
@@ -120,4 +132,118 @@ public:
     virtual void fast_kill();
 };
 
+// The interval to sample the cpu and memory of supervised processes.
+#define SRS_SUPERVISOR_SAMPLE_INTERVAL (3 * SRS_UTIME_SECONDS)
+// The first backoff to restart the crashed process, doubled for each crash.
+#define SRS_SUPERVISOR_BACKOFF_MIN (1 * SRS_UTIME_SECONDS)
+// The process is stable when alive longer than it, then the backoff is reset.
+#define SRS_SUPERVISOR_STABLE (60 * SRS_UTIME_SECONDS)
+
+// A supervised process, for example, the FFmpeg of ingest or transcode.
+class SrsProcessTask
+{
+public:
+    // The kind of task, ingest or transcode.
+    std::string kind_;
+    // The task id, for ingest it's [vhost]/[ingest id], for transcode it's the output.
+    std::string uri_;
+    // Whether queue the task when host is saturated, for example, the transcode.
+    bool low_priority_;
+
+public:
+    // The pid of process, -1 if not started.
+    int pid_;
+    srs_utime_t starttime_;
+    // Whether the task is queued to start, for host is saturated.
+    bool queued_;
+    // The number of restarts, when process terminated unexpectedly.
+    int restarts_;
+    // The backoff to restart, doubled for each crash and reset when stable.
+    srs_utime_t backoff_;
+    // Never restart the process before this time.
+    srs_utime_t next_start_;
+
+public:
+    // The cpu usage of process, 0.153 is 15.3% of one core.
+    float cpu_percent_;
+    // The RSS memory in KB.
+    int64_t rss_kb_;
+    // The utime and stime in USER_HZ, and the time of last sample.
+    int64_t ticks_;
+    srs_utime_t sample_time_;
+
+public:
+    SrsProcessTask(std::string kind, std::string uri, bool low_priority);
+    virtual ~SrsProcessTask();
+
+public:
+    virtual void dumps(SrsJsonObject *obj);
+};
+
+// The supervisor interface.
+class ISrsProcessSupervisor
+{
+public:
+    ISrsProcessSupervisor();
+    virtual ~ISrsProcessSupervisor();
+
+public:
+    virtual void attach(SrsProcessTask *task) = 0;
+    virtual void detach(SrsProcessTask *task) = 0;
+    // Whether the task is allowed to start now, false if in backoff or queued.
+    virtual bool can_start(SrsProcessTask *task) = 0;
+    // Set the cpus and nice of process, before start it.
+    virtual void limit(ISrsProcess *process) = 0;
+    virtual void on_start(SrsProcessTask *task, int pid) = 0;
+    // When process stopped, the terminated is true if it exits unexpectedly.
+    virtual void on_stop(SrsProcessTask *task, bool terminated) = 0;
+    // Sample the cpu and memory of all tasks, ignore if sampled recently.
+    virtual void sample() = 0;
+};
+
+// The supervisor of FFmpeg processes, which samples the cpu and RSS of each process from /proc,
+// pins SRS and FFmpeg to separate cpus, renices FFmpeg, queues the low priority transcodes when
+// host is saturated, and restarts the crashed process with exponential backoff.
+// @remark The scheduling is applied only when enabled, while the metrics are always sampled.
+class SrsProcessSupervisor : public ISrsProcessSupervisor
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsAppConfig *config_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    std::vector<SrsProcessTask *> tasks_;
+    srs_utime_t last_sample_;
+    // The time of last queued task to start, to start queued tasks one by one.
+    srs_utime_t last_dequeue_;
+    int user_hz_;
+    int page_kb_;
+
+public:
+    SrsProcessSupervisor();
+    virtual ~SrsProcessSupervisor();
+
+public:
+    // Pin SRS itself to the cpus, for server starting.
+    virtual srs_error_t initialize();
+
+public:
+    virtual void attach(SrsProcessTask *task);
+    virtual void detach(SrsProcessTask *task);
+    virtual bool can_start(SrsProcessTask *task);
+    virtual void limit(ISrsProcess *process);
+    virtual void on_start(SrsProcessTask *task, int pid);
+    virtual void on_stop(SrsProcessTask *task, bool terminated);
+    virtual void sample();
+    virtual void dumps(SrsJsonObject *obj);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Whether the CPU usage of host exceeds the threshold.
+    virtual bool saturated();
+};
+
+extern SrsProcessSupervisor *_srs_process_supervisor;
+
 #endif
@@ -6,9 +6,17 @@
 
 #include <srs_app_rtc_codec.hpp>
 
+#include <srs_app_config.hpp>
 #include <srs_kernel_codec.hpp>
 #include <srs_kernel_error.hpp>
 #include <srs_kernel_log.hpp>
+#include <srs_kernel_utility.hpp>
+
+#include <sstream>
+using namespace std;
+
+// The interval to retry to acquire a slot, for transcoder without slot.
+#define SRS_AUDIO_TRANSCODER_RETRY (1 * SRS_UTIME_SECONDS)
 
 static const AVCodec *srs_find_decoder_by_id(SrsAudioCodecId id)
 {
@@ -102,8 +110,95 @@ ISrsAudioTranscoder::~ISrsAudioTranscoder()
 {
 }
 
+SrsAudioTranscoderPool *_srs_audio_transcoders = NULL;
+
+SrsAudioTranscoderPool::SrsAudioTranscoderPool()
+{
+    config_ = _srs_config;
+    nn_active_ = 0;
+    nn_jobs_ = 0;
+    nn_overflows_ = 0;
+    nn_drops_ = 0;
+    total_cost_ = 0;
+    max_cost_ = 0;
+}
+
+SrsAudioTranscoderPool::~SrsAudioTranscoderPool()
+{
+    config_ = NULL;
+}
+
+bool SrsAudioTranscoderPool::acquire()
+{
+    // Zero means no limit, read it every time to support reload.
+    int max = config_->get_rtc_server_audio_transcoders();
+    if (max > 0 && nn_active_ >= max) {
+        return false;
+    }
+
+    nn_active_++;
+    return true;
+}
+
+void SrsAudioTranscoderPool::release()
+{
+    if (nn_active_ > 0) {
+        nn_active_--;
+    }
+}
+
+void SrsAudioTranscoderPool::on_transcoded(srs_utime_t cost)
+{
+    nn_jobs_++;
+    total_cost_ += cost;
+    max_cost_ = srs_max(max_cost_, cost);
+}
+
+bool SrsAudioTranscoderPool::drop_overflow()
+{
+    return config_->get_rtc_server_audio_transcoders_drop();
+}
+
+void SrsAudioTranscoderPool::on_overflow()
+{
+    nn_overflows_++;
+}
+
+void SrsAudioTranscoderPool::on_dropped()
+{
+    nn_drops_++;
+}
+
+int SrsAudioTranscoderPool::nn_active()
+{
+    return nn_active_;
+}
+
+string SrsAudioTranscoderPool::dumps()
+{
+    if (!nn_active_ && !nn_jobs_ && !nn_overflows_ && !nn_drops_) {
+        return "";
+    }
+
+    srs_utime_t avg = nn_jobs_ ? total_cost_ / nn_jobs_ : 0;
+
+    stringstream ss;
+    ss << ", trans=(n:" << nn_active_ << ",j:" << nn_jobs_ << ",o:" << nn_overflows_ << ",d:" << nn_drops_
+       << ",a:" << int(avg) << "us,m:" << int(max_cost_) << "us)";
+
+    nn_jobs_ = nn_overflows_ = nn_drops_ = 0;
+    total_cost_ = max_cost_ = 0;
+
+    return ss.str();
+}
+
 SrsAudioTranscoder::SrsAudioTranscoder()
 {
+    pool_ = _srs_audio_transcoders;
+    acquired_ = false;
+    last_acquire_ = 0;
+    nn_dropped_ = 0;
+
     dec_ = NULL;
     dec_frame_ = NULL;
     dec_packet_ = NULL;
@@ -153,12 +248,21 @@ SrsAudioTranscoder::~SrsAudioTranscoder()
         av_audio_fifo_free(fifo_);
         fifo_ = NULL;
     }
+
+    if (acquired_) {
+        pool_->release();
+    }
 }
 
 srs_error_t SrsAudioTranscoder::initialize(SrsAudioCodecId src_codec, SrsAudioCodecId dst_codec, int dst_channels, int dst_samplerate, int dst_bit_rate)
 {
     srs_error_t err = srs_success;
 
+    // Still initialize the codec without slot, for the AAC sequence header.
+    if (!acquired_ && pool_ && !try_acquire()) {
+        srs_warn("transcode: exceed %d transcoders, drop=%d, codec %d to %d", pool_->nn_active(), pool_->drop_overflow(), src_codec, dst_codec);
+    }
+
     if ((err = init_dec(src_codec)) != srs_success) {
         return srs_error_wrap(err, "dec init codec:%d", src_codec);
     }
@@ -179,6 +283,19 @@ srs_error_t SrsAudioTranscoder::transcode(SrsParsedAudioPacket *in_pkt, std::vec
 {
     srs_error_t err = srs_success;
 
+    // Retry to acquire the slot released by other transcoders, if no slot, drop the frame if
+    // configured, otherwise fallback to transcode it inline.
+    if (pool_ && !acquired_ && !try_acquire()) {
+        if (pool_->drop_overflow()) {
+            pool_->on_dropped();
+            nn_dropped_++;
+            return err;
+        }
+        pool_->on_overflow();
+    }
+
+    srs_utime_t starttime = srs_time_now_realtime();
+
     if ((err = decode_and_resample(in_pkt)) != srs_success) {
         return srs_error_wrap(err, "decode and resample");
     }
@@ -187,9 +304,30 @@ srs_error_t SrsAudioTranscoder::transcode(SrsParsedAudioPacket *in_pkt, std::vec
         return srs_error_wrap(err, "encode");
     }
 
+    if (pool_) {
+        pool_->on_transcoded(srs_time_now_realtime() - starttime);
+    }
+
     return err;
 }
 
+bool SrsAudioTranscoder::try_acquire()
+{
+    // Retry at most once per interval, because the slot is seldom released.
+    srs_utime_t now = srs_time_now_cached();
+    if (last_acquire_ && now - last_acquire_ < SRS_AUDIO_TRANSCODER_RETRY) {
+        return false;
+    }
+    last_acquire_ = now;
+
+    if ((acquired_ = pool_->acquire()) == true && nn_dropped_) {
+        srs_trace("transcode: got slot of %d transcoders, dropped=%" PRId64, pool_->nn_active(), nn_dropped_);
+        nn_dropped_ = 0;
+    }
+
+    return acquired_;
+}
+
 void SrsAudioTranscoder::free_frames(std::vector<SrsParsedAudioPacket *> &frames)
 {
     for (std::vector<SrsParsedAudioPacket *>::iterator it = frames.begin(); it != frames.end(); ++it) {
@@ -31,6 +31,8 @@ extern "C" {
 }
 #endif
 
+class ISrsAppConfig;
+
 // Register FFmpeg log callback funciton.
 class SrsFFmpegLogHelper
 {
@@ -71,11 +73,63 @@ public:
     virtual void aac_codec_header(uint8_t **data, int *len) = 0;
 };
 
+// The shared pool of audio transcoders for all bridged sources, which caps the number of
+// concurrent FFmpeg transcoders by rtc_server.audio_transcoders, and samples the cost of
+// each transcode job for the pithy print.
+class SrsAudioTranscoderPool
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsAppConfig *config_;
+    // The number of transcoders which hold a slot.
+    int nn_active_;
+    // The stat of jobs since last dumps.
+    int64_t nn_jobs_;
+    int64_t nn_overflows_;
+    int64_t nn_drops_;
+    srs_utime_t total_cost_;
+    srs_utime_t max_cost_;
+
+public:
+    SrsAudioTranscoderPool();
+    virtual ~SrsAudioTranscoderPool();
+
+public:
+    // Acquire a slot for a transcoder, return false if exceed the max number of transcoders.
+    bool acquire();
+    // Release the slot of a transcoder.
+    void release();
+    // Sample a transcode job which costs the time.
+    void on_transcoded(srs_utime_t cost);
+    // Whether drop the jobs of transcoder without slot, see rtc_server.audio_transcoders_drop.
+    bool drop_overflow();
+    // Sample a job transcoded inline by the transcoder without slot.
+    void on_overflow();
+    // Sample a job dropped because the transcoder has no slot.
+    void on_dropped();
+    int nn_active();
+    // Dump the stat of jobs and reset it, for example, ", trans=(n:2,j:100,o:0,d:0,a:120us,m:800us)".
+    // Return empty string if no transcoder.
+    std::string dumps();
+};
+
+extern SrsAudioTranscoderPool *_srs_audio_transcoders;
+
 // The audio transcoder, transcode audio from one codec to another.
 class SrsAudioTranscoder : public ISrsAudioTranscoder
 {
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
+    // The pool to acquire slot from, and whether we got a slot. If no slot, the transcoder
+    // still transcodes inline, or drops the audio frames if configured, to protect other
+    // streams from the CPU cost of FFmpeg.
+    SrsAudioTranscoderPool *pool_;
+    bool acquired_;
+    // The last time to acquire slot, to retry at most once per interval when no slot.
+    srs_utime_t last_acquire_;
+    // The number of frames dropped since last acquire.
+    int64_t nn_dropped_;
+
     AVCodecContext *dec_;
     AVFrame *dec_frame_;
     AVPacket *dec_packet_;
@@ -119,6 +173,9 @@ SRS_DECLARE_PRIVATE: // clang-format on
     srs_error_t init_swr(AVCodecContext *decoder);
     srs_error_t init_fifo();
 
+    // Try to acquire a slot from pool, return whether got a slot.
+    bool try_acquire();
+
     srs_error_t decode_and_resample(SrsParsedAudioPacket *pkt);
     srs_error_t encode(std::vector<SrsParsedAudioPacket *> &pkts);
 
@@ -553,17 +553,22 @@ srs_error_t SrsRtcPlayStream::initialize(ISrsRequest *req, std::map<uint32_t, Sr
     // TODO: FIXME: Support reload.
     nack_enabled_ = config_->get_rtc_nack_enabled(req->vhost_);
     nack_no_copy_ = config_->get_rtc_nack_no_copy(req->vhost_);
-    srs_trace("RTC player nack=%d, nnc=%d", nack_enabled_, nack_no_copy_);
+    srs_trace("RTC player nack=%d, nnc=%d, cache=%d", nack_enabled_, nack_no_copy_, source_->nack_cache() != NULL);
+
+    // Answer NACK from the shared cache of source if enabled.
+    SrsRtpNackCache *nack_cache = nack_enabled_ ? source_->nack_cache() : NULL;
 
     // Setup tracks.
     for (map<uint32_t, SrsRtcAudioSendTrack *>::iterator it = audio_tracks_.begin(); it != audio_tracks_.end(); ++it) {
         SrsRtcAudioSendTrack *track = it->second;
         track->set_nack_no_copy(nack_no_copy_);
+        track->set_nack_cache(nack_cache);
     }
 
     for (map<uint32_t, SrsRtcVideoSendTrack *>::iterator it = video_tracks_.begin(); it != video_tracks_.end(); ++it) {
         SrsRtcVideoSendTrack *track = it->second;
         track->set_nack_no_copy(nack_no_copy_);
+        track->set_nack_cache(nack_cache);
     }
 
     return err;
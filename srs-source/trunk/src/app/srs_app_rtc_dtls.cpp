@@ -210,6 +210,11 @@ SrsDtlsCertificate::SrsDtlsCertificate()
 // LCOV_EXCL_START
 SrsDtlsCertificate::~SrsDtlsCertificate()
 {
+    // The sessions hold the reference of context, so it's safe to free it.
+    for (std::map<int, SSL_CTX *>::iterator it = dtls_ctxs_.begin(); it != dtls_ctxs_.end(); ++it) {
+        SSL_CTX_free(it->second);
+    }
+
     if (eckey_) {
         EC_KEY_free(eckey_);
     }
@@ -396,6 +401,73 @@ bool SrsDtlsCertificate::is_ecdsa()
     return ecdsa_mode_;
 }
 
+SSL_CTX *SrsDtlsCertificate::get_dtls_ctx(SrsDtlsVersion version, std::string role)
+{
+    // The key of context, the version is -1, 0 or 1, and the role is active or not.
+    int key = (version + 1) * 2 + (role == "active" ? 1 : 0);
+
+    std::map<int, SSL_CTX *>::iterator it = dtls_ctxs_.find(key);
+    if (it != dtls_ctxs_.end()) {
+        return it->second;
+    }
+
+    SSL_CTX *dtls_ctx = srs_build_dtls_ctx(version, role);
+
+    // Disable the session cache, because the context is shared by all sessions, and WebRTC peers
+    // never resume the DTLS session, so the cache only grows.
+    SSL_CTX_set_session_cache_mode(dtls_ctx, SSL_SESS_CACHE_OFF);
+
+    dtls_ctxs_[key] = dtls_ctx;
+    return dtls_ctx;
+}
+
+SrsDtlsHandshakeStat::SrsDtlsHandshakeStat()
+{
+    nn_handshakes_ = 0;
+    total_cost_ = 0;
+    max_cost_ = 0;
+    memset(histogram_, 0, sizeof(histogram_));
+}
+
+SrsDtlsHandshakeStat::~SrsDtlsHandshakeStat()
+{
+}
+
+void SrsDtlsHandshakeStat::on_handshake(srs_utime_t cost)
+{
+    nn_handshakes_++;
+    total_cost_ += cost;
+    max_cost_ = srs_max(max_cost_, cost);
+
+    if (cost < 100 * SRS_UTIME_MILLISECONDS) {
+        histogram_[0]++;
+    } else if (cost < 300 * SRS_UTIME_MILLISECONDS) {
+        histogram_[1]++;
+    } else if (cost < 1 * SRS_UTIME_SECONDS) {
+        histogram_[2]++;
+    } else {
+        histogram_[3]++;
+    }
+}
+
+std::string SrsDtlsHandshakeStat::dumps()
+{
+    if (!nn_handshakes_) {
+        return "";
+    }
+
+    std::string desc = srs_fmt_sprintf(", dtls=(n:%d,a:%dms,m:%dms,h:%d/%d/%d/%d)", nn_handshakes_,
+                                       srsu2msi(total_cost_ / nn_handshakes_), srsu2msi(max_cost_),
+                                       histogram_[0], histogram_[1], histogram_[2], histogram_[3]);
+
+    nn_handshakes_ = 0;
+    total_cost_ = 0;
+    max_cost_ = 0;
+    memset(histogram_, 0, sizeof(histogram_));
+
+    return desc;
+}
+
 ISrsDtlsCallback::ISrsDtlsCallback()
 {
 }
@@ -416,6 +488,7 @@ SrsDtlsImpl::SrsDtlsImpl(ISrsDtlsCallback *callback)
     nn_arq_packets_ = 0;
     last_handshake_type_ = 0;
     last_content_type_ = 0;
+    handshake_starttime_ = 0;
 
     version_ = SrsDtlsVersionAuto;
 }
@@ -427,10 +500,8 @@ SrsDtlsImpl::~SrsDtlsImpl()
                   version_, nn_arq_packets_);
     }
 
-    if (dtls_ctx_) {
-        SSL_CTX_free(dtls_ctx_);
-        dtls_ctx_ = NULL;
-    }
+    // The context is shared, @see SrsDtlsCertificate::get_dtls_ctx
+    dtls_ctx_ = NULL;
 
     if (dtls_) {
         // this function will free bio_in_ and bio_out_
@@ -492,7 +563,7 @@ srs_error_t SrsDtlsImpl::initialize(std::string version, std::string role)
         version_ = SrsDtlsVersionAuto;
     }
 
-    dtls_ctx_ = srs_build_dtls_ctx(version_, role);
+    dtls_ctx_ = _srs_rtc_dtls_certificate->get_dtls_ctx(version_, role);
 
     if ((dtls_ = SSL_new(dtls_ctx_)) == NULL) {
         return srs_error_new(ERROR_OpenSslCreateSSL, "SSL_new dtls");
@@ -564,6 +635,8 @@ srs_error_t SrsDtlsImpl::start_active_handshake()
     // although the DTLS server may receive the ClientHello immediately after sending out the ICE
     // response, this shouldn't be an issue as the handshake function is called before any DTLS
     // packets are received.
+    handshake_starttime_ = srs_time_now_cached();
+
     int r0 = SSL_do_handshake(dtls_);
     int r1 = SSL_get_error(dtls_, r0);
     ERR_clear_error();
@@ -637,6 +710,9 @@ srs_error_t SrsDtlsImpl::do_on_dtls(char *data, int nb_data)
     // Check whether the DTLS is completed.
     if (!handshake_done_for_us_ && SSL_is_init_finished(dtls_) == 1) {
         handshake_done_for_us_ = true;
+        if (handshake_starttime_ && _srs_dtls_handshakes) {
+            _srs_dtls_handshakes->on_handshake(srs_time_now_cached() - handshake_starttime_);
+        }
         if (((err = on_handshake_done()) != srs_success)) {
             return srs_error_wrap(err, "done");
         }
@@ -9,6 +9,7 @@
 
 #include <srs_core.hpp>
 
+#include <map>
 #include <string>
 #include <vector>
 
@@ -19,6 +20,22 @@
 
 class ISrsRequest;
 
+// @remark: play the role of DTLS_CLIENT, will send handshake
+// packet first.
+enum SrsDtlsRole {
+    SrsDtlsRoleClient,
+    SrsDtlsRoleServer
+};
+
+// @remark: DTLS_10 will all be ignored, and only DTLS1_2 will be accepted,
+// DTLS_10 Support will be completely removed in M84 or later.
+// TODO(https://bugs.webrtc.org/10261).
+enum SrsDtlsVersion {
+    SrsDtlsVersionAuto = -1,
+    SrsDtlsVersion1_0,
+    SrsDtlsVersion1_2
+};
+
 // The interface for DTLS certificate.
 class ISrsDtlsCertificate
 {
@@ -41,6 +58,8 @@ SRS_DECLARE_PRIVATE: // clang-format on
     X509 *dtls_cert_;
     EVP_PKEY *dtls_pkey_;
     EC_KEY *eckey_;
+    // The shared DTLS context of each version and role, @see get_dtls_ctx
+    std::map<int, SSL_CTX *> dtls_ctxs_;
 
 public:
     SrsDtlsCertificate();
@@ -59,27 +78,39 @@ public:
     std::string get_fingerprint();
     // whether is ecdsa
     bool is_ecdsa();
+    // Get the DTLS context of version and role, which is built once and shared by all sessions,
+    // because the context is the same, and building it for each player costs a lot in a join storm.
+    SSL_CTX *get_dtls_ctx(SrsDtlsVersion version, std::string role);
 };
 
 // @global config object.
 extern SrsDtlsCertificate *_srs_rtc_dtls_certificate;
 
-// @remark: play the role of DTLS_CLIENT, will send handshake
-// packet first.
-enum SrsDtlsRole {
-    SrsDtlsRoleClient,
-    SrsDtlsRoleServer
-};
+// The statistic of DTLS handshakes, the cost is from the ICE done to the DTLS done, which
+// includes the network RTT, and the ECDHE and signature of both peers.
+class SrsDtlsHandshakeStat
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    int nn_handshakes_;
+    srs_utime_t total_cost_;
+    srs_utime_t max_cost_;
+    // The histogram of cost, in [0,100ms), [100ms,300ms), [300ms,1s) and [1s,+).
+    int histogram_[4];
 
-// @remark: DTLS_10 will all be ignored, and only DTLS1_2 will be accepted,
-// DTLS_10 Support will be completely removed in M84 or later.
-// TODO(https://bugs.webrtc.org/10261).
-enum SrsDtlsVersion {
-    SrsDtlsVersionAuto = -1,
-    SrsDtlsVersion1_0,
-    SrsDtlsVersion1_2
+public:
+    SrsDtlsHandshakeStat();
+    virtual ~SrsDtlsHandshakeStat();
+
+public:
+    void on_handshake(srs_utime_t cost);
+    // Dumps and reset the statistic, for the pithy print of RTC server.
+    std::string dumps();
 };
 
+// @global The statistic of DTLS handshakes.
+extern SrsDtlsHandshakeStat *_srs_dtls_handshakes;
+
 class ISrsDtlsCallback
 {
 public:
@@ -124,6 +155,8 @@ SRS_DECLARE_PROTECTED: // clang-format on
     int nn_arq_packets_;
     uint8_t last_handshake_type_;
     uint8_t last_content_type_;
+    // The start time of handshake, for the statistic of cost.
+    srs_utime_t handshake_starttime_;
 
 public:
     SrsDtlsImpl(ISrsDtlsCallback *callback);
@@ -273,6 +306,10 @@ public:
 
 public:
     virtual srs_error_t initialize(std::string recv_key, std::string send_key) = 0;
+    // Protect one RTP packet in place.
+    // @remark There is no batch API, because libsrtp encrypts exactly one packet per call, so
+    //      a batch costs the same as protecting packet by packet. Use --srtp-nasm=on to build
+    //      libsrtp over the AES-NI of OpenSSL, which is what speeds up the protect.
     virtual srs_error_t protect_rtp(void *packet, int *nb_cipher) = 0;
     virtual srs_error_t protect_rtcp(void *packet, int *nb_cipher) = 0;
     virtual srs_error_t unprotect_rtp(void *packet, int *nb_plaintext) = 0;
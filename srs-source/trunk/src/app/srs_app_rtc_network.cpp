@@ -192,6 +192,7 @@ SrsRtcUdpNetwork::SrsRtcUdpNetwork(ISrsRtcConnection *conn, ISrsEphemeralDelta *
     sendonly_skt_ = NULL;
     pp_address_change_ = new SrsErrorPithyPrint();
     transport_ = new SrsSecurityTransport(this);
+    stun_responder_ = new SrsStunBindingResponder();
 
     conn_manager_ = _srs_conn_manager;
 }
@@ -210,6 +211,7 @@ SrsRtcUdpNetwork::~SrsRtcUdpNetwork()
     }
 
     srs_freep(pp_address_change_);
+    srs_freep(stun_responder_);
 
     conn_manager_ = NULL;
 }
@@ -445,19 +447,12 @@ srs_error_t SrsRtcUdpNetwork::on_binding_request(SrsStunPacket *r, string ice_pw
 {
     srs_error_t err = srs_success;
 
-    SrsStunPacket stun_binding_response;
     char buf[kRtpPacketSize];
     SrsUniquePtr<SrsBuffer> stream(new SrsBuffer(buf, sizeof(buf)));
 
-    stun_binding_response.set_message_type(BindingResponse);
-    stun_binding_response.set_local_ufrag(r->get_remote_ufrag());
-    stun_binding_response.set_remote_ufrag(r->get_local_ufrag());
-    stun_binding_response.set_transcation_id(r->get_transcation_id());
     // FIXME: inet_addr is deprecated, IPV6 support
-    stun_binding_response.set_mapped_address(be32toh(inet_addr(get_peer_ip().c_str())));
-    stun_binding_response.set_mapped_port(get_peer_port());
-
-    if ((err = stun_binding_response.encode(ice_pwd, stream.get())) != srs_success) {
+    uint32_t mapped_address = be32toh(inet_addr(get_peer_ip().c_str()));
+    if ((err = stun_responder_->encode(r, ice_pwd, mapped_address, get_peer_port(), stream.get())) != srs_success) {
         return srs_error_wrap(err, "stun binding response encode failed");
     }
 
@@ -498,6 +493,7 @@ SrsRtcTcpNetwork::SrsRtcTcpNetwork(ISrsRtcConnection *conn, ISrsEphemeralDelta *
     delta_ = delta;
     sendonly_skt_ = NULL;
     transport_ = new SrsSecurityTransport(this);
+    stun_responder_ = new SrsStunBindingResponder();
     peer_port_ = 0;
     state_ = SrsRtcNetworkStateInit;
 }
@@ -506,6 +502,7 @@ SrsRtcTcpNetwork::~SrsRtcTcpNetwork()
 {
     owner_->interrupt();
     srs_freep(transport_);
+    srs_freep(stun_responder_);
 }
 
 void SrsRtcTcpNetwork::update_sendonly_socket(ISrsProtocolReadWriter *skt)
@@ -574,19 +571,12 @@ srs_error_t SrsRtcTcpNetwork::on_binding_request(SrsStunPacket *r, std::string i
 {
     srs_error_t err = srs_success;
 
-    SrsStunPacket stun_binding_response;
     char buf[kRtpPacketSize];
     SrsUniquePtr<SrsBuffer> stream(new SrsBuffer(buf, sizeof(buf)));
 
-    stun_binding_response.set_message_type(BindingResponse);
-    stun_binding_response.set_local_ufrag(r->get_remote_ufrag());
-    stun_binding_response.set_remote_ufrag(r->get_local_ufrag());
-    stun_binding_response.set_transcation_id(r->get_transcation_id());
     // FIXME: inet_addr is deprecated, IPV6 support
-    stun_binding_response.set_mapped_address(be32toh(inet_addr(get_peer_ip().c_str())));
-    stun_binding_response.set_mapped_port(get_peer_port());
-
-    if ((err = stun_binding_response.encode(ice_pwd, stream.get())) != srs_success) {
+    uint32_t mapped_address = be32toh(inet_addr(get_peer_ip().c_str()));
+    if ((err = stun_responder_->encode(r, ice_pwd, mapped_address, get_peer_port(), stream.get())) != srs_success) {
         return srs_error_wrap(err, "stun binding response encode failed");
     }
 
@@ -27,6 +27,7 @@ class ISrsKbpsDelta;
 class SrsUdpMuxSocket;
 class ISrsUdpMuxSocket;
 class SrsErrorPithyPrint;
+class SrsStunBindingResponder;
 class ISrsRtcTransport;
 class SrsEphemeralDelta;
 class ISrsEphemeralDelta;
@@ -201,6 +202,8 @@ SRS_DECLARE_PRIVATE: // clang-format on
     std::map<std::string, ISrsUdpMuxSocket *> peer_addresses_;
     // The DTLS transport over this network.
     ISrsRtcTransport *transport_;
+    // The cached STUN binding response, for ICE consent checks.
+    SrsStunBindingResponder *stun_responder_;
 
 public:
     SrsRtcUdpNetwork(ISrsRtcConnection *conn, ISrsEphemeralDelta *delta);
@@ -253,6 +256,8 @@ SRS_DECLARE_PRIVATE: // clang-format on
     // The DTLS transport over this network.
     ISrsRtcTransport *transport_;
     SrsSharedResource<ISrsRtcTcpConn> owner_;
+    // The cached STUN binding response, for ICE consent checks.
+    SrsStunBindingResponder *stun_responder_;
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
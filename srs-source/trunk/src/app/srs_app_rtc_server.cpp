@@ -15,6 +15,9 @@ using namespace std;
 #include <srs_app_factory.hpp>
 #include <srs_app_http_api.hpp>
 #include <srs_app_rtc_api.hpp>
+#ifdef SRS_FFMPEG_FIT
+#include <srs_app_rtc_codec.hpp>
+#endif
 #include <srs_app_rtc_conn.hpp>
 #include <srs_app_rtc_dtls.hpp>
 #include <srs_app_rtc_network.hpp>
@@ -152,6 +155,9 @@ SrsRtcBlackhole *_srs_blackhole = NULL;
 // @global dtls certficate for rtc module.
 SrsDtlsCertificate *_srs_rtc_dtls_certificate = NULL;
 
+// @global The statistic of DTLS handshakes.
+SrsDtlsHandshakeStat *_srs_dtls_handshakes = NULL;
+
 // TODO: Should support error response.
 // For STUN packet, 0x00 is binding request, 0x01 is binding success response.
 bool srs_is_stun(const uint8_t *data, size_t size)
@@ -492,10 +498,22 @@ void SrsRtcSessionManager::srs_update_rtc_sessions()
     SrsKbsRtcStats stats;
     srs_global_rtc_update(&stats);
 
-    srs_trace("RTC: Server conns=%u%s%s%s%s%s%s%s",
+    string trans_desc;
+#ifdef SRS_FFMPEG_FIT
+    if (_srs_audio_transcoders) {
+        trans_desc = _srs_audio_transcoders->dumps();
+    }
+#endif
+
+    string dtls_desc;
+    if (_srs_dtls_handshakes) {
+        dtls_desc = _srs_dtls_handshakes->dumps();
+    }
+
+    srs_trace("RTC: Server conns=%u%s%s%s%s%s%s%s%s%s",
               nn_rtc_conns,
               stats.rpkts_desc_.c_str(), stats.spkts_desc_.c_str(), stats.rtcp_desc_.c_str(), stats.snk_desc_.c_str(),
-              stats.rnk_desc_.c_str(), loss_desc.c_str(), stats.fid_desc_.c_str());
+              stats.rnk_desc_.c_str(), loss_desc.c_str(), stats.fid_desc_.c_str(), trans_desc.c_str(), dtls_desc.c_str());
 }
 
 // LCOV_EXCL_START
@@ -401,6 +401,9 @@ SrsRtcSource::SrsRtcSource()
     pli_for_rtmp_ = pli_elapsed_ = 0;
     stream_die_at_ = 0;
 
+    nack_cache_ = NULL;
+    nack_cache_stat_at_ = 0;
+
     app_factory_ = _srs_app_factory;
 }
 
@@ -413,6 +416,7 @@ SrsRtcSource::~SrsRtcSource()
     srs_freep(rtc_bridge_);
     srs_freep(req_);
     srs_freep(stream_desc_);
+    srs_freep(nack_cache_);
 
     SrsContextId cid = _source_id;
     if (cid.empty())
@@ -441,6 +445,12 @@ srs_error_t SrsRtcSource::initialize(ISrsRequest *r)
     srs_freep(req_);
     req_ = r->copy();
 
+    // The shared NACK cache, its size is in KB.
+    int nack_cache_size = _srs_config->get_rtc_nack_cache_size(req_->vhost_);
+    if (!nack_cache_ && nack_cache_size > 0) {
+        nack_cache_ = new SrsRtpNackCache((int64_t)nack_cache_size * 1024);
+    }
+
     // Create default relations to allow play before publishing.
     // @see https://github.com/ossrs/srs/issues/2362
     init_for_play_before_publishing();
@@ -740,6 +750,11 @@ void SrsRtcSource::on_unpublish()
         srs_freep(rtc_bridge_);
     }
 
+    // The packets of publisher are useless for next publisher.
+    if (nack_cache_) {
+        nack_cache_->clear();
+    }
+
     SrsStatistic *stat = _srs_stat;
     stat->on_stream_close(req_);
 
@@ -789,6 +804,18 @@ srs_error_t SrsRtcSource::on_rtp(SrsRtpPacket *pkt)
         return err;
     }
 
+    // Keep a copy for players to answer NACK, only when there are players.
+    if (nack_cache_ && !consumers_.empty()) {
+        nack_cache_->put(pkt);
+
+        // Update the memory of cache to stat, about each second.
+        srs_utime_t now = srs_time_now_cached();
+        if (now - nack_cache_stat_at_ >= SRS_UTIME_SECONDS) {
+            nack_cache_stat_at_ = now;
+            _srs_stat->on_rtc_nack_cache(req_, nack_cache_->nn_packets(), nack_cache_->nn_bytes());
+        }
+    }
+
     for (int i = 0; i < (int)consumers_.size(); i++) {
         ISrsRtcConsumer *consumer = consumers_.at(i);
         if ((err = consumer->enqueue(pkt->copy())) != srs_success) {
@@ -854,6 +881,11 @@ std::vector<SrsRtcTrackDescription *> SrsRtcSource::get_track_desc(std::string t
     return track_descs;
 }
 
+SrsRtpNackCache *SrsRtcSource::nack_cache()
+{
+    return nack_cache_;
+}
+
 srs_error_t SrsRtcSource::on_timer(srs_utime_t interval)
 {
     srs_error_t err = srs_success;
@@ -1535,10 +1567,10 @@ bool SrsRtcFrameBuilderVideoPacketCache::check_frame_complete(const uint16_t sta
         if (!pkt)
             continue;
 
-        SrsRtpFUAPayload2 *fua_payload = dynamic_cast<SrsRtpFUAPayload2 *>(pkt->payload());
-        if (!fua_payload)
+        if (pkt->payload_type() != SrsRtpPacketPayloadTypeFUA2)
             continue;
 
+        SrsRtpFUAPayload2 *fua_payload = static_cast<SrsRtpFUAPayload2 *>(pkt->payload());
         if (fua_payload->start_) {
             ++nn_fu_start;
         }
@@ -2257,9 +2289,13 @@ int SrsRtcFrameBuilder::calculate_packet_payload_size(SrsRtpPacket *pkt)
         return 0;
     }
 
+    // The payloader always matches the payload type, so we dispatch by type, rather than
+    // dynamic_cast each payloader, because it's called for each packet of each frame.
+    SrsRtpPacketPayloadType pt = pkt->payload_type();
+
     // H.264 FU-A payload
-    SrsRtpFUAPayload2 *fua_payload = dynamic_cast<SrsRtpFUAPayload2 *>(pkt->payload());
-    if (fua_payload) {
+    if (pt == SrsRtpPacketPayloadTypeFUA2) {
+        SrsRtpFUAPayload2 *fua_payload = static_cast<SrsRtpFUAPayload2 *>(pkt->payload());
         int size = fua_payload->size_;
         if (size <= 0) {
             return 0;
@@ -2271,21 +2307,14 @@ int SrsRtcFrameBuilder::calculate_packet_payload_size(SrsRtpPacket *pkt)
     }
 
     // H.264 STAP-A payload
-    SrsRtpSTAPPayload *stap_payload = dynamic_cast<SrsRtpSTAPPayload *>(pkt->payload());
-    if (stap_payload) {
-        int size = 0;
-        for (int j = 0; j < (int)stap_payload->nalus_.size(); ++j) {
-            SrsNaluSample *sample = stap_payload->nalus_.at(j);
-            if (sample->size_ > 0) {
-                size += 4 + sample->size_; // length prefix + NALU
-            }
-        }
-        return size;
+    if (pt == SrsRtpPacketPayloadTypeSTAP) {
+        SrsRtpSTAPPayload *stap_payload = static_cast<SrsRtpSTAPPayload *>(pkt->payload());
+        return calculate_nalus_size(stap_payload->nalus_);
     }
 
     // H.265 FU-A payload
-    SrsRtpFUAPayloadHevc2 *fua_payload_hevc = dynamic_cast<SrsRtpFUAPayloadHevc2 *>(pkt->payload());
-    if (fua_payload_hevc) {
+    if (pt == SrsRtpPacketPayloadTypeFUAHevc2) {
+        SrsRtpFUAPayloadHevc2 *fua_payload_hevc = static_cast<SrsRtpFUAPayloadHevc2 *>(pkt->payload());
         int size = fua_payload_hevc->size_;
         if (size <= 0) {
             return 0;
@@ -2297,21 +2326,14 @@ int SrsRtcFrameBuilder::calculate_packet_payload_size(SrsRtpPacket *pkt)
     }
 
     // H.265 STAP payload
-    SrsRtpSTAPPayloadHevc *stap_payload_hevc = dynamic_cast<SrsRtpSTAPPayloadHevc *>(pkt->payload());
-    if (stap_payload_hevc) {
-        int size = 0;
-        for (int j = 0; j < (int)stap_payload_hevc->nalus_.size(); ++j) {
-            SrsNaluSample *sample = stap_payload_hevc->nalus_.at(j);
-            if (sample->size_ > 0) {
-                size += 4 + sample->size_; // length prefix + NALU
-            }
-        }
-        return size;
+    if (pt == SrsRtpPacketPayloadTypeSTAPHevc) {
+        SrsRtpSTAPPayloadHevc *stap_payload_hevc = static_cast<SrsRtpSTAPPayloadHevc *>(pkt->payload());
+        return calculate_nalus_size(stap_payload_hevc->nalus_);
     }
 
     // Raw payload
-    SrsRtpRawPayload *raw_payload = dynamic_cast<SrsRtpRawPayload *>(pkt->payload());
-    if (raw_payload) {
+    if (pt == SrsRtpPacketPayloadTypeRaw) {
+        SrsRtpRawPayload *raw_payload = static_cast<SrsRtpRawPayload *>(pkt->payload());
         if (raw_payload->nn_payload_ <= 1) {
             return 0; // Ignore empty payload, which only has the NALU header.
         }
@@ -2321,15 +2343,29 @@ int SrsRtcFrameBuilder::calculate_packet_payload_size(SrsRtpPacket *pkt)
     return 0;
 }
 
+int SrsRtcFrameBuilder::calculate_nalus_size(std::vector<SrsNaluSample *> &nalus)
+{
+    int size = 0;
+    for (int j = 0; j < (int)nalus.size(); ++j) {
+        SrsNaluSample *sample = nalus.at(j);
+        if (sample->size_ > 0) {
+            size += 4 + sample->size_; // length prefix + NALU
+        }
+    }
+    return size;
+}
+
 void SrsRtcFrameBuilder::write_packet_payload_to_buffer(SrsRtpPacket *pkt, SrsBuffer &payload, int &nalu_len)
 {
     if (!pkt || !pkt->payload()) {
         return;
     }
 
+    SrsRtpPacketPayloadType pt = pkt->payload_type();
+
     // H.264 FU-A payload
-    SrsRtpFUAPayload2 *fua_payload = dynamic_cast<SrsRtpFUAPayload2 *>(pkt->payload());
-    if (fua_payload) {
+    if (pt == SrsRtpPacketPayloadTypeFUA2) {
+        SrsRtpFUAPayload2 *fua_payload = static_cast<SrsRtpFUAPayload2 *>(pkt->payload());
         int size = fua_payload->size_;
         if (size <= 0) {
             return;
@@ -2353,21 +2389,15 @@ void SrsRtcFrameBuilder::write_packet_payload_to_buffer(SrsRtpPacket *pkt, SrsBu
     }
 
     // H.264 STAP-A payload
-    SrsRtpSTAPPayload *stap_payload = dynamic_cast<SrsRtpSTAPPayload *>(pkt->payload());
-    if (stap_payload) {
-        for (int j = 0; j < (int)stap_payload->nalus_.size(); ++j) {
-            SrsNaluSample *sample = stap_payload->nalus_.at(j);
-            if (sample->size_ > 0) {
-                payload.write_4bytes(sample->size_);
-                payload.write_bytes(sample->bytes_, sample->size_);
-            }
-        }
+    if (pt == SrsRtpPacketPayloadTypeSTAP) {
+        SrsRtpSTAPPayload *stap_payload = static_cast<SrsRtpSTAPPayload *>(pkt->payload());
+        write_nalus_to_buffer(stap_payload->nalus_, payload);
         return;
     }
 
     // H.265 FU-A payload
-    SrsRtpFUAPayloadHevc2 *fua_payload_hevc = dynamic_cast<SrsRtpFUAPayloadHevc2 *>(pkt->payload());
-    if (fua_payload_hevc) {
+    if (pt == SrsRtpPacketPayloadTypeFUAHevc2) {
+        SrsRtpFUAPayloadHevc2 *fua_payload_hevc = static_cast<SrsRtpFUAPayloadHevc2 *>(pkt->payload());
         int size = fua_payload_hevc->size_;
         if (size <= 0) {
             return;
@@ -2392,21 +2422,15 @@ void SrsRtcFrameBuilder::write_packet_payload_to_buffer(SrsRtpPacket *pkt, SrsBu
     }
 
     // H.265 STAP payload
-    SrsRtpSTAPPayloadHevc *stap_payload_hevc = dynamic_cast<SrsRtpSTAPPayloadHevc *>(pkt->payload());
-    if (stap_payload_hevc) {
-        for (int j = 0; j < (int)stap_payload_hevc->nalus_.size(); ++j) {
-            SrsNaluSample *sample = stap_payload_hevc->nalus_.at(j);
-            if (sample->size_ > 0) {
-                payload.write_4bytes(sample->size_);
-                payload.write_bytes(sample->bytes_, sample->size_);
-            }
-        }
+    if (pt == SrsRtpPacketPayloadTypeSTAPHevc) {
+        SrsRtpSTAPPayloadHevc *stap_payload_hevc = static_cast<SrsRtpSTAPPayloadHevc *>(pkt->payload());
+        write_nalus_to_buffer(stap_payload_hevc->nalus_, payload);
         return;
     }
 
     // Raw payload
-    SrsRtpRawPayload *raw_payload = dynamic_cast<SrsRtpRawPayload *>(pkt->payload());
-    if (raw_payload) {
+    if (pt == SrsRtpPacketPayloadTypeRaw) {
+        SrsRtpRawPayload *raw_payload = static_cast<SrsRtpRawPayload *>(pkt->payload());
         if (raw_payload->nn_payload_ <= 1) {
             return; // Ignore empty payload, which only has the NALU header.
         }
@@ -2416,6 +2440,17 @@ void SrsRtcFrameBuilder::write_packet_payload_to_buffer(SrsRtpPacket *pkt, SrsBu
     }
 }
 
+void SrsRtcFrameBuilder::write_nalus_to_buffer(std::vector<SrsNaluSample *> &nalus, SrsBuffer &payload)
+{
+    for (int j = 0; j < (int)nalus.size(); ++j) {
+        SrsNaluSample *sample = nalus.at(j);
+        if (sample->size_ > 0) {
+            payload.write_4bytes(sample->size_);
+            payload.write_bytes(sample->bytes_, sample->size_);
+        }
+    }
+}
+
 srs_error_t SrsRtcFrameBuilder::packet_video_rtmp(const uint16_t start, const uint16_t end)
 {
     srs_error_t err = srs_success;
@@ -3353,7 +3388,7 @@ void SrsRtcAudioRecvTrack::on_before_decode_payload(SrsRtpPacket *pkt, SrsBuffer
         return;
     }
 
-    *ppayload = new SrsRtpRawPayload();
+    // Only set the payload type, the packet parses the payload when used.
     *ppt = SrsRtpPacketPayloadTypeRaw;
 }
 
@@ -3401,19 +3436,18 @@ void SrsRtcVideoRecvTrack::on_before_decode_payload(SrsRtpPacket *pkt, SrsBuffer
         return;
     }
 
+    // Only peek the NALU type and set the payload type, the packet parses the payload when
+    // used, for example, by RTC to RTMP bridge. Players forward the payload as is.
     SrsVideoCodecId codec = (SrsVideoCodecId)track_desc_->media_->codec(true);
     if (codec == SrsVideoCodecIdAVC) {
         uint8_t v = SrsAvcNaluTypeParse(buf->head()[0]);
         pkt->nalu_type_ = v;
 
         if (v == kStapA) {
-            *ppayload = new SrsRtpSTAPPayload();
             *ppt = SrsRtpPacketPayloadTypeSTAP;
         } else if (v == kFuA) {
-            *ppayload = new SrsRtpFUAPayload2();
             *ppt = SrsRtpPacketPayloadTypeFUA2;
         } else {
-            *ppayload = new SrsRtpRawPayload();
             *ppt = SrsRtpPacketPayloadTypeRaw;
         }
     } else if (codec == SrsVideoCodecIdHEVC) {
@@ -3421,13 +3455,10 @@ void SrsRtcVideoRecvTrack::on_before_decode_payload(SrsRtpPacket *pkt, SrsBuffer
         pkt->nalu_type_ = v;
 
         if (v == kStapHevc) {
-            *ppayload = new SrsRtpSTAPPayloadHevc();
             *ppt = SrsRtpPacketPayloadTypeSTAPHevc;
         } else if (v == kFuHevc) {
-            *ppayload = new SrsRtpFUAPayloadHevc2();
             *ppt = SrsRtpPacketPayloadTypeFUAHevc2;
         } else {
-            *ppayload = new SrsRtpRawPayload();
             *ppt = SrsRtpPacketPayloadTypeRaw;
         }
     } else {
@@ -3516,16 +3547,14 @@ SrsRtcSendTrack::SrsRtcSendTrack(ISrsRtcPacketSender *sender, SrsRtcTrackDescrip
     sender_ = sender;
     track_desc_ = track_desc->copy();
     nack_no_copy_ = false;
+    nack_cache_ = NULL;
 
     // Make a different start of sequence number, for debugging.
     jitter_ts_ = new SrsRtcTsJitter(track_desc_->type_ == "audio" ? 10000 : 20000);
     jitter_seq_ = new SrsRtcSeqJitter(track_desc_->type_ == "audio" ? 100 : 200);
 
-    if (is_audio) {
-        rtp_queue_ = new SrsRtpRingBuffer(100);
-    } else {
-        rtp_queue_ = new SrsRtpRingBuffer(1000);
-    }
+    nack_capacity_ = is_audio ? 100 : 1000;
+    rtp_queue_ = new SrsRtpRingBuffer(nack_capacity_);
 
     nack_epp = new SrsErrorPithyPrint();
 }
@@ -3539,6 +3568,18 @@ SrsRtcSendTrack::~SrsRtcSendTrack()
     srs_freep(jitter_seq_);
 }
 
+void SrsRtcSendTrack::set_nack_cache(SrsRtpNackCache *v)
+{
+    nack_cache_ = v;
+
+    nack_index_.clear();
+    if (nack_cache_) {
+        SrsRtcNackIndex index;
+        memset(&index, 0, sizeof(SrsRtcNackIndex));
+        nack_index_.resize(nack_capacity_, index);
+    }
+}
+
 bool SrsRtcSendTrack::has_ssrc(uint32_t ssrc)
 {
     return track_desc_->has_ssrc(ssrc);
@@ -3600,10 +3641,32 @@ void SrsRtcSendTrack::rebuild_packet(SrsRtpPacket *pkt)
     srs_info("RTC: Correct %s seq=%u/%u, ts=%u/%u", track_desc_->type_.c_str(), seq, pkt->header_.get_sequence(), ts, pkt->header_.get_timestamp());
 }
 
+void SrsRtcSendTrack::index_packet(uint32_t ssrc, uint16_t seq, SrsRtpPacket *pkt)
+{
+    if (!nack_cache_) {
+        return;
+    }
+
+    uint16_t rewritten_seq = pkt->header_.get_sequence();
+    SrsRtcNackIndex &index = nack_index_[rewritten_seq % nack_capacity_];
+
+    index.valid_ = true;
+    index.seq_ = rewritten_seq;
+    index.ssrc_ = ssrc;
+    index.original_seq_ = seq;
+    index.ts_ = pkt->header_.get_timestamp();
+    index.pt_ = pkt->header_.get_payload_type();
+}
+
 srs_error_t SrsRtcSendTrack::on_nack(SrsRtpPacket **ppkt)
 {
     srs_error_t err = srs_success;
 
+    // The packet is in the shared NACK cache of source, already indexed by on_rtp.
+    if (nack_cache_) {
+        return err;
+    }
+
     SrsRtpPacket *pkt = *ppkt;
     uint16_t seq = pkt->header_.get_sequence();
 
@@ -3625,6 +3688,10 @@ srs_error_t SrsRtcSendTrack::on_recv_nack(const vector<uint16_t> &lost_seqs)
 
     ++_srs_pps_rnack2->sugar_;
 
+    if (nack_cache_) {
+        return on_recv_nack_from_cache(lost_seqs);
+    }
+
     for (int i = 0; i < (int)lost_seqs.size(); ++i) {
         uint16_t seq = lost_seqs.at(i);
         SrsRtpPacket *pkt = fetch_rtp_packet(seq);
@@ -3647,6 +3714,54 @@ srs_error_t SrsRtcSendTrack::on_recv_nack(const vector<uint16_t> &lost_seqs)
     return err;
 }
 
+srs_error_t SrsRtcSendTrack::on_recv_nack_from_cache(const vector<uint16_t> &lost_seqs)
+{
+    srs_error_t err = srs_success;
+
+    // Rebuild all lost packets of the NACK from the shared cache, then send them together.
+    vector<SrsRtpPacket *> pkts;
+    for (int i = 0; i < (int)lost_seqs.size(); ++i) {
+        uint16_t seq = lost_seqs.at(i);
+
+        // For NACK, it sequence must match exactly, or it cause SRTP fail.
+        SrsRtcNackIndex &index = nack_index_[seq % nack_capacity_];
+        SrsRtpPacket *original = NULL;
+        if (index.valid_ && index.seq_ == seq) {
+            original = nack_cache_->find(index.ssrc_, index.original_seq_);
+        }
+
+        if (!original) {
+            ++_srs_pps_rmnack->sugar_;
+            continue;
+        }
+        ++_srs_pps_rhnack->sugar_;
+
+        // The copy shares the payload, we only rewrite the header like on_rtp.
+        SrsRtpPacket *pkt = original->copy();
+        pkt->header_.set_ssrc(track_desc_->ssrc_);
+        pkt->header_.set_payload_type(index.pt_);
+        pkt->header_.set_sequence(seq);
+        pkt->header_.set_timestamp(index.ts_);
+        pkts.push_back(pkt);
+
+        uint32_t nn = 0;
+        if (nack_epp->can_print(pkt->header_.get_ssrc(), &nn)) {
+            srs_trace("RTC: NACK ARQ seq=%u/%u, ssrc=%u, ts=%u, count=%u/%u, %d bytes", seq, index.original_seq_,
+                      pkt->header_.get_ssrc(), pkt->header_.get_timestamp(), nn, nack_epp->nn_count_, pkt->nb_bytes());
+        }
+    }
+
+    for (int i = 0; i < (int)pkts.size(); ++i) {
+        SrsRtpPacket *pkt = pkts.at(i);
+        if (err == srs_success && (err = sender_->do_send_packet(pkt)) != srs_success) {
+            err = srs_error_wrap(err, "raw send");
+        }
+        srs_freep(pkt);
+    }
+
+    return err;
+}
+
 SrsRtcAudioSendTrack::SrsRtcAudioSendTrack(ISrsRtcPacketSender *sender, SrsRtcTrackDescription *track_desc)
     : SrsRtcSendTrack(sender, track_desc, true)
 {
@@ -3664,6 +3779,10 @@ srs_error_t SrsRtcAudioSendTrack::on_rtp(SrsRtpPacket *pkt)
         return err;
     }
 
+    // The original SSRC and sequence, to find packet in shared NACK cache.
+    uint32_t ssrc = pkt->header_.get_ssrc();
+    uint16_t seq = pkt->header_.get_sequence();
+
     pkt->header_.set_ssrc(track_desc_->ssrc_);
 
     // Should update PT, because subscriber may use different PT to publisher.
@@ -3679,6 +3798,7 @@ srs_error_t SrsRtcAudioSendTrack::on_rtp(SrsRtpPacket *pkt)
 
     // Rebuild the sequence number and timestamp of packet, see https://github.com/ossrs/srs/issues/3167
     rebuild_packet(pkt);
+    index_packet(ssrc, seq, pkt);
 
     if ((err = sender_->do_send_packet(pkt)) != srs_success) {
         return srs_error_wrap(err, "raw send");
@@ -3714,6 +3834,10 @@ srs_error_t SrsRtcVideoSendTrack::on_rtp(SrsRtpPacket *pkt)
         return err;
     }
 
+    // The original SSRC and sequence, to find packet in shared NACK cache.
+    uint32_t ssrc = pkt->header_.get_ssrc();
+    uint16_t seq = pkt->header_.get_sequence();
+
     pkt->header_.set_ssrc(track_desc_->ssrc_);
 
     // Should update PT, because subscriber may use different PT to publisher.
@@ -3729,6 +3853,7 @@ srs_error_t SrsRtcVideoSendTrack::on_rtp(SrsRtpPacket *pkt)
 
     // Rebuild the sequence number and timestamp of packet, see https://github.com/ossrs/srs/issues/3167
     rebuild_packet(pkt);
+    index_packet(ssrc, seq, pkt);
 
     if ((err = sender_->do_send_packet(pkt)) != srs_success) {
         return srs_error_wrap(err, "raw send");
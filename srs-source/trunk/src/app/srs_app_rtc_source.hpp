@@ -36,6 +36,7 @@ class SrsRtcTrackDescription;
 class SrsRtcConnection;
 class SrsRtpRingBuffer;
 class SrsRtpNackForReceiver;
+class SrsRtpNackCache;
 class SrsJsonObject;
 class SrsErrorPithyPrint;
 class SrsRtcFrameBuilder;
@@ -271,6 +272,13 @@ SRS_DECLARE_PRIVATE: // clang-format on
     // The last die time, while die means neither publishers nor players.
     srs_utime_t stream_die_at_;
 
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The shared NACK cache for all players, NULL if disabled.
+    SrsRtpNackCache *nack_cache_;
+    // The last time to update the NACK cache to stat.
+    srs_utime_t nack_cache_stat_at_;
+
 public:
     SrsRtcSource();
     virtual ~SrsRtcSource();
@@ -338,6 +346,8 @@ public:
     virtual bool has_stream_desc();
     virtual void set_stream_desc(SrsRtcSourceDescription *stream_desc);
     virtual std::vector<SrsRtcTrackDescription *> get_track_desc(std::string type, std::string media_type);
+    // Get the shared NACK cache for players, NULL if disabled.
+    virtual SrsRtpNackCache *nack_cache();
     // interface ISrsFastTimerHandler
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
@@ -628,7 +638,9 @@ SRS_DECLARE_PRIVATE: // clang-format on
 SRS_DECLARE_PRIVATE: // clang-format on
     srs_error_t packet_video_rtmp(const uint16_t start, const uint16_t end);
     int calculate_packet_payload_size(SrsRtpPacket *pkt);
+    int calculate_nalus_size(std::vector<SrsNaluSample *> &nalus);
     void write_packet_payload_to_buffer(SrsRtpPacket *pkt, SrsBuffer &payload, int &nalu_len);
+    void write_nalus_to_buffer(std::vector<SrsNaluSample *> &nalus, SrsBuffer &payload);
 };
 
 #endif
@@ -1048,6 +1060,20 @@ public:
     virtual srs_error_t do_send_packet(SrsRtpPacket *pkt) = 0;
 };
 
+// The index from the rewritten sequence of player to the original packet in shared NACK cache.
+struct SrsRtcNackIndex {
+    // Whether the index is set.
+    bool valid_;
+    // The rewritten sequence, to check whether the index is overwritten.
+    uint16_t seq_;
+    // The original SSRC and sequence of packet from publisher.
+    uint32_t ssrc_;
+    uint16_t original_seq_;
+    // The rewritten timestamp and payload type.
+    uint32_t ts_;
+    uint8_t pt_;
+};
+
 class SrsRtcSendTrack
 {
 public:
@@ -1073,6 +1099,15 @@ SRS_DECLARE_PRIVATE: // clang-format on
     bool nack_no_copy_;
     // The pithy print for special stage.
     SrsErrorPithyPrint *nack_epp;
+    // The capacity of NACK ring buffer.
+    int nack_capacity_;
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The shared NACK cache of source, NULL to use the NACK ring buffer of track.
+    SrsRtpNackCache *nack_cache_;
+    // The index of packets in shared NACK cache, by the rewritten sequence.
+    std::vector<SrsRtcNackIndex> nack_index_;
 
 public:
     SrsRtcSendTrack(ISrsRtcPacketSender *sender, SrsRtcTrackDescription *track_desc, bool is_audio);
@@ -1081,6 +1116,8 @@ public:
 public:
     // SrsRtcSendTrack::set_nack_no_copy
     void set_nack_no_copy(bool v) { nack_no_copy_ = v; }
+    // Answer NACK from the shared cache of source, rather than copies of packets in track.
+    void set_nack_cache(SrsRtpNackCache *v);
     bool has_ssrc(uint32_t ssrc);
     SrsRtpPacket *fetch_rtp_packet(uint16_t seq);
     bool set_track_status(bool active);
@@ -1090,6 +1127,8 @@ public:
 // clang-format off
 SRS_DECLARE_PROTECTED: // clang-format on
     void rebuild_packet(SrsRtpPacket *pkt);
+    // Map the rewritten sequence of pkt to the original SSRC and sequence, for shared NACK cache.
+    void index_packet(uint32_t ssrc, uint16_t seq, SrsRtpPacket *pkt);
 
 public:
     // Note that we can set the pkt to NULL to avoid copy, for example, if the NACK cache the pkt and
@@ -1100,6 +1139,10 @@ public:
     virtual srs_error_t on_rtp(SrsRtpPacket *pkt) = 0;
     virtual srs_error_t on_rtcp(SrsRtpPacket *pkt) = 0;
     virtual srs_error_t on_recv_nack(const std::vector<uint16_t> &lost_seqs);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    srs_error_t on_recv_nack_from_cache(const std::vector<uint16_t> &lost_seqs);
 };
 
 class SrsRtcAudioSendTrack : public SrsRtcSendTrack
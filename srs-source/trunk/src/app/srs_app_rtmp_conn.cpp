@@ -15,6 +15,7 @@
 using namespace std;
 
 #include <srs_app_config.hpp>
+#include <srs_app_coworkers.hpp>
 #include <srs_app_edge.hpp>
 #include <srs_app_factory.hpp>
 #include <srs_app_hls.hpp>
@@ -245,6 +246,7 @@ SrsRtmpConn::SrsRtmpConn(ISrsRtmpTransport *transport, string cip, int cport)
     live_sources_ = _srs_sources;
     stat_ = _srs_stat;
     hooks_ = _srs_hooks;
+    token_traverse_ = _srs_edge_token_traverse;
     rtc_sources_ = _srs_rtc_sources;
     srt_sources_ = _srs_srt_sources;
 #ifdef SRS_RTSP
@@ -286,6 +288,7 @@ SrsRtmpConn::~SrsRtmpConn()
     live_sources_ = NULL;
     stat_ = NULL;
     hooks_ = NULL;
+    token_traverse_ = NULL;
     rtc_sources_ = NULL;
     srt_sources_ = NULL;
 #ifdef SRS_RTSP
@@ -540,7 +543,8 @@ srs_error_t SrsRtmpConn::stream_service_cycle()
 
         // LCOV_EXCL_START
         if (info_->edge_ && edge_traverse) {
-            if ((err = check_edge_token_traverse_auth()) != srs_success) {
+            // The same token shares the in-flight or cached check of origin.
+            if ((err = token_traverse_->check(req, this)) != srs_success) {
                 return srs_error_wrap(err, "rtmp: check token traverse");
             }
         }
@@ -740,6 +744,24 @@ srs_error_t SrsRtmpConn::redirect_to_origin_cluster(SrsSharedPtr<SrsLiveSource>
 
     ISrsRequest *req = info_->req_;
 
+    // Find the origin in directory pushed by coworkers, to avoid querying all coworkers.
+    SrsClusterOrigin *origin = NULL;
+    if (_srs_cluster_directory && config_->get_vhost_origin_directory(req->vhost_)) {
+        origin = _srs_cluster_directory->find(req->vhost_, req->app_, req->stream_);
+    }
+    if (origin && !origin->ip_.empty() && origin->port_ > 0) {
+        string rurl = srs_net_url_encode_rtmp_url(origin->ip_, origin->port_, req->host_, req->vhost_, req->app_, req->stream_, req->param_);
+        srs_trace("rtmp: redirect in cluster by directory, from=%s:%d, target=%s:%d, api=%s, rurl=%s",
+                  req->host_.c_str(), req->port_, origin->ip_.c_str(), origin->port_, origin->api_.c_str(), rurl.c_str());
+
+        bool accepted = false;
+        if ((err = rtmp_->redirect(req, rurl, accepted)) != srs_success) {
+            srs_freep(err);
+        } else {
+            return srs_error_new(ERROR_CONTROL_REDIRECT, "redirected");
+        }
+    }
+
     vector<string> coworkers = config_->get_vhost_coworkers(req->vhost_);
     for (int i = 0; i < (int)coworkers.size(); i++) {
         // TODO: FIXME: User may config the server itself as coworker, we must identify and ignore it.
@@ -1386,6 +1408,14 @@ srs_error_t SrsRtmpConn::do_token_traverse_auth(SrsRtmpClient *client)
     // for token tranverse, always take the debug info(which carries token).
     SrsServerInfo si;
     if ((err = client->connect_app(req->app_, req->tcUrl_, req, true, &si)) != srs_success) {
+        // The origin rejects the token by closing the connection or responding _error for connect app, while other
+        // errors such as timeout or write failure are network errors, which never means the token is rejected.
+        int ret = srs_error_code(err);
+        if (ret == ERROR_SOCKET_READ || ret == ERROR_RTMP_AMF0_DECODE) {
+            string summary = srs_error_summary(err);
+            srs_freep(err);
+            return srs_error_new(ERROR_EDGE_TOKEN_REJECTED, "rtmp: token rejected, tcUrl=%s, %s", req->tcUrl_.c_str(), summary.c_str());
+        }
         return srs_error_wrap(err, "rtmp: connect tcUrl");
     }
 
@@ -11,6 +11,7 @@
 
 #include <string>
 
+#include <srs_app_edge.hpp>
 #include <srs_app_reload.hpp>
 #include <srs_app_st.hpp>
 #include <srs_core_autofree.hpp>
@@ -168,7 +169,8 @@ class SrsRtmpConn : public ISrsConnection, // It's a resource.
                     public ISrsStartable,
                     public ISrsReloadHandler,
                     public ISrsCoroutineHandler,
-                    public ISrsExpire
+                    public ISrsExpire,
+                    public ISrsEdgeTokenTraverseHandler
 {
     // For the thread to directly access any field of connection.
     friend class SrsPublishRecvThread;
@@ -182,6 +184,7 @@ SRS_DECLARE_PRIVATE: // clang-format on
     ISrsLiveSourceManager *live_sources_;
     ISrsStatistic *stat_;
     ISrsHttpHooks *hooks_;
+    SrsEdgeTokenTraverse *token_traverse_;
     ISrsRtcSourceManager *rtc_sources_;
     ISrsSrtSourceManager *srt_sources_;
 #ifdef SRS_RTSP
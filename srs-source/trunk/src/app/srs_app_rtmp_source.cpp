@@ -32,6 +32,7 @@ using namespace std;
 #include <srs_kernel_utility.hpp>
 #include <srs_protocol_amf0.hpp>
 #include <srs_protocol_format.hpp>
+#include <srs_protocol_json.hpp>
 #include <srs_protocol_rtmp_msg_array.hpp>
 #include <srs_protocol_rtmp_stack.hpp>
 #include <srs_protocol_utility.hpp>
@@ -859,6 +860,7 @@ SrsOriginHub::SrsOriginHub()
     hds_ = new SrsHds();
 #endif
     ng_exec_ = new SrsNgExec();
+    forward_queue_ = new SrsForwardQueue();
 
     config_ = _srs_config;
     stat_ = _srs_stat;
@@ -882,6 +884,7 @@ SrsOriginHub::~SrsOriginHub()
         }
         forwarders_.clear();
     }
+    srs_freep(forward_queue_);
     srs_freep(ng_exec_);
 
     srs_freep(hls_);
@@ -964,7 +967,11 @@ srs_error_t SrsOriginHub::on_meta_data(SrsMediaPacket *shared_metadata, SrsOnMet
     srs_error_t err = srs_success;
 
     // copy to all forwarders
-    if (true) {
+    if (!forwarders_.empty()) {
+        if ((err = forward_queue_->enqueue(shared_metadata)) != srs_success) {
+            return srs_error_wrap(err, "Forwarder enqueue metadata");
+        }
+
         std::vector<ISrsForwarder *>::iterator it;
         for (it = forwarders_.begin(); it != forwarders_.end(); ++it) {
             ISrsForwarder *forwarder = *it;
@@ -1060,7 +1067,11 @@ srs_error_t SrsOriginHub::on_audio(SrsMediaPacket *shared_audio)
 #endif
 
     // copy to all forwarders.
-    if (true) {
+    if (!forwarders_.empty()) {
+        if ((err = forward_queue_->enqueue(msg)) != srs_success) {
+            return srs_error_wrap(err, "forward: enqueue audio");
+        }
+
         std::vector<ISrsForwarder *>::iterator it;
         for (it = forwarders_.begin(); it != forwarders_.end(); ++it) {
             ISrsForwarder *forwarder = *it;
@@ -1150,6 +1161,10 @@ srs_error_t SrsOriginHub::on_video(SrsMediaPacket *shared_video, bool is_sequenc
 
     // copy to all forwarders.
     if (!forwarders_.empty()) {
+        if ((err = forward_queue_->enqueue(msg)) != srs_success) {
+            return srs_error_wrap(err, "forward enqueue video");
+        }
+
         std::vector<ISrsForwarder *>::iterator it;
         for (it = forwarders_.begin(); it != forwarders_.end(); ++it) {
             ISrsForwarder *forwarder = *it;
@@ -1235,15 +1250,7 @@ srs_error_t SrsOriginHub::on_forwarder_start(SrsForwarder *forwarder)
 
     // feed the forwarder the metadata/sequence header,
     // when reload to enable the forwarder.
-    if (cache_metadata && (err = forwarder->on_meta_data(cache_metadata)) != srs_success) {
-        return srs_error_wrap(err, "forward metadata");
-    }
-    if (cache_sh_video && (err = forwarder->on_video(cache_sh_video)) != srs_success) {
-        return srs_error_wrap(err, "forward video sh");
-    }
-    if (cache_sh_audio && (err = forwarder->on_audio(cache_sh_audio)) != srs_success) {
-        return srs_error_wrap(err, "forward audio sh");
-    }
+    forwarder->on_start_packets(cache_metadata, cache_sh_video, cache_sh_audio);
 
     return err;
 }
@@ -1324,7 +1331,8 @@ srs_error_t SrsOriginHub::create_forwarders()
     for (int i = 0; conf && i < (int)conf->args_.size(); i++) {
         std::string forward_server = conf->args_.at(i);
 
-        ISrsForwarder *forwarder = new SrsForwarder(this);
+        SrsForwarder *forwarder = new SrsForwarder(this);
+        forwarder->set_queue(forward_queue_);
         forwarders_.push_back(forwarder);
 
         // initialize the forwarder with request.
@@ -1379,7 +1387,8 @@ srs_error_t SrsOriginHub::create_backend_forwarders(bool &applied)
         srs_net_url_parse_tcurl(req->tcUrl_, req->schema_, req->host_, req->vhost_, req->app_, req->stream_, req->port_, req->param_);
 
         // create forwarder
-        ISrsForwarder *forwarder = new SrsForwarder(this);
+        SrsForwarder *forwarder = new SrsForwarder(this);
+        forwarder->set_queue(forward_queue_);
         forwarders_.push_back(forwarder);
 
         std::stringstream forward_server;
@@ -1402,6 +1411,21 @@ srs_error_t SrsOriginHub::create_backend_forwarders(bool &applied)
     return err;
 }
 
+void SrsOriginHub::dumps_forwarders(SrsJsonArray *arr)
+{
+    std::vector<ISrsForwarder *>::iterator it;
+    for (it = forwarders_.begin(); it != forwarders_.end(); ++it) {
+        SrsForwarder *forwarder = dynamic_cast<SrsForwarder *>(*it);
+        if (!forwarder) {
+            continue;
+        }
+
+        SrsJsonObject *obj = SrsJsonAny::object();
+        arr->append(obj);
+        forwarder->dumps(obj);
+    }
+}
+
 void SrsOriginHub::destroy_forwarders()
 {
     std::vector<ISrsForwarder *>::iterator it;
@@ -1745,6 +1769,15 @@ srs_error_t SrsLiveSourceManager::notify(int event, srs_utime_t interval, srs_ut
     return err;
 }
 
+void SrsLiveSourceManager::dumps_forwarders(SrsJsonArray *arr)
+{
+    std::map<std::string, SrsSharedPtr<SrsLiveSource> >::iterator it;
+    for (it = pool_.begin(); it != pool_.end(); ++it) {
+        SrsSharedPtr<SrsLiveSource> &source = it->second;
+        source->dumps_forwarders(arr);
+    }
+}
+
 void SrsLiveSourceManager::destroy()
 {
     pool_.clear();
@@ -1838,6 +1871,9 @@ srs_error_t SrsLiveSource::cycle()
 {
     srs_error_t err = srs_success;
 
+    // Stop the warm pull of edge, when expired.
+    play_edge_->cycle();
+
     if (hub_ && (err = hub_->cycle()) != srs_success) {
         return srs_error_wrap(err, "hub cycle");
     }
@@ -2606,6 +2642,14 @@ SrsRtmpJitterAlgorithm SrsLiveSource::jitter()
     return jitter_algorithm_;
 }
 
+void SrsLiveSource::dumps_forwarders(SrsJsonArray *arr)
+{
+    SrsOriginHub *hub = dynamic_cast<SrsOriginHub *>(hub_);
+    if (hub) {
+        hub->dumps_forwarders(arr);
+    }
+}
+
 srs_error_t SrsLiveSource::on_edge_start_publish()
 {
     return publish_edge_->on_client_publish();
@@ -31,6 +31,8 @@ class SrsRtmpCommonMessage;
 class SrsOnMetaDataPacket;
 class SrsMediaPacket;
 class SrsForwarder;
+class SrsForwardQueue;
+class SrsJsonArray;
 class ISrsRequest;
 class SrsStSocket;
 class SrsRtmpServer;
@@ -458,6 +460,8 @@ SRS_DECLARE_PRIVATE: // clang-format on
     ISrsNgExec *ng_exec_;
     // To forward stream to other servers
     std::vector<ISrsForwarder *> forwarders_;
+    // The packets to forward, shared by all forwarders.
+    SrsForwardQueue *forward_queue_;
 
 public:
     SrsOriginHub();
@@ -500,6 +504,8 @@ public:
     virtual srs_error_t on_dvr_request_sh();
     // For the SrsHls to callback to request the sequence headers.
     virtual srs_error_t on_hls_request_sh();
+    // Dumps the forwarders, for API.
+    virtual void dumps_forwarders(SrsJsonArray *arr);
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
@@ -616,6 +622,8 @@ public:
 public:
     // Get the exists source, NULL when not exists.
     virtual SrsSharedPtr<SrsLiveSource> fetch(ISrsRequest *r);
+    // Dumps the forwarders of all sources, for API.
+    virtual void dumps_forwarders(SrsJsonArray *arr);
 
 public:
     // dispose and cycle all sources.
@@ -796,6 +804,8 @@ public:
     virtual void set_cache(bool enabled);
     virtual void set_gop_cache_max_frames(int v);
     virtual SrsRtmpJitterAlgorithm jitter();
+    // Dumps the forwarders of hub, for API.
+    virtual void dumps_forwarders(SrsJsonArray *arr);
 
 public:
     // For edge, when publish edge stream, check the state
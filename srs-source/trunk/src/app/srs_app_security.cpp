@@ -6,11 +6,353 @@
 
 #include <srs_app_security.hpp>
 
+#include <arpa/inet.h>
+#include <string.h>
+
 #include <srs_app_config.hpp>
 #include <srs_kernel_error.hpp>
+#include <srs_kernel_log.hpp>
+#include <srs_protocol_json.hpp>
 
 using namespace std;
 
+SrsSecurityRuleManager *_srs_security_rules = NULL;
+
+SrsIpTrieNode::SrsIpTrieNode()
+{
+    children_[0] = children_[1] = NULL;
+    terminal_ = false;
+}
+
+SrsIpTrieNode::~SrsIpTrieNode()
+{
+    srs_freep(children_[0]);
+    srs_freep(children_[1]);
+}
+
+SrsIpTrie::SrsIpTrie()
+{
+    ipv4_ = new SrsIpTrieNode();
+    ipv6_ = new SrsIpTrieNode();
+    all_ = false;
+}
+
+SrsIpTrie::~SrsIpTrie()
+{
+    srs_freep(ipv4_);
+    srs_freep(ipv6_);
+}
+
+srs_error_t SrsIpTrie::add(string rule)
+{
+    srs_error_t err = srs_success;
+
+    if (rule == "all") {
+        all_ = true;
+        rules_.push_back(rule);
+        return err;
+    }
+
+    // Parse the prefix length of CIDR, -1 for a single IP.
+    string addr = rule;
+    int prefix = -1;
+    size_t pos = rule.find("/");
+    if (pos != string::npos) {
+        addr = rule.substr(0, pos);
+        string length = rule.substr(pos + 1);
+        if (length.empty() || length.length() > 3 || length.find_first_not_of("0123456789") != string::npos) {
+            return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "invalid prefix of %s", rule.c_str());
+        }
+        prefix = ::atoi(length.c_str());
+    }
+
+    uint8_t buf[16];
+    if (inet_pton(AF_INET, addr.c_str(), buf) == 1) {
+        prefix = (prefix < 0) ? 32 : prefix;
+        if (prefix > 32) {
+            return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "invalid prefix of %s", rule.c_str());
+        }
+        insert(ipv4_, buf, prefix, rule);
+    } else if (inet_pton(AF_INET6, addr.c_str(), buf) == 1) {
+        prefix = (prefix < 0) ? 128 : prefix;
+        if (prefix > 128) {
+            return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "invalid prefix of %s", rule.c_str());
+        }
+        insert(ipv6_, buf, prefix, rule);
+    } else {
+        return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "invalid ip of %s", rule.c_str());
+    }
+
+    rules_.push_back(rule);
+    return err;
+}
+
+bool SrsIpTrie::match(const string &ip)
+{
+    string rule;
+    return match(ip, rule);
+}
+
+bool SrsIpTrie::match(const string &ip, string &rule)
+{
+    if (all_) {
+        rule = "all";
+        return true;
+    }
+
+    SrsIpTrieNode *node = NULL;
+    uint8_t buf[16];
+    if (inet_pton(AF_INET, ip.c_str(), buf) == 1) {
+        node = lookup(ipv4_, buf, 32);
+    } else if (inet_pton(AF_INET6, ip.c_str(), buf) == 1) {
+        node = lookup(ipv6_, buf, 128);
+
+        // For IPv4-mapped IPv6 address like ::ffff:10.0.0.1, also match the IPv4 rules.
+        static const uint8_t mapped[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff};
+        if (!node && memcmp(buf, mapped, sizeof(mapped)) == 0) {
+            node = lookup(ipv4_, buf + 12, 32);
+        }
+    }
+
+    if (node) {
+        rule = node->rule_;
+    }
+    return node != NULL;
+}
+
+int SrsIpTrie::size()
+{
+    return (int)rules_.size();
+}
+
+vector<string> &SrsIpTrie::rules()
+{
+    return rules_;
+}
+
+void SrsIpTrie::insert(SrsIpTrieNode *root, const uint8_t *addr, int prefix, const string &rule)
+{
+    SrsIpTrieNode *node = root;
+    for (int i = 0; i < prefix; i++) {
+        int bit = (addr[i / 8] >> (7 - i % 8)) & 0x01;
+        if (!node->children_[bit]) {
+            node->children_[bit] = new SrsIpTrieNode();
+        }
+        node = node->children_[bit];
+    }
+
+    // Keep the first rule, for the same prefix in different format, such as 10.0.0.1 and 10.0.0.1/32.
+    if (!node->terminal_) {
+        node->terminal_ = true;
+        node->rule_ = rule;
+    }
+}
+
+SrsIpTrieNode *SrsIpTrie::lookup(SrsIpTrieNode *root, const uint8_t *addr, int nn_bits)
+{
+    SrsIpTrieNode *node = root;
+    for (int i = 0; node; i++) {
+        // Match the shortest prefix, any matched rule is ok.
+        if (node->terminal_) {
+            return node;
+        }
+        if (i >= nn_bits) {
+            break;
+        }
+
+        int bit = (addr[i / 8] >> (7 - i % 8)) & 0x01;
+        node = node->children_[bit];
+    }
+    return NULL;
+}
+
+SrsSecurityRules::SrsSecurityRules()
+{
+    allow_play_ = new SrsIpTrie();
+    allow_publish_ = new SrsIpTrie();
+    deny_play_ = new SrsIpTrie();
+    deny_publish_ = new SrsIpTrie();
+    nn_allow_ = 0;
+    nn_deny_ = 0;
+}
+
+SrsSecurityRules::~SrsSecurityRules()
+{
+    srs_freep(allow_play_);
+    srs_freep(allow_publish_);
+    srs_freep(deny_play_);
+    srs_freep(deny_publish_);
+}
+
+void SrsSecurityRules::initialize(SrsConfDirective *rules)
+{
+    for (int i = 0; i < (int)rules->directives_.size(); i++) {
+        SrsConfDirective *rule = rules->at(i);
+
+        SrsIpTrie *play = NULL, *publish = NULL;
+        if (rule->name_ == "allow") {
+            nn_allow_++;
+            play = allow_play_;
+            publish = allow_publish_;
+        } else if (rule->name_ == "deny") {
+            nn_deny_++;
+            play = deny_play_;
+            publish = deny_publish_;
+        } else {
+            continue;
+        }
+
+        SrsIpTrie *trie = NULL;
+        if (rule->arg0() == "play") {
+            trie = play;
+        } else if (rule->arg0() == "publish") {
+            trie = publish;
+        } else {
+            continue;
+        }
+
+        // The invalid rule never matches any client, so we ignore it.
+        srs_error_t err = trie->add(rule->arg1());
+        if (err != srs_success) {
+            srs_warn("security: ignore %s %s %s, %s", rule->name_.c_str(), rule->arg0().c_str(), rule->arg1().c_str(), srs_error_desc(err).c_str());
+            srs_freep(err);
+        }
+    }
+}
+
+SrsIpTrie *SrsSecurityRules::allow(SrsRtmpConnType type)
+{
+    if (srs_client_type_is_publish(type)) {
+        return allow_publish_;
+    }
+    return (type == SrsRtmpConnUnknown) ? NULL : allow_play_;
+}
+
+SrsIpTrie *SrsSecurityRules::deny(SrsRtmpConnType type)
+{
+    if (srs_client_type_is_publish(type)) {
+        return deny_publish_;
+    }
+    return (type == SrsRtmpConnUnknown) ? NULL : deny_play_;
+}
+
+SrsSecurityRuleManager::SrsSecurityRuleManager()
+{
+    generation_ = 0;
+}
+
+SrsSecurityRuleManager::~SrsSecurityRuleManager()
+{
+    clear_rules();
+
+    std::map<std::string, SrsSecurityRules *>::iterator it;
+    for (it = blocklists_.begin(); it != blocklists_.end(); ++it) {
+        SrsSecurityRules *blocklist = it->second;
+        srs_freep(blocklist);
+    }
+    blocklists_.clear();
+}
+
+SrsSecurityRules *SrsSecurityRuleManager::fetch(int generation, SrsConfDirective *rules)
+{
+    // The config is reloaded, the directives are freed, so compile the rules again.
+    if (generation != generation_) {
+        clear_rules();
+        generation_ = generation;
+    }
+
+    std::map<SrsConfDirective *, SrsSecurityRules *>::iterator it = rules_.find(rules);
+    if (it != rules_.end()) {
+        return it->second;
+    }
+
+    SrsSecurityRules *compiled = new SrsSecurityRules();
+    compiled->initialize(rules);
+    rules_[rules] = compiled;
+
+    return compiled;
+}
+
+SrsSecurityRules *SrsSecurityRuleManager::blocklist(string vhost)
+{
+    if (blocklists_.empty()) {
+        return NULL;
+    }
+
+    std::map<std::string, SrsSecurityRules *>::iterator it = blocklists_.find(vhost);
+    return (it != blocklists_.end()) ? it->second : NULL;
+}
+
+srs_error_t SrsSecurityRuleManager::update_blocklist(string vhost, string action, const vector<string> &ips)
+{
+    srs_error_t err = srs_success;
+
+    if (action != "play" && action != "publish") {
+        return srs_error_new(ERROR_SYSTEM_SECURITY, "invalid action %s", action.c_str());
+    }
+
+    // Compile the new trie, never change the blocklist if any ip is invalid.
+    SrsIpTrie *trie = new SrsIpTrie();
+    for (int i = 0; i < (int)ips.size(); i++) {
+        if ((err = trie->add(ips.at(i))) != srs_success) {
+            srs_freep(trie);
+            return srs_error_wrap(err, "blocklist");
+        }
+    }
+
+    SrsSecurityRules *blocklist = NULL;
+    std::map<std::string, SrsSecurityRules *>::iterator it = blocklists_.find(vhost);
+    if (it != blocklists_.end()) {
+        blocklist = it->second;
+    } else {
+        blocklist = blocklists_[vhost] = new SrsSecurityRules();
+    }
+
+    SrsIpTrie *&target = (action == "play") ? blocklist->deny_play_ : blocklist->deny_publish_;
+    srs_freep(target);
+    target = trie;
+    blocklist->nn_deny_ = blocklist->deny_play_->size() + blocklist->deny_publish_->size();
+
+    // Remove the empty blocklist, for the fast path of check.
+    if (!blocklist->nn_deny_) {
+        srs_freep(blocklist);
+        blocklists_.erase(vhost);
+    }
+
+    srs_trace("security: update blocklist vhost=%s, action=%s, ips=%d", vhost.c_str(), action.c_str(), (int)ips.size());
+    return err;
+}
+
+void SrsSecurityRuleManager::dumps(SrsJsonObject *obj)
+{
+    std::map<std::string, SrsSecurityRules *>::iterator it;
+    for (it = blocklists_.begin(); it != blocklists_.end(); ++it) {
+        SrsSecurityRules *blocklist = it->second;
+
+        SrsJsonArray *play = SrsJsonAny::array();
+        for (int i = 0; i < blocklist->deny_play_->size(); i++) {
+            play->append(SrsJsonAny::str(blocklist->deny_play_->rules().at(i).c_str()));
+        }
+
+        SrsJsonArray *publish = SrsJsonAny::array();
+        for (int i = 0; i < blocklist->deny_publish_->size(); i++) {
+            publish->append(SrsJsonAny::str(blocklist->deny_publish_->rules().at(i).c_str()));
+        }
+
+        obj->set(it->first, SrsJsonAny::object()->set("play", play)->set("publish", publish));
+    }
+}
+
+void SrsSecurityRuleManager::clear_rules()
+{
+    std::map<SrsConfDirective *, SrsSecurityRules *>::iterator it;
+    for (it = rules_.begin(); it != rules_.end(); ++it) {
+        SrsSecurityRules *compiled = it->second;
+        srs_freep(compiled);
+    }
+    rules_.clear();
+}
+
 ISrsSecurity::ISrsSecurity()
 {
 }
@@ -22,17 +364,25 @@ ISrsSecurity::~ISrsSecurity()
 SrsSecurity::SrsSecurity()
 {
     config_ = _srs_config;
+    manager_ = _srs_security_rules;
 }
 
 SrsSecurity::~SrsSecurity()
 {
     config_ = NULL;
+    manager_ = NULL;
 }
 
 srs_error_t SrsSecurity::check(SrsRtmpConnType type, string ip, ISrsRequest *req)
 {
     srs_error_t err = srs_success;
 
+    // Deny if in the blocklist, which is updated by HTTP API, even if security disabled.
+    SrsSecurityRules *blocklist = manager_->blocklist(req->vhost_);
+    if (blocklist && (err = deny_check(blocklist, type, ip)) != srs_success) {
+        return srs_error_wrap(err, "blocklist for %s", ip.c_str());
+    }
+
     // allow all if security disabled.
     if (!config_->get_security_enabled(req->vhost_)) {
         return err; // OK
@@ -40,17 +390,18 @@ srs_error_t SrsSecurity::check(SrsRtmpConnType type, string ip, ISrsRequest *req
 
     // rules to apply
     SrsConfDirective *rules = config_->get_security_rules(req->vhost_);
-    return do_check(rules, type, ip, req);
+    if (!rules) {
+        return srs_error_new(ERROR_SYSTEM_SECURITY, "default deny for %s", ip.c_str());
+    }
+
+    SrsSecurityRules *compiled = manager_->fetch(config_->get_generation(), rules);
+    return do_check(compiled, type, ip);
 }
 
-srs_error_t SrsSecurity::do_check(SrsConfDirective *rules, SrsRtmpConnType type, string ip, ISrsRequest *req)
+srs_error_t SrsSecurity::do_check(SrsSecurityRules *rules, SrsRtmpConnType type, string ip)
 {
     srs_error_t err = srs_success;
 
-    if (!rules) {
-        return srs_error_new(ERROR_SYSTEM_SECURITY, "default deny for %s", ip.c_str());
-    }
-
     // deny if matches deny strategy.
     if ((err = deny_check(rules, type, ip)) != srs_success) {
         return srs_error_wrap(err, "for %s", ip.c_str());
@@ -64,115 +415,25 @@ srs_error_t SrsSecurity::do_check(SrsConfDirective *rules, SrsRtmpConnType type,
     return err;
 }
 
-srs_error_t SrsSecurity::allow_check(SrsConfDirective *rules, SrsRtmpConnType type, std::string ip)
+srs_error_t SrsSecurity::allow_check(SrsSecurityRules *rules, SrsRtmpConnType type, std::string ip)
 {
-    int allow_rules = 0;
-    int deny_rules = 0;
-
-    for (int i = 0; i < (int)rules->directives_.size(); i++) {
-        SrsConfDirective *rule = rules->at(i);
-
-        if (rule->name_ != "allow") {
-            if (rule->name_ == "deny") {
-                deny_rules++;
-            }
-            continue;
-        }
-        allow_rules++;
-
-        string cidr_ipv4 = srs_net_get_cidr_ipv4(rule->arg1());
-        string cidr_mask = srs_net_get_cidr_mask(rule->arg1());
-
-        switch (type) {
-        case SrsRtmpConnPlay:
-        case SrsHlsPlay:
-        case SrsFlvPlay:
-        case SrsRtcConnPlay:
-        case SrsSrtConnPlay:
-            if (rule->arg0() != "play") {
-                break;
-            }
-            if (rule->arg1() == "all" || rule->arg1() == ip) {
-                return srs_success; // OK
-            }
-            if (srs_net_is_ipv4(cidr_ipv4) && cidr_mask != "" && srs_net_ipv4_within_mask(ip, cidr_ipv4, cidr_mask)) {
-                return srs_success; // OK
-            }
-            break;
-        case SrsRtmpConnFMLEPublish:
-        case SrsRtmpConnFlashPublish:
-        case SrsRtmpConnHaivisionPublish:
-        case SrsRtcConnPublish:
-        case SrsSrtConnPublish:
-            if (rule->arg0() != "publish") {
-                break;
-            }
-            if (rule->arg1() == "all" || rule->arg1() == ip) {
-                return srs_success; // OK
-            }
-            if (srs_net_is_ipv4(cidr_ipv4) && cidr_mask != "" && srs_net_ipv4_within_mask(ip, cidr_ipv4, cidr_mask)) {
-                return srs_success; // OK
-            }
-            break;
-        case SrsRtmpConnUnknown:
-        default:
-            break;
-        }
+    SrsIpTrie *allow = rules->allow(type);
+    if (allow && allow->match(ip)) {
+        return srs_success; // OK
     }
 
-    if (allow_rules > 0 || (deny_rules + allow_rules) == 0) {
-        return srs_error_new(ERROR_SYSTEM_SECURITY_ALLOW, "not allowed by any of %d/%d rules", allow_rules, deny_rules);
+    if (rules->nn_allow_ > 0 || (rules->nn_deny_ + rules->nn_allow_) == 0) {
+        return srs_error_new(ERROR_SYSTEM_SECURITY_ALLOW, "not allowed by any of %d/%d rules", rules->nn_allow_, rules->nn_deny_);
     }
     return srs_success; // OK
 }
 
-srs_error_t SrsSecurity::deny_check(SrsConfDirective *rules, SrsRtmpConnType type, std::string ip)
+srs_error_t SrsSecurity::deny_check(SrsSecurityRules *rules, SrsRtmpConnType type, std::string ip)
 {
-    for (int i = 0; i < (int)rules->directives_.size(); i++) {
-        SrsConfDirective *rule = rules->at(i);
-
-        if (rule->name_ != "deny") {
-            continue;
-        }
-
-        string cidr_ipv4 = srs_net_get_cidr_ipv4(rule->arg1());
-        string cidr_mask = srs_net_get_cidr_mask(rule->arg1());
-
-        switch (type) {
-        case SrsRtmpConnPlay:
-        case SrsHlsPlay:
-        case SrsFlvPlay:
-        case SrsRtcConnPlay:
-        case SrsSrtConnPlay:
-            if (rule->arg0() != "play") {
-                break;
-            }
-            if (rule->arg1() == "all" || rule->arg1() == ip) {
-                return srs_error_new(ERROR_SYSTEM_SECURITY_DENY, "deny by rule<%s>", rule->arg1().c_str());
-            }
-            if (srs_net_is_ipv4(cidr_ipv4) && cidr_mask != "" && srs_net_ipv4_within_mask(ip, cidr_ipv4, cidr_mask)) {
-                return srs_error_new(ERROR_SYSTEM_SECURITY_DENY, "deny by rule<%s>", rule->arg1().c_str());
-            }
-            break;
-        case SrsRtmpConnFMLEPublish:
-        case SrsRtmpConnFlashPublish:
-        case SrsRtmpConnHaivisionPublish:
-        case SrsRtcConnPublish:
-        case SrsSrtConnPublish:
-            if (rule->arg0() != "publish") {
-                break;
-            }
-            if (rule->arg1() == "all" || rule->arg1() == ip) {
-                return srs_error_new(ERROR_SYSTEM_SECURITY_DENY, "deny by rule<%s>", rule->arg1().c_str());
-            }
-            if (srs_net_is_ipv4(cidr_ipv4) && cidr_mask != "" && srs_net_ipv4_within_mask(ip, cidr_ipv4, cidr_mask)) {
-                return srs_error_new(ERROR_SYSTEM_SECURITY_DENY, "deny by rule<%s>", rule->arg1().c_str());
-            }
-            break;
-        case SrsRtmpConnUnknown:
-        default:
-            break;
-        }
+    SrsIpTrie *deny = rules->deny(type);
+    string rule;
+    if (deny && deny->match(ip, rule)) {
+        return srs_error_new(ERROR_SYSTEM_SECURITY_DENY, "deny by rule<%s>", rule.c_str());
     }
 
     return srs_success; // OK
@@ -9,13 +9,125 @@
 
 #include <srs_core.hpp>
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include <srs_protocol_rtmp_stack.hpp>
 #include <srs_protocol_utility.hpp>
 
 class SrsConfDirective;
 class ISrsAppConfig;
+class SrsJsonObject;
+class SrsSecurityRuleManager;
+
+// The node of IP trie, each level is a bit of address.
+class SrsIpTrieNode
+{
+public:
+    SrsIpTrieNode *children_[2];
+    // Whether an address prefix ends at this node.
+    bool terminal_;
+    // The first rule which ends at this node, for example, 10.0.0.0/8.
+    std::string rule_;
+
+public:
+    SrsIpTrieNode();
+    virtual ~SrsIpTrieNode();
+};
+
+// The binary trie of IPv4 and IPv6 address, to match the CIDR ranges in O(prefix length).
+class SrsIpTrie
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    SrsIpTrieNode *ipv4_;
+    SrsIpTrieNode *ipv6_;
+    // Whether match all address, for rule "all".
+    bool all_;
+    // The rules added to trie.
+    std::vector<std::string> rules_;
+
+public:
+    SrsIpTrie();
+    virtual ~SrsIpTrie();
+
+public:
+    // Add a rule, which is "all", an IP, or an IP range in CIDR, such as 10.0.0.0/8 or 2001:db8::/32.
+    virtual srs_error_t add(std::string rule);
+    // Whether the ip matches any rule.
+    virtual bool match(const std::string &ip);
+    // Whether the ip matches any rule, and get the matched rule.
+    virtual bool match(const std::string &ip, std::string &rule);
+    virtual int size();
+    virtual std::vector<std::string> &rules();
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    virtual void insert(SrsIpTrieNode *root, const uint8_t *addr, int prefix, const std::string &rule);
+    // Get the node of matched rule, NULL if not matched.
+    virtual SrsIpTrieNode *lookup(SrsIpTrieNode *root, const uint8_t *addr, int nn_bits);
+};
+
+// The compiled security rules of a vhost, with tries for each action.
+class SrsSecurityRules
+{
+public:
+    SrsIpTrie *allow_play_;
+    SrsIpTrie *allow_publish_;
+    SrsIpTrie *deny_play_;
+    SrsIpTrie *deny_publish_;
+    // The number of allow and deny rules, including the rules of unknown action.
+    int nn_allow_;
+    int nn_deny_;
+
+public:
+    SrsSecurityRules();
+    virtual ~SrsSecurityRules();
+
+public:
+    // Compile the security directives of vhost, ignore the invalid rules.
+    virtual void initialize(SrsConfDirective *rules);
+    // Get the trie of client type, NULL for unknown type.
+    virtual SrsIpTrie *allow(SrsRtmpConnType type);
+    virtual SrsIpTrie *deny(SrsRtmpConnType type);
+};
+
+// The manager of compiled security rules for all vhosts, and the blocklist updated by HTTP API,
+// so we never walk the directives for each client.
+class SrsSecurityRuleManager
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The generation of config, to drop the rules compiled from old config.
+    int generation_;
+    // The compiled rules, key is the security directive of vhost, which is never changed until
+    // config is reloaded, and the vhosts without security directive use the default vhost's.
+    std::map<SrsConfDirective *, SrsSecurityRules *> rules_;
+    // The blocklist updated by HTTP API, key is the vhost. Only the deny tries are used, and
+    // they are kept when config is reloaded.
+    std::map<std::string, SrsSecurityRules *> blocklists_;
+
+public:
+    SrsSecurityRuleManager();
+    virtual ~SrsSecurityRuleManager();
+
+public:
+    // Fetch the compiled rules of security directive, compile it if config changed.
+    virtual SrsSecurityRules *fetch(int generation, SrsConfDirective *rules);
+    // Get the blocklist of vhost, NULL if not set.
+    virtual SrsSecurityRules *blocklist(std::string vhost);
+    // Replace the blocklist of vhost for action, which is play or publish.
+    virtual srs_error_t update_blocklist(std::string vhost, std::string action, const std::vector<std::string> &ips);
+    // Dumps the blocklists to json.
+    virtual void dumps(SrsJsonObject *obj);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    virtual void clear_rules();
+};
+
+extern SrsSecurityRuleManager *_srs_security_rules;
 
 // The security interface.
 class ISrsSecurity
@@ -34,6 +146,7 @@ class SrsSecurity : public ISrsSecurity
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
     ISrsAppConfig *config_;
+    SrsSecurityRuleManager *manager_;
 
 public:
     SrsSecurity();
@@ -48,9 +161,9 @@ public:
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
-    virtual srs_error_t do_check(SrsConfDirective *rules, SrsRtmpConnType type, std::string ip, ISrsRequest *req);
-    virtual srs_error_t allow_check(SrsConfDirective *rules, SrsRtmpConnType type, std::string ip);
-    virtual srs_error_t deny_check(SrsConfDirective *rules, SrsRtmpConnType type, std::string ip);
+    virtual srs_error_t do_check(SrsSecurityRules *rules, SrsRtmpConnType type, std::string ip);
+    virtual srs_error_t allow_check(SrsSecurityRules *rules, SrsRtmpConnType type, std::string ip);
+    virtual srs_error_t deny_check(SrsSecurityRules *rules, SrsRtmpConnType type, std::string ip);
 };
 
 #endif
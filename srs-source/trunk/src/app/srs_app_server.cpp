@@ -25,6 +25,7 @@ using namespace std;
 #include <srs_app_circuit_breaker.hpp>
 #include <srs_app_config.hpp>
 #include <srs_app_coworkers.hpp>
+#include <srs_app_edge.hpp>
 #include <srs_app_heartbeat.hpp>
 #include <srs_app_http_api.hpp>
 #include <srs_app_http_conn.hpp>
@@ -33,6 +34,7 @@ using namespace std;
 #include <srs_app_latest_version.hpp>
 #include <srs_app_log.hpp>
 #include <srs_app_mpegts_udp.hpp>
+#include <srs_app_process.hpp>
 #include <srs_app_reload.hpp>
 #include <srs_app_rtc_api.hpp>
 #include <srs_app_rtc_dtls.hpp>
@@ -41,6 +43,7 @@ using namespace std;
 #include <srs_app_rtc_source.hpp>
 #include <srs_app_rtmp_conn.hpp>
 #include <srs_app_rtmp_source.hpp>
+#include <srs_app_security.hpp>
 #include <srs_app_statistic.hpp>
 #include <srs_app_stream_token.hpp>
 #include <srs_app_utility.hpp>
@@ -66,6 +69,9 @@ using namespace std;
 #include <srs_app_rtsp_source.hpp>
 #endif
 #include <srs_app_factory.hpp>
+#ifdef SRS_FFMPEG_FIT
+#include <srs_app_rtc_codec.hpp>
+#endif
 
 SrsServer *_srs_server = NULL;
 
@@ -107,6 +113,11 @@ srs_error_t srs_global_initialize()
     _srs_stages = new SrsStageManager();
     _srs_sources = new SrsLiveSourceManager();
     _srs_circuit_breaker = new SrsCircuitBreaker();
+    _srs_security_rules = new SrsSecurityRuleManager();
+    _srs_edge_token_traverse = new SrsEdgeTokenTraverse();
+    _srs_edge_pull_stat = new SrsEdgePullStat();
+    _srs_cluster_directory = new SrsClusterDirectory();
+    _srs_process_supervisor = new SrsProcessSupervisor();
 
     // Initialize global statistic instance before _srs_hooks, as SrsHttpHooks depends on it.
     _srs_stat = new SrsStatistic();
@@ -123,6 +134,10 @@ srs_error_t srs_global_initialize()
 
     _srs_conn_manager = new SrsResourceManager("RTC", true);
     _srs_rtc_dtls_certificate = new SrsDtlsCertificate();
+    _srs_dtls_handshakes = new SrsDtlsHandshakeStat();
+#ifdef SRS_FFMPEG_FIT
+    _srs_audio_transcoders = new SrsAudioTranscoderPool();
+#endif
 #ifdef SRS_RTSP
     _srs_rtsp_sources = new SrsRtspSourceManager();
     _srs_rtsp_manager = new SrsResourceManager("RTSP", true);
@@ -176,6 +191,7 @@ SrsServer::SrsServer()
     signal_gmc_stop_ = false;
     signal_fast_quit_ = false;
     signal_gracefully_quit_ = false;
+    kbps_cursor_ = 0;
 
     pid_file_locker_ = new SrsPidFileLocker();
 
@@ -492,6 +508,11 @@ srs_error_t SrsServer::run()
         return srs_error_wrap(err, "init circuit breaker");
     }
 
+    // Pin SRS to the cpus, before starting any FFmpeg process.
+    if ((err = _srs_process_supervisor->initialize()) != srs_success) {
+        return srs_error_wrap(err, "init supervisor");
+    }
+
     // Initialize the whole system, set hooks to handle server level events.
     if ((err = initialize_st()) != srs_success) {
         return srs_error_wrap(err, "initialize st");
@@ -826,10 +847,22 @@ srs_error_t SrsServer::http_handle()
         return srs_error_wrap(err, "handle raw");
     }
 
+    if ((err = http_api_mux_->handle("/api/v1/security", new SrsGoApiSecurity())) != srs_success) {
+        return srs_error_wrap(err, "handle security");
+    }
+
     if ((err = http_api_mux_->handle("/api/v1/clusters", new SrsGoApiClusters())) != srs_success) {
         return srs_error_wrap(err, "handle clusters");
     }
 
+    if ((err = http_api_mux_->handle("/api/v1/forwards", new SrsGoApiForwards())) != srs_success) {
+        return srs_error_wrap(err, "handle forwards");
+    }
+
+    if ((err = http_api_mux_->handle("/api/v1/processes", new SrsGoApiProcesses())) != srs_success) {
+        return srs_error_wrap(err, "handle processes");
+    }
+
     // test the request info.
     if ((err = http_api_mux_->handle("/api/v1/tests/requests", new SrsGoApiRequests())) != srs_success) {
         return srs_error_wrap(err, "handle tests requests");
@@ -1149,7 +1182,9 @@ srs_error_t SrsServer::setup_ticks()
             return srs_error_wrap(err, "tick");
         }
 
-        if ((err = timer_->tick(8, 3 * SRS_UTIME_SECONDS)) != srs_success) {
+        // Resample kbps every 1s, to collect a slice of connections each time, so all
+        // connections are still collected every SRS_STAT_KBPS_ROUNDS seconds.
+        if ((err = timer_->tick(8, 1 * SRS_UTIME_SECONDS)) != srs_success) {
             return srs_error_wrap(err, "tick");
         }
 
@@ -1222,9 +1257,16 @@ srs_error_t SrsServer::notify(int event, srs_utime_t interval, srs_utime_t tick)
 // LCOV_EXCL_START
 void SrsServer::resample_kbps()
 {
-    // collect delta from all clients.
-    for (int i = 0; i < (int)conn_manager_->size(); i++) {
-        ISrsResource *c = conn_manager_->at(i);
+    // Collect delta from a slice of clients, continue from the last one, so the work is spread across
+    // ticks. It's ok to collect later, because the delta is accumulated by the connection.
+    int nn_conns = (int)conn_manager_->size();
+    int max_collects = (nn_conns + SRS_STAT_KBPS_ROUNDS - 1) / SRS_STAT_KBPS_ROUNDS;
+    if (kbps_cursor_ >= nn_conns) {
+        kbps_cursor_ = 0;
+    }
+
+    for (int i = 0; i < max_collects && kbps_cursor_ < nn_conns; i++) {
+        ISrsResource *c = conn_manager_->at(kbps_cursor_++);
 
         SrsRtmpConn *rtmp = dynamic_cast<SrsRtmpConn *>(c);
         if (rtmp) {
@@ -1415,13 +1457,14 @@ srs_error_t SrsServer::listen_rtc_udp()
 
         for (int i = 0; i < nn_listeners; i++) {
             SrsUdpMuxListener *listener = new SrsUdpMuxListener(this, ip, port);
+            listener->set_recv_batch(config_->get_rtc_server_recv_batch());
 
             if ((err = listener->listen()) != srs_success) {
                 srs_freep(listener);
                 return srs_error_wrap(err, "listen %s:%d", ip.c_str(), port);
             }
 
-            srs_trace("WebRTC listen at udp://%s:%d, fd=%d", ip.c_str(), port, listener->fd());
+            srs_trace("WebRTC listen at udp://%s:%d, fd=%d, batch=%d", ip.c_str(), port, listener->fd(), config_->get_rtc_server_recv_batch());
             rtc_listeners_.push_back(listener);
         }
     }
@@ -228,6 +228,8 @@ SRS_DECLARE_PRIVATE: // clang-format on
     bool signal_gracefully_quit_;
     // Parent pid for asprocess.
     int ppid_;
+    // The index of next connection to collect kbps delta, see resample_kbps().
+    int kbps_cursor_;
 
 public:
     SrsServer();
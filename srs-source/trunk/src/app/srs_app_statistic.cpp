@@ -27,6 +27,94 @@ string srs_generate_stat_vid()
     return "vid-" + rand.gen_str(7);
 }
 
+SrsStatisticPage::SrsStatisticPage()
+{
+    start_ = 0;
+    count_ = 0;
+}
+
+SrsStatisticPage::~SrsStatisticPage()
+{
+}
+
+bool SrsStatisticPage::selected(const char *field)
+{
+    if (fields_.empty()) {
+        return true;
+    }
+
+    for (int i = 0; i < (int)fields_.size(); i++) {
+        if (fields_[i] == field) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+srs_error_t SrsStatisticPage::check_fields(const char **known)
+{
+    for (int i = 0; i < (int)fields_.size(); i++) {
+        const std::string &field = fields_[i];
+
+        bool found = false;
+        for (const char **p = known; *p && !found; p++) {
+            found = (field == *p);
+        }
+
+        if (!found) {
+            return srs_error_new(ERROR_HTTP_API_FIELDS, "unknown field %s", field.c_str());
+        }
+    }
+
+    return srs_success;
+}
+
+const char *srs_stat_stream_fields[] = {
+    "id", "name", "vhost", "app", "tcUrl", "url", "live_ms", "clients", "frames", "send_bytes", "recv_bytes",
+    "kbps", "publish", "video", "audio", "nack_cache", NULL};
+
+const char *srs_stat_client_fields[] = {
+    "id", "vhost", "stream", "ip", "pageUrl", "swfUrl", "tcUrl", "url", "name", "type", "publish", "alive",
+    "send_bytes", "recv_bytes", "kbps", NULL};
+
+// Dumps a page of objects, ordered by id, to the streaming JSON writer. Because the writer might
+// yield when flushing, objects might be removed, so we always find the next object by id.
+template <typename T>
+srs_error_t srs_stat_dumps_page(std::map<std::string, T *> &objs, SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    srs_error_t err = srs_success;
+
+    typename std::map<std::string, T *>::iterator it = objs.begin();
+    if (!page->cursor_.empty()) {
+        it = objs.upper_bound(page->cursor_);
+    } else {
+        for (int i = 0; i < page->start_ && it != objs.end(); i++) {
+            it++;
+        }
+    }
+
+    std::string last;
+    for (int i = 0; i < page->count_ && it != objs.end(); i++) {
+        T *obj = it->second;
+        last = it->first;
+
+        if ((err = obj->dumps(jw, page)) != srs_success) {
+            return srs_error_wrap(err, "dump %s", last.c_str());
+        }
+
+        if ((err = jw->flush()) != srs_success) {
+            return srs_error_wrap(err, "flush");
+        }
+
+        it = objs.upper_bound(last);
+    }
+
+    page->next_ = (it != objs.end()) ? last : "";
+
+    return err;
+}
+
 SrsStatisticVhost::SrsStatisticVhost()
 {
     id_ = srs_generate_stat_vid();
@@ -94,6 +182,10 @@ SrsStatisticStream::SrsStatisticStream()
     width_ = 0;
     height_ = 0;
 
+    has_nack_cache_ = false;
+    nack_cache_packets_ = 0;
+    nack_cache_bytes_ = 0;
+
     kbps_ = new SrsKbps();
 
     nb_clients_ = 0;
@@ -171,6 +263,152 @@ srs_error_t SrsStatisticStream::dumps(SrsJsonObject *obj)
         audio->set("profile", SrsJsonAny::str(srs_aac_object2str(aac_object_).c_str()));
     }
 
+    if (has_nack_cache_) {
+        SrsJsonObject *nack_cache = SrsJsonAny::object();
+        obj->set("nack_cache", nack_cache);
+
+        nack_cache->set("packets", SrsJsonAny::integer(nack_cache_packets_));
+        nack_cache->set("bytes", SrsJsonAny::integer(nack_cache_bytes_));
+    }
+
+    return err;
+}
+
+srs_error_t SrsStatisticStream::dumps(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    srs_error_t err = srs_success;
+
+    jw->object_start();
+
+    if (page->selected("id")) {
+        jw->key("id");
+        jw->str(id_);
+    }
+    if (page->selected("name")) {
+        jw->key("name");
+        jw->str(stream_);
+    }
+    if (page->selected("vhost")) {
+        jw->key("vhost");
+        jw->str(vhost_->id_);
+    }
+    if (page->selected("app")) {
+        jw->key("app");
+        jw->str(app_);
+    }
+    if (page->selected("tcUrl")) {
+        jw->key("tcUrl");
+        jw->str(tcUrl_);
+    }
+    if (page->selected("url")) {
+        jw->key("url");
+        jw->str(url_);
+    }
+    if (page->selected("live_ms")) {
+        jw->key("live_ms");
+        jw->integer(srsu2ms(srs_time_now_cached()));
+    }
+    if (page->selected("clients")) {
+        jw->key("clients");
+        jw->integer(nb_clients_);
+    }
+    if (page->selected("frames")) {
+        jw->key("frames");
+        jw->integer(frames_->sugar_);
+    }
+    if (page->selected("send_bytes")) {
+        jw->key("send_bytes");
+        jw->integer(kbps_->get_send_bytes());
+    }
+    if (page->selected("recv_bytes")) {
+        jw->key("recv_bytes");
+        jw->integer(kbps_->get_recv_bytes());
+    }
+
+    if (page->selected("kbps")) {
+        jw->key("kbps");
+        jw->object_start();
+        jw->key("recv_30s");
+        jw->integer(kbps_->get_recv_kbps_30s());
+        jw->key("send_30s");
+        jw->integer(kbps_->get_send_kbps_30s());
+        jw->object_end();
+    }
+
+    if (page->selected("publish")) {
+        jw->key("publish");
+        jw->object_start();
+        jw->key("active");
+        jw->boolean(active_);
+        if (!publisher_id_.empty()) {
+            jw->key("cid");
+            jw->str(publisher_id_);
+        }
+        jw->object_end();
+    }
+
+    if (page->selected("video")) {
+        jw->key("video");
+        if (!has_video_) {
+            jw->null();
+        } else {
+            jw->object_start();
+            jw->key("codec");
+            jw->str(srs_video_codec_id2str(vcodec_));
+
+            jw->key("profile");
+            if (vcodec_ == SrsVideoCodecIdAVC) {
+                jw->str(srs_avc_profile2str(avc_profile_));
+                jw->key("level");
+                jw->str(srs_avc_level2str(avc_level_));
+            } else if (vcodec_ == SrsVideoCodecIdHEVC) {
+                jw->str(srs_hevc_profile2str(hevc_profile_));
+                jw->key("level");
+                jw->str(srs_hevc_level2str(hevc_level_));
+            } else {
+                jw->str("Other");
+                jw->key("level");
+                jw->str("Other");
+            }
+
+            jw->key("width");
+            jw->integer(width_);
+            jw->key("height");
+            jw->integer(height_);
+            jw->object_end();
+        }
+    }
+
+    if (page->selected("audio")) {
+        jw->key("audio");
+        if (!has_audio_) {
+            jw->null();
+        } else {
+            jw->object_start();
+            jw->key("codec");
+            jw->str(srs_audio_codec_id2str(acodec_));
+            jw->key("sample_rate");
+            jw->integer(srs_audio_sample_rate2number(asample_rate_));
+            jw->key("channel");
+            jw->integer(asound_type_ + 1);
+            jw->key("profile");
+            jw->str(srs_aac_object2str(aac_object_));
+            jw->object_end();
+        }
+    }
+
+    if (has_nack_cache_ && page->selected("nack_cache")) {
+        jw->key("nack_cache");
+        jw->object_start();
+        jw->key("packets");
+        jw->integer(nack_cache_packets_);
+        jw->key("bytes");
+        jw->integer(nack_cache_bytes_);
+        jw->object_end();
+    }
+
+    jw->object_end();
+
     return err;
 }
 
@@ -196,6 +434,7 @@ void SrsStatisticStream::close()
 
     has_video_ = false;
     has_audio_ = false;
+    has_nack_cache_ = false;
     active_ = false;
 
     vhost_->nb_streams_--;
@@ -246,6 +485,84 @@ srs_error_t SrsStatisticClient::dumps(SrsJsonObject *obj)
     return err;
 }
 
+srs_error_t SrsStatisticClient::dumps(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    srs_error_t err = srs_success;
+
+    jw->object_start();
+
+    if (page->selected("id")) {
+        jw->key("id");
+        jw->str(id_);
+    }
+    if (page->selected("vhost")) {
+        jw->key("vhost");
+        jw->str(stream_->vhost_->id_);
+    }
+    if (page->selected("stream")) {
+        jw->key("stream");
+        jw->str(stream_->id_);
+    }
+    if (page->selected("ip")) {
+        jw->key("ip");
+        jw->str(req_->ip_);
+    }
+    if (page->selected("pageUrl")) {
+        jw->key("pageUrl");
+        jw->str(req_->pageUrl_);
+    }
+    if (page->selected("swfUrl")) {
+        jw->key("swfUrl");
+        jw->str(req_->swfUrl_);
+    }
+    if (page->selected("tcUrl")) {
+        jw->key("tcUrl");
+        jw->str(req_->tcUrl_);
+    }
+    if (page->selected("url")) {
+        jw->key("url");
+        jw->str(req_->get_stream_url());
+    }
+    if (page->selected("name")) {
+        jw->key("name");
+        jw->str(req_->stream_);
+    }
+    if (page->selected("type")) {
+        jw->key("type");
+        jw->str(srs_client_type_string(type_));
+    }
+    if (page->selected("publish")) {
+        jw->key("publish");
+        jw->boolean(srs_client_type_is_publish(type_));
+    }
+    if (page->selected("alive")) {
+        jw->key("alive");
+        jw->number(srsu2ms(srs_time_now_cached() - create_) / 1000.0);
+    }
+    if (page->selected("send_bytes")) {
+        jw->key("send_bytes");
+        jw->integer(kbps_->get_send_bytes());
+    }
+    if (page->selected("recv_bytes")) {
+        jw->key("recv_bytes");
+        jw->integer(kbps_->get_recv_bytes());
+    }
+
+    if (page->selected("kbps")) {
+        jw->key("kbps");
+        jw->object_start();
+        jw->key("recv_30s");
+        jw->integer(kbps_->get_recv_kbps_30s());
+        jw->key("send_30s");
+        jw->integer(kbps_->get_send_kbps_30s());
+        jw->object_end();
+    }
+
+    jw->object_end();
+
+    return err;
+}
+
 ISrsStatistic::ISrsStatistic()
 {
 }
@@ -259,6 +576,7 @@ SrsStatistic *_srs_stat = NULL;
 SrsStatistic::SrsStatistic()
 {
     kbps_ = new SrsKbps();
+    sample_ticks_ = 0;
 
     nb_clients_ = 0;
     nb_errs_ = 0;
@@ -415,6 +733,16 @@ void SrsStatistic::on_stream_close(ISrsRequest *req)
     stream->close();
 }
 
+void SrsStatistic::on_rtc_nack_cache(ISrsRequest *req, int nn_packets, int64_t nn_bytes)
+{
+    SrsStatisticVhost *vhost = create_vhost(req);
+    SrsStatisticStream *stream = create_stream(vhost, req);
+
+    stream->has_nack_cache_ = true;
+    stream->nack_cache_packets_ = nn_packets;
+    stream->nack_cache_bytes_ = nn_bytes;
+}
+
 srs_error_t SrsStatistic::on_client(std::string id, ISrsRequest *req, ISrsExpire *conn, SrsRtmpConnType type)
 {
     srs_error_t err = srs_success;
@@ -545,16 +873,38 @@ void SrsStatistic::kbps_sample()
             stream->frames_->update();
         }
     }
-    if (true) {
-        std::map<std::string, SrsStatisticClient *>::iterator it;
-        for (it = clients_.begin(); it != clients_.end(); it++) {
-            SrsStatisticClient *client = it->second;
-            client->kbps_->sample();
-        }
+
+    // Clients are much more than streams, so we only sample a slice of them.
+    sample_clients();
+
+    // Update server level data, once per round of clients.
+    if ((sample_ticks_++ % SRS_STAT_KBPS_ROUNDS) == 0) {
+        srs_update_rtmp_server((int)clients_.size(), kbps_);
     }
+}
 
-    // Update server level data.
-    srs_update_rtmp_server((int)clients_.size(), kbps_);
+void SrsStatistic::sample_clients()
+{
+    int nn_clients = (int)clients_.size();
+    int max_samples = (nn_clients + SRS_STAT_KBPS_ROUNDS - 1) / SRS_STAT_KBPS_ROUNDS;
+
+    // Continue from the last sampled client, note that the client might be removed, so we
+    // use the upper bound of it.
+    std::map<std::string, SrsStatisticClient *>::iterator it = clients_.begin();
+    if (!sample_cursor_.empty()) {
+        it = clients_.upper_bound(sample_cursor_);
+    }
+
+    for (int i = 0; i < max_samples && it != clients_.end(); i++, it++) {
+        SrsStatisticClient *client = it->second;
+        client->kbps_->sample();
+        sample_cursor_ = it->first;
+    }
+
+    // Restart from the first client in next round.
+    if (it == clients_.end()) {
+        sample_cursor_ = "";
+    }
 }
 
 std::string SrsStatistic::server_id()
@@ -649,6 +999,16 @@ srs_error_t SrsStatistic::dumps_clients(SrsJsonArray *arr, int start, int count)
     return err;
 }
 
+srs_error_t SrsStatistic::dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_stat_dumps_page(streams_, jw, page);
+}
+
+srs_error_t SrsStatistic::dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_stat_dumps_page(clients_, jw, page);
+}
+
 void SrsStatistic::dumps_hints_kv(std::stringstream &ss)
 {
     if (!streams_.empty()) {
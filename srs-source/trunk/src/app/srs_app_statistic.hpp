@@ -23,11 +23,50 @@ class ISrsRequest;
 class ISrsExpire;
 class SrsJsonObject;
 class SrsJsonArray;
+class SrsJsonWriter;
 class ISrsKbpsDelta;
 class SrsClsSugar;
 class SrsClsSugars;
 class SrsPps;
 
+// The kbps of clients is sampled in rounds, each tick of kbps_sample() only samples a slice
+// of clients, so a client is sampled once every SRS_STAT_KBPS_ROUNDS ticks. This spreads the
+// work of lots of connections across ticks, instead of walking all of them in one tick.
+#define SRS_STAT_KBPS_ROUNDS 3
+
+// The page of streams or clients to dump in streaming JSON, see SrsStatistic::dumps_clients().
+class SrsStatisticPage
+{
+public:
+    // Dump objects after the cursor, which is the id of last object in previous page, because
+    // objects are ordered by id. Use start index if cursor is empty.
+    std::string cursor_;
+    // The start index, from 0, only used when cursor is empty.
+    int start_;
+    // The max count of objects to dump.
+    int count_;
+    // The fields of object to dump, for example, id,ip,kbps. Dump all fields if empty.
+    std::vector<std::string> fields_;
+
+public:
+    // The cursor for next page, empty if no more objects.
+    std::string next_;
+
+public:
+    SrsStatisticPage();
+    virtual ~SrsStatisticPage();
+
+public:
+    // Whether the field is selected to dump.
+    bool selected(const char *field);
+    // Check the selected fields, which must be in the known fields, ended by NULL.
+    srs_error_t check_fields(const char **known);
+};
+
+// The known fields of stream and client, ended by NULL, to check the fields of page.
+extern const char *srs_stat_stream_fields[];
+extern const char *srs_stat_client_fields[];
+
 struct SrsStatisticVhost {
 public:
     std::string id_;
@@ -92,12 +131,20 @@ public:
     //           in ISO_IEC_14496-3-AAC-2001.pdf.
     SrsAacObjectType aac_object_;
 
+public:
+    // The shared NACK cache of RTC stream, see SrsRtpNackCache.
+    bool has_nack_cache_;
+    int nack_cache_packets_;
+    int64_t nack_cache_bytes_;
+
 public:
     SrsStatisticStream();
     virtual ~SrsStatisticStream();
 
 public:
     virtual srs_error_t dumps(SrsJsonObject *obj);
+    // Dumps the selected fields of stream to streaming JSON writer.
+    virtual srs_error_t dumps(SrsJsonWriter *jw, SrsStatisticPage *page);
 
 public:
     // Publish the stream, id is the publisher.
@@ -128,6 +175,8 @@ public:
 
 public:
     virtual srs_error_t dumps(SrsJsonObject *obj);
+    // Dumps the selected fields of client to streaming JSON writer.
+    virtual srs_error_t dumps(SrsJsonWriter *jw, SrsStatisticPage *page);
 };
 
 // The interface for statistic.
@@ -171,6 +220,10 @@ public:
     virtual srs_error_t dumps_streams(SrsJsonArray *arr, int start, int count) = 0;
     // Dumps the clients to json array.
     virtual srs_error_t dumps_clients(SrsJsonArray *arr, int start, int count) = 0;
+    // Dumps a page of streams to streaming JSON writer.
+    virtual srs_error_t dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page) = 0;
+    // Dumps a page of clients to streaming JSON writer.
+    virtual srs_error_t dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page) = 0;
     // Dumps exporter metrics.
     virtual srs_error_t dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs) = 0;
 };
@@ -212,6 +265,10 @@ SRS_DECLARE_PRIVATE: // clang-format on
         clients_;
     // The server total kbps.
     SrsKbps *kbps_;
+    // The id of last sampled client, to continue sampling in next tick.
+    std::string sample_cursor_;
+    // The ticks of kbps_sample(), to update the server level data once per round.
+    int64_t sample_ticks_;
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
@@ -246,6 +303,8 @@ public:
     virtual void on_stream_publish(ISrsRequest *req, std::string publisher_id);
     // When close stream.
     virtual void on_stream_close(ISrsRequest *req);
+    // When RTC stream updates the memory of shared NACK cache.
+    virtual void on_rtc_nack_cache(ISrsRequest *req, int nn_packets, int64_t nn_bytes);
 
 public:
     // When got a client to publish/play stream,
@@ -269,9 +328,15 @@ public:
     // Sample the kbps, add delta bytes of conn.
     // Use kbps_sample() to get all result of kbps stat.
     virtual void kbps_add_delta(std::string id, ISrsKbpsDelta *delta);
-    // Calc the result for all kbps.
+    // Calc the result for all kbps, while the clients are sampled incrementally, a slice of
+    // clients per call, see SRS_STAT_KBPS_ROUNDS.
     virtual void kbps_sample();
 
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Sample a slice of clients from the cursor, restart from the first client at the end.
+    virtual void sample_clients();
+
 public:
     // Get the server id, used to identify the server.
     // For example, when restart, the server id must changed.
@@ -290,6 +355,11 @@ public:
     // @param start the start index, from 0.
     // @param count the max count of clients to dump.
     virtual srs_error_t dumps_clients(SrsJsonArray *arr, int start, int count);
+    // Dumps a page of streams to streaming JSON writer, without building the JSON tree. The writer
+    // is flushed after each stream, so it might yield, and the page continues by the id of stream.
+    virtual srs_error_t dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page);
+    // Dumps a page of clients to streaming JSON writer, see dumps_streams().
+    virtual srs_error_t dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page);
     // Dumps the hints about SRS server.
     void dumps_hints_kv(std::stringstream &ss);
 
@@ -9,6 +9,9 @@
 #include <arpa/inet.h>
 #include <ifaddrs.h>
 #include <netdb.h>
+#if !defined(SRS_OSX)
+#include <sched.h>
+#endif
 #include <signal.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -24,6 +27,9 @@
 using namespace std;
 
 #include <srs_app_config.hpp>
+#include <srs_app_edge.hpp>
+#include <srs_app_http_hooks.hpp>
+#include <srs_app_log.hpp>
 #include <srs_kernel_buffer.hpp>
 #include <srs_kernel_error.hpp>
 #include <srs_kernel_kbps.hpp>
@@ -397,16 +403,26 @@ bool get_proc_system_stat(SrsProcSystemStat &r)
 }
 
 bool get_proc_self_stat(SrsProcSelfStat &r)
+{
+    return get_proc_stat(0, r);
+}
+
+bool get_proc_stat(int pid, SrsProcSelfStat &r)
 {
 #if !defined(SRS_OSX)
-    FILE *f = fopen("/proc/self/stat", "r");
+    string path = "/proc/self/stat";
+    if (pid > 0) {
+        path = "/proc/" + srs_strconv_format_int(pid) + "/stat";
+    }
+
+    FILE *f = fopen(path.c_str(), "r");
     if (f == NULL) {
-        srs_warn("open self cpu stat failed, ignore");
+        srs_warn("open %s failed, ignore", path.c_str());
         return false;
     }
 
     // Note that we must read less than the size of r.comm_, such as %31s for r.comm_ is char[32].
-    fscanf(f, "%d %31s %c %d %d %d %d "
+    int nn = fscanf(f, "%d %31s %c %d %d %d %d "
               "%d %u %lu %lu %lu %lu "
               "%lu %lu %ld %ld %ld %ld "
               "%ld %ld %llu %lu %ld "
@@ -426,6 +442,11 @@ bool get_proc_self_stat(SrsProcSelfStat &r)
            &r.guest_time_, &r.cguest_time_);
 
     fclose(f);
+
+    // The process might exit when reading, so the fields are incomplete.
+    if (nn < 24) {
+        return false;
+    }
 #endif
 
     r.ok_ = true;
@@ -494,6 +515,71 @@ void srs_update_proc_stat()
     }
 }
 
+srs_error_t srs_parse_cpus(string cpus, vector<int> &cores)
+{
+    srs_error_t err = srs_success;
+
+    vector<string> ranges = srs_strings_split(cpus, ",");
+    for (int i = 0; i < (int)ranges.size(); i++) {
+        string range = srs_strings_trim_start(srs_strings_trim_end(ranges.at(i), " "), " ");
+        if (range.empty()) {
+            continue;
+        }
+
+        string first = range, last = range;
+        size_t pos = range.find("-");
+        if (pos != string::npos) {
+            first = range.substr(0, pos);
+            last = range.substr(pos + 1);
+        }
+
+        if (first.empty() || last.empty() || first.find_first_not_of("0123456789") != string::npos || last.find_first_not_of("0123456789") != string::npos) {
+            return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "invalid cpus %s", cpus.c_str());
+        }
+
+        int from = ::atoi(first.c_str()), to = ::atoi(last.c_str());
+        if (from > to || to >= 1024) {
+            return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "invalid cpus %s", cpus.c_str());
+        }
+
+        for (int core = from; core <= to; core++) {
+            cores.push_back(core);
+        }
+    }
+
+    return err;
+}
+
+// LCOV_EXCL_START
+srs_error_t srs_set_cpu_affinity(int pid, string cpus)
+{
+    srs_error_t err = srs_success;
+
+    vector<int> cores;
+    if ((err = srs_parse_cpus(cpus, cores)) != srs_success) {
+        return srs_error_wrap(err, "parse");
+    }
+
+    if (cores.empty()) {
+        return err;
+    }
+
+#if !defined(SRS_OSX)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int i = 0; i < (int)cores.size(); i++) {
+        CPU_SET(cores.at(i), &set);
+    }
+
+    if (sched_setaffinity(pid, sizeof(set), &set) < 0) {
+        return srs_error_new(ERROR_SYSTEM_CONFIG_INVALID, "set affinity pid=%d, cpus=%s", pid, cpus.c_str());
+    }
+#endif
+
+    return err;
+}
+// LCOV_EXCL_STOP
+
 SrsDiskStat::SrsDiskStat()
 {
     ok_ = false;
@@ -1371,6 +1457,36 @@ void srs_api_dump_summaries(SrsJsonObject *obj)
     self->set("cpu_percent", SrsJsonAny::number(u->percent_));
     self->set("srs_uptime", SrsJsonAny::integer(srs_uptime));
 
+    // The stat of log, to check the throughput and dropped logs.
+    SrsFileLog *flog = dynamic_cast<SrsFileLog *>(_srs_log);
+    if (flog) {
+        SrsJsonObject *log = SrsJsonAny::object();
+        self->set("log", log);
+        flog->dumps(log);
+    }
+
+    // The stat of http hooks, to check the latency and the reused connections.
+    SrsHttpHooks *hooks = dynamic_cast<SrsHttpHooks *>(_srs_hooks);
+    if (hooks) {
+        SrsJsonObject *obj = SrsJsonAny::object();
+        self->set("hooks", obj);
+        hooks->dumps(obj);
+    }
+
+    // The stat of edge token traverse, to check how many checks are served by cache.
+    if (_srs_edge_token_traverse) {
+        SrsJsonObject *obj = SrsJsonAny::object();
+        self->set("token_traverse", obj);
+        _srs_edge_token_traverse->dumps(obj);
+    }
+
+    // The stat of edge pull, to check the time to first frame, the hedged connects and warm pulls.
+    if (_srs_edge_pull_stat) {
+        SrsJsonObject *obj = SrsJsonAny::object();
+        self->set("edge_pull", obj);
+        _srs_edge_pull_stat->dumps(obj);
+    }
+
     // system
     SrsJsonObject *sys = SrsJsonAny::object();
     data->set("system", sys);
@@ -361,6 +361,14 @@ extern void srs_update_proc_stat();
 // Read process self stat from /proc/self/stat (Linux only).
 // @return true on success, false on failure.
 extern bool get_proc_self_stat(SrsProcSelfStat &r);
+// Read process stat from /proc/[pid]/stat (Linux only), the pid 0 is self.
+// @return true on success, false on failure.
+extern bool get_proc_stat(int pid, SrsProcSelfStat &r);
+
+// Parse the cpus in list format of taskset, for example, 0-2,4 is cores 0,1,2,4.
+extern srs_error_t srs_parse_cpus(std::string cpus, std::vector<int> &cores);
+// Pin the process to the cpus, the pid 0 is self, ignore if cpus is empty.
+extern srs_error_t srs_set_cpu_affinity(int pid, std::string cpus);
 
 // Stat disk iops
 // @see: http://stackoverflow.com/questions/4458183/how-the-util-of-iostat-is-computed
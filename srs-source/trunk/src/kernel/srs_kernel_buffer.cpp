@@ -563,11 +563,15 @@ SrsMemoryBlock::SrsMemoryBlock()
 {
     payload_ = NULL;
     size_ = 0;
+    flv_tag_ = NULL;
+    flv_tag_timestamp_ = 0;
+    parent_ = NULL;
 }
 
 SrsMemoryBlock::~SrsMemoryBlock()
 {
-    srs_freepa(payload_);
+    free_payload();
+    srs_freepa(flv_tag_);
 }
 
 void SrsMemoryBlock::create(int size)
@@ -575,7 +579,8 @@ void SrsMemoryBlock::create(int size)
     srs_assert(size >= 0);
 
     // Free existing payload
-    srs_freepa(payload_);
+    free_payload();
+    srs_freepa(flv_tag_);
 
     // Allocate new buffer
     if (size > 0) {
@@ -606,9 +611,127 @@ void SrsMemoryBlock::attach(char *data, int size)
     srs_assert(size >= 0);
 
     // Free existing payload
-    srs_freepa(payload_);
+    free_payload();
+    srs_freepa(flv_tag_);
 
     // Attach new buffer
     payload_ = data;
     size_ = size;
 }
+
+void SrsMemoryBlock::attach(SrsSharedPtr<SrsMemoryBlock> parent, char *data, int size)
+{
+    srs_assert(size >= 0);
+    srs_assert(parent.get() && data >= parent->payload() && data + size <= parent->payload() + parent->size());
+
+    // Free existing payload
+    free_payload();
+    srs_freepa(flv_tag_);
+
+    // Refer to the range of parent, which is never freed by this block.
+    parent_ = new SrsSharedPtr<SrsMemoryBlock>(parent);
+    payload_ = data;
+    size_ = size;
+}
+
+void SrsMemoryBlock::free_payload()
+{
+    if (parent_) {
+        payload_ = NULL;
+        srs_freep(parent_);
+    } else {
+        srs_freepa(payload_);
+    }
+}
+
+char *SrsMemoryBlock::create_flv_tag(int size, int64_t timestamp)
+{
+    srs_assert(size > 0);
+
+    srs_freepa(flv_tag_);
+    flv_tag_ = new char[size];
+    flv_tag_timestamp_ = timestamp;
+
+    return flv_tag_;
+}
+
+SrsFreeListPool::SrsFreeListPool(int max_size, int max_free)
+{
+    int nn_classes = (max_size + SRS_FREE_LIST_ALIGN - 1) / SRS_FREE_LIST_ALIGN;
+    heads_.resize(nn_classes, NULL);
+    sizes_.resize(nn_classes, 0);
+
+    max_free_ = max_free;
+    nn_reused_ = 0;
+    nn_allocated_ = 0;
+}
+
+SrsFreeListPool::~SrsFreeListPool()
+{
+    shrink();
+}
+
+void *SrsFreeListPool::alloc(size_t size)
+{
+    int index = size_class(size);
+    if (index >= 0 && heads_[index]) {
+        void *p = heads_[index];
+        heads_[index] = *(void **)p;
+        sizes_[index]--;
+        nn_reused_++;
+        return p;
+    }
+
+    nn_allocated_++;
+
+    // Always allocate the whole size class, so the object can be reused by any
+    // object of the same class.
+    if (index >= 0) {
+        return ::operator new((index + 1) * SRS_FREE_LIST_ALIGN);
+    }
+    return ::operator new(size);
+}
+
+void SrsFreeListPool::free(void *p, size_t size)
+{
+    if (!p) {
+        return;
+    }
+
+    int index = size_class(size);
+    if (index < 0 || sizes_[index] >= max_free_) {
+        ::operator delete(p);
+        return;
+    }
+
+    *(void **)p = heads_[index];
+    heads_[index] = p;
+    sizes_[index]++;
+}
+
+void SrsFreeListPool::shrink()
+{
+    for (int i = 0; i < (int)heads_.size(); i++) {
+        while (heads_[i]) {
+            void *p = heads_[i];
+            heads_[i] = *(void **)p;
+            ::operator delete(p);
+        }
+        sizes_[i] = 0;
+    }
+}
+
+int SrsFreeListPool::nn_free()
+{
+    int nn = 0;
+    for (int i = 0; i < (int)sizes_.size(); i++) {
+        nn += sizes_[i];
+    }
+    return nn;
+}
+
+int SrsFreeListPool::size_class(size_t size)
+{
+    int index = (int)((size + SRS_FREE_LIST_ALIGN - 1) / SRS_FREE_LIST_ALIGN) - 1;
+    return (index >= 0 && index < (int)heads_.size()) ? index : -1;
+}
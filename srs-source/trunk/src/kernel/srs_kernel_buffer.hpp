@@ -9,8 +9,11 @@
 
 #include <srs_core.hpp>
 
+#include <srs_core_autofree.hpp>
+
 #include <string>
 #include <sys/types.h>
+#include <vector>
 
 class SrsBuffer;
 
@@ -531,6 +534,12 @@ public:
 //   SrsSharedPtr<SrsMemoryBlock> block2 = original_block;
 //   // Both share the same underlying memory
 //
+// Slicing a range of a shared block without copying:
+//   SrsSharedPtr<SrsMemoryBlock> chunk(new SrsMemoryBlock());
+//   chunk->create(65536);  // Read many packets into the chunk
+//   SrsMemoryBlock* slice = new SrsMemoryBlock();
+//   slice->attach(chunk, chunk->payload() + offset, size);  // Refers to the chunk
+//
 // @remark Not all payload data can be decoded to structured packets - some data
 //         (like video/audio packets) may remain as raw bytes.
 // @remark The size may be less than the allocated buffer size for chunked data.
@@ -548,6 +557,17 @@ SRS_DECLARE_PRIVATE: // clang-format on
     // The buffer contains the actual payload data.
     char *payload_;
 
+    // The serialized FLV tag header and previous tag size of the payload, which is
+    // built once by the first FLV muxer and shared by all viewers of the message.
+    // @see SrsFlvTransmuxer::write_tags
+    char *flv_tag_;
+    // The timestamp in the cached FLV tag header.
+    int64_t flv_tag_timestamp_;
+
+    // The block which owns the payload, when this block is a slice of it, NULL if
+    // this block owns the payload. The parent is freed when all slices are freed.
+    SrsSharedPtr<SrsMemoryBlock> *parent_;
+
 public:
     // Construct an empty memory block.
     // Call create() or attach() to initialize with actual memory.
@@ -593,6 +613,81 @@ public:
     // @remark The provided buffer will be freed with delete[] when this object is destroyed.
     // @remark If data is NULL and size is 0, creates a valid but empty memory block.
     virtual void attach(char *data, int size);
+
+    // Refer to a range of the parent block without copying, for example, the tags parsed
+    // from a chunk read from network. The parent is kept alive until this block is freed.
+    // @param data The start of the range, must be within the payload of parent.
+    // @param size The size of the range, must not exceed the payload of parent.
+    // @remark Any existing buffer is freed before attaching the slice.
+    virtual void attach(SrsSharedPtr<SrsMemoryBlock> parent, char *data, int size);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Free the payload if owned, or release the parent of slice.
+    void free_payload();
+
+public:
+    // Get the cached FLV tag of the payload, NULL if not serialized yet.
+    // @remark The tag is SRS_FLV_TAG_HEADER_SIZE bytes header followed by
+    //         SRS_FLV_PREVIOUS_TAG_SIZE bytes previous tag size.
+    char *flv_tag() { return flv_tag_; }
+    // Get the timestamp which the cached FLV tag header is serialized with.
+    int64_t flv_tag_timestamp() { return flv_tag_timestamp_; }
+    // Allocate the FLV tag cache of size bytes for timestamp, the caller should fill it.
+    // @remark The cache is reset when payload is changed by create() or attach().
+    virtual char *create_flv_tag(int size, int64_t timestamp);
+};
+
+// The alignment of size classes of SrsFreeListPool.
+#define SRS_FREE_LIST_ALIGN 16
+
+// The free-list pool for small objects of a few fixed sizes, which are allocated and
+// freed at high rate, for example, the AMF0 nodes of RTMP commands and the RTP packets
+// copied for each RTC player. The freed objects are cached by size class, and reused
+// by the next allocation, so the system allocator is not touched once the pool is warm.
+//
+// Usage, bind the pool to class by operator new and delete:
+//   void *SrsFoo::operator new(size_t size) { return pool->alloc(size); }
+//   void SrsFoo::operator delete(void *p, size_t size) { pool->free(p, size); }
+//
+// @remark Objects larger than max_size always go to the system allocator.
+// @remark Not thread-safe, it must only be used in the ST thread.
+class SrsFreeListPool
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The free list of each size class, linked by the first pointer of free object.
+    std::vector<void *> heads_;
+    std::vector<int> sizes_;
+    // The max free objects cached for each size class.
+    int max_free_;
+    int64_t nn_reused_;
+    int64_t nn_allocated_;
+
+public:
+    // @param max_size The max size of object to pool.
+    // @param max_free The max free objects cached for each size class, to bound the retained memory.
+    SrsFreeListPool(int max_size, int max_free);
+    virtual ~SrsFreeListPool();
+
+public:
+    void *alloc(size_t size);
+    void free(void *p, size_t size);
+    // Release all cached objects to the system allocator.
+    void shrink();
+
+public:
+    // The number of allocations served from the free list.
+    int64_t nn_reused() { return nn_reused_; }
+    // The number of allocations that went to the system allocator.
+    int64_t nn_allocated() { return nn_allocated_; }
+    // The number of free objects cached in pool.
+    int nn_free();
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Get the size class of object, or -1 if too large to pool.
+    int size_class(size_t size);
 };
 
 #endif
@@ -473,5 +473,10 @@ void SrsCplxError::srs_assert(bool expression)
     }
 #endif
 
+    // Never lose the buffered logs before abort.
+    if (!expression && _srs_log) {
+        _srs_log->flush();
+    }
+
     assert(expression);
 }
@@ -276,7 +276,11 @@
     XX(ERROR_HEVC_DECODE_ERROR, 3099, "HevcDecode", "HEVC decode av stream failed")                         \
     XX(ERROR_MP4_HVCC_CHANGE, 3100, "Mp4HvcCChange", "MP4 does not support video HvcC change")              \
     XX(ERROR_HEVC_API_NO_PREFIXED, 3101, "HevcAnnexbPrefix", "No annexb prefix for HEVC decoder")           \
-    XX(ERROR_NALU_EMPTY, 3102, "NaluEmpty", "NALU is empty")
+    XX(ERROR_NALU_EMPTY, 3102, "NaluEmpty", "NALU is empty")                                                \
+    XX(ERROR_EDGE_TOKEN_TRAVERSE, 3103, "EdgeTokenTraverse", "Failed to wait for edge token traverse")     \
+    XX(ERROR_HTTP_API_FIELDS, 3104, "HttpApiFields", "Invalid fields for HTTP API")                         \
+    XX(ERROR_HTTP_NO_RESPONSE, 3105, "HttpNoResponse", "No HTTP response from server")                      \
+    XX(ERROR_EDGE_TOKEN_REJECTED, 3106, "EdgeTokenRejected", "Edge token rejected by origin")
 
 /**************************************************/
 /* HTTP/StreamConverter protocol error. */
@@ -350,15 +350,13 @@ SrsFlvTransmuxer::SrsFlvTransmuxer()
     tag_headers_ = NULL;
     nb_iovss_cache_ = 0;
     iovss_cache_ = NULL;
-    nb_ppts_ = 0;
-    ppts_ = NULL;
+    nn_empty_msgs_ = 0;
 }
 
 SrsFlvTransmuxer::~SrsFlvTransmuxer()
 {
     srs_freepa(tag_headers_);
     srs_freepa(iovss_cache_);
-    srs_freepa(ppts_);
 }
 
 srs_error_t SrsFlvTransmuxer::initialize(ISrsWriter *fw)
@@ -509,48 +507,63 @@ srs_error_t SrsFlvTransmuxer::write_tags(SrsMediaPacket **msgs, int count)
         cache = tag_headers_ = new char[SRS_FLV_TAG_HEADER_SIZE * count];
     }
 
-    // Do realloc the pts if required.
-    char *pts = ppts_;
-    if (nb_ppts_ < count) {
-        srs_freepa(ppts_);
-
-        nb_ppts_ = count;
-        pts = ppts_ = new char[SRS_FLV_PREVIOUS_TAG_SIZE * count];
-    }
-
     // Now all caches are ok, start to write all messages.
     iovec *iovs = iovss;
     int nn_real_iovss = 0;
     for (int i = 0; i < count; i++) {
         SrsMediaPacket *msg = msgs[i];
 
-        // Cache FLV packet header.
-        if (msg->is_audio()) {
-            if (drop_if_not_match_ && !has_audio_)
-                continue; // Ignore audio packets if no audio stream.
-            cache_audio(msg->timestamp_, msg->payload(), msg->size(), cache);
-        } else if (msg->is_video()) {
-            if (drop_if_not_match_ && !has_video_)
-                continue; // Ignore video packets if no video stream.
-            cache_video(msg->timestamp_, msg->payload(), msg->size(), cache);
-        } else {
-            cache_metadata(SrsFrameTypeScript, msg->payload(), msg->size(), cache);
+        // Ignore packets if no such stream.
+        if (msg->is_audio() && drop_if_not_match_ && !has_audio_)
+            continue;
+        if (msg->is_video() && drop_if_not_match_ && !has_video_)
+            continue;
+
+        // The FLV tag is serialized once in the shared payload, so all viewers of the
+        // message, for example, HTTP-FLV players, reuse the same tag header and pts.
+        SrsMemoryBlock *block = msg->payload_.get();
+
+        // Ignore packets without payload, which has no tag to share.
+        if (!block) {
+            nn_empty_msgs_++;
+            srs_warn("flv: ignore msg without payload, type=%d, timestamp=%" PRId64 ", total=%d",
+                     msg->message_type_, msg->timestamp_, nn_empty_msgs_);
+            continue;
+        }
+
+        int64_t timestamp = msg->is_av() ? msg->timestamp_ : 0;
+        char *tag = block->flv_tag();
+        if (!tag) {
+            tag = block->create_flv_tag(SRS_FLV_TAG_HEADER_SIZE + SRS_FLV_PREVIOUS_TAG_SIZE, timestamp);
+            if (msg->is_audio()) {
+                cache_audio(timestamp, msg->payload(), msg->size(), tag);
+            } else if (msg->is_video()) {
+                cache_video(timestamp, msg->payload(), msg->size(), tag);
+            } else {
+                cache_metadata(SrsFrameTypeScript, msg->payload(), msg->size(), tag);
+            }
+            cache_pts(SRS_FLV_TAG_HEADER_SIZE + msg->size(), tag + SRS_FLV_TAG_HEADER_SIZE);
         }
 
-        // Cache FLV pts.
-        cache_pts(SRS_FLV_TAG_HEADER_SIZE + msg->size(), pts);
+        // Share the tag header if the timestamp is identical, for example, ATC or jitter
+        // off, otherwise patch the rebased timestamp in our own header cache.
+        char *header = tag;
+        if (block->flv_tag_timestamp() != timestamp) {
+            memcpy(cache, tag, SRS_FLV_TAG_HEADER_SIZE);
+            cache_timestamp(timestamp, cache);
+            header = cache;
+            cache += SRS_FLV_TAG_HEADER_SIZE;
+        }
 
         // Set cache to iovec.
-        iovs[0].iov_base = cache;
+        iovs[0].iov_base = header;
         iovs[0].iov_len = SRS_FLV_TAG_HEADER_SIZE;
         iovs[1].iov_base = msg->payload();
         iovs[1].iov_len = msg->size();
-        iovs[2].iov_base = pts;
+        iovs[2].iov_base = tag + SRS_FLV_TAG_HEADER_SIZE;
         iovs[2].iov_len = SRS_FLV_PREVIOUS_TAG_SIZE;
 
-        // Move to next cache.
-        cache += SRS_FLV_TAG_HEADER_SIZE;
-        pts += SRS_FLV_PREVIOUS_TAG_SIZE;
+        // Move to next iovec.
         iovs += 3;
         nn_real_iovss += 3;
     }
@@ -563,6 +576,11 @@ srs_error_t SrsFlvTransmuxer::write_tags(SrsMediaPacket **msgs, int count)
     return err;
 }
 
+int SrsFlvTransmuxer::nn_empty_msgs()
+{
+    return nn_empty_msgs_;
+}
+
 void SrsFlvTransmuxer::cache_metadata(char type, char *data, int size, char *cache)
 {
     srs_assert(data);
@@ -644,6 +662,17 @@ void SrsFlvTransmuxer::cache_pts(int size, char *cache)
     tag_stream->write_4bytes(size);
 }
 
+void SrsFlvTransmuxer::cache_timestamp(int64_t timestamp, char *cache)
+{
+    timestamp &= 0x7fffffff;
+
+    // Timestamp UI24 at offset 4, then TimestampExtended UI8.
+    cache[4] = (char)((timestamp >> 16) & 0xFF);
+    cache[5] = (char)((timestamp >> 8) & 0xFF);
+    cache[6] = (char)(timestamp & 0xFF);
+    cache[7] = (char)((timestamp >> 24) & 0xFF);
+}
+
 srs_error_t SrsFlvTransmuxer::write_tag(char *header, int header_size, char *tag, int tag_size)
 {
     srs_error_t err = srs_success;
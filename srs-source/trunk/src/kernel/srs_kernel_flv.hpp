@@ -321,19 +321,21 @@ public:
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
-    // The cache tag header.
+    // The cache tag header, only for messages whose timestamp differs from the
+    // shared FLV tag of payload, see SrsMemoryBlock::flv_tag.
     int nb_tag_headers_;
     char *tag_headers_;
-    // The cache pps(previous tag size)
-    int nb_ppts_;
-    char *ppts_;
     // The cache iovss.
     int nb_iovss_cache_;
     iovec *iovss_cache_;
+    // The number of messages without payload, which are ignored by write_tags.
+    int nn_empty_msgs_;
 
 public:
     // Write the tags in a time.
     virtual srs_error_t write_tags(SrsMediaPacket **msgs, int count);
+    // Get the number of ignored messages without payload.
+    int nn_empty_msgs();
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
@@ -341,6 +343,8 @@ SRS_DECLARE_PRIVATE: // clang-format on
     virtual void cache_audio(int64_t timestamp, char *data, int size, char *cache);
     virtual void cache_video(int64_t timestamp, char *data, int size, char *cache);
     virtual void cache_pts(int size, char *cache);
+    // Rewrite the timestamp of a serialized tag header.
+    virtual void cache_timestamp(int64_t timestamp, char *cache);
     virtual srs_error_t write_tag(char *header, int header_size, char *tag, int tag_size);
 };
 
@@ -59,6 +59,8 @@ public:
     virtual srs_error_t initialize() = 0;
     // Reopen the log file for log rotate.
     virtual void reopen() = 0;
+    // Write the buffered logs, for example, before abort by assert.
+    virtual void flush() = 0;
 
 public:
     // Write a application level log. All parameters are required except the tag.
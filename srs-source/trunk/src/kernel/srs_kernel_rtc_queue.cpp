@@ -298,3 +298,133 @@ void SrsRtpNackForReceiver::update_rtt(int rtt)
 
     opts_.nack_interval_ = srs_min(opts_.nack_interval_, opts_.max_nack_interval_);
 }
+
+SrsRtpNackCache::SrsRtpNackCache(int64_t max_bytes)
+{
+    max_bytes_ = max_bytes;
+    nn_bytes_ = 0;
+    nn_packets_ = 0;
+    cache_ssrc_ = 0;
+    cache_slots_ = NULL;
+}
+
+SrsRtpNackCache::~SrsRtpNackCache()
+{
+    clear();
+}
+
+void SrsRtpNackCache::put(SrsRtpPacket *pkt)
+{
+    uint32_t ssrc = pkt->header_.get_ssrc();
+    uint16_t seq = pkt->header_.get_sequence();
+
+    SrsRtpPacket **slots = fetch_slots(ssrc, true);
+    SrsRtpPacket *&slot = slots[seq & (SRS_RTP_NACK_CACHE_SLOTS - 1)];
+
+    // Overwrite the packet in the same slot, its entry in fifo will be stale.
+    if (slot) {
+        nn_bytes_ -= slot->nb_bytes();
+        nn_packets_--;
+        srs_freep(slot);
+    }
+
+    // The copy shares the payload with pkt, so it's cheap.
+    slot = pkt->copy();
+    nn_bytes_ += slot->nb_bytes();
+    nn_packets_++;
+    fifo_.push_back(std::make_pair(ssrc, seq));
+
+    evict();
+}
+
+SrsRtpPacket *SrsRtpNackCache::find(uint32_t ssrc, uint16_t seq)
+{
+    SrsRtpPacket **slots = fetch_slots(ssrc, false);
+    if (!slots) {
+        return NULL;
+    }
+
+    // The sequence must match exactly, because the slot might be overwritten by other packet.
+    SrsRtpPacket *pkt = slots[seq & (SRS_RTP_NACK_CACHE_SLOTS - 1)];
+    if (!pkt || pkt->header_.get_sequence() != seq) {
+        return NULL;
+    }
+
+    return pkt;
+}
+
+void SrsRtpNackCache::clear()
+{
+    for (std::map<uint32_t, SrsRtpPacket **>::iterator it = slots_.begin(); it != slots_.end(); ++it) {
+        SrsRtpPacket **slots = it->second;
+        for (int i = 0; i < SRS_RTP_NACK_CACHE_SLOTS; i++) {
+            srs_freep(slots[i]);
+        }
+        srs_freepa(slots);
+    }
+    slots_.clear();
+    fifo_.clear();
+
+    cache_ssrc_ = 0;
+    cache_slots_ = NULL;
+    nn_bytes_ = 0;
+    nn_packets_ = 0;
+}
+
+int64_t SrsRtpNackCache::nn_bytes()
+{
+    return nn_bytes_;
+}
+
+int SrsRtpNackCache::nn_packets()
+{
+    return nn_packets_;
+}
+
+SrsRtpPacket **SrsRtpNackCache::fetch_slots(uint32_t ssrc, bool create)
+{
+    if (cache_slots_ && cache_ssrc_ == ssrc) {
+        return cache_slots_;
+    }
+
+    SrsRtpPacket **slots = NULL;
+    std::map<uint32_t, SrsRtpPacket **>::iterator it = slots_.find(ssrc);
+    if (it != slots_.end()) {
+        slots = it->second;
+    } else if (create) {
+        slots = new SrsRtpPacket *[SRS_RTP_NACK_CACHE_SLOTS];
+        memset(slots, 0, sizeof(SrsRtpPacket *) * SRS_RTP_NACK_CACHE_SLOTS);
+        slots_[ssrc] = slots;
+    }
+
+    if (slots) {
+        cache_ssrc_ = ssrc;
+        cache_slots_ = slots;
+    }
+    return slots;
+}
+
+void SrsRtpNackCache::evict()
+{
+    // The fifo never exceeds the total slots, because the stale entries are useless.
+    size_t max_entries = slots_.size() * SRS_RTP_NACK_CACHE_SLOTS;
+
+    while (!fifo_.empty()) {
+        std::pair<uint32_t, uint16_t> &entry = fifo_.front();
+
+        SrsRtpPacket **slots = fetch_slots(entry.first, false);
+        SrsRtpPacket **pslot = slots ? &slots[entry.second & (SRS_RTP_NACK_CACHE_SLOTS - 1)] : NULL;
+        bool stale = !pslot || !*pslot || (*pslot)->header_.get_sequence() != entry.second;
+
+        if (!stale && nn_bytes_ <= max_bytes_ && fifo_.size() <= max_entries) {
+            break;
+        }
+
+        if (!stale) {
+            nn_bytes_ -= (*pslot)->nb_bytes();
+            nn_packets_--;
+            srs_freep(*pslot);
+        }
+        fifo_.pop_front();
+    }
+}
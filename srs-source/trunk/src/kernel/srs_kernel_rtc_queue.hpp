@@ -9,6 +9,7 @@
 
 #include <srs_core.hpp>
 
+#include <deque>
 #include <map>
 #include <string>
 #include <vector>
@@ -142,4 +143,49 @@ public:
     void update_rtt(int rtt);
 };
 
+// The slots of each SSRC in the shared NACK cache, must be power of 2.
+#define SRS_RTP_NACK_CACHE_SLOTS 4096
+
+// The shared NACK cache of a stream, keeps one copy of the recent packets from publisher, which are
+// indexed by the original SSRC and sequence. The oldest packets are evicted when exceeds the max
+// bytes, so all players of a stream answer NACK from this cache, rather than each player keeping
+// its own copy of packets.
+class SrsRtpNackCache
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The max bytes of cached packets.
+    int64_t max_bytes_;
+    int64_t nn_bytes_;
+    int nn_packets_;
+    // The ring of packets for each SSRC, the index is the sequence.
+    std::map<uint32_t, SrsRtpPacket **> slots_;
+    // The last SSRC and its ring, to avoid lookup the map for each packet.
+    uint32_t cache_ssrc_;
+    SrsRtpPacket **cache_slots_;
+    // The SSRC and sequence of packets in order of insertion, to evict the oldest one.
+    std::deque<std::pair<uint32_t, uint16_t> > fifo_;
+
+public:
+    SrsRtpNackCache(int64_t max_bytes);
+    virtual ~SrsRtpNackCache();
+
+public:
+    // Cache a copy of packet, user still owns and should free the pkt.
+    void put(SrsRtpPacket *pkt);
+    // Find the packet by original SSRC and sequence, NULL if not found.
+    // @remark User should never free the returned packet, copy it when need to change it.
+    SrsRtpPacket *find(uint32_t ssrc, uint16_t seq);
+    // Free all packets, for example, when publisher is gone.
+    void clear();
+    int64_t nn_bytes();
+    int nn_packets();
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    SrsRtpPacket **fetch_slots(uint32_t ssrc, bool create);
+    // Evict the oldest packets when exceeds the bytes, or the entry is stale.
+    void evict();
+};
+
 #endif
@@ -10,8 +10,15 @@
 #include <srs_kernel_log.hpp>
 
 #include <arpa/inet.h>
+#include <string.h>
 using namespace std;
 
+SrsFreeListPool *srs_rtcp_pool()
+{
+    static SrsFreeListPool *pool = new SrsFreeListPool(SRS_RTCP_POOL_MAX_SIZE, SRS_RTCP_POOL_MAX_FREE);
+    return pool;
+}
+
 SrsRtcpCommon::SrsRtcpCommon() : ssrc_(0), data_(NULL), nb_data_(0)
 {
     payload_len_ = 0;
@@ -21,6 +28,16 @@ SrsRtcpCommon::~SrsRtcpCommon()
 {
 }
 
+void *SrsRtcpCommon::operator new(size_t size)
+{
+    return srs_rtcp_pool()->alloc(size);
+}
+
+void SrsRtcpCommon::operator delete(void *p, size_t size)
+{
+    srs_rtcp_pool()->free(p, size);
+}
+
 uint8_t SrsRtcpCommon::type() const
 {
     return header_.type;
@@ -701,19 +718,30 @@ SrsRtcpTWCC::SrsRtcpTWCC(uint32_t sender_ssrc) : pkt_len_(0)
     reference_time_ = 0;
     fb_pkt_count_ = 0;
     next_base_sn_ = 0;
+
+    recv_ts_ = NULL;
+    recv_bits_ = NULL;
+    recv_begin_ = recv_end_ = 0;
+    nn_recv_ = 0;
 }
 
 SrsRtcpTWCC::~SrsRtcpTWCC()
 {
+    srs_freepa(recv_ts_);
+    srs_freepa(recv_bits_);
 }
 
 void SrsRtcpTWCC::clear()
 {
     encoded_chucks_.clear();
     pkt_deltas_.clear();
-    recv_packets_.clear();
-    recv_sns_.clear();
     next_base_sn_ = 0;
+
+    if (recv_bits_) {
+        memset(recv_bits_, 0, sizeof(uint64_t) * kTwccFbRecvWindow / 64);
+    }
+    recv_begin_ = recv_end_ = 0;
+    nn_recv_ = 0;
 }
 
 uint16_t SrsRtcpTWCC::get_base_sn() const
@@ -768,20 +796,47 @@ void SrsRtcpTWCC::add_recv_delta(uint16_t delta)
 
 srs_error_t SrsRtcpTWCC::recv_packet(uint16_t sn, srs_utime_t ts)
 {
-    map<uint16_t, srs_utime_t>::iterator it = recv_packets_.find(sn);
-    if (it != recv_packets_.end()) {
+    if (!recv_ts_) {
+        recv_ts_ = new srs_utime_t[kTwccFbRecvWindow];
+        recv_bits_ = new uint64_t[kTwccFbRecvWindow / 64];
+        memset(recv_bits_, 0, sizeof(uint64_t) * kTwccFbRecvWindow / 64);
+    }
+
+    // Extend the window to cover the sn, which might be reordered before the begin.
+    if (!nn_recv_ && recv_begin_ == recv_end_) {
+        recv_begin_ = sn;
+        recv_end_ = sn + 1;
+    } else if (srs_rtp_seq_distance(recv_begin_, sn) < 0) {
+        if ((uint16_t)(recv_end_ - sn) > kTwccFbRecvWindow) {
+            return srs_error_new(ERROR_RTC_RTCP, "TWCC seq %d out of window [%d, %d)", sn, recv_begin_, recv_end_);
+        }
+        recv_begin_ = sn;
+    } else if (srs_rtp_seq_distance(recv_end_, sn) >= 0) {
+        if ((uint16_t)(sn + 1 - recv_begin_) > kTwccFbRecvWindow) {
+            return srs_error_new(ERROR_RTC_RTCP, "TWCC seq %d out of window [%d, %d)", sn, recv_begin_, recv_end_);
+        }
+        recv_end_ = sn + 1;
+    } else if (is_received(sn)) {
         return srs_error_new(ERROR_RTC_RTCP, "TWCC dup seq: %d", sn);
     }
 
-    recv_packets_[sn] = ts;
-    recv_sns_.insert(sn);
+    int index = sn & (kTwccFbRecvWindow - 1);
+    recv_ts_[index] = ts;
+    recv_bits_[index >> 6] |= (uint64_t)1 << (index & 63);
+    nn_recv_++;
 
     return srs_success;
 }
 
 bool SrsRtcpTWCC::need_feedback()
 {
-    return recv_packets_.size() > 0;
+    return nn_recv_ > 0;
+}
+
+bool SrsRtcpTWCC::is_received(uint16_t sn)
+{
+    int index = sn & (kTwccFbRecvWindow - 1);
+    return (recv_bits_[index >> 6] >> (index & 63)) & 1;
 }
 
 srs_error_t SrsRtcpTWCC::decode(SrsBuffer *buffer)
@@ -1065,18 +1120,15 @@ srs_error_t SrsRtcpTWCC::do_encode(SrsBuffer *buffer)
         return srs_error_new(ERROR_RTC_RTCP, "requires %d bytes", nb_bytes());
     }
 
-    pkt_len_ = kTwccFbPktHeaderSize;
-
-    set<uint16_t, SrsSeqCompareLess>::iterator it_sn = recv_sns_.begin();
-    if (!next_base_sn_) {
-        base_sn_ = *it_sn;
-    } else {
-        base_sn_ = next_base_sn_;
-        it_sn = recv_sns_.find(base_sn_);
+    if (!nn_recv_) {
+        return srs_error_new(ERROR_RTC_RTCP, "no packets");
     }
 
-    map<uint16_t, srs_utime_t>::iterator it_ts = recv_packets_.find(base_sn_);
-    srs_utime_t ts = it_ts->second;
+    pkt_len_ = kTwccFbPktHeaderSize;
+
+    // The window always starts from a received packet, see recv_packet.
+    base_sn_ = next_base_sn_ ? next_base_sn_ : recv_begin_;
+    srs_utime_t ts = recv_ts_[base_sn_ & (kTwccFbRecvWindow - 1)];
 
     reference_time_ = (ts % kTwccFbReferenceTimeDivisor) / kTwccFbTimeMultiplier;
     srs_utime_t last_ts = (srs_utime_t)(reference_time_)*kTwccFbTimeMultiplier;
@@ -1086,30 +1138,37 @@ srs_error_t SrsRtcpTWCC::do_encode(SrsBuffer *buffer)
 
     // encode chunk
     SrsRtcpTWCC::SrsRtcpTWCCChunk chunk;
-    for (; it_sn != recv_sns_.end(); ++it_sn) {
+    uint16_t current_sn = base_sn_;
+    for (; current_sn != recv_end_; ++current_sn) {
+        // Skip the whole word of bitmap if no packet received.
+        int index = current_sn & (kTwccFbRecvWindow - 1);
+        if (!recv_bits_[index >> 6]) {
+            current_sn += 63 - (index & 63);
+            if (srs_rtp_seq_distance(current_sn, recv_end_) <= 0) {
+                current_sn = recv_end_ - 1;
+            }
+            continue;
+        }
+        if (!is_received(current_sn)) {
+            continue;
+        }
+
         // check whether exceed buffer len
         // max recv_delta_size = 2
         if (pkt_len_ + 2 >= buffer->left()) {
             break;
         }
 
-        uint16_t current_sn = *it_sn;
-        // calculate delta
-        it_ts = recv_packets_.find(current_sn);
-        if (it_ts == recv_packets_.end()) {
-            continue;
-        }
-
         packet_count++;
-        srs_utime_t delta_us = calculate_delta_us(it_ts->second, last_ts);
+        srs_utime_t delta_us = calculate_delta_us(recv_ts_[index], last_ts);
         int16_t delta = delta_us;
         if (delta != delta_us) {
             return srs_error_new(ERROR_RTC_RTCP, "twcc: delta:%" PRId64 ", exceeds the 16bits", delta_us);
         }
 
-        if (current_sn > (last_sn + 1)) {
+        if (srs_rtp_seq_distance(last_sn, current_sn) > 1) {
             // lost packet
-            for (uint16_t lost_sn = last_sn + 1; lost_sn < current_sn; ++lost_sn) {
+            for (uint16_t lost_sn = last_sn + 1; lost_sn != current_sn; ++lost_sn) {
                 process_pkt_chunk(chunk, 0);
                 packet_count++;
             }
@@ -1126,12 +1185,15 @@ srs_error_t SrsRtcpTWCC::do_encode(SrsBuffer *buffer)
         pkt_len_ += recv_delta_size;
         last_sn = current_sn;
 
-        recv_packets_.erase(it_ts);
+        recv_bits_[index >> 6] &= ~((uint64_t)1 << (index & 63));
+        nn_recv_--;
     }
 
+    // Continue from the sn in next feedback, if buffer is full.
     next_base_sn_ = 0;
-    if (it_sn != recv_sns_.end()) {
-        next_base_sn_ = *it_sn;
+    if (current_sn != recv_end_) {
+        next_base_sn_ = current_sn;
+        recv_begin_ = current_sn;
     }
 
     if (0 < chunk.size_) {
@@ -1259,19 +1321,18 @@ srs_error_t SrsRtcpNack::decode(SrsBuffer *buffer)
     }
 
     media_ssrc_ = buffer->read_4bytes();
-    char bitmask[20];
     for (int i = 0; i < (header_.length - 2); i++) {
         uint16_t pid = buffer->read_2bytes();
         uint16_t blp = buffer->read_2bytes();
         lost_sns_.insert(pid);
-        memset(bitmask, 0, 20);
-        for (int j = 0; j < 16; j++) {
-            bitmask[j] = (blp & (1 << j)) >> j ? '1' : '0';
-            if ((blp & (1 << j)) >> j)
-                lost_sns_.insert(pid + j + 1);
+        srs_info("[%d] pid=%d, blp=%#x", i, pid, blp);
+
+        // Only visit the set bits of BLP, most of them are zero.
+        while (blp) {
+            int j = __builtin_ctz(blp);
+            lost_sns_.insert(pid + j + 1);
+            blp &= blp - 1;
         }
-        bitmask[16] = '\n';
-        srs_info("[%d] %d / %s", i, pid, bitmask);
     }
 
     return err;
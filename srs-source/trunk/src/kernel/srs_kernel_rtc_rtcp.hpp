@@ -22,6 +22,16 @@ const uint8_t kRtcpVersion = 0x2;
 // 1500 - 20(ip_header) - 8(udp_header)
 const int kMaxUDPDataSize = 1472;
 
+// The max size of RTCP objects to pool, which embeds a kRtcpPacketSize payload, @see srs_rtcp_pool
+#define SRS_RTCP_POOL_MAX_SIZE 2048
+// The max free RTCP objects cached for each size class.
+#define SRS_RTCP_POOL_MAX_FREE 256
+
+// The pool for RTCP objects. Each compound RTCP packet from players is decoded to a few
+// RTCP objects, which are freed once handled, so they are recycled at the rate of RTCP
+// packets multiply by players.
+extern SrsFreeListPool *srs_rtcp_pool();
+
 // RTCP Packet Types, @see http://www.networksorcery.com/enp/protocol/rtcp.htm
 enum SrsRtcpType {
     SrsRtcpType_fir = 192,
@@ -81,6 +91,13 @@ SRS_DECLARE_PROTECTED: // clang-format on
 public:
     SrsRtcpCommon();
     virtual ~SrsRtcpCommon();
+
+public:
+    // Allocate the RTCP objects from the RTCP pool, @see srs_rtcp_pool
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
+public:
     virtual uint8_t type() const;
     virtual uint8_t get_rc() const;
 
@@ -276,6 +293,8 @@ public:
 #define kTwccFbTwoBitElements 7
 #define kTwccFbLargeRecvDeltaBytes 2
 #define kTwccFbMaxBitElements kTwccFbOneBitElements
+// The max packets received between two feedbacks, must be power of 2.
+#define kTwccFbRecvWindow 4096
 
 class SrsRtcpTWCC : public SrsRtcpFbCommon
 {
@@ -287,8 +306,14 @@ SRS_DECLARE_PRIVATE: // clang-format on
     std::vector<uint16_t> encoded_chucks_;
     std::vector<uint16_t> pkt_deltas_;
 
-    std::map<uint16_t, srs_utime_t> recv_packets_;
-    std::set<uint16_t, SrsSeqCompareLess> recv_sns_;
+    // The received packets in window [recv_begin_, recv_end_), which is a ring indexed by
+    // sequence, with the receive time and a bitmap of whether received. Allocated when the
+    // first packet is received, because decoded feedbacks never use it.
+    srs_utime_t *recv_ts_;
+    uint64_t *recv_bits_;
+    uint16_t recv_begin_;
+    uint16_t recv_end_;
+    int nn_recv_;
 
     struct SrsRtcpTWCCChunk {
         uint8_t delta_sizes_[kTwccFbMaxBitElements];
@@ -314,6 +339,7 @@ SRS_DECLARE_PRIVATE: // clang-format on
     srs_error_t encode_chunk_two_bit(SrsRtcpTWCCChunk &chunk, size_t size, bool shift);
     void reset_chunk(SrsRtcpTWCCChunk &chunk);
     srs_error_t encode_remaining_chunk(SrsRtcpTWCCChunk &chunk);
+    bool is_received(uint16_t sn);
 
 public:
     SrsRtcpTWCC(uint32_t sender_ssrc = 0);
@@ -25,6 +25,13 @@ SrsPps *_srs_pps_objs_rfua = NULL;
 SrsPps *_srs_pps_objs_rbuf = NULL;
 SrsPps *_srs_pps_objs_rothers = NULL;
 
+// The pool is never freed, because RTP packets may be freed by static objects on exit.
+SrsFreeListPool *srs_rtp_pool()
+{
+    static SrsFreeListPool *pool = new SrsFreeListPool(SRS_RTP_POOL_MAX_SIZE, SRS_RTP_POOL_MAX_FREE);
+    return pool;
+}
+
 /* @see https://tools.ietf.org/html/rfc1889#section-5.1
   0                   1                   2                   3
   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
@@ -749,6 +756,16 @@ ISrsRtpPayloader::~ISrsRtpPayloader()
 {
 }
 
+void *ISrsRtpPayloader::operator new(size_t size)
+{
+    return srs_rtp_pool()->alloc(size);
+}
+
+void ISrsRtpPayloader::operator delete(void *p, size_t size)
+{
+    srs_rtp_pool()->free(p, size);
+}
+
 ISrsRtpPacketDecodeHandler::ISrsRtpPacketDecodeHandler()
 {
 }
@@ -761,6 +778,8 @@ SrsRtpPacket::SrsRtpPacket()
 {
     payload_ = NULL;
     payload_type_ = SrsRtpPacketPayloadTypeUnknown;
+    raw_payload_ = NULL;
+    nn_raw_payload_ = 0;
     shared_buffer_ = SrsSharedPtr<SrsMemoryBlock>(NULL);
     actual_buffer_size_ = 0;
 
@@ -779,6 +798,16 @@ SrsRtpPacket::~SrsRtpPacket()
     // shared_buffer_ automatically cleaned up by SrsSharedPtr
 }
 
+void *SrsRtpPacket::operator new(size_t size)
+{
+    return srs_rtp_pool()->alloc(size);
+}
+
+void SrsRtpPacket::operator delete(void *p, size_t size)
+{
+    srs_rtp_pool()->free(p, size);
+}
+
 char *SrsRtpPacket::wrap(int size)
 {
     // The buffer size is larger or equals to the size of packet.
@@ -827,6 +856,8 @@ SrsRtpPacket *SrsRtpPacket::copy()
     cp->header_ = header_;
     cp->payload_ = payload_ ? payload_->copy() : NULL;
     cp->payload_type_ = payload_type_;
+    cp->raw_payload_ = raw_payload_;
+    cp->nn_raw_payload_ = nn_raw_payload_;
 
     cp->nalu_type_ = nalu_type_;
     cp->shared_buffer_ = shared_buffer_; // Copy shared pointer
@@ -842,6 +873,22 @@ SrsRtpPacket *SrsRtpPacket::copy()
     return cp;
 }
 
+ISrsRtpPayloader *SrsRtpPacket::payload()
+{
+    if (!payload_ && raw_payload_) {
+        decode_raw_payload();
+    }
+    return payload_;
+}
+
+SrsRtpPacketPayloadType SrsRtpPacket::payload_type()
+{
+    if (!payload_ && raw_payload_) {
+        decode_raw_payload();
+    }
+    return payload_type_;
+}
+
 void SrsRtpPacket::set_padding(int size)
 {
     header_.set_padding(size);
@@ -876,7 +923,7 @@ void SrsRtpPacket::set_extension_types(SrsRtpExtensionTypes *v)
 uint64_t SrsRtpPacket::nb_bytes()
 {
     if (!cached_payload_size_) {
-        int nn_payload = (payload_ ? payload_->nb_bytes() : 0);
+        int nn_payload = (payload_ ? payload_->nb_bytes() : nn_raw_payload_);
         cached_payload_size_ = header_.nb_bytes() + nn_payload + header_.get_padding();
     }
     return cached_payload_size_;
@@ -894,6 +941,14 @@ srs_error_t SrsRtpPacket::encode(SrsBuffer *buf)
         return srs_error_wrap(err, "rtp payload");
     }
 
+    // For the undecoded payload, copy the bytes as is.
+    if (!payload_ && raw_payload_) {
+        if (!buf->require(nn_raw_payload_)) {
+            return srs_error_new(ERROR_RTC_RTP_MUXER, "requires %d bytes", nn_raw_payload_);
+        }
+        buf->write_bytes(raw_payload_, nn_raw_payload_);
+    }
+
     if (header_.get_padding() > 0) {
         uint8_t padding = header_.get_padding();
         if (!buf->require(padding)) {
@@ -906,6 +961,46 @@ srs_error_t SrsRtpPacket::encode(SrsBuffer *buf)
     return err;
 }
 
+// Check the STAP or FU payload without decoding it, the same as the decode of payloader, for
+// example, SrsRtpSTAPPayload::decode and SrsRtpFUAPayload2::decode.
+srs_error_t srs_rtp_check_raw_payload(SrsRtpPacketPayloadType pt, uint8_t *p, int size)
+{
+    if (pt == SrsRtpPacketPayloadTypeSTAP || pt == SrsRtpPacketPayloadTypeSTAPHevc) {
+        // The STAP header is 1 byte for H.264 and 2 bytes for H.265.
+        int pos = (pt == SrsRtpPacketPayloadTypeSTAP) ? 1 : 2;
+        if (size < pos) {
+            return srs_error_new(ERROR_RTC_RTP_MUXER, "requires %d bytes", pos);
+        }
+
+        // forbidden_zero_bit should be zero.
+        if ((p[0] & 0x80) == 0x80) {
+            return srs_error_new(ERROR_RTC_RTP_MUXER, "forbidden_zero_bit should be zero");
+        }
+
+        // Each NALU is 2 bytes size and NALU.
+        while (pos < size) {
+            if (pos + 2 > size) {
+                return srs_error_new(ERROR_RTC_RTP_MUXER, "requires %d bytes", 2);
+            }
+
+            int nn = (p[pos] << 8) | p[pos + 1];
+            pos += 2;
+            if (pos + nn > size) {
+                return srs_error_new(ERROR_RTC_RTP_MUXER, "requires %d bytes", nn);
+            }
+            pos += nn;
+        }
+    } else if (pt == SrsRtpPacketPayloadTypeFUA2 || pt == SrsRtpPacketPayloadTypeFUAHevc2) {
+        // The FU indicator and header for H.264, or the PayloadHdr and FU header for H.265,
+        // and at least 1 byte for H.264.
+        if (size < 3) {
+            return srs_error_new(ERROR_RTC_RTP_MUXER, "requires 3 bytes");
+        }
+    }
+
+    return srs_success;
+}
+
 srs_error_t SrsRtpPacket::decode(SrsBuffer *buf)
 {
     srs_error_t err = srs_success;
@@ -922,15 +1017,27 @@ srs_error_t SrsRtpPacket::decode(SrsBuffer *buf)
     buf->set_size(buf->size() - padding);
 
     // TODO: FIXME: We should keep payload to NULL and return if buffer is empty.
-    // If user set the decode handler, call it to set the payload.
+    // If user set the decode handler, call it to set the payload, or only the payload type.
     if (decode_handler_) {
         decode_handler_->on_before_decode_payload(this, buf, &payload_, &payload_type_);
     }
 
-    // By default, we always use the RAW payload.
+    // If no payloader, keep the payload undecoded, parse it when used. By default, we always
+    // use the RAW payload.
     if (!payload_) {
-        payload_ = new SrsRtpRawPayload();
-        payload_type_ = SrsRtpPacketPayloadTypeRaw;
+        if (payload_type_ == SrsRtpPacketPayloadTypeUnknown) {
+            payload_type_ = SrsRtpPacketPayloadTypeRaw;
+        }
+
+        // Check the structure of STAP and FU, so the corrupt packet is rejected as before,
+        // rather than forwarded to players.
+        if ((err = srs_rtp_check_raw_payload(payload_type_, (uint8_t *)buf->head(), buf->left())) != srs_success) {
+            return srs_error_wrap(err, "rtp payload");
+        }
+
+        raw_payload_ = buf->head();
+        nn_raw_payload_ = buf->left();
+        return err;
     }
 
     if ((err = payload_->decode(buf)) != srs_success) {
@@ -940,6 +1047,87 @@ srs_error_t SrsRtpPacket::decode(SrsBuffer *buf)
     return err;
 }
 
+void SrsRtpPacket::decode_raw_payload()
+{
+    srs_error_t err = srs_success;
+
+    ISrsRtpPayloader *p = NULL;
+    if (payload_type_ == SrsRtpPacketPayloadTypeSTAP) {
+        p = new SrsRtpSTAPPayload();
+    } else if (payload_type_ == SrsRtpPacketPayloadTypeFUA2) {
+        p = new SrsRtpFUAPayload2();
+    } else if (payload_type_ == SrsRtpPacketPayloadTypeSTAPHevc) {
+        p = new SrsRtpSTAPPayloadHevc();
+    } else if (payload_type_ == SrsRtpPacketPayloadTypeFUAHevc2) {
+        p = new SrsRtpFUAPayloadHevc2();
+    }
+
+    // Fallback to RAW payload, if not parsed by payload type, or corrupt.
+    if (p) {
+        SrsBuffer buf(raw_payload_, nn_raw_payload_);
+        if ((err = p->decode(&buf)) != srs_success) {
+            srs_warn("RTP: parse payload type=%d as raw, ssrc=%u, seq=%u, err %s", payload_type_,
+                     header_.get_ssrc(), header_.get_sequence(), srs_error_desc(err).c_str());
+            srs_freep(err);
+            srs_freep(p);
+        }
+    }
+
+    if (!p) {
+        SrsBuffer buf(raw_payload_, nn_raw_payload_);
+        p = new SrsRtpRawPayload();
+        payload_type_ = SrsRtpPacketPayloadTypeRaw;
+        srs_error_t r0 = p->decode(&buf);
+        srs_freep(r0);
+    }
+
+    payload_ = p;
+    raw_payload_ = NULL;
+    nn_raw_payload_ = 0;
+}
+
+// Peek the STAP or FU payload without decoding, @see srs_rtp_packet_h264_is_keyframe
+bool srs_rtp_peek_h264_is_keyframe(uint8_t nalu_type, uint8_t *p, int size)
+{
+    if (nalu_type == kStapA) {
+        // Skip the STAP-A header, then each NALU is 2 bytes size and NALU.
+        for (int pos = 1; pos + 2 < size;) {
+            int nn = (p[pos] << 8) | p[pos + 1];
+            uint8_t v = SrsAvcNaluTypeParse(p[pos + 2]);
+            if (v == SrsAvcNaluTypeSPS || v == SrsAvcNaluTypePPS) {
+                return true;
+            }
+            pos += 2 + nn;
+        }
+        return false;
+    } else if (nalu_type == kFuA) {
+        return size >= 2 && SrsAvcNaluTypeParse(p[1]) == SrsAvcNaluTypeIDR;
+    }
+
+    return (SrsAvcNaluTypeIDR == nalu_type) || (SrsAvcNaluTypeSPS == nalu_type) || (SrsAvcNaluTypePPS == nalu_type);
+}
+
+// Peek the STAP or FU payload without decoding, @see srs_rtp_packet_h265_is_keyframe
+bool srs_rtp_peek_h265_is_keyframe(uint8_t nalu_type, uint8_t *p, int size)
+{
+    if (nalu_type == kStapHevc) {
+        // Skip the 2 bytes STAP header, then each NALU is 2 bytes size and NALU.
+        for (int pos = 2; pos + 2 < size;) {
+            int nn = (p[pos] << 8) | p[pos + 1];
+            uint8_t v = SrsHevcNaluTypeParse(p[pos + 2]);
+            if (v == SrsHevcNaluType_VPS || v == SrsHevcNaluType_SPS || v == SrsHevcNaluType_PPS) {
+                return true;
+            }
+            pos += 2 + nn;
+        }
+        return false;
+    } else if (nalu_type == kFuHevc) {
+        return size >= 3 && SrsIsIRAP(SrsHevcNaluType(p[2] & 0x3F));
+    }
+
+    return SrsIsIRAP(nalu_type) || (SrsHevcNaluType_VPS == nalu_type) || (SrsHevcNaluType_SPS == nalu_type) || (SrsHevcNaluType_PPS == nalu_type);
+}
+
 bool srs_rtp_packet_h264_is_keyframe(uint8_t nalu_type, ISrsRtpPayloader *payload)
 {
     if (nalu_type == kStapA) {
@@ -991,11 +1179,17 @@ bool SrsRtpPacket::is_keyframe(SrsVideoCodecId codec_id)
 
     // For H264 video rtp packet
     if (codec_id == SrsVideoCodecIdAVC) {
+        if (!payload_ && raw_payload_) {
+            return srs_rtp_peek_h264_is_keyframe(nalu_type_, (uint8_t *)raw_payload_, nn_raw_payload_);
+        }
         return srs_rtp_packet_h264_is_keyframe(nalu_type_, payload_);
     }
 
     // For H265 video rtp packet
     if (codec_id == SrsVideoCodecIdHEVC) {
+        if (!payload_ && raw_payload_) {
+            return srs_rtp_peek_h265_is_keyframe(nalu_type_, (uint8_t *)raw_payload_, nn_raw_payload_);
+        }
         return srs_rtp_packet_h265_is_keyframe(nalu_type_, payload_);
     }
 
@@ -1058,9 +1252,9 @@ ISrsRtpPayloader *SrsRtpRawPayload::copy()
     cp->payload_ = payload_;
     cp->nn_payload_ = nn_payload_;
 
-    // free sample to prevent memory leak.
-    srs_freep(cp->sample_);
-    cp->sample_ = sample_->copy();
+    // Reuse the sample of copy, which shares the bytes pointer.
+    cp->sample_->bytes_ = sample_->bytes_;
+    cp->sample_->size_ = sample_->size_;
 
     return cp;
 }
@@ -1326,7 +1520,7 @@ srs_error_t SrsRtpSTAPPayload::decode(SrsBuffer *buf)
     // @see https://tools.ietf.org/html/rfc6184#section-5.7
     uint8_t v = buf->read_1bytes();
 
-    // forbidden_zero_bit shoul be zero.
+    // forbidden_zero_bit should be zero.
     // @see https://tools.ietf.org/html/rfc6184#section-5.3
     uint8_t f = (v & 0x80);
     if (f == 0x80) {
@@ -1717,7 +1911,7 @@ srs_error_t SrsRtpSTAPPayloadHevc::decode(SrsBuffer *buf)
     uint8_t v = buf->read_1bytes();
     buf->skip(1);
 
-    // forbidden_zero_bit shoul be zero.
+    // forbidden_zero_bit should be zero.
     // @see https://datatracker.ietf.org/doc/html/rfc7798#section-4.4.2
     uint8_t f = (v & 0x80);
     if (f == 0x80) {
@@ -45,6 +45,11 @@ const int kRtpPacketSize = 1500;
 const int kRtpMaxPayloadSize = kRtpPacketSize - 300;
 
 const int kRtpHeaderFixedSize = 12;
+
+// The max size of RTP packet and payloader objects to pool, @see srs_rtp_pool
+#define SRS_RTP_POOL_MAX_SIZE 256
+// The max free RTP objects cached for each size class.
+#define SRS_RTP_POOL_MAX_FREE 4096
 const uint8_t kRtpMarker = 0x80;
 
 // H.264 nalu header type mask.
@@ -69,6 +74,11 @@ class SrsRtpRawPayload;
 class SrsRtpFUAPayload2;
 class SrsRtpExtensionTypes;
 
+// The pool for RTP packets and payloaders. The RTC source copies each RTP packet for
+// every player, which is freed once sent or evicted from the NACK queue, so the
+// objects are recycled at the rate of packets multiply by players.
+extern SrsFreeListPool *srs_rtp_pool();
+
 // Fast parse the SSRC from RTP packet. Return 0 if invalid.
 uint32_t srs_rtp_fast_parse_ssrc(char *buf, int size);
 uint16_t srs_rtp_fast_parse_seq(char *buf, int size);
@@ -299,6 +309,11 @@ public:
     ISrsRtpPayloader();
     virtual ~ISrsRtpPayloader();
 
+public:
+    // Allocate the payloaders from the RTP pool, @see srs_rtp_pool
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
 public:
     virtual ISrsRtpPayloader *copy() = 0;
 };
@@ -338,6 +353,10 @@ public:
 SRS_DECLARE_PRIVATE: // clang-format on
     ISrsRtpPayloader *payload_;
     SrsRtpPacketPayloadType payload_type_;
+    // The undecoded payload in the shared memory block, which is parsed by payload_type_ on
+    // the first access of payload(), so forwarding to players never builds the payloader.
+    char *raw_payload_;
+    int nn_raw_payload_;
 
 // clang-format off
 SRS_DECLARE_PRIVATE: // clang-format on
@@ -371,6 +390,11 @@ public:
     SrsRtpPacket();
     virtual ~SrsRtpPacket();
 
+public:
+    // Allocate the packets from the RTP pool, @see srs_rtp_pool
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
 public:
     // Wrap buffer to shared_message, which is managed by us.
     char *wrap(int size);
@@ -389,8 +413,13 @@ public:
     {
         payload_ = p;
         payload_type_ = pt;
+        raw_payload_ = NULL;
+        nn_raw_payload_ = 0;
     }
-    ISrsRtpPayloader *payload() { return payload_; }
+    // @remark The payload is parsed on the first access, if decoded lazily.
+    ISrsRtpPayloader *payload();
+    // Get the type of payload(), which is RAW if failed to parse the lazily decoded payload.
+    SrsRtpPacketPayloadType payload_type();
     // Set the padding of RTP packet.
     void set_padding(int size);
     // Increase the padding of RTP packet.
@@ -407,7 +436,12 @@ public:
     virtual srs_error_t encode(SrsBuffer *buf);
     virtual srs_error_t decode(SrsBuffer *buf);
 
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    void decode_raw_payload();
+
 public:
+    // Whether the packet is keyframe, peek the undecoded payload if possible.
     bool is_keyframe(SrsVideoCodecId codec_id);
     // Get and set the packet sync time in milliseconds.
     void set_avsync_time(int64_t avsync_time) { avsync_time_ = avsync_time; }
@@ -3344,6 +3344,11 @@ void SrsTsTransmuxer::set_guess_has_av(bool v)
     }
 }
 
+void SrsTsTransmuxer::refresh()
+{
+    context_->reset();
+}
+
 srs_error_t SrsTsTransmuxer::initialize(ISrsStreamWriter *fw)
 {
     srs_error_t err = srs_success;
@@ -1510,6 +1510,10 @@ public:
     virtual void set_has_audio(bool v) = 0;
     virtual void set_has_video(bool v) = 0;
     virtual void set_guess_has_av(bool v) = 0;
+
+public:
+    // Refresh the PAT/PMT table, which is written before the next frame.
+    virtual void refresh() = 0;
 };
 
 // Transmux the RTMP stream to HTTP-TS stream.
@@ -1538,6 +1542,11 @@ public:
     void set_has_video(bool v);
     void set_guess_has_av(bool v);
 
+public:
+    // Refresh the PAT/PMT table, for example, to make the next keyframe a start point
+    // for new viewers of a shared TS stream.
+    virtual void refresh();
+
 public:
     // Initialize the underlayer file stream.
     // @param fw the writer to use for ts encoder, user must free it.
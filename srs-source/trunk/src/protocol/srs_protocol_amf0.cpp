@@ -44,6 +44,43 @@ using namespace srs_internal;
 // User defined
 #define RTMP_AMF0_Invalid 0x3F
 
+// The pool is never freed, because AMF0 nodes may be freed by static objects on exit.
+static SrsFreeListPool *srs_amf0_pool()
+{
+    static SrsFreeListPool *pool = new SrsFreeListPool(SRS_AMF0_POOL_MAX_SIZE, SRS_AMF0_POOL_MAX_FREE);
+    return pool;
+}
+
+void *SrsAmf0NodePool::alloc(size_t size)
+{
+    return srs_amf0_pool()->alloc(size);
+}
+
+void SrsAmf0NodePool::free(void *p, size_t size)
+{
+    srs_amf0_pool()->free(p, size);
+}
+
+int64_t SrsAmf0NodePool::nn_reused()
+{
+    return srs_amf0_pool()->nn_reused();
+}
+
+int64_t SrsAmf0NodePool::nn_allocated()
+{
+    return srs_amf0_pool()->nn_allocated();
+}
+
+int SrsAmf0NodePool::nn_free()
+{
+    return srs_amf0_pool()->nn_free();
+}
+
+void SrsAmf0NodePool::shrink()
+{
+    srs_amf0_pool()->shrink();
+}
+
 SrsAmf0Any::SrsAmf0Any()
 {
     marker_ = RTMP_AMF0_Invalid;
@@ -53,6 +90,16 @@ SrsAmf0Any::~SrsAmf0Any()
 {
 }
 
+void *SrsAmf0Any::operator new(size_t size)
+{
+    return SrsAmf0NodePool::alloc(size);
+}
+
+void SrsAmf0Any::operator delete(void *p, size_t size)
+{
+    SrsAmf0NodePool::free(p, size);
+}
+
 bool SrsAmf0Any::is_string()
 {
     return marker_ == RTMP_AMF0_String;
@@ -440,6 +487,16 @@ SrsUnSortedHashtable::~SrsUnSortedHashtable()
     clear();
 }
 
+void *SrsUnSortedHashtable::operator new(size_t size)
+{
+    return SrsAmf0NodePool::alloc(size);
+}
+
+void SrsUnSortedHashtable::operator delete(void *p, size_t size)
+{
+    SrsAmf0NodePool::free(p, size);
+}
+
 int SrsUnSortedHashtable::count()
 {
     return (int)properties_.size();
@@ -483,7 +540,7 @@ void SrsUnSortedHashtable::set(string key, SrsAmf0Any *value)
 
     for (it = properties_.begin(); it != properties_.end(); ++it) {
         SrsAmf0ObjectPropertyType &elem = *it;
-        std::string name = elem.first;
+        const std::string &name = elem.first;
         SrsAmf0Any *any = elem.second;
 
         if (key == name) {
@@ -504,7 +561,7 @@ SrsAmf0Any *SrsUnSortedHashtable::get_property(string name)
 
     for (it = properties_.begin(); it != properties_.end(); ++it) {
         SrsAmf0ObjectPropertyType &elem = *it;
-        std::string key = elem.first;
+        const std::string &key = elem.first;
         SrsAmf0Any *any = elem.second;
         if (key == name) {
             return any;
@@ -1706,14 +1763,16 @@ srs_error_t srs_amf0_read_utf8(SrsBuffer *stream, string &value)
     if (!stream->require(len)) {
         return srs_error_new(ERROR_RTMP_AMF0_DECODE, "requires %d only %d bytes", len, stream->left());
     }
-    std::string str = stream->read_string(len);
+    // Assign from the payload directly, to avoid the copy of a temporary string.
+    value.assign(stream->head(), len);
+    stream->skip(len);
 
     // support utf8-1 only
     // 1.3.1 Strings and UTF-8
     // UTF8-1 = %x00-7F
     // TODO: support other utf-8 strings
     /*for (int i = 0; i < len; i++) {
-     char ch = *(str.data() + i);
+     char ch = *(value.data() + i);
      if ((ch & 0x80) != 0) {
      ret = ERROR_RTMP_AMF0_DECODE;
      srs_error("ignored. only support utf8-1, 0x00-0x7F, actual is %#x. ret=%d", (int)ch, ret);
@@ -1721,8 +1780,6 @@ srs_error_t srs_amf0_read_utf8(SrsBuffer *stream, string &value)
      }
      }*/
 
-    value = str;
-
     return err;
 }
 
@@ -97,6 +97,36 @@ class SrsAmf0Date;
  ////////////////////////////////////////////////////////////////////////
  */
 
+// The max size of AMF0 node to pool, larger nodes always go to the system allocator.
+#define SRS_AMF0_POOL_MAX_SIZE 128
+// The max free nodes cached for each size class, to bound the retained memory.
+#define SRS_AMF0_POOL_MAX_FREE 1024
+
+/**
+ * The free-list pool for AMF0 nodes. Each RTMP command (connect, publish, play)
+ * and each onMetaData decodes into a tree of small heap objects, which is freed
+ * once the packet is handled; in a reconnect storm this is a lot of malloc/free
+ * churn of the same few sizes. The pool recycles these nodes by size class, so
+ * the allocator is only touched until the pool is warm.
+ * @see SrsFreeListPool
+ */
+class SrsAmf0NodePool
+{
+public:
+    static void *alloc(size_t size);
+    static void free(void *p, size_t size);
+
+public:
+    // The number of allocations served from the free list.
+    static int64_t nn_reused();
+    // The number of allocations that went to the system allocator.
+    static int64_t nn_allocated();
+    // The number of free nodes cached in pool.
+    static int nn_free();
+    // Release all cached nodes to the system allocator.
+    static void shrink();
+};
+
 /**
  * any amf0 value.
  * 2.1 Types Overview
@@ -113,6 +143,11 @@ public:
 public:
     SrsAmf0Any();
     virtual ~SrsAmf0Any();
+
+public:
+    // Allocate the AMF0 nodes from the pool, @see SrsAmf0NodePool.
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
     // type identify, user should identify the type then convert from/to value.
 public:
     /**
@@ -827,6 +862,11 @@ public:
     SrsUnSortedHashtable();
     virtual ~SrsUnSortedHashtable();
 
+public:
+    // Allocate the hashtable from the pool, @see SrsAmf0NodePool.
+    static void *operator new(size_t size);
+    static void operator delete(void *p, size_t size);
+
 public:
     virtual int count();
     virtual void clear();
@@ -376,8 +376,19 @@ srs_error_t SrsHttpClient::post(string path, string req, ISrsHttpMessage **ppmsg
         return srs_error_wrap(err, "http: write");
     }
 
+    // The server may close the idle keep-alive connection, so we got EOF or reset before any response byte,
+    // which means the request is never handled, and it's safe to retry by caller.
+    int64_t nn_recv = transport_->get_recv_bytes();
+
     ISrsHttpMessage *msg = NULL;
     if ((err = parser_->parse_message(reader(), &msg)) != srs_success) {
+        if (srs_error_code(err) == ERROR_SOCKET_READ && nn_recv == transport_->get_recv_bytes()) {
+            string summary = srs_error_summary(err);
+            srs_freep(err);
+
+            disconnect();
+            return srs_error_new(ERROR_HTTP_NO_RESPONSE, "http: no response, %s", summary.c_str());
+        }
         return srs_error_wrap(err, "http: parse response");
     }
     srs_assert(msg);
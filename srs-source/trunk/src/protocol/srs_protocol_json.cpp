@@ -1963,3 +1963,144 @@ SrsAmf0Any *SrsJsonArray::to_amf0()
 ////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////
 ////////////////////////////////////////////////////////////////////////////////////////////////
+
+ISrsJsonSink::ISrsJsonSink()
+{
+}
+
+ISrsJsonSink::~ISrsJsonSink()
+{
+}
+
+SrsJsonWriter::SrsJsonWriter(ISrsJsonSink *sink, int chunk_size)
+{
+    sink_ = sink;
+    chunk_size_ = chunk_size;
+    after_key_ = false;
+}
+
+SrsJsonWriter::~SrsJsonWriter()
+{
+}
+
+void SrsJsonWriter::object_start()
+{
+    before_value();
+    buf_.append(SRS_JOBJECT_START);
+    commas_.push_back(false);
+}
+
+void SrsJsonWriter::object_end()
+{
+    buf_.append(SRS_JOBJECT_END);
+    if (!commas_.empty()) {
+        commas_.pop_back();
+    }
+}
+
+void SrsJsonWriter::array_start()
+{
+    before_value();
+    buf_.append(SRS_JARRAY_START);
+    commas_.push_back(false);
+}
+
+void SrsJsonWriter::array_end()
+{
+    buf_.append(SRS_JARRAY_END);
+    if (!commas_.empty()) {
+        commas_.pop_back();
+    }
+}
+
+void SrsJsonWriter::key(const std::string &k)
+{
+    before_value();
+    buf_.append(json_serialize_string(k));
+    buf_.append(":");
+    after_key_ = true;
+}
+
+void SrsJsonWriter::str(const std::string &v)
+{
+    before_value();
+    buf_.append(json_serialize_string(v));
+}
+
+void SrsJsonWriter::integer(int64_t v)
+{
+    before_value();
+    buf_.append(srs_strconv_format_int(v));
+}
+
+void SrsJsonWriter::number(double v)
+{
+    before_value();
+
+    // Keep the same format as SrsJsonAny::dumps().
+    char tmp[21 + 1];
+    snprintf(tmp, sizeof(tmp), "%.2f", v);
+    buf_.append(tmp);
+}
+
+void SrsJsonWriter::boolean(bool v)
+{
+    before_value();
+    buf_.append(v ? "true" : "false");
+}
+
+void SrsJsonWriter::null()
+{
+    before_value();
+    buf_.append("null");
+}
+
+void SrsJsonWriter::raw(const std::string &v)
+{
+    before_value();
+    buf_.append(v);
+}
+
+srs_error_t SrsJsonWriter::flush(bool force)
+{
+    srs_error_t err = srs_success;
+
+    if (!sink_ || buf_.empty()) {
+        return err;
+    }
+
+    if (!force && (int)buf_.size() < chunk_size_) {
+        return err;
+    }
+
+    if ((err = sink_->write_json(buf_)) != srs_success) {
+        return srs_error_wrap(err, "write json chunk");
+    }
+
+    buf_.clear();
+
+    return err;
+}
+
+std::string &SrsJsonWriter::buffer()
+{
+    return buf_;
+}
+
+void SrsJsonWriter::before_value()
+{
+    // The value of key, never write comma.
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+
+    if (commas_.empty()) {
+        return;
+    }
+
+    if (commas_.back()) {
+        buf_.append(SRS_JFIELD_CONT);
+    }
+    commas_.back() = true;
+}
@@ -171,4 +171,74 @@ public:
 ////////////////////////////////////////////////////////////////////////
 // JSON encode, please use JSON.dumps() to encode json object.
 
+// The sink of streaming JSON writer, to consume the JSON text chunk by chunk.
+class ISrsJsonSink
+{
+public:
+    ISrsJsonSink();
+    virtual ~ISrsJsonSink();
+
+public:
+    // Consume a chunk of JSON text, which is not a complete JSON.
+    virtual srs_error_t write_json(const std::string &chunk) = 0;
+};
+
+// The streaming JSON encoder, which writes JSON text without building the tree of SrsJsonAny, and
+// flush the text to sink in chunks. It's used for large JSON, for example, 100k clients:
+//      SrsJsonWriter jw(sink, 16 * 1024);
+//      jw.object_start();
+//      jw.key("clients"); jw.array_start();
+//      for (...) {
+//          jw.object_start(); jw.key("id"); jw.str(id); jw.object_end();
+//          if ((err = jw.flush()) != srs_success) { ... }
+//      }
+//      jw.array_end();
+//      jw.object_end();
+//      err = jw.flush(true);
+// @remark The writer never checks the structure, user should make sure the JSON is valid.
+class SrsJsonWriter
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    ISrsJsonSink *sink_;
+    // Flush the buffer to sink when exceed this size.
+    int chunk_size_;
+    std::string buf_;
+    // For each level of object or array, whether there is already a value, so a comma is required.
+    std::vector<bool> commas_;
+    // Whether the key is written, so the next value is for the key and without comma.
+    bool after_key_;
+
+public:
+    // @param sink The sink to consume JSON chunks, NULL to keep all text in buffer.
+    SrsJsonWriter(ISrsJsonSink *sink = NULL, int chunk_size = 0);
+    virtual ~SrsJsonWriter();
+
+public:
+    void object_start();
+    void object_end();
+    void array_start();
+    void array_end();
+    void key(const std::string &k);
+    void str(const std::string &v);
+    void integer(int64_t v);
+    void number(double v);
+    void boolean(bool v);
+    void null();
+    // Write a JSON value in text, for example, dumps of a SrsJsonAny.
+    void raw(const std::string &v);
+
+public:
+    // Flush the buffer to sink if it's large than the chunk size.
+    // @param force Whether flush the buffer even it's small.
+    srs_error_t flush(bool force = false);
+    // Get the buffered JSON text, which is not flushed to sink.
+    std::string &buffer();
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // Write the comma if required, before a key or value.
+    void before_value();
+};
+
 #endif
@@ -217,7 +217,8 @@ srs_error_t SrsStunPacket::decode(const char *buf, const int nb_buf)
 {
     srs_error_t err = srs_success;
 
-    SrsUniquePtr<SrsBuffer> stream(new SrsBuffer(const_cast<char *>(buf), nb_buf));
+    SrsBuffer b(const_cast<char *>(buf), nb_buf);
+    SrsBuffer *stream = &b;
 
     if (stream->left() < 20) {
         return srs_error_new(ERROR_RTC_STUN, "invalid stun packet, size=%d", stream->size());
@@ -225,7 +226,7 @@ srs_error_t SrsStunPacket::decode(const char *buf, const int nb_buf)
 
     message_type_ = stream->read_2bytes();
     uint16_t message_len = stream->read_2bytes();
-    string magic_cookie = stream->read_string(4);
+    stream->skip(4); // magic cookie
     transcation_id_ = stream->read_string(12);
 
     if (nb_buf != 20 + message_len) {
@@ -240,10 +241,16 @@ srs_error_t SrsStunPacket::decode(const char *buf, const int nb_buf)
             return srs_error_new(ERROR_RTC_STUN, "invalid stun packet");
         }
 
-        string val = stream->read_string(len);
+        // Only the USERNAME is used, skip the value of others, to avoid allocating strings.
+        string val;
+        if (type == Username) {
+            val = stream->read_string(len);
+        } else {
+            stream->skip(len);
+        }
         // padding
         if (len % 4 != 0) {
-            stream->read_string(4 - (len % 4));
+            stream->skip(4 - (len % 4));
         }
 
         switch (type) {
@@ -399,3 +406,138 @@ string SrsStunPacket::encode_fingerprint(uint32_t crc32)
 
     return string(stream->data(), stream->pos());
 }
+
+SrsStunBindingResponder::SrsStunBindingResponder()
+{
+    hmac_ = NULL;
+}
+
+SrsStunBindingResponder::~SrsStunBindingResponder()
+{
+    if (hmac_) {
+        HMAC_CTX_free(hmac_);
+    }
+}
+
+srs_error_t SrsStunBindingResponder::encode(SrsStunPacket *r, const string &pwd, uint32_t mapped_address, uint16_t mapped_port, SrsBuffer *stream)
+{
+    srs_error_t err = srs_success;
+
+    // Fallback to the general encoder, for the template is for the 12 bytes transaction id.
+    string tid = r->get_transcation_id();
+    if (tid.size() != 12) {
+        SrsStunPacket res;
+        res.set_message_type(BindingResponse);
+        res.set_local_ufrag(r->get_remote_ufrag());
+        res.set_remote_ufrag(r->get_local_ufrag());
+        res.set_transcation_id(tid);
+        res.set_mapped_address(mapped_address);
+        res.set_mapped_port(mapped_port);
+        return res.encode(pwd, stream);
+    }
+
+    // Rebuild the template only when ufrags changed, for ICE restart.
+    if (template_.empty() || local_ufrag_ != r->get_local_ufrag() || remote_ufrag_ != r->get_remote_ufrag()) {
+        if ((err = build_template(r)) != srs_success) {
+            return srs_error_wrap(err, "build template");
+        }
+    }
+
+    // Reset the HMAC with the same key, or setup the key when pwd changed.
+    if (!hmac_ && (hmac_ = HMAC_CTX_new()) == NULL) {
+        return srs_error_new(ERROR_RTC_STUN, "hmac init failed");
+    }
+    if (pwd_.empty() || pwd_ != pwd) {
+        if (!HMAC_Init_ex(hmac_, pwd.data(), pwd.size(), EVP_sha1(), NULL)) {
+            return srs_error_new(ERROR_RTC_STUN, "hmac init failed");
+        }
+        pwd_ = pwd;
+    } else if (!HMAC_Init_ex(hmac_, NULL, 0, NULL, NULL)) {
+        return srs_error_new(ERROR_RTC_STUN, "hmac reset failed");
+    }
+
+    // The template, MESSAGE-INTEGRITY(4+20 bytes) and FINGERPRINT(4+4 bytes).
+    int size = (int)template_.size();
+    if (!stream->require(size + 24 + 8)) {
+        return srs_error_new(ERROR_RTC_STUN, "requires %d bytes", size + 24 + 8);
+    }
+
+    char *p = stream->head();
+    stream->write_bytes((char *)template_.data(), size);
+    memcpy(p + 8, tid.data(), 12);
+
+    // The XOR-MAPPED-ADDRESS is the last attribute of template.
+    SrsBuffer mapped(p + size - 6, 6);
+    mapped.write_2bytes(mapped_port ^ (kStunMagicCookie >> 16));
+    mapped.write_4bytes(mapped_address ^ kStunMagicCookie);
+
+    // The length in header already includes the MESSAGE-INTEGRITY.
+    unsigned char hmac_buf[20];
+    unsigned int hmac_buf_len = 0;
+    if (!HMAC_Update(hmac_, (const unsigned char *)p, size) || !HMAC_Final(hmac_, hmac_buf, &hmac_buf_len)) {
+        return srs_error_new(ERROR_RTC_STUN, "hmac sign failed");
+    }
+
+    stream->write_2bytes(MessageIntegrity);
+    stream->write_2bytes(hmac_buf_len);
+    stream->write_bytes((char *)hmac_buf, hmac_buf_len);
+
+    // Include the FINGERPRINT in length, then sign the CRC32.
+    int nn = size + 4 + hmac_buf_len;
+    p[2] = ((nn - 20 + 8) & 0x0000FF00) >> 8;
+    p[3] = ((nn - 20 + 8) & 0x000000FF);
+
+    uint32_t crc32 = srs_crc32_ieee(p, nn, 0) ^ 0x5354554E;
+    stream->write_2bytes(Fingerprint);
+    stream->write_2bytes(4);
+    stream->write_4bytes(crc32);
+
+    return err;
+}
+
+srs_error_t SrsStunBindingResponder::build_template(SrsStunPacket *r)
+{
+    srs_error_t err = srs_success;
+
+    local_ufrag_ = r->get_local_ufrag();
+    remote_ufrag_ = r->get_remote_ufrag();
+
+    // The response username is the same to request, see SrsStunPacket::encode_username.
+    string username = local_ufrag_ + ":" + remote_ufrag_;
+
+    char buf[1460] = {0};
+    SrsBuffer stream(buf, sizeof(buf));
+    if (!stream.require(20 + 4 + (int)username.size() + 4 + 12)) {
+        return srs_error_new(ERROR_RTC_STUN, "invalid username size=%d", (int)username.size());
+    }
+
+    // Header, the transaction id is patched for each request.
+    stream.write_2bytes(BindingResponse);
+    stream.write_2bytes(0);
+    stream.write_4bytes(kStunMagicCookie);
+    stream.skip(12);
+
+    stream.write_2bytes(Username);
+    stream.write_2bytes(username.size());
+    stream.write_string(username);
+    if (stream.pos() % 4 != 0) {
+        static char padding[4] = {0};
+        stream.write_bytes(padding, 4 - (stream.pos() % 4));
+    }
+
+    // The XOR-MAPPED-ADDRESS, the port and address is patched for each request.
+    stream.write_2bytes(XorMappedAddress);
+    stream.write_2bytes(8);
+    stream.write_1bytes(0); // ignore this bytes
+    stream.write_1bytes(1); // ipv4 family
+    stream.write_2bytes(0);
+    stream.write_4bytes(0);
+
+    // The length includes the MESSAGE-INTEGRITY, which is signed.
+    buf[2] = ((stream.pos() - 20 + 20 + 4) & 0x0000FF00) >> 8;
+    buf[3] = ((stream.pos() - 20 + 20 + 4) & 0x000000FF);
+
+    template_ = string(buf, stream.pos());
+
+    return err;
+}
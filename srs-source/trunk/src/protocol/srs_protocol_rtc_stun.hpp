@@ -11,6 +11,8 @@
 
 #include <string>
 
+#include <openssl/hmac.h>
+
 #include <srs_kernel_error.hpp>
 
 class SrsBuffer;
@@ -107,6 +109,36 @@ SRS_DECLARE_PRIVATE: // clang-format on
     std::string encode_fingerprint(uint32_t crc32);
 };
 
+// The STUN binding responder of a session, for ICE consent checks are sent by each peer every
+// few seconds. It caches the encoded response and the HMAC key, so only the transaction id and
+// the XOR-MAPPED-ADDRESS are patched, then sign the MESSAGE-INTEGRITY and FINGERPRINT for each
+// request. The response is the same as SrsStunPacket::encode.
+class SrsStunBindingResponder
+{
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    // The HMAC-SHA1 context, keyed by the ice pwd.
+    HMAC_CTX *hmac_;
+    std::string pwd_;
+    // The ufrags of request, for which the response template is built.
+    std::string local_ufrag_;
+    std::string remote_ufrag_;
+    // The response header, USERNAME and XOR-MAPPED-ADDRESS, without transaction id and address.
+    std::string template_;
+
+public:
+    SrsStunBindingResponder();
+    virtual ~SrsStunBindingResponder();
+
+public:
+    // Encode the binding response of request r to stream, signed by pwd.
+    srs_error_t encode(SrsStunPacket *r, const std::string &pwd, uint32_t mapped_address, uint16_t mapped_port, SrsBuffer *stream);
+
+// clang-format off
+SRS_DECLARE_PRIVATE: // clang-format on
+    srs_error_t build_template(SrsStunPacket *r);
+};
+
 // Calc the crc32 of bytes in buf by IEEE, for zip.
 extern uint32_t srs_crc32_ieee(const void *buf, int size, uint32_t previous = 0);
 
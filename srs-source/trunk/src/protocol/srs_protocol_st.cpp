@@ -8,6 +8,7 @@
 
 #include <fcntl.h>
 #include <netdb.h>
+#include <poll.h>
 #include <st.h>
 #include <sys/resource.h>
 #include <sys/socket.h>
@@ -562,6 +563,32 @@ int srs_sendmsg(srs_netfd_t stfd, const struct msghdr *msg, int flags, srs_utime
     return st_sendmsg((st_netfd_t)stfd, msg, flags, (st_utime_t)timeout);
 }
 
+#ifdef __linux__
+int srs_recvmmsg(srs_netfd_t stfd, struct mmsghdr *msgvec, unsigned int vlen, int flags, srs_utime_t timeout)
+{
+    int osfd = st_netfd_fileno((st_netfd_t)stfd);
+
+    // Like st_recvmsg, read without blocking, and wait in ST when there is no packet.
+    while (true) {
+        int n = ::recvmmsg(osfd, msgvec, vlen, flags | MSG_DONTWAIT, NULL);
+        if (n >= 0) {
+            return n;
+        }
+
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            return -1;
+        }
+
+        if (st_netfd_poll((st_netfd_t)stfd, POLLIN, (st_utime_t)timeout) < 0) {
+            return -1;
+        }
+    }
+}
+#endif
+
 srs_netfd_t srs_accept(srs_netfd_t stfd, struct sockaddr *addr, int *addrlen, srs_utime_t timeout)
 {
     return (srs_netfd_t)st_accept((st_netfd_t)stfd, addr, addrlen, (st_utime_t)timeout);
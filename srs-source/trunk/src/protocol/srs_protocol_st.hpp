@@ -142,6 +142,11 @@ extern int srs_recvfrom(srs_netfd_t stfd, void *buf, int len, struct sockaddr *f
 extern int srs_sendto(srs_netfd_t stfd, void *buf, int len, const struct sockaddr *to, int tolen, srs_utime_t timeout);
 extern int srs_recvmsg(srs_netfd_t stfd, struct msghdr *msg, int flags, srs_utime_t timeout);
 extern int srs_sendmsg(srs_netfd_t stfd, const struct msghdr *msg, int flags, srs_utime_t timeout);
+#ifdef __linux__
+// Receive multiple packets by one recvmmsg, wait in ST if no packet. Return the number of
+// packets received, or -1 with errno set, for example, ETIME for timeout.
+extern int srs_recvmmsg(srs_netfd_t stfd, struct mmsghdr *msgvec, unsigned int vlen, int flags, srs_utime_t timeout);
+#endif
 
 extern srs_netfd_t srs_accept(srs_netfd_t stfd, struct sockaddr *addr, int *addrlen, srs_utime_t timeout);
 
@@ -299,42 +299,37 @@ string srs_net_url_encode_rtmp_url(string server, int port, string host, string
     return url;
 }
 
+// Initialize the message header by the FLV tag type.
+srs_error_t srs_rtmp_create_header(char type, uint32_t timestamp, int size, int stream_id, SrsMessageHeader *header)
+{
+    if (type == SrsFrameTypeAudio) {
+        header->initialize_audio(size, timestamp, stream_id);
+    } else if (type == SrsFrameTypeVideo) {
+        header->initialize_video(size, timestamp, stream_id);
+    } else if (type == SrsFrameTypeScript) {
+        header->initialize_amf0_script(size, stream_id);
+    } else {
+        return srs_error_new(ERROR_STREAM_CASTER_FLV_TAG, "unknown tag=%#x", (uint8_t)type);
+    }
+
+    return srs_success;
+}
+
 srs_error_t srs_do_rtmp_create_msg(char type, uint32_t timestamp, char *data, int size, int stream_id, SrsRtmpCommonMessage **ppmsg)
 {
     srs_error_t err = srs_success;
 
     *ppmsg = NULL;
-    SrsRtmpCommonMessage *msg = NULL;
-
-    if (type == SrsFrameTypeAudio) {
-        SrsMessageHeader header;
-        header.initialize_audio(size, timestamp, stream_id);
 
-        msg = new SrsRtmpCommonMessage();
-        if ((err = msg->create(&header, data, size)) != srs_success) {
-            srs_freep(msg);
-            return srs_error_wrap(err, "create message");
-        }
-    } else if (type == SrsFrameTypeVideo) {
-        SrsMessageHeader header;
-        header.initialize_video(size, timestamp, stream_id);
-
-        msg = new SrsRtmpCommonMessage();
-        if ((err = msg->create(&header, data, size)) != srs_success) {
-            srs_freep(msg);
-            return srs_error_wrap(err, "create message");
-        }
-    } else if (type == SrsFrameTypeScript) {
-        SrsMessageHeader header;
-        header.initialize_amf0_script(size, stream_id);
+    SrsMessageHeader header;
+    if ((err = srs_rtmp_create_header(type, timestamp, size, stream_id, &header)) != srs_success) {
+        return srs_error_wrap(err, "create header");
+    }
 
-        msg = new SrsRtmpCommonMessage();
-        if ((err = msg->create(&header, data, size)) != srs_success) {
-            srs_freep(msg);
-            return srs_error_wrap(err, "create message");
-        }
-    } else {
-        return srs_error_new(ERROR_STREAM_CASTER_FLV_TAG, "unknown tag=%#x", (uint8_t)type);
+    SrsRtmpCommonMessage *msg = new SrsRtmpCommonMessage();
+    if ((err = msg->create(&header, data, size)) != srs_success) {
+        srs_freep(msg);
+        return srs_error_wrap(err, "create message");
     }
 
     *ppmsg = msg;
@@ -355,6 +350,29 @@ srs_error_t srs_rtmp_create_msg(char type, uint32_t timestamp, char *data, int s
     return err;
 }
 
+srs_error_t srs_rtmp_create_msg(char type, uint32_t timestamp, SrsMemoryBlock *payload, int stream_id, SrsRtmpCommonMessage **ppmsg)
+{
+    srs_error_t err = srs_success;
+
+    // The payload is freed by the shared ptr, when failed or the message is freed.
+    SrsSharedPtr<SrsMemoryBlock> block(payload);
+
+    *ppmsg = NULL;
+
+    SrsMessageHeader header;
+    if ((err = srs_rtmp_create_header(type, timestamp, payload->size(), stream_id, &header)) != srs_success) {
+        return srs_error_wrap(err, "create header");
+    }
+
+    SrsRtmpCommonMessage *msg = new SrsRtmpCommonMessage();
+    msg->header_ = header;
+    msg->payload_ = block;
+
+    *ppmsg = msg;
+
+    return err;
+}
+
 ISrsProtocolUtility::ISrsProtocolUtility()
 {
 }
@@ -36,6 +36,7 @@ class ISrsHttpMessage;
 class SrsMessageHeader;
 class SrsMediaPacket;
 class SrsRtmpCommonMessage;
+class SrsMemoryBlock;
 class ISrsProtocolReadWriter;
 class ISrsReader;
 
@@ -104,6 +105,12 @@ extern std::string srs_net_url_encode_rtmp_url(std::string server, int port, std
  * @param ppmsg output the shared ptr message. user should free it.
  */
 extern srs_error_t srs_rtmp_create_msg(char type, uint32_t timestamp, char *data, int size, int stream_id, SrsRtmpCommonMessage **ppmsg);
+/**
+ * create shared ptr message from memory block, which maybe a slice of a larger block.
+ * @param payload the payload of message. user should never free it, even when failed.
+ * @param ppmsg output the shared ptr message. user should free it.
+ */
+extern srs_error_t srs_rtmp_create_msg(char type, uint32_t timestamp, SrsMemoryBlock *payload, int stream_id, SrsRtmpCommonMessage **ppmsg);
 
 struct SrsIPAddress {
     // The network interface name, such as eth0, en0, eth1.
@@ -817,6 +817,62 @@ VOID TEST(KernelRTCQueueTest, RtpNackForReceiver)
     EXPECT_GE(timeout_nacks, 0);
 }
 
+VOID TEST(KernelRTCQueueTest, RtpNackCacheEvictByBytes)
+{
+    // Each packet is 12 bytes header and 88 bytes payload, so the cache keeps 10 packets.
+    SrsRtpNackCache cache(1000);
+    char payload[88];
+    memset(payload, 0, sizeof(payload));
+
+    for (int i = 0; i < 20; i++) {
+        SrsRtpPacket pkt;
+        pkt.header_.set_ssrc(100);
+        pkt.header_.set_sequence(i);
+        pkt.header_.set_timestamp(i * 90);
+
+        SrsRtpRawPayload *raw = new SrsRtpRawPayload();
+        raw->payload_ = payload;
+        raw->nn_payload_ = sizeof(payload);
+        pkt.set_payload(raw, SrsRtpPacketPayloadTypeRaw);
+
+        cache.put(&pkt);
+    }
+
+    EXPECT_EQ(10, cache.nn_packets());
+    EXPECT_EQ(1000, cache.nn_bytes());
+
+    // The oldest packets are evicted.
+    EXPECT_TRUE(cache.find(100, 9) == NULL);
+    EXPECT_TRUE(cache.find(100, 10) != NULL);
+    EXPECT_TRUE(cache.find(100, 19) != NULL);
+    EXPECT_EQ(19 * 90, (int)cache.find(100, 19)->header_.get_timestamp());
+    EXPECT_TRUE(cache.find(200, 19) == NULL);
+
+    // Overwrite the packet in the same slot.
+    if (true) {
+        SrsRtpPacket pkt;
+        pkt.header_.set_ssrc(100);
+        pkt.header_.set_sequence(19 + SRS_RTP_NACK_CACHE_SLOTS);
+
+        SrsRtpRawPayload *raw = new SrsRtpRawPayload();
+        raw->payload_ = payload;
+        raw->nn_payload_ = sizeof(payload);
+        pkt.set_payload(raw, SrsRtpPacketPayloadTypeRaw);
+
+        cache.put(&pkt);
+    }
+
+    EXPECT_TRUE(cache.find(100, 19) == NULL);
+    EXPECT_TRUE(cache.find(100, 19 + SRS_RTP_NACK_CACHE_SLOTS) != NULL);
+    EXPECT_EQ(10, cache.nn_packets());
+    EXPECT_EQ(1000, cache.nn_bytes());
+
+    cache.clear();
+    EXPECT_EQ(0, cache.nn_packets());
+    EXPECT_EQ(0, cache.nn_bytes());
+    EXPECT_TRUE(cache.find(100, 10) == NULL);
+}
+
 // Tests for srs_kernel_error.hpp
 VOID TEST(KernelErrorTest, ErrorCheckingFunctions)
 {
@@ -1682,6 +1738,100 @@ VOID TEST(KernelRtcpTest, SrsRtcpTWCC)
     EXPECT_GT(twcc.nb_bytes(), 0);
 }
 
+VOID TEST(KernelRtcpTest, SrsRtcpNackDecodeBitmask)
+{
+    srs_error_t err;
+
+    // The PID=100, BLP=0x8001, so lost 100, 101 and 116.
+    uint8_t data[] = {
+        0x81, 0xcd, 0x00, 0x03, // V=2, P=0, FMT=1, PT=205(RTPFB), length=3
+        0x12, 0x34, 0x56, 0x78, // SSRC of packet sender
+        0x87, 0x65, 0x43, 0x21, // SSRC of media source
+        0x00, 0x64, 0x80, 0x01  // PID, BLP
+    };
+
+    SrsRtcpNack nack;
+    SrsBuffer buffer((char *)data, sizeof(data));
+    HELPER_EXPECT_SUCCESS(nack.decode(&buffer));
+
+    std::vector<uint16_t> lost_sns = nack.get_lost_sns();
+    ASSERT_EQ(3, (int)lost_sns.size());
+    EXPECT_EQ(100, lost_sns[0]);
+    EXPECT_EQ(101, lost_sns[1]);
+    EXPECT_EQ(116, lost_sns[2]);
+}
+
+VOID TEST(KernelRtcpTest, SrsRtcpTWCCRecvWindow)
+{
+    srs_error_t err;
+
+    SrsRtcpTWCC twcc(0x12345678);
+    twcc.set_media_ssrc(0x87654321);
+
+    // Packets around the sequence flip back, with 65535 and 1 lost, and 0 reordered.
+    HELPER_EXPECT_SUCCESS(twcc.recv_packet(65533, 1000000));
+    HELPER_EXPECT_SUCCESS(twcc.recv_packet(65534, 1001000));
+    HELPER_EXPECT_SUCCESS(twcc.recv_packet(2, 1004000));
+    HELPER_EXPECT_SUCCESS(twcc.recv_packet(0, 1002000));
+    HELPER_EXPECT_FAILED(twcc.recv_packet(65534, 1005000));
+    HELPER_EXPECT_FAILED(twcc.recv_packet(65533 - kTwccFbRecvWindow, 1005000));
+    EXPECT_TRUE(twcc.need_feedback());
+
+    char buf[kMaxUDPDataSize];
+    SrsBuffer buffer(buf, sizeof(buf));
+    HELPER_EXPECT_SUCCESS(twcc.encode(&buffer));
+    EXPECT_FALSE(twcc.need_feedback());
+
+    // The base sequence and packet status count, including the lost packets.
+    SrsBuffer reader(buf, buffer.pos());
+    reader.skip(12);
+    EXPECT_EQ(65533, (uint16_t)reader.read_2bytes());
+    EXPECT_EQ(6, reader.read_2bytes());
+
+    // The window restarts after feedback.
+    HELPER_EXPECT_SUCCESS(twcc.recv_packet(100, 2000000));
+    EXPECT_TRUE(twcc.need_feedback());
+}
+
+VOID TEST(KernelRtcpTest, SrsRtcpCompoundFromPool)
+{
+    srs_error_t err;
+
+    // A compound packet of RR and PLI.
+    uint8_t data[] = {
+        0x81, 0xc9, 0x00, 0x07, // V=2, P=0, RC=1, PT=201(RR), length=7
+        0x00, 0x00, 0x00, 0x01, // SSRC of packet sender
+        0x87, 0x65, 0x43, 0x21, // SSRC of source
+        0x00, 0x00, 0x00, 0x00, // fraction lost, cumulative lost
+        0x00, 0x00, 0x00, 0x64, // highest sequence
+        0x00, 0x00, 0x00, 0x00, // jitter
+        0x00, 0x00, 0x00, 0x00, // LSR
+        0x00, 0x00, 0x00, 0x00, // DLSR
+        0x81, 0xce, 0x00, 0x02, // V=2, P=0, FMT=1, PT=206(PSFB), length=2
+        0x00, 0x00, 0x00, 0x01, // SSRC of packet sender
+        0x87, 0x65, 0x43, 0x21  // SSRC of media source
+    };
+
+    for (int i = 0; i < 2; i++) {
+        int64_t nn_reused = srs_rtcp_pool()->nn_reused();
+
+        SrsRtcpCompound compound;
+        SrsBuffer buffer((char *)data, sizeof(data));
+        HELPER_EXPECT_SUCCESS(compound.decode(&buffer));
+
+        SrsUniquePtr<SrsRtcpCommon> pli(compound.get_next_rtcp());
+        SrsUniquePtr<SrsRtcpCommon> rr(compound.get_next_rtcp());
+        EXPECT_EQ(SrsRtcpType_psfb, pli->type());
+        EXPECT_EQ(SrsRtcpType_rr, rr->type());
+        EXPECT_TRUE(compound.get_next_rtcp() == NULL);
+
+        // The objects of second round are reused from pool.
+        if (i > 0) {
+            EXPECT_EQ(nn_reused + 2, srs_rtcp_pool()->nn_reused());
+        }
+    }
+}
+
 VOID TEST(KernelRtcpTest, SrsRtcpCompound)
 {
     srs_error_t err;
@@ -4571,3 +4571,56 @@ VOID TEST(RtcFrameBuilderTest, PacketVideoKeyFrame_ExactIsLostSnCodePathCoverage
         srs_freep(result);
     }
 }
+
+// Test SrsRtcFrameBuilder assembles the FU-A packets decoded lazily from the wire
+VOID TEST(RtcFrameBuilderTest, PacketVideoRtmp_LazilyDecodedFUA)
+{
+    srs_error_t err;
+
+    MockRtcFrameTarget target;
+    SrsRtcFrameBuilder builder(_srs_app_factory, &target);
+
+    SrsUniquePtr<MockRtcRequest> req(new MockRtcRequest());
+    HELPER_EXPECT_SUCCESS(builder.initialize(req.get(), SrsAudioCodecIdAAC, SrsVideoCodecIdAVC));
+
+    // The FU-A start and end of an IDR, each with 10 bytes fragment.
+    char data[2][24];
+    SrsUniquePtr<SrsRtpPacket> start(new SrsRtpPacket());
+    SrsUniquePtr<SrsRtpPacket> end(new SrsRtpPacket());
+    SrsRtpPacket *pkts[2] = {start.get(), end.get()};
+    for (int i = 0; i < 2; i++) {
+        memset(data[i], 0x30 + i, sizeof(data[i]));
+        SrsBuffer b(data[i], sizeof(data[i]));
+        b.write_1bytes(0x80);
+        b.write_1bytes(96);
+        b.write_2bytes(100 + i);
+        b.write_4bytes(90000);
+        b.write_4bytes(12345);
+        b.write_1bytes(0x60 | kFuA);
+        b.write_1bytes((i ? kEnd : kStart) | SrsAvcNaluTypeIDR);
+
+        // Like the publisher track, which only sets the payload type.
+        SrsBuffer rb(pkts[i]->wrap(data[i], sizeof(data[i])), sizeof(data[i]));
+        HELPER_EXPECT_SUCCESS(pkts[i]->decode(&rb));
+        pkts[i]->payload_type_ = SrsRtpPacketPayloadTypeFUA2;
+        EXPECT_TRUE(pkts[i]->payload_ == NULL);
+    }
+
+    // The start has the NALU header and the length prefix.
+    EXPECT_EQ(10 + 1 + 4, builder.calculate_packet_payload_size(start.get()));
+    EXPECT_EQ(10, builder.calculate_packet_payload_size(end.get()));
+
+    char out[25];
+    SrsBuffer ob(out, sizeof(out));
+    int nalu_len = 0;
+    builder.write_packet_payload_to_buffer(start.get(), ob, nalu_len);
+    builder.write_packet_payload_to_buffer(end.get(), ob, nalu_len);
+    EXPECT_EQ(25, ob.pos());
+    EXPECT_EQ(21, nalu_len);
+
+    SrsBuffer rb(out, sizeof(out));
+    EXPECT_EQ(21, rb.read_4bytes());
+    EXPECT_EQ(0x60 | SrsAvcNaluTypeIDR, rb.read_1bytes());
+    EXPECT_EQ(0, memcmp(rb.head(), data[0] + 14, 10));
+    EXPECT_EQ(0, memcmp(rb.head() + 10, data[1] + 14, 10));
+}
@@ -2291,10 +2291,10 @@ VOID TEST(SrsRtcVideoRecvTrackTest, OnBeforeDecodePayloadH264RawNALU)
     ISrsRtpPayloader *payload = NULL;
     SrsRtpPacketPayloadType ppt = SrsRtpPacketPayloadTypeUnknown;
 
-    // Test H.264 raw NALU - should create raw payload
+    // Test H.264 raw NALU - should set raw payload type, without payload
     track.on_before_decode_payload(pkt.get(), &buffer, &payload, &ppt);
 
-    EXPECT_TRUE(payload != NULL);
+    EXPECT_TRUE(payload == NULL);
     EXPECT_EQ(SrsRtpPacketPayloadTypeRaw, ppt);
     EXPECT_EQ(7, pkt->nalu_type_); // Should set NALU type to SPS (7)
 
@@ -2326,10 +2326,10 @@ VOID TEST(SrsRtcVideoRecvTrackTest, OnBeforeDecodePayloadH264STAP)
     ISrsRtpPayloader *payload = NULL;
     SrsRtpPacketPayloadType ppt = SrsRtpPacketPayloadTypeUnknown;
 
-    // Test H.264 STAP-A - should create STAP payload
+    // Test H.264 STAP-A - should set STAP payload type, without payload
     track.on_before_decode_payload(pkt.get(), &buffer, &payload, &ppt);
 
-    EXPECT_TRUE(payload != NULL);
+    EXPECT_TRUE(payload == NULL);
     EXPECT_EQ(SrsRtpPacketPayloadTypeSTAP, ppt);
     EXPECT_EQ(kStapA, pkt->nalu_type_); // Should set NALU type to STAP-A (24)
 
@@ -2360,10 +2360,10 @@ VOID TEST(SrsRtcVideoRecvTrackTest, OnBeforeDecodePayloadH264FUA)
     ISrsRtpPayloader *payload = NULL;
     SrsRtpPacketPayloadType ppt = SrsRtpPacketPayloadTypeUnknown;
 
-    // Test H.264 FU-A - should create FUA payload
+    // Test H.264 FU-A - should set FUA payload type, without payload
     track.on_before_decode_payload(pkt.get(), &buffer, &payload, &ppt);
 
-    EXPECT_TRUE(payload != NULL);
+    EXPECT_TRUE(payload == NULL);
     EXPECT_EQ(SrsRtpPacketPayloadTypeFUA2, ppt);
     EXPECT_EQ(kFuA, pkt->nalu_type_); // Should set NALU type to FU-A (28)
 
@@ -2391,10 +2391,10 @@ VOID TEST(SrsRtcVideoRecvTrackTest, OnBeforeDecodePayloadHEVCRawNALU)
     ISrsRtpPayloader *payload = NULL;
     SrsRtpPacketPayloadType ppt = SrsRtpPacketPayloadTypeUnknown;
 
-    // Test H.265 raw NALU - should create raw payload
+    // Test H.265 raw NALU - should set raw payload type, without payload
     track.on_before_decode_payload(pkt.get(), &buffer, &payload, &ppt);
 
-    EXPECT_TRUE(payload != NULL);
+    EXPECT_TRUE(payload == NULL);
     EXPECT_EQ(SrsRtpPacketPayloadTypeRaw, ppt);
     EXPECT_EQ(32, pkt->nalu_type_); // Should set NALU type to VPS (32)
 
@@ -2428,10 +2428,10 @@ VOID TEST(SrsRtcVideoRecvTrackTest, OnBeforeDecodePayloadHEVCSTAP)
     ISrsRtpPayloader *payload = NULL;
     SrsRtpPacketPayloadType ppt = SrsRtpPacketPayloadTypeUnknown;
 
-    // Test H.265 STAP - should create STAP HEVC payload
+    // Test H.265 STAP - should set STAP HEVC payload type, without payload
     track.on_before_decode_payload(pkt.get(), &buffer, &payload, &ppt);
 
-    EXPECT_TRUE(payload != NULL);
+    EXPECT_TRUE(payload == NULL);
     EXPECT_EQ(SrsRtpPacketPayloadTypeSTAPHevc, ppt);
     EXPECT_EQ(kStapHevc, pkt->nalu_type_); // Should set NALU type to STAP HEVC (48)
 
@@ -2463,10 +2463,10 @@ VOID TEST(SrsRtcVideoRecvTrackTest, OnBeforeDecodePayloadHEVCFUA)
     ISrsRtpPayloader *payload = NULL;
     SrsRtpPacketPayloadType ppt = SrsRtpPacketPayloadTypeUnknown;
 
-    // Test H.265 FU-A - should create FUA HEVC payload
+    // Test H.265 FU-A - should set FUA HEVC payload type, without payload
     track.on_before_decode_payload(pkt.get(), &buffer, &payload, &ppt);
 
-    EXPECT_TRUE(payload != NULL);
+    EXPECT_TRUE(payload == NULL);
     EXPECT_EQ(SrsRtpPacketPayloadTypeFUAHevc2, ppt);
     EXPECT_EQ(kFuHevc, pkt->nalu_type_); // Should set NALU type to FU HEVC (49)
 
@@ -2544,10 +2544,10 @@ VOID TEST(SrsRtcVideoRecvTrackTest, OnBeforeDecodePayloadH264IDR)
     ISrsRtpPayloader *payload = NULL;
     SrsRtpPacketPayloadType ppt = SrsRtpPacketPayloadTypeUnknown;
 
-    // Test H.264 IDR NALU - should create raw payload
+    // Test H.264 IDR NALU - should set raw payload type, without payload
     track.on_before_decode_payload(pkt.get(), &buffer, &payload, &ppt);
 
-    EXPECT_TRUE(payload != NULL);
+    EXPECT_TRUE(payload == NULL);
     EXPECT_EQ(SrsRtpPacketPayloadTypeRaw, ppt);
     EXPECT_EQ(5, pkt->nalu_type_); // Should set NALU type to IDR (5)
 
@@ -2575,10 +2575,10 @@ VOID TEST(SrsRtcVideoRecvTrackTest, OnBeforeDecodePayloadHEVCIDR)
     ISrsRtpPayloader *payload = NULL;
     SrsRtpPacketPayloadType ppt = SrsRtpPacketPayloadTypeUnknown;
 
-    // Test H.265 IDR NALU - should create raw payload
+    // Test H.265 IDR NALU - should set raw payload type, without payload
     track.on_before_decode_payload(pkt.get(), &buffer, &payload, &ppt);
 
-    EXPECT_TRUE(payload != NULL);
+    EXPECT_TRUE(payload == NULL);
     EXPECT_EQ(SrsRtpPacketPayloadTypeRaw, ppt);
     EXPECT_EQ(19, pkt->nalu_type_); // Should set NALU type to IDR (19)
 
@@ -2606,7 +2606,7 @@ VOID TEST(SrsRtcVideoRecvTrackTest, OnBeforeDecodePayloadSingleByte)
     // Test single byte buffer - should still work
     track.on_before_decode_payload(pkt.get(), &buffer, &payload, &ppt);
 
-    EXPECT_TRUE(payload != NULL);
+    EXPECT_TRUE(payload == NULL);
     EXPECT_EQ(SrsRtpPacketPayloadTypeRaw, ppt);
     EXPECT_EQ(7, pkt->nalu_type_); // Should set NALU type to SPS (7)
 
@@ -2614,6 +2614,99 @@ VOID TEST(SrsRtcVideoRecvTrackTest, OnBeforeDecodePayloadSingleByte)
     srs_freep(payload);
 }
 
+// Test the RTP packet decoded by video track, which parses the payload lazily
+VOID TEST(SrsRtcVideoRecvTrackTest, DecodePayloadLazily)
+{
+    srs_error_t err;
+
+    MockRtcPacketReceiver mock_receiver;
+    SrsUniquePtr<SrsRtcTrackDescription> desc(create_video_track_description("H264", 12345));
+    SrsRtcVideoRecvTrack track(&mock_receiver, desc.get(), false);
+
+    // The RTP packet of H.264 FU-A, the start of IDR.
+    char data[64];
+    memset(data, 0x42, sizeof(data));
+    if (true) {
+        SrsBuffer b(data, sizeof(data));
+        b.write_1bytes(0x80);
+        b.write_1bytes(96);
+        b.write_2bytes(100);
+        b.write_4bytes(1000);
+        b.write_4bytes(12345);
+        b.write_1bytes(0x60 | kFuA);
+        b.write_1bytes(kStart | SrsAvcNaluTypeIDR);
+    }
+
+    SrsUniquePtr<SrsRtpPacket> pkt(new SrsRtpPacket());
+    pkt->set_decode_handler(&track);
+    SrsBuffer b(pkt->wrap(data, sizeof(data)), sizeof(data));
+    HELPER_EXPECT_SUCCESS(pkt->decode(&b));
+
+    // Keyframe by peeking the FU header, without payloader.
+    EXPECT_TRUE(pkt->payload_ == NULL);
+    EXPECT_EQ(SrsRtpPacketPayloadTypeFUA2, pkt->payload_type_);
+    EXPECT_TRUE(pkt->is_keyframe(SrsVideoCodecIdAVC));
+    EXPECT_EQ(64, (int)pkt->nb_bytes());
+
+    // The copy for player forwards the payload as is.
+    SrsUniquePtr<SrsRtpPacket> cp(pkt->copy());
+    char out[64];
+    SrsBuffer ob(out, sizeof(out));
+    HELPER_EXPECT_SUCCESS(cp->encode(&ob));
+    EXPECT_EQ(64, ob.pos());
+    EXPECT_EQ(0, memcmp(data, out, sizeof(data)));
+    EXPECT_TRUE(cp->payload_ == NULL);
+
+    // Parse the payload on the first access.
+    SrsRtpFUAPayload2 *fua = dynamic_cast<SrsRtpFUAPayload2 *>(pkt->payload());
+    ASSERT_TRUE(fua != NULL);
+    EXPECT_TRUE(fua->start_);
+    EXPECT_EQ(SrsAvcNaluTypeIDR, fua->nalu_type_);
+    EXPECT_EQ(50, fua->size_);
+    EXPECT_TRUE(pkt->is_keyframe(SrsVideoCodecIdAVC));
+
+    // The corrupt FU-A without payload is rejected at decode, never forwarded.
+    if (true) {
+        char bad[14];
+        memcpy(bad, data, sizeof(bad));
+
+        SrsUniquePtr<SrsRtpPacket> p(new SrsRtpPacket());
+        p->set_decode_handler(&track);
+        SrsBuffer b(p->wrap(bad, sizeof(bad)), sizeof(bad));
+        HELPER_EXPECT_FAILED(p->decode(&b));
+    }
+
+    // The corrupt STAP-A whose NALU exceeds the packet is rejected at decode.
+    if (true) {
+        char bad[16];
+        memcpy(bad, data, 12);
+        SrsBuffer w(bad + 12, 4);
+        w.write_1bytes(0x60 | kStapA);
+        w.write_2bytes(16);
+        w.write_1bytes(0x67);
+
+        SrsUniquePtr<SrsRtpPacket> p(new SrsRtpPacket());
+        p->set_decode_handler(&track);
+        SrsBuffer b(p->wrap(bad, sizeof(bad)), sizeof(bad));
+        HELPER_EXPECT_FAILED(p->decode(&b));
+    }
+
+    // The corrupt STAP-A with forbidden_zero_bit is rejected at decode.
+    if (true) {
+        char bad[16];
+        memcpy(bad, data, 12);
+        SrsBuffer w(bad + 12, 4);
+        w.write_1bytes(0x80 | 0x60 | kStapA);
+        w.write_2bytes(1);
+        w.write_1bytes(0x67);
+
+        SrsUniquePtr<SrsRtpPacket> p(new SrsRtpPacket());
+        p->set_decode_handler(&track);
+        SrsBuffer b(p->wrap(bad, sizeof(bad)), sizeof(bad));
+        HELPER_EXPECT_FAILED(p->decode(&b));
+    }
+}
+
 // Test SrsRtcVideoRecvTrack::check_send_nacks (basic functionality)
 VOID TEST(SrsRtcVideoRecvTrackTest, CheckSendNacksBasic)
 {
@@ -2945,7 +3038,7 @@ VOID TEST(SrsRtcAudioRecvTrackTest, OnBeforeDecodePayload)
         EXPECT_EQ(SrsRtpPacketPayloadTypeUnknown, ppt);
     }
 
-    // Test case 2: Non-empty buffer - should create SrsRtpRawPayload
+    // Test case 2: Non-empty buffer - should set raw payload type
     {
         SrsRtpPacket pkt;
         char test_data[64];
@@ -2956,16 +3049,9 @@ VOID TEST(SrsRtcAudioRecvTrackTest, OnBeforeDecodePayload)
 
         audio_track.on_before_decode_payload(&pkt, &buf, &payload, &ppt);
 
-        // Should create SrsRtpRawPayload and set payload type to Raw
-        EXPECT_TRUE(payload != NULL);
+        // Should only set payload type to Raw, the packet parses it when used
+        EXPECT_TRUE(payload == NULL);
         EXPECT_EQ(SrsRtpPacketPayloadTypeRaw, ppt);
-
-        // Verify it's actually a SrsRtpRawPayload by trying to cast
-        SrsRtpRawPayload *raw_payload = dynamic_cast<SrsRtpRawPayload *>(payload);
-        EXPECT_TRUE(raw_payload != NULL);
-
-        // Clean up the created payload
-        srs_freep(payload);
     }
 
     // Test case 3: Buffer with data but at end position - should return early
@@ -1377,6 +1377,45 @@ VOID TEST(SecurityTransportTest, SrtpInitializeWithEmptyKeys)
     EXPECT_STREQ("", mock_srtp.last_send_key_.c_str());
 }
 
+VOID TEST(SecurityTransportTest, DtlsContextSharedBySessions)
+{
+    srs_error_t err;
+
+    // The context is built once for each version and role.
+    SSL_CTX *server = _srs_rtc_dtls_certificate->get_dtls_ctx(SrsDtlsVersionAuto, "passive");
+    ASSERT_TRUE(server != NULL);
+    EXPECT_EQ(server, _srs_rtc_dtls_certificate->get_dtls_ctx(SrsDtlsVersionAuto, "passive"));
+    EXPECT_EQ(SSL_SESS_CACHE_OFF, SSL_CTX_get_session_cache_mode(server));
+
+    SSL_CTX *client = _srs_rtc_dtls_certificate->get_dtls_ctx(SrsDtlsVersionAuto, "active");
+    EXPECT_TRUE(server != client);
+    EXPECT_TRUE(server != _srs_rtc_dtls_certificate->get_dtls_ctx(SrsDtlsVersion1_2, "passive"));
+
+    // The sessions use the shared context, and never free it.
+    if (true) {
+        SrsDtlsServerImpl dtls(NULL);
+        HELPER_EXPECT_SUCCESS(dtls.initialize("auto", "passive"));
+        EXPECT_EQ(server, dtls.dtls_ctx_);
+    }
+    EXPECT_EQ(server, _srs_rtc_dtls_certificate->get_dtls_ctx(SrsDtlsVersionAuto, "passive"));
+}
+
+VOID TEST(SecurityTransportTest, DtlsHandshakeStat)
+{
+    SrsDtlsHandshakeStat stat;
+    EXPECT_STREQ("", stat.dumps().c_str());
+
+    stat.on_handshake(20 * SRS_UTIME_MILLISECONDS);
+    stat.on_handshake(40 * SRS_UTIME_MILLISECONDS);
+    stat.on_handshake(200 * SRS_UTIME_MILLISECONDS);
+    stat.on_handshake(500 * SRS_UTIME_MILLISECONDS);
+    stat.on_handshake(2 * SRS_UTIME_SECONDS);
+    EXPECT_STREQ(", dtls=(n:5,a:552ms,m:2000ms,h:2/1/1/1)", stat.dumps().c_str());
+
+    // Reset after dumps.
+    EXPECT_STREQ("", stat.dumps().c_str());
+}
+
 // Tests for SrsSemiSecurityTransport
 VOID TEST(SemiSecurityTransportTest, ConstructorAndDestructor)
 {
@@ -3197,6 +3236,63 @@ VOID TEST(RtcPlayStreamTest, OnRtcpNack)
     }
 }
 
+VOID TEST(RtcPlayStreamTest, OnRecvNackFromSharedCache)
+{
+    srs_error_t err;
+
+    MockRtcPacketSender sender0;
+    MockRtcPacketSender sender1;
+    SrsRtpNackCache cache(1024 * 1024);
+
+    SrsUniquePtr<SrsRtcTrackDescription> desc(new SrsRtcTrackDescription());
+    desc->type_ = "video";
+    desc->ssrc_ = 0x22222222;
+    desc->is_active_ = true;
+
+    // Two players of the same stream, share the NACK cache of source.
+    SrsUniquePtr<SrsRtcVideoSendTrack> track0(new SrsRtcVideoSendTrack(&sender0, desc.get()));
+    SrsUniquePtr<SrsRtcVideoSendTrack> track1(new SrsRtcVideoSendTrack(&sender1, desc.get()));
+    track0->set_nack_cache(&cache);
+    track1->set_nack_cache(&cache);
+
+    // The source caches the packet, then delivers a copy to each player.
+    std::vector<uint16_t> seqs;
+    for (int i = 0; i < 10; i++) {
+        SrsRtpPacket pkt;
+        pkt.header_.set_ssrc(0x11111111);
+        pkt.header_.set_sequence(1000 + i);
+        pkt.header_.set_timestamp(9000 + i * 90);
+        cache.put(&pkt);
+
+        SrsRtpPacket *cp0 = pkt.copy();
+        HELPER_EXPECT_SUCCESS(track0->on_rtp(cp0));
+        seqs.push_back(cp0->header_.get_sequence());
+        HELPER_EXPECT_SUCCESS(track0->on_nack(&cp0));
+        srs_freep(cp0);
+
+        SrsRtpPacket *cp1 = pkt.copy();
+        HELPER_EXPECT_SUCCESS(track1->on_rtp(cp1));
+        HELPER_EXPECT_SUCCESS(track1->on_nack(&cp1));
+        srs_freep(cp1);
+    }
+    EXPECT_EQ(10, cache.nn_packets());
+    EXPECT_EQ(10, sender0.send_packet_count_);
+
+    // The player NACK by the rewritten sequence, one of them is unknown.
+    std::vector<uint16_t> lost;
+    lost.push_back(seqs.at(2));
+    lost.push_back(seqs.at(5));
+    lost.push_back((uint16_t)(seqs.at(9) + 1));
+    HELPER_EXPECT_SUCCESS(track0->on_recv_nack(lost));
+    EXPECT_EQ(12, sender0.send_packet_count_);
+    EXPECT_EQ(10, sender1.send_packet_count_);
+
+    // Miss when the packet is evicted from cache.
+    cache.clear();
+    HELPER_EXPECT_SUCCESS(track1->on_recv_nack(lost));
+    EXPECT_EQ(10, sender1.send_packet_count_);
+}
+
 VOID TEST(RtcPlayStreamTest, DoRequestKeyframe)
 {
     srs_error_t err;
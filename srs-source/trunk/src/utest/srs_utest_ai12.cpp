@@ -354,7 +354,7 @@ VOID TEST(SrsRtcPublishStreamTest, OnBeforeDecodePayloadTypicalScenario)
     // Call on_before_decode_payload for audio track - should delegate to audio track
     publish_stream->on_before_decode_payload(pkt3.get(), &audio_buffer, &payload3, &ppt3);
     // Audio track should have processed the payload and set it to raw payload
-    EXPECT_TRUE(payload3 != NULL);               // Audio track should create raw payload
+    EXPECT_TRUE(payload3 == NULL);               // Audio track parses the payload lazily
     EXPECT_EQ(SrsRtpPacketPayloadTypeRaw, ppt3); // Audio track should set raw payload type
 
     // Test scenario 4: Unknown SSRC - should not match any track
@@ -2013,6 +2013,16 @@ srs_error_t MockStatisticForOriginHub::dumps_clients(SrsJsonArray *arr, int star
     return srs_success;
 }
 
+srs_error_t MockStatisticForOriginHub::dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
+srs_error_t MockStatisticForOriginHub::dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
 srs_error_t MockStatisticForOriginHub::dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs)
 {
     send_bytes = 0;
@@ -2731,11 +2741,14 @@ VOID TEST(AppOriginHubTest, SequenceHeaderRequestTypicalScenario)
     SrsForwarder *forwarder = new SrsForwarder(hub.get());
     hub->forwarders_.push_back(forwarder);
 
-    // Test on_forwarder_start
+    // Test on_forwarder_start, the forwarder caches the packets to send by its coroutine,
+    // never writes to the destination in the hub.
     HELPER_EXPECT_SUCCESS(hub->on_forwarder_start(forwarder));
-
-    // We can't easily verify the forwarder received the data without mocking,
-    // but we can verify the method succeeded without error
+    EXPECT_TRUE(forwarder->metadata_ != NULL);
+    EXPECT_TRUE(forwarder->sh_video_ != NULL);
+    EXPECT_TRUE(forwarder->sh_audio_ != NULL);
+    EXPECT_TRUE(forwarder->sdk_ == NULL);
+    EXPECT_EQ(mock_source->meta()->vsh()->payload(), forwarder->sh_video_->payload());
 
     // Test on_dvr_request_sh
     HELPER_EXPECT_SUCCESS(hub->on_dvr_request_sh());
@@ -2804,7 +2817,7 @@ VOID TEST(AppOriginHubTest, CreateBackendForwardersTypicalScenario)
         hub->stat_ = mock_stat;
         hub->source_ = mock_source;
         hub->config_ = mock_config;
-        srs_freep(hub->hooks_);
+        // The hooks is the global _srs_hooks, not owned by hub, so never free it.
         hub->hooks_ = mock_hooks;
 
         // Configure backend URL
@@ -2878,6 +2891,146 @@ VOID TEST(AppForwarderTest, RejectRtmpsDestination)
     srs_freep(mock_source);
 }
 
+// Create an audio packet for the forward queue.
+static SrsMediaPacket *mock_forward_audio(int64_t timestamp)
+{
+    SrsMediaPacket *msg = new SrsMediaPacket();
+    char *payload = new char[4];
+    payload[0] = (char)0xaf; // AAC
+    payload[1] = 0x01;       // raw data
+    payload[2] = payload[3] = 0x00;
+    msg->wrap(payload, 4);
+    msg->timestamp_ = timestamp;
+    msg->message_type_ = SrsFrameTypeAudio;
+    return msg;
+}
+
+VOID TEST(AppForwarderTest, ForwardQueueCursors)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<SrsForwardQueue> queue(new SrsForwardQueue());
+    SrsForwardCursor c0, c1;
+    queue->attach(&c0);
+    queue->attach(&c1);
+
+    for (int i = 0; i < 3; i++) {
+        SrsUniquePtr<SrsMediaPacket> msg(mock_forward_audio(i * 20));
+        HELPER_EXPECT_SUCCESS(queue->enqueue(msg.get()));
+    }
+    EXPECT_EQ(3, (int)queue->msgs_.size());
+    EXPECT_EQ(3, queue->size(&c0));
+    EXPECT_EQ(40 * SRS_UTIME_MILLISECONDS, queue->duration(&c0));
+
+    // The packets share the payload of queue.
+    SrsMediaPacket *msgs[8];
+    int count = 0, dropped = 0;
+    queue->fetch(&c0, 8, msgs, count, dropped);
+    EXPECT_EQ(3, count);
+    EXPECT_EQ(0, dropped);
+    EXPECT_EQ(queue->msgs_.at(0)->payload(), msgs[0]->payload());
+    for (int i = 0; i < count; i++) {
+        srs_freep(msgs[i]);
+    }
+
+    // The packets are kept for the slow cursor.
+    EXPECT_EQ(0, queue->size(&c0));
+    EXPECT_EQ(3, queue->size(&c1));
+    EXPECT_EQ(3, (int)queue->msgs_.size());
+
+    // The packets are removed once all cursors passed.
+    queue->fetch(&c1, 2, msgs, count, dropped);
+    EXPECT_EQ(2, count);
+    for (int i = 0; i < count; i++) {
+        srs_freep(msgs[i]);
+    }
+    EXPECT_EQ(1, (int)queue->msgs_.size());
+    EXPECT_EQ(1, queue->size(&c1));
+
+    // The detached cursor never holds the packets.
+    queue->detach(&c1);
+    EXPECT_EQ(0, (int)queue->msgs_.size());
+    queue->detach(&c0);
+}
+
+VOID TEST(AppForwarderTest, ForwardQueueOverflow)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<SrsForwardQueue> queue(new SrsForwardQueue());
+    queue->set_queue_size(1 * SRS_UTIME_SECONDS);
+
+    SrsForwardCursor cursor;
+    queue->attach(&cursor);
+
+    // The zero timestamp of sequence header is ignored.
+    for (int i = 0; i <= 10; i++) {
+        SrsUniquePtr<SrsMediaPacket> msg(mock_forward_audio(i * 100));
+        HELPER_EXPECT_SUCCESS(queue->enqueue(msg.get()));
+    }
+    EXPECT_EQ(11, queue->size(&cursor));
+
+    // Overflow, the slow cursor skips the packets.
+    for (int i = 11; i <= 15; i++) {
+        SrsUniquePtr<SrsMediaPacket> msg(mock_forward_audio(i * 100));
+        HELPER_EXPECT_SUCCESS(queue->enqueue(msg.get()));
+    }
+    EXPECT_EQ(11, queue->size(&cursor));
+    EXPECT_EQ(1 * SRS_UTIME_SECONDS, queue->duration(&cursor));
+
+    SrsMediaPacket *msgs[16];
+    int count = 0, dropped = 0;
+    queue->fetch(&cursor, 16, msgs, count, dropped);
+    EXPECT_EQ(11, count);
+    EXPECT_EQ(5, dropped);
+    EXPECT_EQ(5, cursor.nn_dropped_);
+    EXPECT_EQ(500, msgs[0]->timestamp_);
+    for (int i = 0; i < count; i++) {
+        srs_freep(msgs[i]);
+    }
+
+    queue->detach(&cursor);
+}
+
+VOID TEST(AppForwarderTest, SharedForwardQueue)
+{
+    srs_error_t err;
+
+    MockLiveSourceForOriginHub *mock_source = new MockLiveSourceForOriginHub();
+    SrsUniquePtr<SrsOriginHub> hub(new SrsOriginHub());
+    hub->source_ = mock_source;
+    SrsUniquePtr<MockHlsRequest> req(new MockHlsRequest());
+
+    // The forwarders consume the queue of hub.
+    SrsForwarder *f0 = new SrsForwarder(hub.get());
+    SrsForwarder *f1 = new SrsForwarder(hub.get());
+    f0->set_queue(hub->forward_queue_);
+    f1->set_queue(hub->forward_queue_);
+    HELPER_EXPECT_SUCCESS(f0->initialize(req.get(), "127.0.0.1:19350"));
+    HELPER_EXPECT_SUCCESS(f1->initialize(req.get(), "127.0.0.1:19351"));
+
+    // The hub enqueues the packet once, which is not copied by forwarders.
+    SrsUniquePtr<SrsMediaPacket> msg(mock_forward_audio(100));
+    HELPER_EXPECT_SUCCESS(hub->forward_queue_->enqueue(msg.get()));
+    HELPER_EXPECT_SUCCESS(f0->on_audio(msg.get()));
+    HELPER_EXPECT_SUCCESS(f1->on_audio(msg.get()));
+    EXPECT_EQ(1, (int)hub->forward_queue_->msgs_.size());
+
+    SrsJsonObject *obj = SrsJsonAny::object();
+    SrsUniquePtr<SrsJsonAny> obj_uptr(obj);
+    f1->dumps(obj);
+    EXPECT_STREQ("127.0.0.1:19351", obj->get_property("ep")->to_str().c_str());
+    EXPECT_EQ(1, obj->get_property("queue")->to_integer());
+    EXPECT_EQ(0, obj->get_property("dropped")->to_integer());
+
+    // Free the forwarders before the hub.
+    srs_freep(f0);
+    srs_freep(f1);
+    EXPECT_EQ(0, (int)hub->forward_queue_->msgs_.size());
+
+    srs_freep(mock_source);
+}
+
 VOID TEST(SrsLiveSourceTest, OnAggregateSelectionTypical)
 {
     srs_error_t err;
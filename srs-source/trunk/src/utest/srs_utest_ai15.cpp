@@ -357,6 +357,10 @@ void MockLogForSignal::reopen()
     reopen_count_++;
 }
 
+void MockLogForSignal::flush()
+{
+}
+
 void MockLogForSignal::log(SrsLogLevel level, const char *tag, const SrsContextId &context_id, const char *fmt, va_list args)
 {
     // Do nothing for mock
@@ -859,6 +863,16 @@ srs_error_t MockStatisticForResampleKbps::dumps_clients(SrsJsonArray *arr, int s
     return srs_success;
 }
 
+srs_error_t MockStatisticForResampleKbps::dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
+srs_error_t MockStatisticForResampleKbps::dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
 srs_error_t MockStatisticForResampleKbps::dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs)
 {
     send_bytes = 0;
@@ -94,6 +94,7 @@ public:
 public:
     virtual srs_error_t initialize();
     virtual void reopen();
+    virtual void flush();
     virtual void log(SrsLogLevel level, const char *tag, const SrsContextId &context_id, const char *fmt, va_list args);
 };
 
@@ -270,6 +271,8 @@ public:
     virtual srs_error_t dumps_vhosts(SrsJsonArray *arr);
     virtual srs_error_t dumps_streams(SrsJsonArray *arr, int start, int count);
     virtual srs_error_t dumps_clients(SrsJsonArray *arr, int start, int count);
+    virtual srs_error_t dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page);
+    virtual srs_error_t dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page);
     virtual srs_error_t dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs);
     void reset();
 };
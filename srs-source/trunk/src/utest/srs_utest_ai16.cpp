@@ -11,6 +11,7 @@ using namespace std;
 #include <srs_app_http_api.hpp>
 #include <srs_app_http_hooks.hpp>
 #include <srs_app_http_stream.hpp>
+#include <srs_app_log.hpp>
 #include <srs_app_rtmp_source.hpp>
 #include <srs_kernel_balance.hpp>
 #include <srs_kernel_consts.hpp>
@@ -24,6 +25,9 @@ using namespace std;
 #include <srs_utest_manual_kernel.hpp>
 #include <vector>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 // External function declarations for testing
 extern srs_error_t srs_api_response_jsonp(ISrsHttpResponseWriter *w, string callback, string data);
 extern srs_error_t srs_api_response_code(ISrsHttpResponseWriter *w, ISrsHttpMessage *r, int code);
@@ -304,6 +308,87 @@ VOID TEST(HttpStreamTest, TsStreamEncoderCacheAndAVSettings)
     EXPECT_TRUE(writer->filesize() > 0);
 }
 
+// Create a H.264 video packet in AnnexB, keyframe or inter frame.
+static SrsMediaPacket *mock_ts_shared_video(int64_t timestamp, bool keyframe)
+{
+    char *data = new char[128];
+    memset(data, 0x00, 128);
+    data[0] = keyframe ? 0x17 : 0x27;
+    data[1] = 0x01; // AVC NALU
+    data[8] = 0x01; // NALU start code
+    data[9] = keyframe ? 0x65 : 0x41;
+
+    SrsMediaPacket *msg = new SrsMediaPacket();
+    msg->wrap(data, 128);
+    msg->message_type_ = SrsFrameTypeVideo;
+    msg->timestamp_ = timestamp;
+    return msg;
+}
+
+VOID TEST(HttpStreamTest, TsSharedMuxerFetchFromKeyframe)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<MockRequest> req(new MockRequest("test.vhost", "live", "stream1"));
+    SrsUniquePtr<SrsTsSharedMuxer> muxer(new SrsTsSharedMuxer(req.get()));
+    HELPER_EXPECT_SUCCESS(muxer->enc_->initialize(muxer.get()));
+
+    // No chunks before keyframe.
+    uint64_t cursor = 0;
+    vector<SrsSharedPtr<SrsMemoryBlock> > chunks;
+    muxer->fetch(cursor, chunks);
+    EXPECT_TRUE(chunks.empty());
+    EXPECT_EQ(0, (int)cursor);
+
+    // The first GOP, the keyframe chunk starts with PAT.
+    if (true) {
+        SrsUniquePtr<SrsMediaPacket> msg(mock_ts_shared_video(0, true));
+        HELPER_EXPECT_SUCCESS(muxer->on_message(msg.get()));
+    }
+    if (true) {
+        SrsUniquePtr<SrsMediaPacket> msg(mock_ts_shared_video(40, false));
+        HELPER_EXPECT_SUCCESS(muxer->on_message(msg.get()));
+    }
+    ASSERT_EQ(2, (int)muxer->chunks_.size());
+    EXPECT_TRUE(muxer->chunks_.at(0)->keyframe_);
+    EXPECT_FALSE(muxer->chunks_.at(1)->keyframe_);
+    EXPECT_EQ(0, muxer->chunks_.at(0)->data_->size() % SRS_TS_PACKET_SIZE);
+    EXPECT_EQ(0x47, (uint8_t)muxer->chunks_.at(0)->data_->payload()[0]);
+    EXPECT_EQ(0x00, (uint8_t)muxer->chunks_.at(0)->data_->payload()[2]); // PID of PAT.
+
+    // A new viewer starts from the keyframe.
+    muxer->fetch(cursor, chunks);
+    EXPECT_EQ(2, (int)chunks.size());
+    EXPECT_EQ(3, (int)cursor);
+
+    // The viewer gets nothing until new chunk.
+    chunks.clear();
+    muxer->fetch(cursor, chunks);
+    EXPECT_TRUE(chunks.empty());
+
+    // The second and third GOP, evict chunks before the previous keyframe.
+    for (int i = 0; i < 2; i++) {
+        SrsUniquePtr<SrsMediaPacket> key(mock_ts_shared_video(80 + i * 80, true));
+        HELPER_EXPECT_SUCCESS(muxer->on_message(key.get()));
+        SrsUniquePtr<SrsMediaPacket> inter(mock_ts_shared_video(120 + i * 80, false));
+        HELPER_EXPECT_SUCCESS(muxer->on_message(inter.get()));
+    }
+    ASSERT_EQ(4, (int)muxer->chunks_.size());
+    EXPECT_EQ(3, (int)muxer->chunks_.front()->seq_);
+
+    // The viewer at cursor 3 gets all chunks in order.
+    muxer->fetch(cursor, chunks);
+    EXPECT_EQ(4, (int)chunks.size());
+    EXPECT_EQ(7, (int)cursor);
+
+    // A slow viewer whose chunks are evicted skips to the latest keyframe.
+    uint64_t slow = 1;
+    chunks.clear();
+    muxer->fetch(slow, chunks);
+    EXPECT_EQ(2, (int)chunks.size());
+    EXPECT_EQ(7, (int)slow);
+}
+
 VOID TEST(SrsFlvStreamEncoderTest, InitializeSuccess)
 {
     srs_error_t err;
@@ -877,6 +962,16 @@ srs_error_t MockStatisticForLiveStream::dumps_clients(SrsJsonArray *arr, int sta
     return srs_success;
 }
 
+srs_error_t MockStatisticForLiveStream::dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
+srs_error_t MockStatisticForLiveStream::dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
 srs_error_t MockStatisticForLiveStream::dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs)
 {
     send_bytes = 0;
@@ -3089,6 +3184,89 @@ VOID TEST(HTTPApiTest, ClientsApiGetAllClients)
     srs_freep(api->entry_);
 }
 
+VOID TEST(HTTPApiTest, ClientsApiStreamingPage)
+{
+    srs_error_t err;
+
+    // Test GET /api/v1/clients with cursor and fields, which responses in streaming JSON.
+    SrsUniquePtr<SrsStatistic> stat(new SrsStatistic());
+    SrsUniquePtr<MockRequest> mock_req(new MockRequest("__defaultVhost__", "live", "livestream"));
+    mock_req->ip_ = "127.0.0.1";
+
+    MockExpire conns[3];
+    for (int i = 0; i < 3; i++) {
+        std::string id = "client-" + srs_strconv_format_int(i);
+        HELPER_EXPECT_SUCCESS(stat->on_client(id, mock_req.get(), &conns[i], SrsRtmpConnPlay));
+    }
+
+    SrsUniquePtr<SrsGoApiClients> api(new SrsGoApiClients());
+    api->stat_ = stat.get();
+    api->entry_ = new SrsHttpMuxEntry();
+    api->entry_->pattern = "/api/v1/clients/";
+
+    SrsUniquePtr<SrsHttpMessage> req(new SrsHttpMessage());
+    HELPER_EXPECT_SUCCESS(req->set_url("http://127.0.0.1/api/v1/clients?cursor=client-0&count=1&fields=id,ip", false));
+
+    MockResponseWriter w;
+    HELPER_EXPECT_SUCCESS(api->serve_http(&w, req.get()));
+
+    // The response is chunked, with the selected fields of one client, and the cursor of next page.
+    string response = HELPER_BUFFER2STR(&w.io.out_buffer);
+    EXPECT_TRUE(response.find("Transfer-Encoding: chunked") != string::npos);
+    EXPECT_TRUE(response.find("\"code\":0,\"server\":\"") != string::npos);
+    EXPECT_TRUE(response.find("\"total\":3") != string::npos);
+    EXPECT_TRUE(response.find("\"clients\":[{\"id\":\"client-1\",\"ip\":\"127.0.0.1\"}],\"next\":\"client-1\"}") != string::npos);
+    EXPECT_TRUE(response.find("\"vhost\"") == string::npos);
+    EXPECT_TRUE(response.find("\r\n0\r\n\r\n") != string::npos);
+
+    api->stat_ = NULL;
+    srs_freep(api->entry_);
+}
+
+VOID TEST(HTTPApiTest, ClientsApiPageFields)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<SrsStatistic> stat(new SrsStatistic());
+    SrsUniquePtr<MockRequest> mock_req(new MockRequest("__defaultVhost__", "live", "livestream"));
+    mock_req->ip_ = "127.0.0.1";
+    MockExpire conn;
+    HELPER_EXPECT_SUCCESS(stat->on_client("client-0", mock_req.get(), &conn, SrsRtmpConnPlay));
+
+    SrsUniquePtr<SrsGoApiClients> api(new SrsGoApiClients());
+    api->stat_ = stat.get();
+    api->entry_ = new SrsHttpMuxEntry();
+    api->entry_->pattern = "/api/v1/clients/";
+
+    // The escaped comma, and multiple fields in query, are all parsed.
+    if (true) {
+        SrsUniquePtr<SrsHttpMessage> req(new SrsHttpMessage());
+        HELPER_EXPECT_SUCCESS(req->set_url("http://127.0.0.1/api/v1/clients?fields=id%2Cip&count=1&fields=name", false));
+
+        MockResponseWriter w;
+        HELPER_EXPECT_SUCCESS(api->serve_http(&w, req.get()));
+
+        string response = HELPER_BUFFER2STR(&w.io.out_buffer);
+        EXPECT_TRUE(response.find("\"clients\":[{\"id\":\"client-0\",\"ip\":\"127.0.0.1\",\"name\":\"livestream\"}]") != string::npos);
+    }
+
+    // The unknown field is rejected.
+    if (true) {
+        SrsUniquePtr<SrsHttpMessage> req(new SrsHttpMessage());
+        HELPER_EXPECT_SUCCESS(req->set_url("http://127.0.0.1/api/v1/clients?fields=id,live_ms", false));
+
+        MockResponseWriter w;
+        HELPER_EXPECT_SUCCESS(api->serve_http(&w, req.get()));
+
+        string response = HELPER_BUFFER2STR(&w.io.out_buffer);
+        EXPECT_TRUE(response.find("\"code\":" + srs_strconv_format_int(ERROR_HTTP_API_FIELDS)) != string::npos);
+        EXPECT_TRUE(response.find("\"clients\"") == string::npos);
+    }
+
+    api->stat_ = NULL;
+    srs_freep(api->entry_);
+}
+
 VOID TEST(HTTPApiTest, ClientsApiGetSpecificClient)
 {
     srs_error_t err;
@@ -3531,3 +3709,162 @@ VOID TEST(SrsGoApiMetricsTest, ServeHttpSuccess)
     api->stat_ = NULL;
     api->config_ = NULL;
 }
+
+// Write a trace log by the file log.
+static void mock_file_log_trace(SrsFileLog *log, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    log->log(SrsLogLevelTrace, NULL, SrsContextId(), fmt, ap);
+    va_end(ap);
+}
+
+// Write an error log by the file log.
+static void mock_file_log_error(SrsFileLog *log, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    log->log(SrsLogLevelError, NULL, SrsContextId(), fmt, ap);
+    va_end(ap);
+}
+
+// Read the whole content of file.
+static string mock_read_file(const string &filepath)
+{
+    string content;
+    int fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return content;
+    }
+
+    char buf[4096];
+    ssize_t nn;
+    while ((nn = ::read(fd, buf, sizeof(buf))) > 0) {
+        content.append(buf, nn);
+    }
+    ::close(fd);
+    return content;
+}
+
+VOID TEST(SrsFileLogTest, AsyncWriteInBatch)
+{
+    string filepath = _srs_tmp_file_prefix + "utest-async.log";
+    ::unlink(filepath.c_str());
+
+    if (true) {
+        SrsFileLog log;
+        log.log_to_file_tank_ = true;
+        log.async_ = true;
+        log.fd_ = ::open(filepath.c_str(), O_RDWR | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR);
+        ASSERT_TRUE(log.fd_ > 0);
+
+        // The lines are buffered, never write to file.
+        mock_file_log_trace(&log, "Hello %s", "async");
+        mock_file_log_trace(&log, "Hello %d", 2);
+        EXPECT_TRUE(mock_read_file(filepath).empty());
+        EXPECT_EQ(2, log.nn_lines_);
+        EXPECT_EQ(0, log.nn_writes_);
+
+        // Flush the lines in one write.
+        log.flush();
+        string content = mock_read_file(filepath);
+        EXPECT_TRUE(content.find("Hello async\n") != string::npos);
+        EXPECT_TRUE(content.find("Hello 2\n") != string::npos);
+        EXPECT_EQ(1, log.nn_writes_);
+        EXPECT_EQ(0, log.nn_cache_);
+
+        // The dumps of stat, for summaries api.
+        SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+        log.dumps(obj.get());
+        EXPECT_EQ(2, obj->get_property("lines")->to_integer());
+        EXPECT_EQ(0, obj->get_property("dropped")->to_integer());
+
+        // The error log is written immediately, with the buffered lines before it.
+        mock_file_log_trace(&log, "Before error");
+        EXPECT_TRUE(mock_read_file(filepath).find("Before error\n") == string::npos);
+        errno = 0;
+        mock_file_log_error(&log, "Some error");
+        content = mock_read_file(filepath);
+        EXPECT_TRUE(content.find("Before error\n") != string::npos);
+        EXPECT_TRUE(content.find("Some error\n") != string::npos);
+        EXPECT_EQ(0, log.nn_cache_);
+    }
+
+    if (true) {
+        SrsFileLog log;
+        log.log_to_file_tank_ = true;
+        log.async_ = true;
+        log.fd_ = ::open(filepath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_APPEND, S_IRUSR | S_IWUSR);
+        ASSERT_TRUE(log.fd_ > 0);
+
+        // The lines wrap around the end of ring, and write by two iovecs.
+        log.head_ = log.nn_cache_ = 0;
+        mock_file_log_trace(&log, "First");
+        log.flush();
+        int size = (int)mock_read_file(filepath).size();
+        EXPECT_EQ(0, ::ftruncate(log.fd_, 0));
+
+        log.head_ = SRS_LOG_CACHE_SIZE - size / 2;
+        mock_file_log_trace(&log, "First");
+        EXPECT_EQ(size, log.nn_cache_);
+        log.flush();
+        string content = mock_read_file(filepath);
+        EXPECT_EQ(size, (int)content.size());
+        EXPECT_TRUE(content.find("First\n") != string::npos);
+    }
+
+    if (true) {
+        SrsFileLog log;
+        log.log_to_file_tank_ = true;
+        log.async_ = true;
+
+        // The file is not writable, drop the lines when ring is full.
+        log.fd_ = ::open(filepath.c_str(), O_RDONLY);
+        ASSERT_TRUE(log.fd_ > 0);
+        log.cache_ = new char[SRS_LOG_CACHE_SIZE];
+        log.nn_cache_ = SRS_LOG_CACHE_SIZE - 10;
+        mock_file_log_trace(&log, "Dropped");
+        EXPECT_EQ(1, log.nn_dropped_);
+        EXPECT_EQ(0, log.nn_lines_);
+        log.nn_cache_ = 0;
+    }
+
+    ::unlink(filepath.c_str());
+}
+
+VOID TEST(SrsFileLogTest, SuppressIdenticalLogs)
+{
+    string filepath = _srs_tmp_file_prefix + "utest-limit.log";
+    ::unlink(filepath.c_str());
+
+    if (true) {
+        SrsFileLog log;
+        log.log_to_file_tank_ = true;
+        log.limit_ = 2;
+        log.fd_ = ::open(filepath.c_str(), O_RDWR | O_CREAT | O_APPEND, S_IRUSR | S_IWUSR);
+        ASSERT_TRUE(log.fd_ > 0);
+
+        // Only the first 2 logs of a statement are written in a window.
+        for (int i = 0; i < 5; i++) {
+            mock_file_log_trace(&log, "Write err %d", i);
+        }
+        mock_file_log_trace(&log, "Other");
+        EXPECT_EQ(3, log.nn_lines_);
+        EXPECT_EQ(3, log.nn_suppressed_);
+
+        // Expire the window, the number of suppressed logs is written.
+        std::map<const char *, SrsLogLimiter *>::iterator it;
+        for (it = log.limiters_.begin(); it != log.limiters_.end(); ++it) {
+            it->second->starttime_ -= 2 * SRS_UTIME_SECONDS;
+        }
+        mock_file_log_trace(&log, "Write err %d", 5);
+
+        string content = mock_read_file(filepath);
+        EXPECT_TRUE(content.find("Write err 1\n") != string::npos);
+        EXPECT_TRUE(content.find("Write err 2\n") == string::npos);
+        EXPECT_TRUE(content.find("suppressed 3 logs like: Write err %d\n") != string::npos);
+        EXPECT_TRUE(content.find("Write err 5\n") != string::npos);
+    }
+
+    ::unlink(filepath.c_str());
+}
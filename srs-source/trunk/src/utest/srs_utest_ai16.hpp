@@ -178,6 +178,8 @@ public:
     virtual srs_error_t dumps_vhosts(SrsJsonArray *arr);
     virtual srs_error_t dumps_streams(SrsJsonArray *arr, int start, int count);
     virtual srs_error_t dumps_clients(SrsJsonArray *arr, int start, int count);
+    virtual srs_error_t dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page);
+    virtual srs_error_t dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page);
     virtual srs_error_t dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs);
 };
 
@@ -1757,6 +1757,16 @@ srs_error_t MockStatisticForRtcApi::dumps_clients(SrsJsonArray *arr, int start,
     return srs_success;
 }
 
+srs_error_t MockStatisticForRtcApi::dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
+srs_error_t MockStatisticForRtcApi::dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
 srs_error_t MockStatisticForRtcApi::dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs)
 {
     send_bytes = 0;
@@ -3211,6 +3221,165 @@ VOID TEST(StatisticTest, KbpsAddDelta)
     EXPECT_EQ(0, remaining_out);
 }
 
+// Test SrsStatistic::kbps_sample() samples clients incrementally, a slice of clients per tick.
+VOID TEST(StatisticTest, KbpsSampleClientsInRounds)
+{
+    srs_error_t err = srs_success;
+
+    SrsUniquePtr<SrsStatistic> stat(new SrsStatistic());
+    SrsUniquePtr<MockSrsRequest> req(new MockSrsRequest("test.vhost", "live", "stream1"));
+
+    MockExpire conns[6];
+    for (int i = 0; i < 6; i++) {
+        std::string id = "client-" + srs_strconv_format_int(i);
+        HELPER_EXPECT_SUCCESS(stat->on_client(id, req.get(), &conns[i], SrsRtmpConnPlay));
+    }
+
+    // Each tick samples 6/SRS_STAT_KBPS_ROUNDS clients, continued from the last one.
+    int nn_per_tick = 6 / SRS_STAT_KBPS_ROUNDS;
+    for (int round = 1; round <= SRS_STAT_KBPS_ROUNDS; round++) {
+        stat->kbps_sample();
+
+        int nn_sampled = 0;
+        std::map<std::string, SrsStatisticClient *>::iterator it;
+        for (it = stat->clients_.begin(); it != stat->clients_.end(); it++) {
+            if (it->second->kbps_->is_->sample_30s_.time_ >= 0) {
+                nn_sampled++;
+            }
+        }
+        EXPECT_EQ(round * nn_per_tick, nn_sampled);
+    }
+
+    // All clients are sampled in a round, restart from the first one.
+    EXPECT_TRUE(stat->sample_cursor_.empty());
+    EXPECT_EQ(SRS_STAT_KBPS_ROUNDS, stat->sample_ticks_);
+
+    // The cursor is safe when the last sampled client is removed.
+    stat->kbps_sample();
+    std::string cursor = stat->sample_cursor_;
+    EXPECT_FALSE(cursor.empty());
+    stat->on_disconnect(cursor, srs_success);
+    stat->sample_clients();
+    EXPECT_FALSE(stat->sample_cursor_.empty());
+    stat->sample_clients();
+    EXPECT_TRUE(stat->sample_cursor_.empty());
+}
+
+// Test SrsStatistic::dumps_clients() to streaming JSON, with cursor based page and selected fields.
+VOID TEST(StatisticTest, DumpsClientsPageInStreamingJson)
+{
+    srs_error_t err = srs_success;
+
+    SrsUniquePtr<SrsStatistic> stat(new SrsStatistic());
+    SrsUniquePtr<MockSrsRequest> req(new MockSrsRequest("test.vhost", "live", "stream1"));
+
+    MockExpire conns[5];
+    for (int i = 0; i < 5; i++) {
+        std::string id = "client-" + srs_strconv_format_int(i);
+        HELPER_EXPECT_SUCCESS(stat->on_client(id, req.get(), &conns[i], SrsRtmpConnPlay));
+    }
+
+    // The first page, by start index.
+    SrsStatisticPage page;
+    page.start_ = 1;
+    page.count_ = 2;
+    page.fields_.push_back("id");
+    page.fields_.push_back("kbps");
+
+    SrsJsonWriter jw;
+    jw.array_start();
+    HELPER_EXPECT_SUCCESS(stat->dumps_clients(&jw, &page));
+    jw.array_end();
+    EXPECT_STREQ("client-2", page.next_.c_str());
+    EXPECT_STREQ("[{\"id\":\"client-1\",\"kbps\":{\"recv_30s\":0,\"send_30s\":0}},"
+                 "{\"id\":\"client-2\",\"kbps\":{\"recv_30s\":0,\"send_30s\":0}}]",
+                 jw.buffer().c_str());
+
+    // The next page by cursor, even the last client of previous page is removed.
+    stat->on_disconnect("client-2", srs_success);
+
+    SrsStatisticPage next;
+    next.cursor_ = page.next_;
+    next.count_ = 10;
+    next.fields_.push_back("id");
+
+    SrsJsonWriter jw2;
+    jw2.array_start();
+    HELPER_EXPECT_SUCCESS(stat->dumps_clients(&jw2, &next));
+    jw2.array_end();
+    EXPECT_TRUE(next.next_.empty());
+    EXPECT_STREQ("[{\"id\":\"client-3\"},{\"id\":\"client-4\"}]", jw2.buffer().c_str());
+
+    // All fields are same as the JSON object.
+    SrsStatisticPage all;
+    all.count_ = 1;
+
+    SrsJsonWriter jw3;
+    HELPER_EXPECT_SUCCESS(stat->dumps_clients(&jw3, &all));
+
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    HELPER_EXPECT_SUCCESS(stat->clients_["client-0"]->dumps(obj.get()));
+    EXPECT_STREQ(obj->dumps().c_str(), jw3.buffer().c_str());
+}
+
+// Test SrsStatisticStream::dumps() to streaming JSON, which must be same as the JSON object.
+VOID TEST(StatisticTest, DumpsStreamSameAsJsonObject)
+{
+    srs_error_t err = srs_success;
+
+    SrsUniquePtr<SrsStatistic> stat(new SrsStatistic());
+    SrsUniquePtr<MockSrsRequest> req(new MockSrsRequest("test.vhost", "live", "stream1"));
+
+    stat->on_stream_publish(req.get(), "publisher1");
+    SrsStatisticStream *stream = stat->find_stream_by_url(req->get_stream_url());
+    ASSERT_TRUE(stream != NULL);
+
+    // Compare all fields, for stream without video and audio.
+    SrsStatisticPage all;
+    if (true) {
+        SrsJsonWriter jw;
+        HELPER_EXPECT_SUCCESS(stream->dumps(&jw, &all));
+
+        SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+        HELPER_EXPECT_SUCCESS(stream->dumps(obj.get()));
+        EXPECT_STREQ(obj->dumps().c_str(), jw.buffer().c_str());
+    }
+
+    // Compare all fields, for stream with video, audio and NACK cache.
+    HELPER_EXPECT_SUCCESS(stat->on_video_info(req.get(), SrsVideoCodecIdAVC, SrsAvcProfileHigh, SrsAvcLevel_4, 1920, 1080));
+    HELPER_EXPECT_SUCCESS(stat->on_audio_info(req.get(), SrsAudioCodecIdAAC, SrsAudioSampleRate44100, SrsAudioChannelsStereo, SrsAacObjectTypeAacLC));
+    stat->on_rtc_nack_cache(req.get(), 10, 12000);
+    if (true) {
+        SrsJsonWriter jw;
+        HELPER_EXPECT_SUCCESS(stream->dumps(&jw, &all));
+
+        SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+        HELPER_EXPECT_SUCCESS(stream->dumps(obj.get()));
+        EXPECT_STREQ(obj->dumps().c_str(), jw.buffer().c_str());
+    }
+
+    // Compare the HEVC video, which has different profile and level.
+    HELPER_EXPECT_SUCCESS(stat->on_video_info(req.get(), SrsVideoCodecIdHEVC, SrsHevcProfileMain, SrsHevcLevel_51, 3840, 2160));
+    if (true) {
+        SrsJsonWriter jw;
+        HELPER_EXPECT_SUCCESS(stream->dumps(&jw, &all));
+
+        SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+        HELPER_EXPECT_SUCCESS(stream->dumps(obj.get()));
+        EXPECT_STREQ(obj->dumps().c_str(), jw.buffer().c_str());
+    }
+
+    // All known fields are accepted, and unknown field is rejected.
+    SrsStatisticPage page;
+    for (const char **p = srs_stat_stream_fields; *p; p++) {
+        page.fields_.push_back(*p);
+    }
+    HELPER_EXPECT_SUCCESS(page.check_fields(srs_stat_stream_fields));
+
+    page.fields_.push_back("ip");
+    HELPER_EXPECT_FAILED(page.check_fields(srs_stat_stream_fields));
+}
+
 // Test SrsStatistic::dumps_metrics() - major use scenario for exporting metrics
 // This test covers the major use scenario for dumping server metrics
 VOID TEST(StatisticTest, DumpsMetrics)
@@ -3676,6 +3845,16 @@ srs_error_t MockStatisticForHooks::dumps_clients(SrsJsonArray *arr, int start, i
     return srs_success;
 }
 
+srs_error_t MockStatisticForHooks::dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
+srs_error_t MockStatisticForHooks::dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
 srs_error_t MockStatisticForHooks::dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs)
 {
     return srs_success;
@@ -4140,3 +4319,276 @@ VOID TEST(HttpHooksTest, OnForwardBackendSuccess)
     hooks->stat_ = NULL;
     mock_factory->mock_http_client_ = NULL;
 }
+
+MockHttpMessageForHooksKeepAlive::MockHttpMessageForHooksKeepAlive(bool keep_alive)
+{
+    keep_alive_ = keep_alive;
+}
+
+MockHttpMessageForHooksKeepAlive::~MockHttpMessageForHooksKeepAlive()
+{
+}
+
+bool MockHttpMessageForHooksKeepAlive::is_keep_alive()
+{
+    return keep_alive_;
+}
+
+MockHttpClientForHooksKeepAlive::MockHttpClientForHooksKeepAlive(MockAppFactoryForHooksKeepAlive *factory)
+{
+    factory_ = factory;
+}
+
+MockHttpClientForHooksKeepAlive::~MockHttpClientForHooksKeepAlive()
+{
+}
+
+srs_error_t MockHttpClientForHooksKeepAlive::initialize(std::string schema, std::string h, int p, srs_utime_t tm)
+{
+    return srs_success;
+}
+
+srs_error_t MockHttpClientForHooksKeepAlive::get(std::string path, std::string req, ISrsHttpMessage **ppmsg)
+{
+    return srs_error_new(ERROR_NOT_SUPPORTED, "not supported");
+}
+
+srs_error_t MockHttpClientForHooksKeepAlive::post(std::string path, std::string req, ISrsHttpMessage **ppmsg)
+{
+    if (factory_->fail_next_post_) {
+        int code = factory_->fail_next_post_;
+        factory_->fail_next_post_ = 0;
+        return srs_error_new(code, "connection closed");
+    }
+
+    factory_->nn_posts_++;
+
+    MockHttpMessageForHooksKeepAlive *msg = new MockHttpMessageForHooksKeepAlive(factory_->keep_alive_);
+    msg->status_code_ = factory_->status_code_;
+    *ppmsg = msg;
+    return srs_success;
+}
+
+void MockHttpClientForHooksKeepAlive::set_recv_timeout(srs_utime_t tm)
+{
+}
+
+void MockHttpClientForHooksKeepAlive::kbps_sample(const char *label, srs_utime_t age)
+{
+}
+
+MockAppFactoryForHooksKeepAlive::MockAppFactoryForHooksKeepAlive()
+{
+    nn_created_ = 0;
+    nn_posts_ = 0;
+    keep_alive_ = true;
+    status_code_ = 200;
+    fail_next_post_ = 0;
+}
+
+MockAppFactoryForHooksKeepAlive::~MockAppFactoryForHooksKeepAlive()
+{
+}
+
+ISrsHttpClient *MockAppFactoryForHooksKeepAlive::create_http_client()
+{
+    nn_created_++;
+    return new MockHttpClientForHooksKeepAlive(this);
+}
+
+MockAppConfigForHooksKeepAlive::MockAppConfigForHooksKeepAlive()
+{
+    keep_alive_ = false;
+    play_cache_ = 0;
+}
+
+MockAppConfigForHooksKeepAlive::~MockAppConfigForHooksKeepAlive()
+{
+}
+
+bool MockAppConfigForHooksKeepAlive::get_vhost_http_hooks_keep_alive(std::string vhost)
+{
+    return keep_alive_;
+}
+
+srs_utime_t MockAppConfigForHooksKeepAlive::get_vhost_http_hooks_play_cache(std::string vhost)
+{
+    return play_cache_;
+}
+
+VOID TEST(HttpHooksTest, KeepAliveReuseConnection)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<MockAppFactoryForHooksKeepAlive> mock_factory(new MockAppFactoryForHooksKeepAlive());
+    SrsUniquePtr<MockStatisticForHooks> mock_stat(new MockStatisticForHooks());
+    SrsUniquePtr<MockAppConfigForHooksKeepAlive> mock_config(new MockAppConfigForHooksKeepAlive());
+    mock_config->keep_alive_ = true;
+
+    SrsUniquePtr<MockSrsRequest> req(new MockSrsRequest("test.vhost", "live", "stream1"));
+
+    SrsUniquePtr<SrsHttpHooks> hooks(new SrsHttpHooks());
+    hooks->factory_ = mock_factory.get();
+    hooks->stat_ = mock_stat.get();
+    hooks->config_ = mock_config.get();
+
+    // All hooks to the same server share one connection.
+    std::string url = "http://127.0.0.1:8085/api/v1/clients";
+    HELPER_EXPECT_SUCCESS(hooks->on_connect(url, req.get()));
+    HELPER_EXPECT_SUCCESS(hooks->on_connect(url, req.get()));
+    HELPER_EXPECT_SUCCESS(hooks->on_publish("http://127.0.0.1:8085/api/v1/streams", req.get()));
+    EXPECT_EQ(1, mock_factory->nn_created_);
+    EXPECT_EQ(3, mock_factory->nn_posts_);
+    EXPECT_EQ(2, hooks->nn_reused_);
+    EXPECT_EQ(1, (int)hooks->idle_clients_["http://127.0.0.1:8085"].size());
+
+    // Another server uses another connection.
+    HELPER_EXPECT_SUCCESS(hooks->on_connect("http://127.0.0.1:8086/api/v1/clients", req.get()));
+    EXPECT_EQ(2, mock_factory->nn_created_);
+    EXPECT_EQ(2, (int)hooks->idle_clients_.size());
+
+    // The idle connection closed by server without any response, retry by a new connection.
+    mock_factory->fail_next_post_ = ERROR_HTTP_NO_RESPONSE;
+    HELPER_EXPECT_SUCCESS(hooks->on_connect(url, req.get()));
+    EXPECT_EQ(3, mock_factory->nn_created_);
+    EXPECT_EQ(5, mock_factory->nn_posts_);
+    EXPECT_EQ(1, (int)hooks->idle_clients_["http://127.0.0.1:8085"].size());
+
+    // Failed to write the request, retry by a new connection.
+    mock_factory->fail_next_post_ = ERROR_SOCKET_WRITE;
+    HELPER_EXPECT_SUCCESS(hooks->on_connect(url, req.get()));
+    EXPECT_EQ(4, mock_factory->nn_created_);
+    EXPECT_EQ(6, mock_factory->nn_posts_);
+    EXPECT_EQ(1, (int)hooks->idle_clients_["http://127.0.0.1:8085"].size());
+
+    // The server might have handled the request, never retry, and drop the connection.
+    mock_factory->fail_next_post_ = ERROR_SOCKET_TIMEOUT;
+    err = hooks->on_connect(url, req.get());
+    EXPECT_EQ(ERROR_SOCKET_TIMEOUT, srs_error_code(err));
+    srs_freep(err);
+    EXPECT_EQ(4, mock_factory->nn_created_);
+    EXPECT_EQ(6, mock_factory->nn_posts_);
+    EXPECT_EQ(0, (int)hooks->idle_clients_["http://127.0.0.1:8085"].size());
+
+    // Drop the connection if server doesn't support keep-alive.
+    mock_factory->keep_alive_ = false;
+    HELPER_EXPECT_SUCCESS(hooks->on_connect(url, req.get()));
+    EXPECT_EQ(5, mock_factory->nn_created_);
+    EXPECT_EQ(0, (int)hooks->idle_clients_["http://127.0.0.1:8085"].size());
+
+    // The error response is not reused connection error, never retry.
+    mock_factory->keep_alive_ = true;
+    mock_factory->status_code_ = 500;
+    HELPER_EXPECT_FAILED(hooks->on_connect(url, req.get()));
+    EXPECT_EQ(6, mock_factory->nn_created_);
+    EXPECT_EQ(8, mock_factory->nn_posts_);
+    EXPECT_EQ(1, (int)hooks->idle_clients_["http://127.0.0.1:8085"].size());
+
+    // Check the stat of hooks.
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    hooks->dumps(obj.get());
+    EXPECT_EQ(9, obj->get_property("requests")->to_integer());
+    EXPECT_EQ(2, obj->get_property("errors")->to_integer());
+    EXPECT_EQ(2, obj->get_property("idles")->to_integer());
+
+    int64_t nn_latency = 0;
+    for (int i = 0; i < SRS_HTTP_HOOKS_NB_BUCKETS; i++) {
+        nn_latency += hooks->latency_[i];
+    }
+    EXPECT_EQ(9, nn_latency);
+
+    hooks->factory_ = NULL;
+    hooks->stat_ = NULL;
+    hooks->config_ = NULL;
+    hooks->clear_idle_clients();
+}
+
+VOID TEST(HttpHooksTest, KeepAliveDisabled)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<MockAppFactoryForHooksKeepAlive> mock_factory(new MockAppFactoryForHooksKeepAlive());
+    SrsUniquePtr<MockStatisticForHooks> mock_stat(new MockStatisticForHooks());
+    SrsUniquePtr<MockAppConfigForHooksKeepAlive> mock_config(new MockAppConfigForHooksKeepAlive());
+
+    SrsUniquePtr<MockSrsRequest> req(new MockSrsRequest("test.vhost", "live", "stream1"));
+
+    SrsUniquePtr<SrsHttpHooks> hooks(new SrsHttpHooks());
+    hooks->factory_ = mock_factory.get();
+    hooks->stat_ = mock_stat.get();
+    hooks->config_ = mock_config.get();
+
+    // Without keep-alive, each hook uses a new connection.
+    std::string url = "http://127.0.0.1:8085/api/v1/clients";
+    HELPER_EXPECT_SUCCESS(hooks->on_connect(url, req.get()));
+    HELPER_EXPECT_SUCCESS(hooks->on_connect(url, req.get()));
+    EXPECT_EQ(2, mock_factory->nn_created_);
+    EXPECT_EQ(0, hooks->nn_reused_);
+    EXPECT_TRUE(hooks->idle_clients_.empty());
+
+    hooks->factory_ = NULL;
+    hooks->stat_ = NULL;
+    hooks->config_ = NULL;
+}
+
+VOID TEST(HttpHooksTest, OnPlayCache)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<MockAppFactoryForHooksKeepAlive> mock_factory(new MockAppFactoryForHooksKeepAlive());
+    SrsUniquePtr<MockStatisticForHooks> mock_stat(new MockStatisticForHooks());
+    SrsUniquePtr<MockAppConfigForHooksKeepAlive> mock_config(new MockAppConfigForHooksKeepAlive());
+
+    SrsUniquePtr<MockSrsRequest> req(new MockSrsRequest("test.vhost", "live", "stream1"));
+    req->param_ = "?token=abc";
+
+    SrsUniquePtr<SrsHttpHooks> hooks(new SrsHttpHooks());
+    hooks->factory_ = mock_factory.get();
+    hooks->stat_ = mock_stat.get();
+    hooks->config_ = mock_config.get();
+
+    // Never cache if disabled.
+    std::string url = "http://127.0.0.1:8085/api/v1/sessions";
+    HELPER_EXPECT_SUCCESS(hooks->on_play(url, req.get()));
+    HELPER_EXPECT_SUCCESS(hooks->on_play(url, req.get()));
+    EXPECT_EQ(2, mock_factory->nn_posts_);
+    EXPECT_TRUE(hooks->play_cache_.empty());
+
+    // The allowed play is cached.
+    mock_config->play_cache_ = 10 * SRS_UTIME_SECONDS;
+    HELPER_EXPECT_SUCCESS(hooks->on_play(url, req.get()));
+    HELPER_EXPECT_SUCCESS(hooks->on_play(url, req.get()));
+    HELPER_EXPECT_SUCCESS(hooks->on_play(url, req.get()));
+    EXPECT_EQ(3, mock_factory->nn_posts_);
+    EXPECT_EQ(2, hooks->nn_play_hits_);
+
+    // The verdict is not shared by clients of different ip.
+    req->ip_ = "10.0.0.2";
+    mock_factory->status_code_ = 403;
+    HELPER_EXPECT_FAILED(hooks->on_play(url, req.get()));
+    EXPECT_EQ(4, mock_factory->nn_posts_);
+    req->ip_ = "";
+
+    // The different param is not cached.
+    req->param_ = "?token=xyz";
+    HELPER_EXPECT_FAILED(hooks->on_play(url, req.get()));
+    EXPECT_EQ(5, mock_factory->nn_posts_);
+
+    // The rejected play is not cached.
+    HELPER_EXPECT_FAILED(hooks->on_play(url, req.get()));
+    EXPECT_EQ(6, mock_factory->nn_posts_);
+
+    // The expired play is removed.
+    req->param_ = "?token=abc";
+    mock_factory->status_code_ = 200;
+    std::map<std::string, srs_utime_t>::iterator it = hooks->play_cache_.begin();
+    it->second = srs_time_now_cached() - SRS_UTIME_SECONDS;
+    HELPER_EXPECT_SUCCESS(hooks->on_play(url, req.get()));
+    EXPECT_EQ(7, mock_factory->nn_posts_);
+    EXPECT_EQ(2, hooks->nn_play_hits_);
+    EXPECT_EQ(1, (int)hooks->play_cache_.size());
+
+    hooks->factory_ = NULL;
+    hooks->stat_ = NULL;
+    hooks->config_ = NULL;
+}
@@ -327,6 +327,8 @@ public:
     virtual srs_error_t dumps_vhosts(SrsJsonArray *arr);
     virtual srs_error_t dumps_streams(SrsJsonArray *arr, int start, int count);
     virtual srs_error_t dumps_clients(SrsJsonArray *arr, int start, int count);
+    virtual srs_error_t dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page);
+    virtual srs_error_t dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page);
     virtual srs_error_t dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs);
 };
 
@@ -576,7 +578,78 @@ public:
     virtual srs_error_t dumps_vhosts(SrsJsonArray *arr);
     virtual srs_error_t dumps_streams(SrsJsonArray *arr, int start, int count);
     virtual srs_error_t dumps_clients(SrsJsonArray *arr, int start, int count);
+    virtual srs_error_t dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page);
+    virtual srs_error_t dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page);
     virtual srs_error_t dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs);
 };
 
+// Mock ISrsHttpMessage for testing keep-alive of SrsHttpHooks
+class MockHttpMessageForHooksKeepAlive : public MockHttpMessageForHooks
+{
+public:
+    bool keep_alive_;
+
+public:
+    MockHttpMessageForHooksKeepAlive(bool keep_alive);
+    virtual ~MockHttpMessageForHooksKeepAlive();
+
+public:
+    virtual bool is_keep_alive();
+};
+
+class MockAppFactoryForHooksKeepAlive;
+
+// Mock ISrsHttpClient for testing keep-alive of SrsHttpHooks, which creates a response for each post
+class MockHttpClientForHooksKeepAlive : public ISrsHttpClient
+{
+public:
+    MockAppFactoryForHooksKeepAlive *factory_;
+
+public:
+    MockHttpClientForHooksKeepAlive(MockAppFactoryForHooksKeepAlive *factory);
+    virtual ~MockHttpClientForHooksKeepAlive();
+
+public:
+    virtual srs_error_t initialize(std::string schema, std::string h, int p, srs_utime_t tm);
+    virtual srs_error_t get(std::string path, std::string req, ISrsHttpMessage **ppmsg);
+    virtual srs_error_t post(std::string path, std::string req, ISrsHttpMessage **ppmsg);
+    virtual void set_recv_timeout(srs_utime_t tm);
+    virtual void kbps_sample(const char *label, srs_utime_t age);
+};
+
+// Mock ISrsAppFactory for testing keep-alive of SrsHttpHooks
+class MockAppFactoryForHooksKeepAlive : public SrsAppFactory
+{
+public:
+    int nn_created_;
+    int nn_posts_;
+    bool keep_alive_;
+    int status_code_;
+    // The error code to fail the next post, to simulate the idle connection closed by server, 0 for no error.
+    int fail_next_post_;
+
+public:
+    MockAppFactoryForHooksKeepAlive();
+    virtual ~MockAppFactoryForHooksKeepAlive();
+
+public:
+    virtual ISrsHttpClient *create_http_client();
+};
+
+// Mock ISrsAppConfig for testing keep-alive and play cache of SrsHttpHooks
+class MockAppConfigForHooksKeepAlive : public MockAppConfig
+{
+public:
+    bool keep_alive_;
+    srs_utime_t play_cache_;
+
+public:
+    MockAppConfigForHooksKeepAlive();
+    virtual ~MockAppConfigForHooksKeepAlive();
+
+public:
+    virtual bool get_vhost_http_hooks_keep_alive(std::string vhost);
+    virtual srs_utime_t get_vhost_http_hooks_play_cache(std::string vhost);
+};
+
 #endif
@@ -150,6 +150,7 @@ srs_error_t MockUdpMuxHandler::on_udp_packet(ISrsUdpMuxSocket *skt)
     last_peer_port_ = skt->get_peer_port();
     last_packet_data_ = string(skt->data(), skt->size());
     last_packet_size_ = skt->size();
+    packets_.push_back(last_packet_data_);
     return srs_success;
 }
 
@@ -411,6 +412,55 @@ VOID TEST(UdpMuxListenerTest, ReceivePacketFromClient)
     EXPECT_EQ(mock_handler->last_packet_data_, test_data2);
 }
 
+VOID TEST(UdpMuxListenerTest, ReceivePacketsByBatch)
+{
+    srs_error_t err;
+
+    SrsRand rand;
+    int port = rand.integer(30000, 60000);
+
+    SrsUniquePtr<MockUdpMuxHandler> mock_handler(new MockUdpMuxHandler());
+    SrsUniquePtr<SrsUdpMuxListener> listener(new SrsUdpMuxListener(mock_handler.get(), "127.0.0.1", port));
+    listener->set_recv_batch(16);
+    HELPER_EXPECT_SUCCESS(listener->listen());
+
+    // Yield to allow the listener coroutine to start and initialize
+    srs_usleep(1 * SRS_UTIME_MILLISECONDS);
+
+    // Two clients, like two WebRTC sessions.
+    srs_netfd_t fd_a = NULL;
+    HELPER_EXPECT_SUCCESS(srs_udp_listen("127.0.0.1", 0, &fd_a));
+    SrsUniquePtr<srs_netfd_t> fd_a_ptr(&fd_a, srs_close_stfd_ptr);
+
+    srs_netfd_t fd_b = NULL;
+    HELPER_EXPECT_SUCCESS(srs_udp_listen("127.0.0.1", 0, &fd_b));
+    SrsUniquePtr<srs_netfd_t> fd_b_ptr(&fd_b, srs_close_stfd_ptr);
+
+    sockaddr_in dest_addr;
+    memset(&dest_addr, 0, sizeof(dest_addr));
+    dest_addr.sin_family = AF_INET;
+    dest_addr.sin_port = htons(port);
+    dest_addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+
+    // Interleave the packets of sessions, without yield, so they are received by one batch.
+    const char *packets[] = {"a1", "b1", "a2", "b2", "a3"};
+    for (int i = 0; i < 5; i++) {
+        srs_netfd_t fd = packets[i][0] == 'a' ? fd_a : fd_b;
+        int sent = srs_sendto(fd, (void *)packets[i], 2, (sockaddr *)&dest_addr, sizeof(dest_addr), SRS_UTIME_NO_TIMEOUT);
+        EXPECT_EQ(2, sent);
+    }
+
+    srs_usleep(1 * SRS_UTIME_MILLISECONDS);
+
+    // All packets are received, grouped by session, in order of each session.
+    ASSERT_EQ(5, (int)mock_handler->packets_.size());
+    string received;
+    for (int i = 0; i < 5; i++) {
+        received += mock_handler->packets_[i];
+    }
+    EXPECT_TRUE(received == "a1a2a3b1b2" || received == "b1b2a1a2a3") << received;
+}
+
 VOID TEST(UdpMuxSocketTest, SendtoReplyToClient)
 {
     srs_error_t err;
@@ -2988,6 +3038,10 @@ std::string MockFFMPEG::output()
     return "";
 }
 
+void MockFFMPEG::set_task(std::string kind, std::string uri, bool low_priority)
+{
+}
+
 srs_error_t MockFFMPEG::initialize(std::string in, std::string out, std::string log)
 {
     return srs_success;
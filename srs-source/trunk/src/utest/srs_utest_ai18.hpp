@@ -79,6 +79,8 @@ public:
     int last_peer_port_;
     std::string last_packet_data_;
     int last_packet_size_;
+    // All received packets, in the order of handling.
+    std::vector<std::string> packets_;
 
 public:
     MockUdpMuxHandler();
@@ -447,6 +449,7 @@ public:
     virtual void append_iparam(std::string iparam);
     virtual void set_oformat(std::string format);
     virtual std::string output();
+    virtual void set_task(std::string kind, std::string uri, bool low_priority);
     virtual srs_error_t initialize(std::string in, std::string out, std::string log);
     virtual srs_error_t initialize_transcode(SrsConfDirective *engine);
     virtual srs_error_t initialize_copy();
@@ -26,6 +26,7 @@ using namespace std;
 #include <srs_kernel_utility.hpp>
 #include <srs_protocol_http_conn.hpp>
 #include <srs_protocol_http_stack.hpp>
+#include <srs_protocol_json.hpp>
 #include <srs_protocol_rtmp_stack.hpp>
 #include <srs_utest_ai05.hpp>
 #include <srs_utest_manual_coworkers.hpp>
@@ -2249,6 +2250,16 @@ srs_error_t MockStatisticForHttpxConn::dumps_clients(SrsJsonArray *arr, int star
     return srs_success;
 }
 
+srs_error_t MockStatisticForHttpxConn::dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
+srs_error_t MockStatisticForHttpxConn::dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
 srs_error_t MockStatisticForHttpxConn::dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs)
 {
     return srs_success;
@@ -2666,6 +2677,7 @@ MockFFMPEGForEncoder::MockFFMPEGForEncoder()
     start_called_ = false;
     start_error_ = srs_success;
     output_ = "";
+    task_low_priority_ = false;
 }
 
 MockFFMPEGForEncoder::~MockFFMPEGForEncoder()
@@ -2685,6 +2697,12 @@ std::string MockFFMPEGForEncoder::output()
     return output_;
 }
 
+void MockFFMPEGForEncoder::set_task(std::string kind, std::string uri, bool low_priority)
+{
+    task_kind_ = kind;
+    task_low_priority_ = low_priority;
+}
+
 srs_error_t MockFFMPEGForEncoder::initialize(std::string in, std::string out, std::string log)
 {
     initialize_called_ = true;
@@ -2731,6 +2749,8 @@ void MockFFMPEGForEncoder::reset()
     start_called_ = false;
     srs_freep(start_error_);
     output_ = "";
+    task_kind_ = "";
+    task_low_priority_ = false;
 }
 
 // Mock ISrsAppConfig implementation
@@ -2971,6 +2991,10 @@ VOID TEST(EncoderTest, InitializeFFmpegMajorScenario)
     // Verify that input_stream_name_ was set correctly (vhost/app/stream format)
     EXPECT_STREQ("test.vhost/live/livestream", encoder->input_stream_name_.c_str());
 
+    // Verify that the transcode is supervised as low priority task.
+    EXPECT_STREQ("transcode", mock_ffmpeg->task_kind_.c_str());
+    EXPECT_TRUE(mock_ffmpeg->task_low_priority_);
+
     // Clean up - set to NULL to avoid double-free
     encoder->config_ = NULL;
 }
@@ -4140,3 +4164,257 @@ VOID TEST(CircuitBreakerTest, InitializeAndWaterLevelTransitions)
     disabled_breaker->host_ = NULL;
     srs_freep(mock_host);
 }
+
+MockAppConfigForSupervisor::MockAppConfigForSupervisor()
+{
+    enabled_ = true;
+    nice_ = 10;
+    threshold_ = 80;
+    backoff_max_ = 4 * SRS_UTIME_SECONDS;
+}
+
+MockAppConfigForSupervisor::~MockAppConfigForSupervisor()
+{
+}
+
+bool MockAppConfigForSupervisor::get_supervisor_enabled()
+{
+    return enabled_;
+}
+
+std::string MockAppConfigForSupervisor::get_supervisor_srs_cpus()
+{
+    return srs_cpus_;
+}
+
+std::string MockAppConfigForSupervisor::get_supervisor_ffmpeg_cpus()
+{
+    return ffmpeg_cpus_;
+}
+
+int MockAppConfigForSupervisor::get_supervisor_ffmpeg_nice()
+{
+    return nice_;
+}
+
+int MockAppConfigForSupervisor::get_supervisor_threshold()
+{
+    return threshold_;
+}
+
+srs_utime_t MockAppConfigForSupervisor::get_supervisor_backoff_max()
+{
+    return backoff_max_;
+}
+
+VOID TEST(SupervisorTest, ParseCpus)
+{
+    srs_error_t err;
+
+    if (true) {
+        vector<int> cores;
+        HELPER_EXPECT_SUCCESS(srs_parse_cpus("0-2,4", cores));
+        ASSERT_EQ(4, (int)cores.size());
+        EXPECT_EQ(0, cores.at(0));
+        EXPECT_EQ(2, cores.at(2));
+        EXPECT_EQ(4, cores.at(3));
+    }
+
+    if (true) {
+        vector<int> cores;
+        HELPER_EXPECT_SUCCESS(srs_parse_cpus(" 3 , 5-6 ", cores));
+        ASSERT_EQ(3, (int)cores.size());
+        EXPECT_EQ(3, cores.at(0));
+        EXPECT_EQ(6, cores.at(2));
+    }
+
+    if (true) {
+        vector<int> cores;
+        HELPER_EXPECT_SUCCESS(srs_parse_cpus("", cores));
+        EXPECT_TRUE(cores.empty());
+    }
+
+    if (true) {
+        vector<int> cores;
+        HELPER_EXPECT_FAILED(srs_parse_cpus("a-b", cores));
+        HELPER_EXPECT_FAILED(srs_parse_cpus("3-1", cores));
+        HELPER_EXPECT_FAILED(srs_parse_cpus("1-", cores));
+    }
+}
+
+VOID TEST(SupervisorTest, RestartBackoff)
+{
+    SrsUniquePtr<MockAppConfigForSupervisor> config(new MockAppConfigForSupervisor());
+    SrsUniquePtr<SrsProcessSupervisor> supervisor(new SrsProcessSupervisor());
+    supervisor->config_ = config.get();
+
+    SrsProcessTask task("ingest", "__defaultVhost__/livestream", false);
+    supervisor->attach(&task);
+    EXPECT_TRUE(supervisor->can_start(&task));
+
+    // The first crash, restart after the min backoff.
+    supervisor->on_start(&task, 100);
+    EXPECT_EQ(100, task.pid_);
+    supervisor->on_stop(&task, true);
+    EXPECT_EQ(-1, task.pid_);
+    EXPECT_EQ(1, task.restarts_);
+    EXPECT_EQ(SRS_SUPERVISOR_BACKOFF_MIN, task.backoff_);
+    EXPECT_FALSE(supervisor->can_start(&task));
+
+    // Crash again, double the backoff util the max.
+    task.next_start_ = 0;
+    EXPECT_TRUE(supervisor->can_start(&task));
+    supervisor->on_start(&task, 101);
+    supervisor->on_stop(&task, true);
+    EXPECT_EQ(2 * SRS_UTIME_SECONDS, task.backoff_);
+
+    supervisor->on_start(&task, 102);
+    supervisor->on_stop(&task, true);
+    EXPECT_EQ(4 * SRS_UTIME_SECONDS, task.backoff_);
+
+    supervisor->on_start(&task, 103);
+    supervisor->on_stop(&task, true);
+    EXPECT_EQ(4 * SRS_UTIME_SECONDS, task.backoff_);
+    EXPECT_EQ(4, task.restarts_);
+
+    // Reset the backoff, if the process runs stable.
+    supervisor->on_start(&task, 104);
+    task.starttime_ -= SRS_SUPERVISOR_STABLE;
+    supervisor->on_stop(&task, true);
+    EXPECT_EQ(SRS_SUPERVISOR_BACKOFF_MIN, task.backoff_);
+
+    // Stop by user, not restart.
+    supervisor->on_start(&task, 105);
+    supervisor->on_stop(&task, false);
+    EXPECT_EQ(5, task.restarts_);
+
+    // Never backoff if disabled.
+    config->enabled_ = false;
+    EXPECT_TRUE(supervisor->can_start(&task));
+
+    supervisor->detach(&task);
+    EXPECT_TRUE(supervisor->tasks_.empty());
+    supervisor->config_ = NULL;
+}
+
+VOID TEST(SupervisorTest, QueueWhenSaturated)
+{
+    SrsUniquePtr<MockAppConfigForSupervisor> config(new MockAppConfigForSupervisor());
+    SrsUniquePtr<SrsProcessSupervisor> supervisor(new SrsProcessSupervisor());
+    supervisor->config_ = config.get();
+
+    SrsProcSystemStat *stat = srs_get_system_proc_stat();
+    SrsProcSystemStat saved = *stat;
+    stat->ok_ = true;
+    stat->percent_ = 0.9;
+
+    // The transcodes are queued when host is saturated, but the ingest is not.
+    SrsProcessTask ingest("ingest", "__defaultVhost__/livestream", false);
+    SrsProcessTask transcode("transcode", "rtmp://127.0.0.1/live/livestream_hd", true);
+    SrsProcessTask transcode2("transcode", "rtmp://127.0.0.1/live/livestream_sd", true);
+    EXPECT_TRUE(supervisor->can_start(&ingest));
+    EXPECT_FALSE(supervisor->can_start(&transcode));
+    EXPECT_TRUE(transcode.queued_);
+    EXPECT_FALSE(supervisor->can_start(&transcode2));
+    EXPECT_TRUE(transcode2.queued_);
+
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    supervisor->dumps(obj.get());
+    EXPECT_TRUE(obj->get_property("saturated")->to_boolean());
+
+    // Start the queued transcodes one by one, when host is not saturated.
+    stat->percent_ = 0.5;
+    EXPECT_TRUE(supervisor->can_start(&transcode));
+    EXPECT_FALSE(transcode.queued_);
+    EXPECT_FALSE(supervisor->can_start(&transcode2));
+    EXPECT_TRUE(transcode2.queued_);
+
+    supervisor->last_dequeue_ -= SRS_SUPERVISOR_SAMPLE_INTERVAL;
+    EXPECT_TRUE(supervisor->can_start(&transcode2));
+    EXPECT_FALSE(transcode2.queued_);
+
+    // Never queue if threshold is 0.
+    stat->percent_ = 0.99;
+    config->threshold_ = 0;
+    EXPECT_TRUE(supervisor->can_start(&transcode));
+
+    *stat = saved;
+    supervisor->config_ = NULL;
+}
+
+VOID TEST(SupervisorTest, LimitAndSample)
+{
+    SrsUniquePtr<MockAppConfigForSupervisor> config(new MockAppConfigForSupervisor());
+    SrsUniquePtr<SrsProcessSupervisor> supervisor(new SrsProcessSupervisor());
+    supervisor->config_ = config.get();
+
+    // Pin the FFmpeg to cpus, and renice it.
+    if (true) {
+        config->ffmpeg_cpus_ = "2-3";
+        SrsProcess process;
+        supervisor->limit(&process);
+        EXPECT_STREQ("2-3", process.cpus_.c_str());
+        EXPECT_EQ(10, process.nice_);
+    }
+
+    // Use all cpus for FFmpeg, if SRS is pinned.
+    if (true) {
+        config->ffmpeg_cpus_ = "";
+        config->srs_cpus_ = "0";
+        SrsProcess process;
+        supervisor->limit(&process);
+        EXPECT_TRUE(srs_strings_starts_with(process.cpus_, "0-"));
+    }
+
+    // No limits if disabled.
+    if (true) {
+        config->enabled_ = false;
+        SrsProcess process;
+        supervisor->limit(&process);
+        EXPECT_TRUE(process.cpus_.empty());
+        EXPECT_EQ(0, process.nice_);
+    }
+
+    // Sample the cpu and memory of process, use this process for test.
+    SrsProcessTask task("transcode", "rtmp://127.0.0.1/live/livestream_hd", true);
+    supervisor->attach(&task);
+    supervisor->on_start(&task, (int)getpid());
+
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    supervisor->dumps(obj.get());
+    EXPECT_TRUE(task.sample_time_ > 0);
+    EXPECT_TRUE(task.ticks_ > 0);
+    EXPECT_TRUE(task.rss_kb_ > 0);
+
+    SrsJsonAny *tasks = obj->get_property("tasks");
+    ASSERT_TRUE(tasks && tasks->is_array());
+    ASSERT_EQ(1, tasks->to_array()->count());
+    SrsJsonObject *item = tasks->to_array()->at(0)->to_object();
+    EXPECT_STREQ("transcode", item->get_property("kind")->to_str().c_str());
+    EXPECT_EQ((int)getpid(), (int)item->get_property("pid")->to_integer());
+    EXPECT_TRUE(item->get_property("rss_kb")->to_integer() > 0);
+
+    supervisor->detach(&task);
+    supervisor->config_ = NULL;
+}
+
+VOID TEST(SupervisorTest, FFmpegTask)
+{
+    SrsUniquePtr<SrsProcessSupervisor> supervisor(new SrsProcessSupervisor());
+
+    SrsFFMPEG *ffmpeg = new SrsFFMPEG("/usr/bin/ffmpeg");
+    ffmpeg->supervisor_ = supervisor.get();
+    ffmpeg->set_task("ingest", "__defaultVhost__/livestream", false);
+    ASSERT_TRUE(ffmpeg->task_ != NULL);
+    EXPECT_FALSE(ffmpeg->task_->low_priority_);
+    EXPECT_EQ(1, (int)supervisor->tasks_.size());
+
+    // Replace the task.
+    ffmpeg->set_task("transcode", "rtmp://127.0.0.1/live/livestream_hd", true);
+    EXPECT_TRUE(ffmpeg->task_->low_priority_);
+    EXPECT_EQ(1, (int)supervisor->tasks_.size());
+
+    // Detach the task when FFmpeg is freed.
+    srs_freep(ffmpeg);
+    EXPECT_TRUE(supervisor->tasks_.empty());
+}
@@ -505,6 +505,8 @@ public:
     virtual srs_error_t dumps_vhosts(SrsJsonArray *arr);
     virtual srs_error_t dumps_streams(SrsJsonArray *arr, int start, int count);
     virtual srs_error_t dumps_clients(SrsJsonArray *arr, int start, int count);
+    virtual srs_error_t dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page);
+    virtual srs_error_t dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page);
     virtual srs_error_t dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs);
     void reset();
 };
@@ -543,6 +545,8 @@ public:
     bool start_called_;
     srs_error_t start_error_;
     std::string output_;
+    std::string task_kind_;
+    bool task_low_priority_;
 
 public:
     MockFFMPEGForEncoder();
@@ -552,6 +556,7 @@ public:
     virtual void append_iparam(std::string iparam);
     virtual void set_oformat(std::string format);
     virtual std::string output();
+    virtual void set_task(std::string kind, std::string uri, bool low_priority);
     virtual srs_error_t initialize(std::string in, std::string out, std::string log);
     virtual srs_error_t initialize_transcode(SrsConfDirective *engine);
     virtual srs_error_t initialize_copy();
@@ -914,4 +919,28 @@ public:
     virtual SrsProcSelfStat *self_proc_stat();
 };
 
+// Mock ISrsAppConfig for testing SrsProcessSupervisor
+class MockAppConfigForSupervisor : public MockAppConfig
+{
+public:
+    bool enabled_;
+    std::string srs_cpus_;
+    std::string ffmpeg_cpus_;
+    int nice_;
+    int threshold_;
+    srs_utime_t backoff_max_;
+
+public:
+    MockAppConfigForSupervisor();
+    virtual ~MockAppConfigForSupervisor();
+
+public:
+    virtual bool get_supervisor_enabled();
+    virtual std::string get_supervisor_srs_cpus();
+    virtual std::string get_supervisor_ffmpeg_cpus();
+    virtual int get_supervisor_ffmpeg_nice();
+    virtual int get_supervisor_threshold();
+    virtual srs_utime_t get_supervisor_backoff_max();
+};
+
 #endif
@@ -1307,6 +1307,16 @@ srs_error_t MockSrtStatistic::dumps_clients(SrsJsonArray *arr, int start, int co
     return srs_success;
 }
 
+srs_error_t MockSrtStatistic::dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
+srs_error_t MockSrtStatistic::dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
 srs_error_t MockSrtStatistic::dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs)
 {
     send_bytes = 0;
@@ -318,6 +318,9 @@ MockEdgeHttpMessage::MockEdgeHttpMessage()
     status_code_ = 200;
     header_ = new SrsHttpHeader();
     body_reader_ = NULL;
+    keep_alive_ = false;
+    content_length_ = -1;
+    nn_body_read_all_ = 0;
 }
 
 MockEdgeHttpMessage::~MockEdgeHttpMessage()
@@ -403,6 +406,7 @@ std::string MockEdgeHttpMessage::ext()
 
 srs_error_t MockEdgeHttpMessage::body_read_all(std::string &body)
 {
+    nn_body_read_all_++;
     return srs_success;
 }
 
@@ -413,7 +417,7 @@ ISrsHttpResponseReader *MockEdgeHttpMessage::body_reader()
 
 int64_t MockEdgeHttpMessage::content_length()
 {
-    return -1;
+    return content_length_;
 }
 
 std::string MockEdgeHttpMessage::query_get(std::string key)
@@ -433,7 +437,7 @@ bool MockEdgeHttpMessage::is_jsonp()
 
 bool MockEdgeHttpMessage::is_keep_alive()
 {
-    return false;
+    return keep_alive_;
 }
 
 std::string MockEdgeHttpMessage::parse_rest_id(std::string pattern)
@@ -441,77 +445,43 @@ std::string MockEdgeHttpMessage::parse_rest_id(std::string pattern)
     return "";
 }
 
-// MockEdgeFileReader implementation
-MockEdgeFileReader::MockEdgeFileReader(const char *data, int size)
+// MockEdgeHttpResponseReader implementation
+MockEdgeHttpResponseReader::MockEdgeHttpResponseReader(std::string data)
 {
-    data_ = new char[size];
-    memcpy(data_, data, size);
-    size_ = size;
+    data_ = data;
     pos_ = 0;
+    max_read_ = 0;
+    nn_reads_ = 0;
 }
 
-MockEdgeFileReader::~MockEdgeFileReader()
-{
-    srs_freepa(data_);
-}
-
-srs_error_t MockEdgeFileReader::open(std::string p)
-{
-    return srs_success;
-}
-
-void MockEdgeFileReader::close()
-{
-}
-
-bool MockEdgeFileReader::is_open()
+MockEdgeHttpResponseReader::~MockEdgeHttpResponseReader()
 {
-    return true;
-}
-
-int64_t MockEdgeFileReader::tellg()
-{
-    return pos_;
 }
 
-void MockEdgeFileReader::skip(int64_t size)
+bool MockEdgeHttpResponseReader::eof()
 {
-    pos_ += size;
+    return pos_ >= (int)data_.size();
 }
 
-int64_t MockEdgeFileReader::seek2(int64_t offset)
+srs_error_t MockEdgeHttpResponseReader::read(void *buf, size_t size, ssize_t *nread)
 {
-    pos_ = offset;
-    return pos_;
-}
-
-int64_t MockEdgeFileReader::filesize()
-{
-    return size_;
-}
-
-srs_error_t MockEdgeFileReader::read(void *buf, size_t count, ssize_t *pnread)
-{
-    int available = size_ - pos_;
-    int to_read = (int)count;
-    if (to_read > available) {
-        to_read = available;
+    if (eof()) {
+        return srs_error_new(ERROR_HTTP_RESPONSE_EOF, "EOF");
     }
 
-    if (to_read > 0) {
-        memcpy(buf, data_ + pos_, to_read);
-        pos_ += to_read;
+    int to_read = srs_min((int)size, (int)data_.size() - pos_);
+    if (max_read_ > 0) {
+        to_read = srs_min(to_read, max_read_);
     }
 
-    if (pnread) {
-        *pnread = to_read;
-    }
+    memcpy(buf, data_.data() + pos_, to_read);
+    pos_ += to_read;
+    nn_reads_++;
 
-    return srs_success;
-}
+    if (nread) {
+        *nread = to_read;
+    }
 
-srs_error_t MockEdgeFileReader::lseek(off_t offset, int whence, off_t *seeked)
-{
     return srs_success;
 }
 
@@ -524,67 +494,11 @@ MockPublishEdge::~MockPublishEdge()
 {
 }
 
-// MockEdgeFlvDecoder implementation
-MockEdgeFlvDecoder::MockEdgeFlvDecoder()
-{
-    initialize_called_ = false;
-    read_header_called_ = false;
-    read_previous_tag_size_called_ = false;
-}
-
-MockEdgeFlvDecoder::~MockEdgeFlvDecoder()
-{
-}
-
-srs_error_t MockEdgeFlvDecoder::initialize(ISrsReader *fr)
-{
-    initialize_called_ = true;
-    return srs_success;
-}
-
-srs_error_t MockEdgeFlvDecoder::read_header(char header[9])
-{
-    read_header_called_ = true;
-    // Write FLV header: 'FLV' + version(1) + flags(5) + header_size(4)
-    header[0] = 'F';
-    header[1] = 'L';
-    header[2] = 'V';
-    header[3] = 0x01; // version
-    header[4] = 0x05; // audio + video
-    header[5] = 0x00;
-    header[6] = 0x00;
-    header[7] = 0x00;
-    header[8] = 0x09; // header size
-    return srs_success;
-}
-
-srs_error_t MockEdgeFlvDecoder::read_tag_header(char *ptype, int32_t *pdata_size, uint32_t *ptime)
-{
-    return srs_success;
-}
-
-srs_error_t MockEdgeFlvDecoder::read_tag_data(char *data, int32_t size)
-{
-    return srs_success;
-}
-
-srs_error_t MockEdgeFlvDecoder::read_previous_tag_size(char previous_tag_size[4])
-{
-    read_previous_tag_size_called_ = true;
-    // Write previous tag size as 0
-    previous_tag_size[0] = 0x00;
-    previous_tag_size[1] = 0x00;
-    previous_tag_size[2] = 0x00;
-    previous_tag_size[3] = 0x00;
-    return srs_success;
-}
-
 // MockEdgeFlvAppFactory implementation
 MockEdgeFlvAppFactory::MockEdgeFlvAppFactory()
 {
     mock_http_client_ = NULL;
-    mock_file_reader_ = NULL;
-    mock_flv_decoder_ = NULL;
+    nn_http_clients_ = 0;
 }
 
 MockEdgeFlvAppFactory::~MockEdgeFlvAppFactory()
@@ -594,26 +508,17 @@ MockEdgeFlvAppFactory::~MockEdgeFlvAppFactory()
 
 ISrsHttpClient *MockEdgeFlvAppFactory::create_http_client()
 {
+    nn_http_clients_++;
     return mock_http_client_;
 }
 
-ISrsFileReader *MockEdgeFlvAppFactory::create_http_file_reader(ISrsHttpResponseReader *r)
-{
-    return mock_file_reader_;
-}
-
-ISrsFlvDecoder *MockEdgeFlvAppFactory::create_flv_decoder()
-{
-    return mock_flv_decoder_;
-}
-
 // Test SrsEdgeFlvUpstream::connect() - major use scenario
 // This test covers the typical edge server connecting to origin server via HTTP-FLV:
 // 1. Edge server receives a play request
 // 2. Uses load balancer to select an origin server
 // 3. Connects to the origin server via HTTP
 // 4. Gets the FLV stream from origin
-// 5. Initializes FLV decoder to read the stream
+// 5. Initializes FLV demuxer to read the stream
 //
 // This test uses mocks to avoid needing a real HTTP server.
 VOID TEST(EdgeFlvUpstreamTest, ConnectToOriginWithHttpFlv)
@@ -642,17 +547,13 @@ VOID TEST(EdgeFlvUpstreamTest, ConnectToOriginWithHttpFlv)
     mock_http_client->get_error_ = srs_success;
     mock_http_client->mock_response_ = mock_response;
 
-    // Create mock file reader
-    MockEdgeFileReader *mock_file_reader = new MockEdgeFileReader("", 0);
-
-    // Create mock FLV decoder
-    MockEdgeFlvDecoder *mock_flv_decoder = new MockEdgeFlvDecoder();
+    // Create mock body reader with FLV header and the first previous tag size
+    SrsUniquePtr<MockEdgeHttpResponseReader> mock_body(new MockEdgeHttpResponseReader(std::string("FLV\x01\x05\x00\x00\x00\x09\x00\x00\x00\x00", 13)));
+    mock_response->body_reader_ = mock_body.get();
 
     // Create mock app factory that returns our mock objects
     SrsUniquePtr<MockEdgeFlvAppFactory> mock_factory(new MockEdgeFlvAppFactory());
     mock_factory->mock_http_client_ = mock_http_client;
-    mock_factory->mock_file_reader_ = mock_file_reader;
-    mock_factory->mock_flv_decoder_ = mock_flv_decoder;
 
     // Create load balancer for round-robin selection
     SrsUniquePtr<SrsLbRoundRobin> lb(new SrsLbRoundRobin());
@@ -676,10 +577,9 @@ VOID TEST(EdgeFlvUpstreamTest, ConnectToOriginWithHttpFlv)
     EXPECT_EQ(8080, mock_http_client->port_);
     EXPECT_STREQ("/live/livestream.flv?token=abc123", mock_http_client->path_.c_str());
 
-    // Verify FLV decoder was initialized and read header
-    EXPECT_TRUE(mock_flv_decoder->initialize_called_);
-    EXPECT_TRUE(mock_flv_decoder->read_header_called_);
-    EXPECT_TRUE(mock_flv_decoder->read_previous_tag_size_called_);
+    // Verify FLV demuxer was initialized and read header
+    EXPECT_TRUE(upstream->demuxer_ != NULL);
+    EXPECT_EQ(13, mock_body->pos_);
 
     // Verify load balancer selected first server
     std::string selected_server;
@@ -691,90 +591,35 @@ VOID TEST(EdgeFlvUpstreamTest, ConnectToOriginWithHttpFlv)
     // Clean up - set to NULL to avoid double-free
     upstream->sdk_ = NULL;
     upstream->hr_ = NULL;
-    upstream->reader_ = NULL;
-    upstream->decoder_ = NULL;
 
     srs_freep(mock_http_client);
     srs_freep(mock_response);
-    srs_freep(mock_file_reader);
-    srs_freep(mock_flv_decoder);
 }
 
-// Mock FLV decoder that returns actual FLV tag data for testing recv_message
-class MockFlvDecoderWithData : public ISrsFlvDecoder
+// Build a FLV tag with the previous tag size, for testing the FLV demuxer of edge.
+std::string mock_flv_tag(char type, uint32_t time, std::string payload)
 {
-public:
-    char tag_type_;
-    int32_t tag_size_;
-    uint32_t tag_time_;
-    char *tag_data_;
-    bool should_fail_;
-
-public:
-    MockFlvDecoderWithData()
-    {
-        tag_type_ = SrsFrameTypeScript;
-        tag_size_ = 0;
-        tag_time_ = 0;
-        tag_data_ = NULL;
-        should_fail_ = false;
-    }
-
-    virtual ~MockFlvDecoderWithData()
-    {
-        // Don't free tag_data_ - it will be managed by the message
-    }
-
-    virtual srs_error_t initialize(ISrsReader *fr)
-    {
-        return srs_success;
-    }
-
-    virtual srs_error_t read_header(char header[9])
-    {
-        return srs_success;
-    }
-
-    virtual srs_error_t read_tag_header(char *ptype, int32_t *pdata_size, uint32_t *ptime)
-    {
-        if (should_fail_) {
-            return srs_error_new(ERROR_SYSTEM_IO_INVALID, "mock read tag header failed");
-        }
-        *ptype = tag_type_;
-        *pdata_size = tag_size_;
-        *ptime = tag_time_;
-        return srs_success;
-    }
+    int size = (int)payload.size();
+    char header[SRS_FLV_TAG_HEADER_SIZE];
+    SrsBuffer hb(header, sizeof(header));
+    hb.write_1bytes(type);
+    hb.write_3bytes(size);
+    hb.write_3bytes(time & 0xffffff);
+    hb.write_1bytes((time >> 24) & 0xff);
+    hb.write_3bytes(0);
 
-    virtual srs_error_t read_tag_data(char *data, int32_t size)
-    {
-        if (should_fail_) {
-            return srs_error_new(ERROR_SYSTEM_IO_INVALID, "mock read tag data failed");
-        }
-        if (tag_data_ && size > 0) {
-            memcpy(data, tag_data_, size);
-        }
-        return srs_success;
-    }
+    char pts[SRS_FLV_PREVIOUS_TAG_SIZE];
+    SrsBuffer pb(pts, sizeof(pts));
+    pb.write_4bytes(SRS_FLV_TAG_HEADER_SIZE + size);
 
-    virtual srs_error_t read_previous_tag_size(char previous_tag_size[4])
-    {
-        if (should_fail_) {
-            return srs_error_new(ERROR_SYSTEM_IO_INVALID, "mock read pts failed");
-        }
-        previous_tag_size[0] = 0x00;
-        previous_tag_size[1] = 0x00;
-        previous_tag_size[2] = 0x00;
-        previous_tag_size[3] = 0x00;
-        return srs_success;
-    }
-};
+    return std::string(header, sizeof(header)) + payload + std::string(pts, sizeof(pts));
+}
 
 // Test SrsEdgeFlvUpstream::recv_message() and decode_message() - major use scenario
 // This test covers the typical edge server receiving FLV messages from origin:
-// 1. Edge server reads FLV tag header (type, size, timestamp)
-// 2. Reads FLV tag data
-// 3. Reads previous tag size
+// 1. Edge server reads a chunk of FLV stream
+// 2. Parses FLV tag header (type, size, timestamp)
+// 3. Slices FLV tag data and previous tag size from the chunk
 // 4. Creates RTMP message from FLV tag
 // 5. Decodes metadata message if it's onMetaData
 VOID TEST(EdgeFlvUpstreamTest, RecvAndDecodeMetadataMessage)
@@ -795,16 +640,15 @@ VOID TEST(EdgeFlvUpstreamTest, RecvAndDecodeMetadataMessage)
     HELPER_EXPECT_SUCCESS(name->write(&metadata_buf));
     HELPER_EXPECT_SUCCESS(metadata->write(&metadata_buf));
 
-    // Create mock FLV decoder with metadata tag
-    MockFlvDecoderWithData *mock_decoder = new MockFlvDecoderWithData();
-    mock_decoder->tag_type_ = SrsFrameTypeScript; // 18 = script data
-    mock_decoder->tag_size_ = metadata_size;
-    mock_decoder->tag_time_ = 1000; // 1 second (note: script messages always have timestamp 0)
-    mock_decoder->tag_data_ = metadata_data;
+    // Create mock body reader with metadata tag
+    SrsUniquePtr<MockEdgeHttpResponseReader> mock_body(new MockEdgeHttpResponseReader(
+        mock_flv_tag(SrsFrameTypeScript, 1000, std::string(metadata_data, metadata_size))));
+    srs_freepa(metadata_data);
 
     // Create edge FLV upstream
     SrsUniquePtr<SrsEdgeFlvUpstream> upstream(new SrsEdgeFlvUpstream("http"));
-    upstream->decoder_ = mock_decoder;
+    upstream->demuxer_ = new SrsEdgeFlvDemuxer();
+    upstream->demuxer_->initialize(mock_body.get());
 
     // Test: Receive message from FLV stream
     SrsRtmpCommonMessage *msg = NULL;
@@ -843,8 +687,6 @@ VOID TEST(EdgeFlvUpstreamTest, RecvAndDecodeMetadataMessage)
     // Clean up
     srs_freep(msg);
     srs_freep(packet);
-    upstream->decoder_ = NULL;
-    srs_freep(mock_decoder);
 }
 
 // Test SrsEdgeFlvUpstream utility methods - major use scenario
@@ -891,14 +733,12 @@ VOID TEST(EdgeFlvUpstreamTest, UtilityMethodsAndCleanup)
 
     // Create additional resources to test cleanup
     MockEdgeHttpMessage *mock_response = new MockEdgeHttpMessage();
-    MockEdgeFileReader *mock_file_reader = new MockEdgeFileReader(NULL, 0);
-    MockEdgeFlvDecoder *mock_flv_decoder = new MockEdgeFlvDecoder();
     MockEdgeRequest *mock_request = new MockEdgeRequest("test.vhost", "live", "stream1");
 
     upstream->hr_ = mock_response;
-    upstream->reader_ = mock_file_reader;
-    upstream->decoder_ = mock_flv_decoder;
+    upstream->demuxer_ = new SrsEdgeFlvDemuxer();
     upstream->req_ = mock_request;
+    upstream->keepalive_ = true;
 
     // Test 4: Close and cleanup all resources
     upstream->close();
@@ -906,9 +746,162 @@ VOID TEST(EdgeFlvUpstreamTest, UtilityMethodsAndCleanup)
     // Verify all resources are freed (pointers should be NULL after close)
     EXPECT_TRUE(upstream->sdk_ == NULL);
     EXPECT_TRUE(upstream->hr_ == NULL);
-    EXPECT_TRUE(upstream->reader_ == NULL);
-    EXPECT_TRUE(upstream->decoder_ == NULL);
+    EXPECT_TRUE(upstream->demuxer_ == NULL);
     EXPECT_TRUE(upstream->req_ == NULL);
+    EXPECT_FALSE(upstream->keepalive_);
+}
+
+// Test the FLV demuxer of edge parses multiple tags from one read, and the payloads of tags
+// refer to the chunk without copy, while a tag larger than chunk is read into its own chunk.
+VOID TEST(EdgeFlvUpstreamTest, DemuxerParseTagsInChunk)
+{
+    srs_error_t err;
+
+    std::string flv = std::string("FLV\x01\x05\x00\x00\x00\x09\x00\x00\x00\x00", 13);
+    flv += mock_flv_tag(SrsFrameTypeAudio, 10, std::string(100, 'a'));
+    flv += mock_flv_tag(SrsFrameTypeVideo, 20, std::string(200, 'v'));
+    flv += mock_flv_tag(SrsFrameTypeAudio, 0x01000030, std::string(100, 'b'));
+    flv += mock_flv_tag(SrsFrameTypeVideo, 40, std::string(3000, 'k'));
+    MockEdgeHttpResponseReader body(flv);
+
+    SrsEdgeFlvDemuxer demuxer(1024);
+    demuxer.initialize(&body);
+
+    char header[9];
+    HELPER_EXPECT_SUCCESS(demuxer.read_header(header));
+    EXPECT_EQ('F', header[0]);
+    EXPECT_EQ(1, demuxer.nn_reads());
+
+    // The first three tags are parsed from the chunk of first read.
+    char type;
+    uint32_t time;
+    SrsMemoryBlock *p0 = NULL, *p1 = NULL, *p2 = NULL, *p3 = NULL;
+    HELPER_EXPECT_SUCCESS(demuxer.read_tag(&type, &time, &p0));
+    EXPECT_EQ(SrsFrameTypeAudio, type);
+    EXPECT_EQ(10, (int)time);
+    EXPECT_EQ(100, p0->size());
+    EXPECT_EQ('a', p0->payload()[99]);
+
+    HELPER_EXPECT_SUCCESS(demuxer.read_tag(&type, &time, &p1));
+    EXPECT_EQ(SrsFrameTypeVideo, type);
+    EXPECT_EQ(200, p1->size());
+    EXPECT_TRUE(p1->payload() == p0->payload() + 100 + SRS_FLV_PREVIOUS_TAG_SIZE + SRS_FLV_TAG_HEADER_SIZE);
+
+    HELPER_EXPECT_SUCCESS(demuxer.read_tag(&type, &time, &p2));
+    EXPECT_EQ(0x01000030, (int)time);
+    EXPECT_EQ('b', p2->payload()[0]);
+    EXPECT_EQ(1, demuxer.nn_reads());
+
+    // The large tag is read into a new chunk, and the previous tags are still valid.
+    HELPER_EXPECT_SUCCESS(demuxer.read_tag(&type, &time, &p3));
+    EXPECT_EQ(3000, p3->size());
+    EXPECT_EQ('k', p3->payload()[2999]);
+    EXPECT_EQ(4, demuxer.nn_tags());
+    EXPECT_EQ(2, demuxer.nn_reads());
+
+    srs_freep(p0);
+    srs_freep(p1);
+    srs_freep(p3);
+    EXPECT_EQ('b', p2->payload()[99]);
+    srs_freep(p2);
+
+    // The stream is EOF.
+    HELPER_EXPECT_FAILED(demuxer.read_tag(&type, &time, &p0));
+}
+
+// Test the FLV demuxer of edge when the data arrives in small reads, the partial tag is kept
+// when switching to a new chunk, and the message shares the payload of tag.
+VOID TEST(EdgeFlvUpstreamTest, DemuxerPartialReads)
+{
+    srs_error_t err;
+
+    std::string flv = std::string("FLV\x01\x05\x00\x00\x00\x09\x00\x00\x00\x00", 13);
+    for (int i = 0; i < 10; i++) {
+        flv += mock_flv_tag(SrsFrameTypeVideo, i * 40, std::string(50, 'a' + i));
+    }
+    MockEdgeHttpResponseReader body(flv);
+    body.max_read_ = 7;
+
+    SrsEdgeFlvUpstream upstream("http");
+    upstream.demuxer_ = new SrsEdgeFlvDemuxer(128);
+    upstream.demuxer_->initialize(&body);
+
+    char header[9];
+    HELPER_EXPECT_SUCCESS(upstream.demuxer_->read_header(header));
+
+    for (int i = 0; i < 10; i++) {
+        SrsRtmpCommonMessage *msg = NULL;
+        HELPER_EXPECT_SUCCESS(upstream.recv_message(&msg));
+        SrsUniquePtr<SrsRtmpCommonMessage> msg_uptr(msg);
+
+        EXPECT_TRUE(msg->header_.is_video());
+        EXPECT_EQ(i * 40, (int)msg->header_.timestamp_);
+        EXPECT_EQ(50, msg->size());
+        EXPECT_EQ(50, msg->header_.payload_length_);
+        EXPECT_EQ('a' + i, msg->payload()[0]);
+        EXPECT_EQ('a' + i, msg->payload()[49]);
+    }
+    EXPECT_EQ(10, upstream.demuxer_->nn_tags());
+}
+
+// Test the edge FLV upstream reuses the keep-alive HTTP connection when retry for 404, and
+// creates a new connection when the previous response is not drained.
+VOID TEST(EdgeFlvUpstreamTest, KeepAliveReconnect)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<MockEdgeRequest> req(new MockEdgeRequest("test.vhost", "live", "livestream"));
+    SrsUniquePtr<MockEdgeConfig> config(new MockEdgeConfig());
+    config->edge_origin_directive_ = new SrsConfDirective();
+    config->edge_origin_directive_->name_ = "origin";
+    config->edge_origin_directive_->args_.push_back("192.168.1.10:8080");
+
+    MockEdgeHttpClient *mock_http_client = new MockEdgeHttpClient();
+    SrsUniquePtr<MockEdgeFlvAppFactory> mock_factory(new MockEdgeFlvAppFactory());
+    mock_factory->mock_http_client_ = mock_http_client;
+
+    SrsUniquePtr<SrsLbRoundRobin> lb(new SrsLbRoundRobin());
+    SrsUniquePtr<SrsEdgeFlvUpstream> upstream(new SrsEdgeFlvUpstream("http"));
+    upstream->config_ = config.get();
+    upstream->app_factory_ = mock_factory.get();
+
+    // The stream is not ready, origin responses 404 with body, which is drained.
+    MockEdgeHttpMessage *r0 = new MockEdgeHttpMessage();
+    r0->status_code_ = 404;
+    r0->keep_alive_ = true;
+    r0->content_length_ = 10;
+    mock_http_client->mock_response_ = r0;
+
+    HELPER_EXPECT_FAILED(upstream->connect(req.get(), lb.get()));
+    EXPECT_EQ(1, mock_factory->nn_http_clients_);
+    EXPECT_EQ(1, r0->nn_body_read_all_);
+    EXPECT_TRUE(upstream->keepalive_);
+
+    // Retry reuses the connection, the stream is ready.
+    SrsUniquePtr<MockEdgeHttpResponseReader> mock_body(new MockEdgeHttpResponseReader(std::string("FLV\x01\x05\x00\x00\x00\x09\x00\x00\x00\x00", 13)));
+    MockEdgeHttpMessage *r1 = new MockEdgeHttpMessage();
+    r1->body_reader_ = mock_body.get();
+    mock_http_client->mock_response_ = r1;
+    mock_http_client->initialize_called_ = false;
+
+    HELPER_EXPECT_SUCCESS(upstream->connect(req.get(), lb.get()));
+    EXPECT_EQ(1, mock_factory->nn_http_clients_);
+    EXPECT_FALSE(mock_http_client->initialize_called_);
+    EXPECT_FALSE(upstream->keepalive_);
+    EXPECT_TRUE(upstream->demuxer_ != NULL);
+
+    // The stream response is never drained, so the next retry uses a new connection.
+    MockEdgeHttpMessage *r2 = new MockEdgeHttpMessage();
+    r2->status_code_ = 404;
+    mock_http_client->mock_response_ = r2;
+
+    // Avoid the client to be freed when creating the new one, which is the same mock object.
+    upstream->sdk_ = NULL;
+    HELPER_EXPECT_FAILED(upstream->connect(req.get(), lb.get()));
+    EXPECT_EQ(2, mock_factory->nn_http_clients_);
+    EXPECT_TRUE(mock_http_client->initialize_called_);
+    EXPECT_FALSE(upstream->keepalive_);
+    EXPECT_EQ(0, r2->nn_body_read_all_);
 }
 
 // MockPlayEdge implementation
@@ -1532,6 +1525,16 @@ srs_error_t MockStatisticForRtspPlayStream::dumps_clients(SrsJsonArray *arr, int
     return srs_success;
 }
 
+srs_error_t MockStatisticForRtspPlayStream::dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
+srs_error_t MockStatisticForRtspPlayStream::dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
 srs_error_t MockStatisticForRtspPlayStream::dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs)
 {
     send_bytes = 0;
@@ -4428,3 +4431,848 @@ VOID TEST(DvrSegmentPlanTest, OnAudioTypicalScenario)
     plan->segment_ = NULL;
     plan->config_ = NULL;
 }
+
+MockEdgeTokenTraverseHandler::MockEdgeTokenTraverseHandler()
+{
+    nn_checks_ = 0;
+    origin_ = NULL;
+    deny_ = false;
+    unreachable_ = false;
+}
+
+MockEdgeTokenTraverseHandler::~MockEdgeTokenTraverseHandler()
+{
+}
+
+srs_error_t MockEdgeTokenTraverseHandler::check_edge_token_traverse_auth()
+{
+    nn_checks_++;
+
+    if (origin_) {
+        origin_->wait();
+    }
+
+    if (unreachable_) {
+        return srs_error_new(ERROR_EDGE_PORT_INVALID, "origin unreachable");
+    }
+    if (deny_) {
+        return srs_error_new(ERROR_EDGE_TOKEN_REJECTED, "token denied");
+    }
+    return srs_success;
+}
+
+MockAppConfigForTokenTraverse::MockAppConfigForTokenTraverse()
+{
+    ttl_ = 0;
+    deny_ttl_ = 0;
+}
+
+MockAppConfigForTokenTraverse::~MockAppConfigForTokenTraverse()
+{
+}
+
+srs_utime_t MockAppConfigForTokenTraverse::get_vhost_edge_token_traverse_ttl(std::string vhost)
+{
+    return ttl_;
+}
+
+srs_utime_t MockAppConfigForTokenTraverse::get_vhost_edge_token_traverse_deny_ttl(std::string vhost)
+{
+    return deny_ttl_;
+}
+
+VOID TEST(EdgeTokenTraverseTest, CoalesceInflightCheck)
+{
+    srs_error_t err;
+
+    MockAppConfigForTokenTraverse config;
+    SrsEdgeTokenTraverse traverse;
+    traverse.config_ = &config;
+
+    MockEdgeRequest req("test.vhost", "live", "stream1");
+    req.param_ = "?token=abc";
+
+    // The first connection checks the token by origin, until origin responds.
+    SrsCond origin;
+    MockEdgeTokenTraverseHandler leader;
+    leader.origin_ = &origin;
+
+    // The other connection with the same token waits for the verdict of leader.
+    MockEdgeTokenTraverseHandler follower;
+    int follower_done = 0;
+
+    SrsCoroutineChan ctx1;
+    ctx1.push(&traverse).push(&req).push(&leader);
+    SRS_COROUTINE_GO_CTX2(&ctx1, coroutine1, {
+        SrsEdgeTokenTraverse *traverse = (SrsEdgeTokenTraverse *)ctx.pop();
+        MockEdgeRequest *req = (MockEdgeRequest *)ctx.pop();
+        MockEdgeTokenTraverseHandler *leader = (MockEdgeTokenTraverseHandler *)ctx.pop();
+        srs_error_t err;
+        HELPER_EXPECT_SUCCESS(traverse->check(req, leader));
+    });
+
+    SrsCoroutineChan ctx2;
+    ctx2.push(&traverse).push(&req).push(&follower).push(&follower_done);
+    SRS_COROUTINE_GO_CTX2(&ctx2, coroutine2, {
+        SrsEdgeTokenTraverse *traverse = (SrsEdgeTokenTraverse *)ctx.pop();
+        MockEdgeRequest *req = (MockEdgeRequest *)ctx.pop();
+        MockEdgeTokenTraverseHandler *follower = (MockEdgeTokenTraverseHandler *)ctx.pop();
+        int *follower_done = (int *)ctx.pop();
+        srs_error_t err;
+        HELPER_EXPECT_SUCCESS(traverse->check(req, follower));
+        *follower_done = 1;
+    });
+
+    // Both connections are waiting for origin, only one check is in-flight.
+    srs_usleep(1 * SRS_UTIME_MILLISECONDS);
+    EXPECT_EQ(1, leader.nn_checks_);
+    EXPECT_EQ(0, follower.nn_checks_);
+    EXPECT_EQ(0, follower_done);
+    EXPECT_EQ(1, traverse.nn_misses_);
+    EXPECT_EQ(1, traverse.nn_coalesced_);
+    EXPECT_EQ(1, (int)traverse.verdicts_.size());
+
+    // The origin responds, both connections are allowed.
+    origin.signal();
+    srs_usleep(1 * SRS_UTIME_MILLISECONDS);
+    EXPECT_EQ(1, follower_done);
+    EXPECT_EQ(0, follower.nn_checks_);
+
+    // Without cache, the verdict is removed after the check.
+    EXPECT_TRUE(traverse.verdicts_.empty());
+    HELPER_EXPECT_SUCCESS(traverse.check(&req, &follower));
+    EXPECT_EQ(1, follower.nn_checks_);
+
+    traverse.config_ = NULL;
+}
+
+VOID TEST(EdgeTokenTraverseTest, CacheVerdicts)
+{
+    srs_error_t err;
+
+    MockAppConfigForTokenTraverse config;
+    config.ttl_ = 10 * SRS_UTIME_SECONDS;
+    SrsEdgeTokenTraverse traverse;
+    traverse.config_ = &config;
+
+    MockEdgeRequest req("test.vhost", "live", "stream1");
+    req.param_ = "?token=abc";
+
+    // The allowed token is cached, even for other streams.
+    MockEdgeTokenTraverseHandler handler;
+    HELPER_EXPECT_SUCCESS(traverse.check(&req, &handler));
+    req.stream_ = "stream2";
+    HELPER_EXPECT_SUCCESS(traverse.check(&req, &handler));
+    EXPECT_EQ(1, handler.nn_checks_);
+    EXPECT_EQ(1, traverse.nn_hits_);
+
+    // The denied token is not cached by default.
+    req.param_ = "?token=xyz";
+    handler.deny_ = true;
+    HELPER_EXPECT_FAILED(traverse.check(&req, &handler));
+    HELPER_EXPECT_FAILED(traverse.check(&req, &handler));
+    EXPECT_EQ(3, handler.nn_checks_);
+
+    // The denied token is cached by negative ttl.
+    config.deny_ttl_ = 5 * SRS_UTIME_SECONDS;
+    HELPER_EXPECT_FAILED(traverse.check(&req, &handler));
+    HELPER_EXPECT_FAILED(traverse.check(&req, &handler));
+    EXPECT_EQ(4, handler.nn_checks_);
+    EXPECT_EQ(2, traverse.nn_hits_);
+
+    // The failure such as origin unreachable is never cached, even with negative ttl.
+    req.param_ = "?token=unreachable";
+    handler.deny_ = false;
+    handler.unreachable_ = true;
+    HELPER_EXPECT_FAILED(traverse.check(&req, &handler));
+    HELPER_EXPECT_FAILED(traverse.check(&req, &handler));
+    EXPECT_EQ(6, handler.nn_checks_);
+    EXPECT_EQ(2, traverse.nn_hits_);
+    EXPECT_TRUE(traverse.verdicts_.find(traverse.token_key(&req)) == traverse.verdicts_.end());
+    handler.unreachable_ = false;
+
+    // The expired verdict is checked again.
+    req.param_ = "?token=abc";
+    traverse.verdicts_[traverse.token_key(&req)]->expire_ = srs_time_now_cached() - SRS_UTIME_SECONDS;
+    HELPER_EXPECT_SUCCESS(traverse.check(&req, &handler));
+    EXPECT_EQ(7, handler.nn_checks_);
+
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    traverse.dumps(obj.get());
+    EXPECT_EQ(2, obj->get_property("hits")->to_integer());
+    EXPECT_EQ(7, obj->get_property("misses")->to_integer());
+    EXPECT_EQ(0, obj->get_property("coalesced")->to_integer());
+    EXPECT_EQ(2, obj->get_property("tokens")->to_integer());
+
+    traverse.config_ = NULL;
+}
+
+VOID TEST(EdgeTokenTraverseTest, DifferentConnectArgs)
+{
+    srs_error_t err;
+
+    MockAppConfigForTokenTraverse config;
+    config.ttl_ = 10 * SRS_UTIME_SECONDS;
+    SrsEdgeTokenTraverse traverse;
+    traverse.config_ = &config;
+
+    // The clients with the same url, but different args of connect, which are sent to origin.
+    MockEdgeRequest allowed("test.vhost", "live", "stream1");
+    allowed.args_ = SrsAmf0Any::object();
+    allowed.args_->set("token", SrsAmf0Any::str("abc"));
+
+    MockEdgeRequest forged("test.vhost", "live", "stream1");
+    forged.args_ = SrsAmf0Any::object();
+    forged.args_->set("token", SrsAmf0Any::str("xyz"));
+    EXPECT_NE(traverse.token_key(&allowed), traverse.token_key(&forged));
+
+    // The allowed client checks by origin, until origin responds.
+    SrsCond origin;
+    MockEdgeTokenTraverseHandler leader;
+    leader.origin_ = &origin;
+
+    // The forged client must never wait for or reuse the verdict of allowed client.
+    MockEdgeTokenTraverseHandler follower;
+    follower.deny_ = true;
+    int follower_done = 0;
+
+    SrsCoroutineChan ctx1;
+    ctx1.push(&traverse).push(&allowed).push(&leader);
+    SRS_COROUTINE_GO_CTX2(&ctx1, coroutine1, {
+        SrsEdgeTokenTraverse *traverse = (SrsEdgeTokenTraverse *)ctx.pop();
+        MockEdgeRequest *req = (MockEdgeRequest *)ctx.pop();
+        MockEdgeTokenTraverseHandler *leader = (MockEdgeTokenTraverseHandler *)ctx.pop();
+        srs_error_t err;
+        HELPER_EXPECT_SUCCESS(traverse->check(req, leader));
+    });
+
+    SrsCoroutineChan ctx2;
+    ctx2.push(&traverse).push(&forged).push(&follower).push(&follower_done);
+    SRS_COROUTINE_GO_CTX2(&ctx2, coroutine2, {
+        SrsEdgeTokenTraverse *traverse = (SrsEdgeTokenTraverse *)ctx.pop();
+        MockEdgeRequest *req = (MockEdgeRequest *)ctx.pop();
+        MockEdgeTokenTraverseHandler *follower = (MockEdgeTokenTraverseHandler *)ctx.pop();
+        int *follower_done = (int *)ctx.pop();
+        srs_error_t err;
+        HELPER_EXPECT_FAILED(traverse->check(req, follower));
+        *follower_done = 1;
+    });
+
+    // The forged client is checked by origin and denied, not coalesced to the in-flight check.
+    srs_usleep(1 * SRS_UTIME_MILLISECONDS);
+    EXPECT_EQ(1, leader.nn_checks_);
+    EXPECT_EQ(1, follower.nn_checks_);
+    EXPECT_EQ(1, follower_done);
+    EXPECT_EQ(2, traverse.nn_misses_);
+    EXPECT_EQ(0, traverse.nn_coalesced_);
+
+    // The allowed client is cached, but the forged client is still checked by origin.
+    origin.signal();
+    srs_usleep(1 * SRS_UTIME_MILLISECONDS);
+    leader.origin_ = NULL;
+    HELPER_EXPECT_SUCCESS(traverse.check(&allowed, &leader));
+    HELPER_EXPECT_FAILED(traverse.check(&forged, &follower));
+    EXPECT_EQ(1, leader.nn_checks_);
+    EXPECT_EQ(2, follower.nn_checks_);
+    EXPECT_EQ(1, traverse.nn_hits_);
+
+    // The client with other pageUrl is not served by the cache either.
+    MockEdgeRequest other("test.vhost", "live", "stream1");
+    other.args_ = SrsAmf0Any::object();
+    other.args_->set("token", SrsAmf0Any::str("abc"));
+    other.pageUrl_ = "http://other.page";
+    HELPER_EXPECT_FAILED(traverse.check(&other, &follower));
+    EXPECT_EQ(3, follower.nn_checks_);
+
+    traverse.config_ = NULL;
+}
+
+MockEdgeUpstreamForHedge::MockEdgeUpstreamForHedge()
+{
+    connect_error_ = srs_success;
+    cond_ = new SrsCond();
+    closed_ = false;
+}
+
+MockEdgeUpstreamForHedge::~MockEdgeUpstreamForHedge()
+{
+    srs_freep(connect_error_);
+    for (int i = 0; i < (int)msgs_.size(); i++) {
+        srs_freep(msgs_[i]);
+    }
+    srs_freep(cond_);
+}
+
+srs_error_t MockEdgeUpstreamForHedge::connect(ISrsRequest *r, ISrsLbRoundRobin *lb)
+{
+    return srs_error_copy(connect_error_);
+}
+
+srs_error_t MockEdgeUpstreamForHedge::recv_message(SrsRtmpCommonMessage **pmsg)
+{
+    // Wait for messages, like a slow origin, until interrupted.
+    while (msgs_.empty()) {
+        if (cond_->wait() != 0) {
+            return srs_error_new(ERROR_SOCKET_READ, "mock interrupted");
+        }
+    }
+
+    *pmsg = msgs_.front();
+    msgs_.erase(msgs_.begin());
+    return srs_success;
+}
+
+srs_error_t MockEdgeUpstreamForHedge::decode_message(SrsRtmpCommonMessage *msg, SrsRtmpCommand **ppacket)
+{
+    return srs_success;
+}
+
+void MockEdgeUpstreamForHedge::close()
+{
+    closed_ = true;
+}
+
+void MockEdgeUpstreamForHedge::selected(std::string &server, int &port)
+{
+}
+
+void MockEdgeUpstreamForHedge::set_recv_timeout(srs_utime_t tm)
+{
+}
+
+void MockEdgeUpstreamForHedge::kbps_sample(const char *label, srs_utime_t age)
+{
+}
+
+MockAppConfigForWarmPull::MockAppConfigForWarmPull()
+{
+    warm_pull_ = 0;
+    warm_pull_plays_ = 2;
+}
+
+MockAppConfigForWarmPull::~MockAppConfigForWarmPull()
+{
+}
+
+srs_utime_t MockAppConfigForWarmPull::get_vhost_edge_warm_pull(std::string vhost)
+{
+    return warm_pull_;
+}
+
+int MockAppConfigForWarmPull::get_vhost_edge_warm_pull_plays(std::string vhost)
+{
+    return warm_pull_plays_;
+}
+
+// Create a RTMP message of audio or video, for the hedged connect.
+static SrsRtmpCommonMessage *mock_hedge_message(bool video, uint8_t b0, uint8_t b1)
+{
+    SrsRtmpCommonMessage *msg = new SrsRtmpCommonMessage();
+    if (video) {
+        msg->header_.initialize_video(4, 0, 1);
+    } else {
+        msg->header_.initialize_audio(4, 0, 1);
+    }
+    msg->create_payload(4);
+    msg->payload()[0] = (char)b0;
+    msg->payload()[1] = (char)b1;
+    msg->payload()[2] = msg->payload()[3] = 0;
+    return msg;
+}
+
+VOID TEST(EdgeHedgeTest, FirstFrame)
+{
+    // The video keyframe is the first frame.
+    if (true) {
+        bool has_video = false;
+        SrsUniquePtr<SrsRtmpCommonMessage> vsh(mock_hedge_message(true, 0x17, 0x00));
+        SrsUniquePtr<SrsRtmpCommonMessage> ash(mock_hedge_message(false, 0xaf, 0x00));
+        SrsUniquePtr<SrsRtmpCommonMessage> audio(mock_hedge_message(false, 0xaf, 0x01));
+        SrsUniquePtr<SrsRtmpCommonMessage> inter(mock_hedge_message(true, 0x27, 0x01));
+        SrsUniquePtr<SrsRtmpCommonMessage> key(mock_hedge_message(true, 0x17, 0x01));
+        EXPECT_FALSE(srs_edge_is_first_frame(vsh.get(), has_video));
+        EXPECT_TRUE(has_video);
+        EXPECT_FALSE(srs_edge_is_first_frame(ash.get(), has_video));
+        EXPECT_FALSE(srs_edge_is_first_frame(audio.get(), has_video));
+        EXPECT_FALSE(srs_edge_is_first_frame(inter.get(), has_video));
+        EXPECT_TRUE(srs_edge_is_first_frame(key.get(), has_video));
+    }
+
+    // The audio frame is the first frame, if no video.
+    if (true) {
+        bool has_video = false;
+        SrsUniquePtr<SrsRtmpCommonMessage> ash(mock_hedge_message(false, 0xaf, 0x00));
+        SrsUniquePtr<SrsRtmpCommonMessage> audio(mock_hedge_message(false, 0xaf, 0x01));
+        EXPECT_FALSE(srs_edge_is_first_frame(ash.get(), has_video));
+        EXPECT_TRUE(srs_edge_is_first_frame(audio.get(), has_video));
+    }
+}
+
+VOID TEST(EdgeHedgeTest, RacerReadyOnKeyframe)
+{
+    srs_error_t err;
+
+    MockEdgeRequest req("test.vhost", "live", "stream1");
+    SrsCond cond;
+
+    MockEdgeUpstreamForHedge *upstream = new MockEdgeUpstreamForHedge();
+    upstream->msgs_.push_back(mock_hedge_message(true, 0x17, 0x00));
+    upstream->msgs_.push_back(mock_hedge_message(false, 0xaf, 0x00));
+    upstream->msgs_.push_back(mock_hedge_message(true, 0x17, 0x01));
+    upstream->msgs_.push_back(mock_hedge_message(true, 0x27, 0x01));
+
+    SrsUniquePtr<SrsEdgeHedgeRacer> racer(new SrsEdgeHedgeRacer(upstream, &req, NULL, &cond));
+    EXPECT_FALSE(racer->started());
+    HELPER_EXPECT_SUCCESS(racer->start());
+    EXPECT_TRUE(racer->started());
+
+    // Wait for the racer to get the keyframe.
+    cond.timedwait(3 * SRS_UTIME_SECONDS);
+    EXPECT_TRUE(racer->ready());
+    EXPECT_FALSE(racer->failed());
+
+    // The messages after keyframe are left in upstream.
+    std::vector<SrsRtmpCommonMessage *> msgs;
+    EXPECT_TRUE(racer->take(msgs) == upstream);
+    EXPECT_EQ(3, (int)msgs.size());
+    EXPECT_EQ(1, (int)upstream->msgs_.size());
+    for (int i = 0; i < (int)msgs.size(); i++) {
+        srs_freep(msgs[i]);
+    }
+    srs_freep(upstream);
+}
+
+VOID TEST(EdgeHedgeTest, RacerFailedAndStopped)
+{
+    srs_error_t err;
+
+    MockEdgeRequest req("test.vhost", "live", "stream1");
+    SrsCond cond;
+
+    // The racer fails to connect origin.
+    if (true) {
+        MockEdgeUpstreamForHedge *upstream = new MockEdgeUpstreamForHedge();
+        upstream->connect_error_ = srs_error_new(ERROR_SOCKET_CONNECT, "mock refused");
+
+        SrsUniquePtr<SrsEdgeHedgeRacer> racer(new SrsEdgeHedgeRacer(upstream, &req, NULL, &cond));
+        HELPER_EXPECT_SUCCESS(racer->start());
+
+        cond.timedwait(3 * SRS_UTIME_SECONDS);
+        EXPECT_TRUE(racer->failed());
+        EXPECT_FALSE(racer->ready());
+        EXPECT_EQ(ERROR_SOCKET_CONNECT, srs_error_code(racer->error()));
+    }
+
+    // The slow racer is stopped and closed when freed.
+    if (true) {
+        MockEdgeUpstreamForHedge *upstream = new MockEdgeUpstreamForHedge();
+        upstream->msgs_.push_back(mock_hedge_message(true, 0x17, 0x00));
+
+        SrsEdgeHedgeRacer *racer = new SrsEdgeHedgeRacer(upstream, &req, NULL, &cond);
+        HELPER_EXPECT_SUCCESS(racer->start());
+        srs_usleep(1 * SRS_UTIME_MILLISECONDS);
+
+        EXPECT_FALSE(racer->ready());
+        srs_freep(racer);
+    }
+}
+
+VOID TEST(EdgeHedgeTest, PullStat)
+{
+    SrsEdgePullStat stat;
+    stat.on_pull();
+    stat.on_pull();
+    stat.on_hedged();
+    stat.on_hedge_won();
+    stat.on_warm_hit();
+    stat.on_ttff(50 * SRS_UTIME_MILLISECONDS);
+    stat.on_ttff(150 * SRS_UTIME_MILLISECONDS);
+    stat.on_ttff(5 * SRS_UTIME_SECONDS);
+
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    stat.dumps(obj.get());
+    EXPECT_EQ(2, obj->get_property("pulls")->to_integer());
+    EXPECT_EQ(1, obj->get_property("hedged")->to_integer());
+    EXPECT_EQ(1, obj->get_property("hedge_wins")->to_integer());
+    EXPECT_EQ(1, obj->get_property("warm_hits")->to_integer());
+
+    SrsJsonObject *ttff = obj->get_property("ttff")->to_object();
+    EXPECT_EQ(3, ttff->get_property("count")->to_integer());
+    EXPECT_EQ(1733, ttff->get_property("avg_ms")->to_integer());
+    EXPECT_EQ(5000, ttff->get_property("max_ms")->to_integer());
+    EXPECT_EQ(1, ttff->get_property("100ms")->to_integer());
+    EXPECT_EQ(1, ttff->get_property("500ms")->to_integer());
+    EXPECT_EQ(1, ttff->get_property("slow")->to_integer());
+}
+
+VOID TEST(EdgeHedgeTest, WarmPullPopularStream)
+{
+    srs_error_t err;
+
+    SrsSharedPtr<SrsLiveSource> source_ptr(new MockLiveSource());
+    MockEdgeRequest req("test.vhost", "live", "stream1");
+    MockAppConfigForWarmPull config;
+    config.warm_pull_ = 10 * SRS_UTIME_SECONDS;
+
+    SrsUniquePtr<SrsPlayEdge> play_edge(new SrsPlayEdge());
+    play_edge->config_ = &config;
+    MockEdgeIngester *mock_ingester = new MockEdgeIngester();
+    srs_freep(play_edge->ingester_);
+    play_edge->ingester_ = mock_ingester;
+    HELPER_EXPECT_SUCCESS(play_edge->initialize(source_ptr, &req));
+
+    // Not popular, stop pulling when the only player quit.
+    HELPER_EXPECT_SUCCESS(play_edge->on_client_play());
+    play_edge->on_all_client_stop();
+    EXPECT_TRUE(mock_ingester->stop_called_);
+    EXPECT_EQ(SrsEdgeStateInit, play_edge->state_);
+
+    // Popular, keep pulling when all players quit.
+    mock_ingester->stop_called_ = false;
+    HELPER_EXPECT_SUCCESS(play_edge->on_client_play());
+    play_edge->on_all_client_stop();
+    EXPECT_FALSE(mock_ingester->stop_called_);
+    EXPECT_EQ(SrsEdgeStatePlay, play_edge->state_);
+    EXPECT_TRUE(play_edge->warm_expire_ > 0);
+
+    // The player rejoins the warm stream.
+    HELPER_EXPECT_SUCCESS(play_edge->on_client_play());
+    EXPECT_EQ(0, play_edge->warm_expire_);
+    play_edge->cycle();
+    EXPECT_FALSE(mock_ingester->stop_called_);
+
+    // Stop pulling when warm pull expired.
+    play_edge->on_all_client_stop();
+    play_edge->cycle();
+    EXPECT_FALSE(mock_ingester->stop_called_);
+    play_edge->warm_expire_ = srs_time_now_cached() - SRS_UTIME_SECONDS;
+    play_edge->cycle();
+    EXPECT_TRUE(mock_ingester->stop_called_);
+    EXPECT_EQ(SrsEdgeStateInit, play_edge->state_);
+    EXPECT_EQ(0, play_edge->warm_expire_);
+
+    play_edge->config_ = NULL;
+}
+
+MockClusterHttpClient::MockClusterHttpClient()
+{
+    port_ = 0;
+    nn_posts_ = 0;
+    status_code_ = 200;
+    post_error_ = srs_success;
+}
+
+MockClusterHttpClient::~MockClusterHttpClient()
+{
+    srs_freep(post_error_);
+}
+
+srs_error_t MockClusterHttpClient::initialize(std::string schema, std::string h, int p, srs_utime_t tm)
+{
+    host_ = h;
+    port_ = p;
+    return srs_success;
+}
+
+srs_error_t MockClusterHttpClient::get(std::string path, std::string req, ISrsHttpMessage **ppmsg)
+{
+    return srs_success;
+}
+
+srs_error_t MockClusterHttpClient::post(std::string path, std::string req, ISrsHttpMessage **ppmsg)
+{
+    nn_posts_++;
+    path_ = path;
+    body_ = req;
+
+    if (post_error_ != srs_success) {
+        return srs_error_copy(post_error_);
+    }
+
+    MockEdgeHttpMessage *msg = new MockEdgeHttpMessage();
+    msg->status_code_ = status_code_;
+    *ppmsg = msg;
+    return srs_success;
+}
+
+void MockClusterHttpClient::set_recv_timeout(srs_utime_t tm)
+{
+}
+
+void MockClusterHttpClient::kbps_sample(const char *label, srs_utime_t age)
+{
+}
+
+MockClusterAppFactory::MockClusterAppFactory()
+{
+}
+
+MockClusterAppFactory::~MockClusterAppFactory()
+{
+    // The clients are owned by directory.
+}
+
+ISrsHttpClient *MockClusterAppFactory::create_http_client()
+{
+    MockClusterHttpClient *client = new MockClusterHttpClient();
+    clients_.push_back(client);
+    return client;
+}
+
+MockAppConfigForClusterDirectory::MockAppConfigForClusterDirectory()
+{
+    origin_directory_ = true;
+    listens_.push_back("19350");
+    http_api_listens_.push_back("9090");
+}
+
+MockAppConfigForClusterDirectory::~MockAppConfigForClusterDirectory()
+{
+}
+
+std::vector<std::string> MockAppConfigForClusterDirectory::get_vhost_coworkers(std::string vhost)
+{
+    return coworkers_;
+}
+
+bool MockAppConfigForClusterDirectory::get_vhost_origin_directory(std::string vhost)
+{
+    return origin_directory_;
+}
+
+std::string MockAppConfigForClusterDirectory::get_vhost_origin_directory_ip(std::string vhost)
+{
+    return origin_directory_ip_;
+}
+
+std::vector<std::string> MockAppConfigForClusterDirectory::get_listens()
+{
+    return listens_;
+}
+
+std::vector<std::string> MockAppConfigForClusterDirectory::get_http_api_listens()
+{
+    return http_api_listens_;
+}
+
+// Build the message pushed by coworker, see SrsClusterDirectory::on_message.
+static SrsJsonObject *mock_cluster_message(string action, string vhost, string api, string streams)
+{
+    string body = "{\"action\":\"" + action + "\",\"vhost\":\"" + vhost + "\",\"origin\":{\"ip\":\"10.0.0.1\",\"port\":19350,\"api\":\"" + api + "\"},\"streams\":[";
+    vector<string> names = srs_strings_split(streams, ",");
+    for (int i = 0; i < (int)names.size(); i++) {
+        if (names.at(i).empty()) {
+            continue;
+        }
+        body += string(i ? "," : "") + "{\"vhost\":\"" + vhost + "\",\"app\":\"live\",\"stream\":\"" + names.at(i) + "\"}";
+    }
+    body += "]}";
+
+    SrsJsonAny *json = SrsJsonAny::loads(body);
+    srs_assert(json && json->is_object());
+    return json->to_object();
+}
+
+VOID TEST(ClusterDirectoryTest, OnMessagePublishUnpublish)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<MockAppConfigForClusterDirectory> config(new MockAppConfigForClusterDirectory());
+    config->coworkers_.push_back("10.0.0.1:9090");
+    config->coworkers_.push_back("10.0.0.2:9090");
+    SrsUniquePtr<SrsClusterDirectory> directory(new SrsClusterDirectory());
+    directory->config_ = config.get();
+
+    // Not found before origin pushes it.
+    EXPECT_TRUE(directory->find("__defaultVhost__", "live", "livestream") == NULL);
+
+    // Reject the message which is not from coworkers.
+    SrsUniquePtr<SrsJsonObject> msg(mock_cluster_message("publish", "__defaultVhost__", "10.0.0.1:9090", "livestream"));
+    HELPER_EXPECT_FAILED(directory->on_message(msg.get(), "10.0.0.9"));
+    HELPER_EXPECT_FAILED(directory->on_message(msg.get(), ""));
+    EXPECT_TRUE(directory->origins_.empty());
+    EXPECT_EQ(0, (int)directory->nn_received_);
+
+    HELPER_EXPECT_SUCCESS(directory->on_message(msg.get(), "10.0.0.1"));
+
+    SrsClusterOrigin *origin = directory->find("__defaultVhost__", "live", "livestream");
+    ASSERT_TRUE(origin != NULL);
+    EXPECT_STREQ("10.0.0.1", origin->ip_.c_str());
+    EXPECT_EQ(19350, origin->port_);
+    EXPECT_STREQ("10.0.0.1:9090", origin->api_.c_str());
+    EXPECT_EQ(1, (int)directory->nn_received_);
+    EXPECT_EQ(1, (int)directory->nn_hits_);
+
+    // The unpublish of another origin should be ignored, the stream is republished.
+    SrsUniquePtr<SrsJsonObject> other(mock_cluster_message("unpublish", "__defaultVhost__", "10.0.0.2:9090", "livestream"));
+    HELPER_EXPECT_SUCCESS(directory->on_message(other.get(), "10.0.0.2"));
+    EXPECT_TRUE(directory->find("__defaultVhost__", "live", "livestream") != NULL);
+
+    SrsUniquePtr<SrsJsonObject> unpublish(mock_cluster_message("unpublish", "__defaultVhost__", "10.0.0.1:9090", "livestream"));
+    HELPER_EXPECT_SUCCESS(directory->on_message(unpublish.get(), "10.0.0.1"));
+    EXPECT_TRUE(directory->find("__defaultVhost__", "live", "livestream") == NULL);
+
+    // Ignore the message from this origin itself.
+    directory->apis_.insert("10.0.0.3:1985");
+    SrsUniquePtr<SrsJsonObject> self(mock_cluster_message("publish", "__defaultVhost__", "10.0.0.3:1985", "livestream"));
+    HELPER_EXPECT_SUCCESS(directory->on_message(self.get(), "10.0.0.3"));
+    EXPECT_TRUE(directory->find("__defaultVhost__", "live", "livestream") == NULL);
+
+    // Ignore the stream if directory of vhost is disabled.
+    config->origin_directory_ = false;
+    HELPER_EXPECT_SUCCESS(directory->on_message(msg.get(), "10.0.0.1"));
+    EXPECT_TRUE(directory->origins_.empty());
+
+    // Invalid message without origin.
+    SrsUniquePtr<SrsJsonAny> invalid(SrsJsonAny::loads("{\"action\":\"publish\",\"streams\":[]}"));
+    HELPER_EXPECT_FAILED(directory->on_message(invalid->to_object(), "10.0.0.1"));
+
+    directory->config_ = NULL;
+}
+
+VOID TEST(ClusterDirectoryTest, SyncAndExpire)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<MockAppConfigForClusterDirectory> config(new MockAppConfigForClusterDirectory());
+    config->coworkers_.push_back("10.0.0.1:9090");
+    config->coworkers_.push_back("10.0.0.2:9090");
+    SrsUniquePtr<SrsClusterDirectory> directory(new SrsClusterDirectory());
+    directory->config_ = config.get();
+
+    SrsUniquePtr<SrsJsonObject> publish(mock_cluster_message("publish", "__defaultVhost__", "10.0.0.1:9090", "s1,s2"));
+    HELPER_EXPECT_SUCCESS(directory->on_message(publish.get(), "10.0.0.1"));
+    SrsUniquePtr<SrsJsonObject> publish2(mock_cluster_message("publish", "__defaultVhost__", "10.0.0.2:9090", "s4"));
+    HELPER_EXPECT_SUCCESS(directory->on_message(publish2.get(), "10.0.0.2"));
+    SrsUniquePtr<SrsJsonObject> publish3(mock_cluster_message("publish", "test.vhost", "10.0.0.1:9090", "s5"));
+    HELPER_EXPECT_SUCCESS(directory->on_message(publish3.get(), "10.0.0.1"));
+    EXPECT_EQ(4, (int)directory->origins_.size());
+
+    // The sync carries all streams of origin in vhost, so s1 is removed and s3 is added, while s5 of
+    // other vhost is kept.
+    SrsUniquePtr<SrsJsonObject> sync(mock_cluster_message("sync", "__defaultVhost__", "10.0.0.1:9090", "s2,s3"));
+    HELPER_EXPECT_SUCCESS(directory->on_message(sync.get(), "10.0.0.1"));
+    EXPECT_TRUE(directory->find("__defaultVhost__", "live", "s1") == NULL);
+    EXPECT_TRUE(directory->find("__defaultVhost__", "live", "s2") != NULL);
+    EXPECT_TRUE(directory->find("__defaultVhost__", "live", "s3") != NULL);
+    EXPECT_TRUE(directory->find("__defaultVhost__", "live", "s4") != NULL);
+    EXPECT_TRUE(directory->origins_.find(srs_net_url_encode_sid("test.vhost", "live", "s5")) != directory->origins_.end());
+    EXPECT_EQ(4, (int)directory->origins_.size());
+
+    // The stream expires when not renewed by its origin.
+    SrsClusterOrigin *origin = directory->find("__defaultVhost__", "live", "s4");
+    ASSERT_TRUE(origin != NULL);
+    origin->expire_ = srs_time_now_cached() - 1;
+    directory->expire();
+    EXPECT_EQ(3, (int)directory->origins_.size());
+    EXPECT_TRUE(directory->find("__defaultVhost__", "live", "s4") == NULL);
+
+    // The dumps for API.
+    SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+    directory->dumps(obj.get());
+    EXPECT_EQ(3, (int)obj->get_property("streams")->to_integer());
+
+    directory->config_ = NULL;
+}
+
+VOID TEST(ClusterDirectoryTest, PushToCoworkers)
+{
+    srs_error_t err;
+
+    SrsUniquePtr<MockAppConfigForClusterDirectory> config(new MockAppConfigForClusterDirectory());
+    config->coworkers_.push_back("127.0.0.1:9091");
+    config->coworkers_.push_back("127.0.0.1:9092");
+    SrsUniquePtr<MockClusterAppFactory> factory(new MockClusterAppFactory());
+
+    SrsUniquePtr<SrsClusterDirectory> directory(new SrsClusterDirectory());
+    directory->config_ = config.get();
+    directory->app_factory_ = factory.get();
+    // Avoid starting the coroutine, we flush the changes manually.
+    directory->started_ = true;
+
+    SrsRequest req;
+    req.vhost_ = "__defaultVhost__";
+    req.app_ = "live";
+    req.stream_ = "livestream";
+    HELPER_EXPECT_SUCCESS(directory->on_publish(&req));
+    EXPECT_EQ(1, (int)directory->changes_.size());
+
+    directory->flush();
+    EXPECT_EQ(0, (int)directory->changes_.size());
+    ASSERT_EQ(2, (int)factory->clients_.size());
+    EXPECT_EQ(2, (int)directory->nn_pushed_);
+
+    MockClusterHttpClient *client = factory->clients_.at(0);
+    EXPECT_STREQ("127.0.0.1", client->host_.c_str());
+    EXPECT_EQ(9091, client->port_);
+    EXPECT_STREQ("/api/v1/clusters", client->path_.c_str());
+    EXPECT_TRUE(client->body_.find("\"publish\"") != string::npos);
+    EXPECT_TRUE(client->body_.find("\"livestream\"") != string::npos);
+
+    // The coworker applies the message pushed by this origin, which is exposed by the host of coworker,
+    // because it listens without ip.
+    SrsUniquePtr<MockAppConfigForClusterDirectory> config2(new MockAppConfigForClusterDirectory());
+    config2->coworkers_.push_back("127.0.0.1:9090");
+    SrsUniquePtr<SrsClusterDirectory> peer(new SrsClusterDirectory());
+    peer->config_ = config2.get();
+    SrsUniquePtr<SrsJsonAny> json(SrsJsonAny::loads(client->body_));
+    HELPER_EXPECT_SUCCESS(peer->on_message(json->to_object(), "127.0.0.1"));
+    SrsClusterOrigin *origin = peer->find("__defaultVhost__", "live", "livestream");
+    ASSERT_TRUE(origin != NULL);
+    EXPECT_STREQ("127.0.0.1", origin->ip_.c_str());
+    EXPECT_EQ(19350, origin->port_);
+    EXPECT_STREQ("127.0.0.1:9090", origin->api_.c_str());
+
+    // The message from this origin itself is ignored.
+    EXPECT_TRUE(directory->apis_.find("127.0.0.1:9090") != directory->apis_.end());
+
+    // The configured ip is exposed to coworker.
+    config->origin_directory_ip_ = "10.0.0.1";
+    SrsUniquePtr<SrsClusterChange> change(new SrsClusterChange());
+    change->vhost_ = "__defaultVhost__";
+    change->action_ = "publish";
+    change->streams_.push_back(req.copy());
+    SrsUniquePtr<SrsJsonAny> json2(SrsJsonAny::loads(directory->encode(change.get(), "127.0.0.1:9091")));
+    HELPER_EXPECT_SUCCESS(peer->on_message(json2->to_object(), "127.0.0.1"));
+    origin = peer->find("__defaultVhost__", "live", "livestream");
+    ASSERT_TRUE(origin != NULL);
+    EXPECT_STREQ("10.0.0.1", origin->ip_.c_str());
+    EXPECT_STREQ("10.0.0.1:9090", origin->api_.c_str());
+    config->origin_directory_ip_ = "";
+    peer->config_ = NULL;
+
+    // Reuse the persistent connections for the sync of all streams.
+    directory->sync();
+    directory->flush();
+    EXPECT_EQ(2, (int)factory->clients_.size());
+    EXPECT_EQ(2, client->nn_posts_);
+    EXPECT_TRUE(client->body_.find("\"sync\"") != string::npos);
+
+    // The failed connection is closed, and the coworker is backed off.
+    client->post_error_ = srs_error_new(ERROR_SOCKET_WRITE, "mock error");
+    directory->on_unpublish(&req);
+    directory->flush();
+    EXPECT_EQ(1, (int)directory->nn_push_errors_);
+    EXPECT_EQ(1, (int)directory->peers_.size());
+    EXPECT_EQ(0, (int)directory->locals_.size());
+    EXPECT_EQ(1, (int)directory->backoffs_.size());
+
+    // The changes to the failed coworker are skipped until the next sync, other coworkers are pushed.
+    MockClusterHttpClient *client2 = factory->clients_.at(1);
+    HELPER_EXPECT_SUCCESS(directory->on_publish(&req));
+    directory->flush();
+    EXPECT_EQ(2, (int)factory->clients_.size());
+    EXPECT_EQ(1, (int)directory->peers_.size());
+    EXPECT_EQ(4, client2->nn_posts_);
+    EXPECT_EQ(1, (int)directory->nn_push_errors_);
+
+    // The sync retries the failed coworker, which reconnects.
+    directory->sync();
+    directory->flush();
+    EXPECT_EQ(3, (int)factory->clients_.size());
+    EXPECT_EQ(2, (int)directory->peers_.size());
+    EXPECT_TRUE(directory->backoffs_.empty());
+
+    directory->config_ = NULL;
+    directory->app_factory_ = NULL;
+}
@@ -13,6 +13,7 @@
 #include <srs_utest.hpp>
 
 #include <srs_app_config.hpp>
+#include <srs_app_coworkers.hpp>
 #include <srs_app_dvr.hpp>
 #include <srs_app_edge.hpp>
 #include <srs_app_factory.hpp>
@@ -131,6 +132,9 @@ public:
     int status_code_;
     SrsHttpHeader *header_;
     ISrsHttpResponseReader *body_reader_;
+    bool keep_alive_;
+    int64_t content_length_;
+    int nn_body_read_all_;
 
 public:
     MockEdgeHttpMessage();
@@ -162,48 +166,23 @@ public:
     virtual std::string parse_rest_id(std::string pattern);
 };
 
-// Mock file reader for testing edge FLV upstream
-class MockEdgeFileReader : public ISrsFileReader
+// Mock HTTP body reader for testing edge FLV upstream, which returns at most max_read_
+// bytes for each read, to simulate the data arrives in multiple reads.
+class MockEdgeHttpResponseReader : public ISrsHttpResponseReader
 {
 public:
-    char *data_;
-    int size_;
+    std::string data_;
     int pos_;
+    int max_read_;
+    int nn_reads_;
 
 public:
-    MockEdgeFileReader(const char *data, int size);
-    virtual ~MockEdgeFileReader();
+    MockEdgeHttpResponseReader(std::string data);
+    virtual ~MockEdgeHttpResponseReader();
 
 public:
-    virtual srs_error_t open(std::string p);
-    virtual void close();
-    virtual bool is_open();
-    virtual int64_t tellg();
-    virtual void skip(int64_t size);
-    virtual int64_t seek2(int64_t offset);
-    virtual int64_t filesize();
-    virtual srs_error_t read(void *buf, size_t count, ssize_t *pnread);
-    virtual srs_error_t lseek(off_t offset, int whence, off_t *seeked);
-};
-
-// Mock FLV decoder for testing edge FLV upstream
-class MockEdgeFlvDecoder : public ISrsFlvDecoder
-{
-public:
-    bool initialize_called_;
-    bool read_header_called_;
-    bool read_previous_tag_size_called_;
-
-public:
-    MockEdgeFlvDecoder();
-    virtual ~MockEdgeFlvDecoder();
-
-public:
-    virtual srs_error_t initialize(ISrsReader *fr);
-    virtual srs_error_t read_header(char header[9]);
-    virtual srs_error_t read_tag_header(char *ptype, int32_t *pdata_size, uint32_t *ptime);
-    virtual srs_error_t read_tag_data(char *data, int32_t size);
-    virtual srs_error_t read_previous_tag_size(char previous_tag_size[4]);
+    virtual bool eof();
+    virtual srs_error_t read(void *buf, size_t size, ssize_t *nread);
 };
 
 // Mock app factory for testing edge FLV upstream
@@ -211,8 +190,7 @@ class MockEdgeFlvAppFactory : public SrsAppFactory
 {
 public:
     MockEdgeHttpClient *mock_http_client_;
-    MockEdgeFileReader *mock_file_reader_;
-    MockEdgeFlvDecoder *mock_flv_decoder_;
+    int nn_http_clients_;
 
 public:
     MockEdgeFlvAppFactory();
@@ -220,8 +198,6 @@ public:
 
 public:
     virtual ISrsHttpClient *create_http_client();
-    virtual ISrsFileReader *create_http_file_reader(ISrsHttpResponseReader *r);
-    virtual ISrsFlvDecoder *create_flv_decoder();
 };
 
 // Mock play edge for testing SrsEdgeIngester
@@ -350,6 +326,8 @@ public:
     virtual srs_error_t dumps_vhosts(SrsJsonArray *arr);
     virtual srs_error_t dumps_streams(SrsJsonArray *arr, int start, int count);
     virtual srs_error_t dumps_clients(SrsJsonArray *arr, int start, int count);
+    virtual srs_error_t dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page);
+    virtual srs_error_t dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page);
     virtual srs_error_t dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs);
     void reset();
 };
@@ -612,4 +590,138 @@ public:
     virtual srs_error_t close();
 };
 
+// Mock ISrsEdgeTokenTraverseHandler for testing SrsEdgeTokenTraverse
+class MockEdgeTokenTraverseHandler : public ISrsEdgeTokenTraverseHandler
+{
+public:
+    int nn_checks_;
+    // Wait for origin to respond, to simulate the in-flight check.
+    SrsCond *origin_;
+    bool deny_;
+    bool unreachable_;
+
+public:
+    MockEdgeTokenTraverseHandler();
+    virtual ~MockEdgeTokenTraverseHandler();
+
+public:
+    virtual srs_error_t check_edge_token_traverse_auth();
+};
+
+// Mock ISrsAppConfig for testing SrsEdgeTokenTraverse
+class MockAppConfigForTokenTraverse : public MockAppConfig
+{
+public:
+    srs_utime_t ttl_;
+    srs_utime_t deny_ttl_;
+
+public:
+    MockAppConfigForTokenTraverse();
+    virtual ~MockAppConfigForTokenTraverse();
+
+public:
+    virtual srs_utime_t get_vhost_edge_token_traverse_ttl(std::string vhost);
+    virtual srs_utime_t get_vhost_edge_token_traverse_deny_ttl(std::string vhost);
+};
+
+// Mock edge upstream for testing SrsEdgeHedgeRacer
+class MockEdgeUpstreamForHedge : public ISrsEdgeUpstream
+{
+public:
+    srs_error_t connect_error_;
+    // The messages to receive, wait on cond if empty.
+    std::vector<SrsRtmpCommonMessage *> msgs_;
+    SrsCond *cond_;
+    bool closed_;
+
+public:
+    MockEdgeUpstreamForHedge();
+    virtual ~MockEdgeUpstreamForHedge();
+
+public:
+    virtual srs_error_t connect(ISrsRequest *r, ISrsLbRoundRobin *lb);
+    virtual srs_error_t recv_message(SrsRtmpCommonMessage **pmsg);
+    virtual srs_error_t decode_message(SrsRtmpCommonMessage *msg, SrsRtmpCommand **ppacket);
+    virtual void close();
+    virtual void selected(std::string &server, int &port);
+    virtual void set_recv_timeout(srs_utime_t tm);
+    virtual void kbps_sample(const char *label, srs_utime_t age);
+};
+
+// Mock ISrsAppConfig for testing the warm pull of SrsPlayEdge
+class MockAppConfigForWarmPull : public MockAppConfig
+{
+public:
+    srs_utime_t warm_pull_;
+    int warm_pull_plays_;
+
+public:
+    MockAppConfigForWarmPull();
+    virtual ~MockAppConfigForWarmPull();
+
+public:
+    virtual srs_utime_t get_vhost_edge_warm_pull(std::string vhost);
+    virtual int get_vhost_edge_warm_pull_plays(std::string vhost);
+};
+
+// Mock HTTP client for testing SrsClusterDirectory, which is owned by directory.
+class MockClusterHttpClient : public ISrsHttpClient
+{
+public:
+    std::string host_;
+    int port_;
+    int nn_posts_;
+    std::string path_;
+    std::string body_;
+    int status_code_;
+    srs_error_t post_error_;
+
+public:
+    MockClusterHttpClient();
+    virtual ~MockClusterHttpClient();
+
+public:
+    virtual srs_error_t initialize(std::string schema, std::string h, int p, srs_utime_t tm);
+    virtual srs_error_t get(std::string path, std::string req, ISrsHttpMessage **ppmsg);
+    virtual srs_error_t post(std::string path, std::string req, ISrsHttpMessage **ppmsg);
+    virtual void set_recv_timeout(srs_utime_t tm);
+    virtual void kbps_sample(const char *label, srs_utime_t age);
+};
+
+// Mock app factory for testing SrsClusterDirectory, to create HTTP client to coworkers.
+class MockClusterAppFactory : public SrsAppFactory
+{
+public:
+    std::vector<MockClusterHttpClient *> clients_;
+
+public:
+    MockClusterAppFactory();
+    virtual ~MockClusterAppFactory();
+
+public:
+    virtual ISrsHttpClient *create_http_client();
+};
+
+// Mock ISrsAppConfig for testing SrsClusterDirectory
+class MockAppConfigForClusterDirectory : public MockAppConfig
+{
+public:
+    std::vector<std::string> coworkers_;
+    bool origin_directory_;
+    std::string origin_directory_ip_;
+    std::vector<std::string> listens_;
+    std::vector<std::string> http_api_listens_;
+
+public:
+    MockAppConfigForClusterDirectory();
+    virtual ~MockAppConfigForClusterDirectory();
+
+public:
+    virtual std::vector<std::string> get_vhost_coworkers(std::string vhost);
+    virtual bool get_vhost_origin_directory(std::string vhost);
+    virtual std::string get_vhost_origin_directory_ip(std::string vhost);
+    virtual std::vector<std::string> get_listens();
+    virtual std::vector<std::string> get_http_api_listens();
+};
+
 #endif
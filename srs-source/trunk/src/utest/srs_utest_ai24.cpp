@@ -478,6 +478,70 @@ VOID TEST(FFmpegLogHelperTest, LogCallback)
     // If we reach here without crashing, the test passes
     EXPECT_TRUE(true);
 }
+
+VOID TEST(AudioTranscoderPoolTest, CapConcurrentTranscoders)
+{
+    srs_error_t err;
+
+    MockAppConfig config;
+    config.rtc_server_audio_transcoders_ = 1;
+
+    SrsAudioTranscoderPool pool;
+    pool.config_ = &config;
+    EXPECT_STREQ("", pool.dumps().c_str());
+
+    // The first transcoder got the only slot.
+    SrsAudioTranscoder t0;
+    t0.pool_ = &pool;
+    t0.acquired_ = pool.acquire();
+    EXPECT_TRUE(t0.acquired_);
+    EXPECT_EQ(1, pool.nn_active());
+
+    // The second one has no slot, so it transcodes inline by default.
+    SrsAudioTranscoder t1;
+    t1.pool_ = &pool;
+    EXPECT_FALSE(pool.acquire());
+    HELPER_EXPECT_SUCCESS(t1.initialize(SrsAudioCodecIdAAC, SrsAudioCodecIdOpus, 2, 48000, 48000));
+    EXPECT_FALSE(t1.acquired_);
+
+    SrsParsedAudioPacket in;
+    std::vector<SrsParsedAudioPacket *> outs;
+    HELPER_EXPECT_SUCCESS(t1.transcode(&in, outs));
+    EXPECT_TRUE(outs.empty());
+    EXPECT_EQ(0, t1.nn_dropped_);
+    EXPECT_EQ(0, (int)pool.dumps().find(", trans=(n:1,j:1,o:1,d:0,"));
+
+    // Drop the audio without error, if configured.
+    config.rtc_server_audio_transcoders_drop_ = true;
+    HELPER_EXPECT_SUCCESS(t1.transcode(&in, outs));
+    EXPECT_TRUE(outs.empty());
+
+    pool.on_transcoded(100);
+    pool.on_transcoded(300);
+    EXPECT_STREQ(", trans=(n:1,j:2,o:0,d:1,a:200us,m:300us)", pool.dumps().c_str());
+    EXPECT_STREQ(", trans=(n:1,j:0,o:0,d:0,a:0us,m:0us)", pool.dumps().c_str());
+
+    // Retry to acquire the slot at most once per interval.
+    t1.last_acquire_ = srs_time_now_cached();
+    EXPECT_FALSE(t1.try_acquire());
+    EXPECT_EQ(1, t1.nn_dropped_);
+
+    // The slot released by the first transcoder, is taken by the retry.
+    t0.acquired_ = false;
+    pool.release();
+    EXPECT_FALSE(t1.try_acquire());
+    t1.last_acquire_ -= 2 * SRS_UTIME_SECONDS;
+    EXPECT_TRUE(t1.try_acquire());
+    EXPECT_TRUE(t1.acquired_);
+    EXPECT_EQ(0, t1.nn_dropped_);
+    EXPECT_EQ(1, pool.nn_active());
+
+    // Zero for no limit.
+    config.rtc_server_audio_transcoders_ = 0;
+    EXPECT_TRUE(pool.acquire());
+    pool.release();
+    EXPECT_EQ(1, pool.nn_active());
+}
 #endif
 
 // Test SrsDvrAsyncCallOnHls::call() method
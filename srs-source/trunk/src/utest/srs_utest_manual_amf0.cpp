@@ -2487,6 +2487,59 @@ VOID TEST(ProtocolAMF0Test, Amf0Object2)
     }
 }
 
+VOID TEST(ProtocolAMF0Test, NodePoolReuse)
+{
+    srs_error_t err;
+
+    // Encode a connect command object, like the RTMP clients.
+    char buf[512];
+    int size = 0;
+    if (true) {
+        SrsUniquePtr<SrsAmf0Object> o(SrsAmf0Any::object());
+        o->set("app", SrsAmf0Any::str("live"));
+        o->set("flashVer", SrsAmf0Any::str("FMLE/3.0 (compatible; FMSc/1.0)"));
+        o->set("tcUrl", SrsAmf0Any::str("rtmp://127.0.0.1:1935/live"));
+        o->set("fpad", SrsAmf0Any::boolean(false));
+        o->set("audioCodecs", SrsAmf0Any::number(3575));
+        o->set("objectEncoding", SrsAmf0Any::number(0));
+
+        size = o->total_size();
+        SrsBuffer b(buf, sizeof(buf));
+        HELPER_EXPECT_SUCCESS(o->write(&b));
+    }
+
+    // Warm up the pool, then decoding the same command never allocates nodes.
+    SrsAmf0NodePool::shrink();
+    for (int i = 0; i < 2; i++) {
+        SrsBuffer b(buf, size);
+        SrsAmf0Any *any = NULL;
+        HELPER_EXPECT_SUCCESS(srs_amf0_read_any(&b, &any));
+        srs_freep(any);
+    }
+    EXPECT_LT(0, SrsAmf0NodePool::nn_free());
+
+    int64_t allocated = SrsAmf0NodePool::nn_allocated();
+    int64_t reused = SrsAmf0NodePool::nn_reused();
+    for (int i = 0; i < 10; i++) {
+        SrsBuffer b(buf, size);
+        SrsAmf0Any *any = NULL;
+        HELPER_EXPECT_SUCCESS(srs_amf0_read_any(&b, &any));
+        SrsUniquePtr<SrsAmf0Any> any_uptr(any);
+
+        SrsAmf0Object *o = any->to_object();
+        EXPECT_EQ(6, o->count());
+        EXPECT_STREQ("live", o->get_property("app")->to_str().c_str());
+        EXPECT_STREQ("rtmp://127.0.0.1:1935/live", o->ensure_property_string("tcUrl")->to_str().c_str());
+        EXPECT_EQ(3575, o->ensure_property_number("audioCodecs")->to_number());
+    }
+    EXPECT_EQ(allocated, SrsAmf0NodePool::nn_allocated());
+    EXPECT_LT(reused, SrsAmf0NodePool::nn_reused());
+
+    // Release the cached nodes.
+    SrsAmf0NodePool::shrink();
+    EXPECT_EQ(0, SrsAmf0NodePool::nn_free());
+}
+
 VOID TEST(ProtocolJSONTest, Interfaces)
 {
     if (true) {
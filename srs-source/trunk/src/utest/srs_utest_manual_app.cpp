@@ -16,6 +16,7 @@ using namespace std;
 #include <srs_app_st.hpp>
 #include <srs_kernel_buffer.hpp>
 #include <srs_protocol_conn.hpp>
+#include <srs_protocol_json.hpp>
 #include <srs_protocol_rtmp_stack.hpp>
 
 class MockIDResource : public ISrsResource
@@ -533,47 +534,43 @@ VOID TEST(AppSecurity, CheckSecurity)
 {
     srs_error_t err;
 
-    // Deny if no rules.
-    if (true) {
-        SrsSecurity sec;
-        SrsRequest rr;
-        HELPER_EXPECT_FAILED(sec.do_check(NULL, SrsRtmpConnUnknown, "", &rr));
-    }
-
     // Deny if not allowed.
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnUnknown, "", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnUnknown, ""));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("others");
         rules.get_or_create("any");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnUnknown, "", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnUnknown, ""));
     }
 
     // Deny by rule.
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "all");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnPlay, "", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnPlay, ""));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "12.13.14.15");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "11.12.13.14");
         if (true) {
@@ -583,25 +580,34 @@ VOID TEST(AppSecurity, CheckSecurity)
             d->args_.push_back("12.13.14.15");
             rules.directives_.push_back(d);
         }
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnPlay, "12.13.14.15", &rr));
+
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+
+        // The error has the matched rule.
+        err = sec.do_check(&compiled, SrsRtmpConnPlay, "12.13.14.15");
+        EXPECT_EQ(ERROR_SYSTEM_SECURITY_DENY, srs_error_code(err));
+        EXPECT_TRUE(srs_error_desc(err).find("deny by rule<12.13.14.15>") != std::string::npos);
+        srs_freep(err);
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "all");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtcConnPlay, "", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtcConnPlay, ""));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "12.13.14.15");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtcConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtcConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "11.12.13.14");
         if (true) {
@@ -611,278 +617,317 @@ VOID TEST(AppSecurity, CheckSecurity)
             d->args_.push_back("12.13.14.15");
             rules.directives_.push_back(d);
         }
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtcConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtcConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "publish", "12.13.14.15");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnFMLEPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnFMLEPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "publish", "12.13.14.15");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnFlashPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnFlashPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "publish", "all");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnFlashPublish, "11.12.13.14", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnFlashPublish, "11.12.13.14"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "publish", "12.13.14.15");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnHaivisionPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnHaivisionPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "publish", "12.13.14.15");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtcConnPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtcConnPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "publish", "all");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtcConnPublish, "11.12.13.14", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtcConnPublish, "11.12.13.14"));
     }
 
     // Allowed if not denied.
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "all");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnFMLEPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnFMLEPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnFMLEPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnFMLEPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnPlay, "11.12.13.14", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnPlay, "11.12.13.14"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "publish", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "publish", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnUnknown, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnUnknown, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "publish", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnFlashPublish, "11.12.13.14", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnFlashPublish, "11.12.13.14"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtcConnPlay, "11.12.13.14", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtcConnPlay, "11.12.13.14"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "publish", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtcConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtcConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "all");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtcConnPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtcConnPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtcConnPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtcConnPublish, "12.13.14.15"));
     }
 
     // Allowed by rule.
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "play", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "play", "all");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "play", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtcConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtcConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "play", "all");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtcConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtcConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "publish", "all");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtcConnPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtcConnPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "publish", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtcConnPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtcConnPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "publish", "all");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnFMLEPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnFMLEPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "publish", "all");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnFlashPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnFlashPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "publish", "all");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnHaivisionPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnHaivisionPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "publish", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnHaivisionPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnHaivisionPublish, "12.13.14.15"));
     }
 
     // Allowed if not denied.
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "12.13.14.15");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnFMLEPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnFMLEPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("deny", "play", "all");
-        HELPER_EXPECT_SUCCESS(sec.do_check(&rules, SrsRtmpConnFMLEPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnFMLEPublish, "12.13.14.15"));
     }
 
     // Denied if not allowd.
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "play", "11.12.13.14");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnFMLEPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnFMLEPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "play", "11.12.13.14");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "publish", "12.13.14.15");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "play", "11.12.13.14");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtcConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtcConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "publish", "12.13.14.15");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtcConnPlay, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtcConnPlay, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "publish", "11.12.13.14");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnHaivisionPublish, "12.13.14.15", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnHaivisionPublish, "12.13.14.15"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "publish", "11.12.13.14");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnUnknown, "11.12.13.14", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnUnknown, "11.12.13.14"));
     }
 
     // Denied if dup.
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "play", "11.12.13.14");
         rules.get_or_create("deny", "play", "11.12.13.14");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtmpConnPlay, "11.12.13.14", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnPlay, "11.12.13.14"));
     }
     if (true) {
         SrsSecurity sec;
-        SrsRequest rr;
         SrsConfDirective rules;
         rules.get_or_create("allow", "play", "11.12.13.14");
         rules.get_or_create("deny", "play", "11.12.13.14");
-        HELPER_EXPECT_FAILED(sec.do_check(&rules, SrsRtcConnPlay, "11.12.13.14", &rr));
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtcConnPlay, "11.12.13.14"));
     }
 
     // SRS apply the following simple strategies one by one:
@@ -891,3 +936,149 @@ VOID TEST(AppSecurity, CheckSecurity)
     //       3. allow if matches allow strategy.
     //       4. deny if matches deny strategy.
 }
+
+VOID TEST(AppSecurity, IpTrieMatchCidr)
+{
+    srs_error_t err;
+
+    if (true) {
+        SrsIpTrie trie;
+        HELPER_EXPECT_SUCCESS(trie.add("10.0.0.0/8"));
+        HELPER_EXPECT_SUCCESS(trie.add("192.168.1.5"));
+        HELPER_EXPECT_SUCCESS(trie.add("172.16.1.1/16"));
+        EXPECT_EQ(3, trie.size());
+
+        EXPECT_TRUE(trie.match("10.0.0.1"));
+        EXPECT_TRUE(trie.match("10.255.255.255"));
+        EXPECT_FALSE(trie.match("11.0.0.1"));
+        EXPECT_TRUE(trie.match("192.168.1.5"));
+        EXPECT_FALSE(trie.match("192.168.1.6"));
+        EXPECT_TRUE(trie.match("172.16.200.3"));
+        EXPECT_FALSE(trie.match("172.17.0.1"));
+
+        // The IPv4-mapped IPv6 address matches the IPv4 rules.
+        EXPECT_TRUE(trie.match("::ffff:10.1.2.3"));
+        EXPECT_FALSE(trie.match("::ffff:11.1.2.3"));
+
+        // Get the matched rule.
+        std::string rule;
+        EXPECT_TRUE(trie.match("10.1.2.3", rule));
+        EXPECT_STREQ("10.0.0.0/8", rule.c_str());
+        EXPECT_TRUE(trie.match("172.16.200.3", rule));
+        EXPECT_STREQ("172.16.1.1/16", rule.c_str());
+        EXPECT_TRUE(trie.match("::ffff:192.168.1.5", rule));
+        EXPECT_STREQ("192.168.1.5", rule.c_str());
+
+        // Not an IP.
+        EXPECT_FALSE(trie.match(""));
+        EXPECT_FALSE(trie.match("localhost"));
+    }
+
+    if (true) {
+        SrsIpTrie trie;
+        HELPER_EXPECT_SUCCESS(trie.add("2001:db8::/32"));
+        HELPER_EXPECT_SUCCESS(trie.add("::1"));
+        EXPECT_TRUE(trie.match("2001:db8::1"));
+        EXPECT_TRUE(trie.match("2001:db8:ffff::1"));
+        EXPECT_FALSE(trie.match("2001:db9::1"));
+        EXPECT_TRUE(trie.match("::1"));
+        EXPECT_FALSE(trie.match("::2"));
+        EXPECT_FALSE(trie.match("10.0.0.1"));
+    }
+
+    if (true) {
+        SrsIpTrie trie;
+        HELPER_EXPECT_SUCCESS(trie.add("all"));
+        std::string rule;
+        EXPECT_TRUE(trie.match("1.2.3.4", rule));
+        EXPECT_STREQ("all", rule.c_str());
+        EXPECT_TRUE(trie.match("2001:db8::1"));
+    }
+
+    if (true) {
+        SrsIpTrie trie;
+        HELPER_EXPECT_FAILED(trie.add("localhost"));
+        HELPER_EXPECT_FAILED(trie.add("10.0.0.0/33"));
+        HELPER_EXPECT_FAILED(trie.add("10.0.0.0/"));
+        HELPER_EXPECT_FAILED(trie.add("10.0.0.0/a"));
+        HELPER_EXPECT_FAILED(trie.add("2001:db8::/129"));
+        EXPECT_EQ(0, trie.size());
+        EXPECT_FALSE(trie.match("10.0.0.1"));
+    }
+}
+
+VOID TEST(AppSecurity, CompiledRulesAndBlocklist)
+{
+    srs_error_t err;
+
+    // The CIDR of IPv6 in config.
+    if (true) {
+        SrsSecurity sec;
+        SrsConfDirective rules;
+        rules.get_or_create("allow", "play", "2001:db8::/32");
+        SrsSecurityRules compiled;
+        compiled.initialize(&rules);
+        HELPER_EXPECT_SUCCESS(sec.do_check(&compiled, SrsRtmpConnPlay, "2001:db8::100"));
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnPlay, "2001:db9::100"));
+        HELPER_EXPECT_FAILED(sec.do_check(&compiled, SrsRtmpConnFMLEPublish, "2001:db8::100"));
+    }
+
+    // The rules are compiled once for each generation of config.
+    if (true) {
+        SrsSecurityRuleManager manager;
+        SrsConfDirective rules;
+        rules.get_or_create("deny", "publish", "10.0.0.0/8");
+        rules.get_or_create("allow", "play", "all");
+
+        SrsSecurityRules *compiled = manager.fetch(1, &rules);
+        EXPECT_TRUE(compiled == manager.fetch(1, &rules));
+        EXPECT_EQ(1, compiled->nn_allow_);
+        EXPECT_EQ(1, compiled->nn_deny_);
+        EXPECT_TRUE(compiled->deny(SrsRtcConnPublish)->match("10.2.3.4"));
+        EXPECT_TRUE(compiled->deny(SrsRtmpConnUnknown) == NULL);
+
+        manager.fetch(2, &rules);
+        EXPECT_EQ(1, (int)manager.rules_.size());
+        EXPECT_EQ(2, manager.generation_);
+    }
+
+    // The blocklist updated by API, applied even security disabled.
+    if (true) {
+        SrsSecurityRuleManager manager;
+        SrsSecurity sec;
+        sec.manager_ = &manager;
+
+        SrsRequest rr;
+        rr.vhost_ = "v";
+        HELPER_EXPECT_SUCCESS(sec.check(SrsRtmpConnPlay, "10.1.2.3", &rr));
+
+        vector<string> ips;
+        ips.push_back("10.0.0.0/8");
+        ips.push_back("2001:db8::/32");
+        HELPER_EXPECT_SUCCESS(manager.update_blocklist("v", "play", ips));
+        HELPER_EXPECT_FAILED(sec.check(SrsRtmpConnPlay, "10.1.2.3", &rr));
+        HELPER_EXPECT_FAILED(sec.check(SrsFlvPlay, "2001:db8::1", &rr));
+        HELPER_EXPECT_SUCCESS(sec.check(SrsRtmpConnPlay, "11.1.2.3", &rr));
+        HELPER_EXPECT_SUCCESS(sec.check(SrsRtmpConnFMLEPublish, "10.1.2.3", &rr));
+
+        // Other vhost is not affected.
+        rr.vhost_ = "other";
+        HELPER_EXPECT_SUCCESS(sec.check(SrsRtmpConnPlay, "10.1.2.3", &rr));
+        rr.vhost_ = "v";
+
+        SrsUniquePtr<SrsJsonObject> obj(SrsJsonAny::object());
+        manager.dumps(obj.get());
+        EXPECT_STREQ("{\"v\":{\"play\":[\"10.0.0.0/8\",\"2001:db8::/32\"],\"publish\":[]}}", obj->dumps().c_str());
+
+        // Never change the blocklist if invalid.
+        ips.push_back("invalid");
+        HELPER_EXPECT_FAILED(manager.update_blocklist("v", "play", ips));
+        HELPER_EXPECT_FAILED(manager.update_blocklist("v", "others", vector<string>()));
+        HELPER_EXPECT_FAILED(sec.check(SrsRtmpConnPlay, "10.1.2.3", &rr));
+
+        // Clear the blocklist.
+        HELPER_EXPECT_SUCCESS(manager.update_blocklist("v", "play", vector<string>()));
+        EXPECT_TRUE(manager.blocklist("v") == NULL);
+        HELPER_EXPECT_SUCCESS(sec.check(SrsRtmpConnPlay, "10.1.2.3", &rr));
+    }
+}
@@ -4192,6 +4192,68 @@ VOID TEST(ConfigMainTest, SrtServerTlpktDrop)
     }
 }
 
+VOID TEST(ConfigMainTest, VhostSnapshot)
+{
+    srs_error_t err;
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.mock_parse(_MIN_OK_CONF "vhost v{play{atc on;queue_length 5;reduce_sequence_header on;}}"));
+        EXPECT_TRUE(conf.get_atc("v"));
+        EXPECT_EQ(5 * SRS_UTIME_SECONDS, conf.get_queue_length("v"));
+        EXPECT_TRUE(conf.get_reduce_sequence_header("v"));
+        EXPECT_TRUE(conf.get_parse_sps("v"));
+        EXPECT_FALSE(conf.get_vhost_is_edge("v"));
+
+        // The snapshot is compiled once and reused.
+        SrsConfVhostSnapshot *snapshot = conf.get_vhost_snapshot("v");
+        EXPECT_TRUE(snapshot == conf.get_vhost_snapshot("v"));
+        EXPECT_EQ(1, (int)conf.vhost_snapshots_.size());
+
+        // The unknown vhost, without default vhost, shares the empty snapshot.
+        EXPECT_FALSE(conf.get_atc("unknown"));
+        EXPECT_FALSE(conf.get_atc("other"));
+        EXPECT_EQ(2, (int)conf.vhost_snapshots_.size());
+
+        // Parse new config, the snapshots are rebuilt, and the generation is increased.
+        int generation = conf.get_generation();
+        HELPER_ASSERT_SUCCESS(conf.mock_parse(_MIN_OK_CONF "vhost v{cluster{mode remote;} publish{parse_sps off;}}"));
+        EXPECT_EQ(0, (int)conf.vhost_snapshots_.size());
+        EXPECT_LT(generation, conf.get_generation());
+
+        // Only a config change increases the generation, not freeing the snapshots.
+        generation = conf.get_generation();
+        conf.clear_vhost_snapshots();
+        EXPECT_EQ(generation, conf.get_generation());
+        EXPECT_FALSE(conf.get_atc("v"));
+        EXPECT_FALSE(conf.get_parse_sps("v"));
+        EXPECT_TRUE(conf.get_vhost_is_edge("v"));
+    }
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.mock_parse(_MIN_OK_CONF "vhost __defaultVhost__{play{mix_correct on;}}"));
+
+        // The unknown vhost falls back to the default vhost, and never grows the snapshots.
+        EXPECT_TRUE(conf.get_mix_correct("__defaultVhost__"));
+        EXPECT_TRUE(conf.get_mix_correct("192.168.1.10"));
+        EXPECT_TRUE(conf.get_mix_correct("192.168.1.11"));
+        EXPECT_EQ(1, (int)conf.vhost_snapshots_.size());
+    }
+
+    if (true) {
+        MockSrsConfig conf;
+        HELPER_ASSERT_SUCCESS(conf.mock_parse(_MIN_OK_CONF "vhost v{play{time_jitter zero;}}"));
+        EXPECT_EQ(SrsRtmpJitterAlgorithmZERO, conf.get_time_jitter("v"));
+
+        // Reload the config, the snapshots of old root are dropped.
+        MockSrsConfig reloaded;
+        HELPER_ASSERT_SUCCESS(reloaded.mock_parse(_MIN_OK_CONF "vhost v{play{time_jitter off;}}"));
+        HELPER_ASSERT_SUCCESS(conf.reload_conf(&reloaded));
+        EXPECT_EQ(SrsRtmpJitterAlgorithmOFF, conf.get_time_jitter("v"));
+    }
+}
+
 VOID TEST(ConfigEnvTest, CheckEnvValuesGlobal)
 {
     if (true) {
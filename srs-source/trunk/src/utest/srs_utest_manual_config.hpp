@@ -60,12 +60,15 @@ public:
         conf = c;
         key = k;
         srs_setenv(k, v, overwrite);
+        // The env is applied when building the snapshots, so rebuild them like reload.
+        conf->clear_vhost_snapshots();
     }
     virtual ~ISrsSetEnvConfig()
     {
         srs_unsetenv(key);
         srs_freep(conf->env_cache_);
         conf->env_cache_ = new SrsConfDirective();
+        conf->clear_vhost_snapshots();
     }
 
 // clang-format off
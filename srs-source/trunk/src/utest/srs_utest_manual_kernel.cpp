@@ -5825,6 +5825,78 @@ VOID TEST(KernelFLVTest, CoverAll)
 
         EXPECT_EQ(16, f.tellg());
     }
+
+    // Ignore the message without payload.
+    if (true) {
+        MockSrsFileWriter f;
+        SrsFlvTransmuxer mux;
+        HELPER_EXPECT_SUCCESS(mux.initialize(&f));
+
+        SrsMediaPacket m;
+        m.message_type_ = SrsFrameTypeVideo;
+
+        SrsMediaPacket *msgs = &m;
+        HELPER_EXPECT_SUCCESS(mux.write_tags(&msgs, 1));
+        EXPECT_EQ(0, f.tellg());
+        EXPECT_EQ(1, mux.nn_empty_msgs());
+    }
+}
+
+VOID TEST(KernelFLVTest, SharedTagHeaderCache)
+{
+    srs_error_t err;
+
+    SrsMessageHeader h;
+    h.initialize_video(3, 0x010203, 1);
+
+    SrsMediaPacket m;
+    SrsRtmpCommonMessage common_msg;
+    HELPER_EXPECT_SUCCESS(common_msg.create(&h, new char[3], 3));
+    common_msg.to_msg(&m);
+
+    // The first muxer serializes the tag header in the shared payload.
+    if (true) {
+        MockSrsFileWriter f;
+        SrsFlvTransmuxer mux;
+        HELPER_EXPECT_SUCCESS(mux.initialize(&f));
+
+        SrsMediaPacket *msgs = &m;
+        HELPER_EXPECT_SUCCESS(mux.write_tags(&msgs, 1));
+        EXPECT_EQ(18, f.tellg());
+
+        char *tag = m.payload_->flv_tag();
+        ASSERT_TRUE(tag != NULL);
+        EXPECT_EQ(0x010203, m.payload_->flv_tag_timestamp());
+        EXPECT_EQ(0, memcmp(f.data(), tag, 11));
+        EXPECT_EQ(0, memcmp(f.data() + 14, tag + 11, 4));
+    }
+
+    // The second muxer with a rebased timestamp patches its own header.
+    if (true) {
+        SrsUniquePtr<SrsMediaPacket> copy(m.copy());
+        copy->timestamp_ = 0x7f040506;
+
+        MockSrsFileWriter f;
+        SrsFlvTransmuxer mux;
+        HELPER_EXPECT_SUCCESS(mux.initialize(&f));
+
+        SrsMediaPacket *msgs = copy.get();
+        HELPER_EXPECT_SUCCESS(mux.write_tags(&msgs, 1));
+        EXPECT_EQ(18, f.tellg());
+
+        uint8_t *p = (uint8_t *)f.data();
+        EXPECT_EQ(9, p[0]);
+        EXPECT_EQ(3, p[3]);
+        EXPECT_EQ(0x04, p[4]);
+        EXPECT_EQ(0x05, p[5]);
+        EXPECT_EQ(0x06, p[6]);
+        EXPECT_EQ(0x7f, p[7]);
+        EXPECT_EQ(14, p[17]);
+
+        // The shared header is not changed.
+        EXPECT_EQ(0x010203, copy->payload_->flv_tag_timestamp());
+        EXPECT_EQ(0x03, (uint8_t)copy->payload_->flv_tag()[6]);
+    }
 }
 
 VOID TEST(KernelFLVTest, CoverSharedPtrMessage)
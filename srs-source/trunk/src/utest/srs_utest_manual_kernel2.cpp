@@ -10,6 +10,7 @@
 #include <srs_kernel_error.hpp>
 #include <srs_kernel_ps.hpp>
 #include <srs_kernel_rtc_rtcp.hpp>
+#include <srs_kernel_rtc_rtp.hpp>
 
 VOID TEST(KernelPSTest, PsPacketDecodeNormal)
 {
@@ -838,6 +839,82 @@ VOID TEST(KernelMemoryBlockTest, SharedMemoryBlock)
     }
 }
 
+VOID TEST(KernelMemoryBlockTest, FreeListPool)
+{
+    SrsFreeListPool pool(64, 2);
+
+    // Objects of the same size class are reused.
+    void *p0 = pool.alloc(20);
+    void *p1 = pool.alloc(32);
+    EXPECT_EQ(2, pool.nn_allocated());
+    pool.free(p0, 20);
+    pool.free(p1, 32);
+    EXPECT_EQ(2, pool.nn_free());
+
+    void *p2 = pool.alloc(24);
+    EXPECT_TRUE(p2 == p0 || p2 == p1);
+    EXPECT_EQ(1, pool.nn_reused());
+    EXPECT_EQ(2, pool.nn_allocated());
+
+    // Objects of other size class are not reused.
+    void *p3 = pool.alloc(48);
+    EXPECT_EQ(3, pool.nn_allocated());
+
+    // Too large objects are never pooled.
+    void *p4 = pool.alloc(128);
+    pool.free(p4, 128);
+    EXPECT_EQ(1, pool.nn_free());
+
+    // The free objects are bounded by max_free for each size class.
+    void *p5 = pool.alloc(32);
+    void *p6 = pool.alloc(32);
+    pool.free(p2, 24);
+    pool.free(p5, 32);
+    pool.free(p6, 32);
+    pool.free(p3, 48);
+    EXPECT_EQ(3, pool.nn_free());
+
+    pool.shrink();
+    EXPECT_EQ(0, pool.nn_free());
+}
+
+VOID TEST(KernelMemoryBlockTest, RtpPacketCopyFromPool)
+{
+    SrsRtpPacket *pkt = new SrsRtpPacket();
+    SrsUniquePtr<SrsRtpPacket> pkt_uptr(pkt);
+    pkt->header_.set_sequence(100);
+    pkt->header_.set_ssrc(200);
+
+    SrsRtpRawPayload *raw = new SrsRtpRawPayload();
+    raw->payload_ = pkt->wrap(10);
+    raw->nn_payload_ = 10;
+    raw->sample_->bytes_ = raw->payload_;
+    raw->sample_->size_ = 10;
+    pkt->set_payload(raw, SrsRtpPacketPayloadTypeRaw);
+
+    // Warm up the pool, by the copies for players.
+    if (true) {
+        SrsRtpPacket *cp = pkt->copy();
+        srs_freep(cp);
+    }
+
+    // Copy the packet for each player, from the pool.
+    int64_t allocated = srs_rtp_pool()->nn_allocated();
+    for (int i = 0; i < 10; i++) {
+        SrsUniquePtr<SrsRtpPacket> cp(pkt->copy());
+        cp->header_.set_sequence(i);
+        EXPECT_EQ(200, (int)cp->header_.get_ssrc());
+
+        SrsRtpRawPayload *cp_raw = dynamic_cast<SrsRtpRawPayload *>(cp->payload());
+        ASSERT_TRUE(cp_raw != NULL);
+        EXPECT_EQ(raw->payload_, cp_raw->payload_);
+        EXPECT_EQ(raw->payload_, cp_raw->sample_->bytes_);
+        EXPECT_EQ(10, cp_raw->sample_->size_);
+    }
+    EXPECT_EQ(allocated, srs_rtp_pool()->nn_allocated());
+    EXPECT_EQ(100, pkt->header_.get_sequence());
+}
+
 VOID TEST(KernelBufferTest, SrsBufferConstructorAndBasics)
 {
     // Test constructor with valid data
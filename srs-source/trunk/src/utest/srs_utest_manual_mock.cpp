@@ -488,6 +488,16 @@ srs_error_t MockAppStatistic::dumps_clients(SrsJsonArray *arr, int start, int co
     return srs_success;
 }
 
+srs_error_t MockAppStatistic::dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
+srs_error_t MockAppStatistic::dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page)
+{
+    return srs_success;
+}
+
 srs_error_t MockAppStatistic::dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs)
 {
     return srs_success;
@@ -225,6 +225,8 @@ public:
     virtual srs_error_t dumps_vhosts(SrsJsonArray *arr);
     virtual srs_error_t dumps_streams(SrsJsonArray *arr, int start, int count);
     virtual srs_error_t dumps_clients(SrsJsonArray *arr, int start, int count);
+    virtual srs_error_t dumps_streams(SrsJsonWriter *jw, SrsStatisticPage *page);
+    virtual srs_error_t dumps_clients(SrsJsonWriter *jw, SrsStatisticPage *page);
     virtual srs_error_t dumps_metrics(int64_t &send_bytes, int64_t &recv_bytes, int64_t &nstreams, int64_t &nclients, int64_t &total_nclients, int64_t &nerrs);
     void set_on_client_error(srs_error_t err);
 };
@@ -293,6 +295,8 @@ public:
     bool rtc_server_enabled_;
     bool rtc_enabled_;
     bool rtc_init_rate_from_sdp_;
+    int rtc_server_audio_transcoders_;
+    bool rtc_server_audio_transcoders_drop_;
     bool asprocess_;
 
 public:
@@ -324,6 +328,8 @@ public:
         rtc_server_enabled_ = false;
         rtc_enabled_ = false;
         rtc_init_rate_from_sdp_ = false;
+        rtc_server_audio_transcoders_ = 0;
+        rtc_server_audio_transcoders_drop_ = false;
         asprocess_ = false;
     }
     virtual ~MockAppConfig()
@@ -366,6 +372,7 @@ public:
     virtual srs_error_t persistence() { return srs_success; }
     virtual std::string config() { return ""; }
     virtual SrsConfDirective *get_root() { return NULL; }
+    virtual int get_generation() { return 0; }
     virtual std::string cwd() { return "./"; }
     virtual int get_max_connections() { return 1000; }
     virtual std::string get_pid_file() { return ""; }
@@ -417,6 +424,9 @@ public:
         return v;
     }
     virtual int get_rtc_server_reuseport() { return 1; }
+    virtual int get_rtc_server_recv_batch() { return 1; }
+    virtual int get_rtc_server_audio_transcoders() { return rtc_server_audio_transcoders_; }
+    virtual bool get_rtc_server_audio_transcoders_drop() { return rtc_server_audio_transcoders_drop_; }
     virtual bool get_rtc_server_encrypt() { return false; }
     virtual bool get_api_as_candidates() { return api_as_candidates_; }
     virtual bool get_resolve_api_domain() { return resolve_api_domain_; }
@@ -451,6 +461,12 @@ public:
     virtual int get_critical_pulse() { return 0; }
     virtual int get_dying_threshold() { return 0; }
     virtual int get_dying_pulse() { return 0; }
+    virtual bool get_supervisor_enabled() { return false; }
+    virtual std::string get_supervisor_srs_cpus() { return ""; }
+    virtual std::string get_supervisor_ffmpeg_cpus() { return ""; }
+    virtual int get_supervisor_ffmpeg_nice() { return 0; }
+    virtual int get_supervisor_threshold() { return 0; }
+    virtual srs_utime_t get_supervisor_backoff_max() { return 0; }
     virtual std::string get_rtmps_ssl_cert() { return ""; }
     virtual std::string get_rtmps_ssl_key() { return ""; }
     virtual SrsConfDirective *get_vhost(std::string vhost, bool try_default_vhost = true) { return default_vhost_; }
@@ -475,12 +491,21 @@ public:
     virtual SrsConfDirective *get_refer_publish(std::string vhost) { return NULL; }
     virtual bool get_vhost_origin_cluster(std::string vhost) { return false; }
     virtual std::vector<std::string> get_vhost_coworkers(std::string vhost) { return std::vector<std::string>(); }
+    virtual bool get_vhost_origin_directory(std::string vhost) { return false; }
+    virtual std::string get_vhost_origin_directory_ip(std::string vhost) { return ""; }
     virtual bool get_vhost_edge_token_traverse(std::string vhost) { return false; }
+    virtual srs_utime_t get_vhost_edge_token_traverse_ttl(std::string vhost) { return 0; }
+    virtual srs_utime_t get_vhost_edge_token_traverse_deny_ttl(std::string vhost) { return 0; }
+    virtual srs_utime_t get_vhost_edge_hedge_delay(std::string vhost) { return 0; }
+    virtual srs_utime_t get_vhost_edge_warm_pull(std::string vhost) { return 0; }
+    virtual int get_vhost_edge_warm_pull_plays(std::string vhost) { return 2; }
     virtual SrsConfDirective *get_vhost_edge_origin(std::string vhost) { return NULL; }
     virtual SrsConfDirective *get_vhost_on_connect(std::string vhost) { return NULL; }
     virtual SrsConfDirective *get_vhost_on_close(std::string vhost) { return NULL; }
     virtual SrsConfDirective *get_vhost_on_publish(std::string vhost) { return NULL; }
     virtual SrsConfDirective *get_vhost_on_play(std::string vhost) { return NULL; }
+    virtual bool get_vhost_http_hooks_keep_alive(std::string vhost) { return false; }
+    virtual srs_utime_t get_vhost_http_hooks_play_cache(std::string vhost) { return 0; }
     virtual bool get_rtc_enabled(std::string vhost) { return rtc_enabled_; }
     virtual bool get_rtsp_enabled(std::string vhost) { return false; }
     virtual bool get_rtc_from_rtmp(std::string vhost) { return rtc_from_rtmp_; }
@@ -492,6 +517,7 @@ public:
     virtual SrsConfDirective *get_vhost_on_dvr(std::string vhost) { return NULL; }
     virtual bool get_rtc_nack_enabled(std::string vhost) { return rtc_nack_enabled_; }
     virtual bool get_rtc_nack_no_copy(std::string vhost) { return rtc_nack_no_copy_; }
+    virtual int get_rtc_nack_cache_size(std::string vhost) { return 0; }
     virtual bool get_realtime_enabled(std::string vhost, bool is_rtc) { return true; }
     virtual int get_mw_msgs(std::string vhost, bool is_realtime, bool is_rtc) { return mw_msgs_; }
     virtual int get_rtc_drop_for_pt(std::string vhost) { return rtc_drop_for_pt_; }
@@ -566,6 +592,7 @@ public:
     virtual bool get_vhost_http_remux_has_audio(std::string vhost) { return true; }
     virtual bool get_vhost_http_remux_has_video(std::string vhost) { return true; }
     virtual bool get_vhost_http_remux_guess_has_av(std::string vhost) { return true; }
+    virtual bool get_vhost_http_remux_ts_shared(std::string vhost) { return false; }
     virtual std::string get_vhost_http_remux_mount(std::string vhost) { return ""; }
     virtual std::string get_vhost_edge_protocol(std::string vhost) { return "rtmp"; }
     virtual bool get_vhost_edge_follow_client(std::string vhost) { return false; }
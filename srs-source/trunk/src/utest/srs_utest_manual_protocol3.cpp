@@ -337,6 +337,78 @@ VOID TEST(ProtocolJsonTest, SrsJsonLoads)
     }
 }
 
+class MockJsonSink : public ISrsJsonSink
+{
+public:
+    std::vector<std::string> chunks_;
+
+public:
+    virtual srs_error_t write_json(const std::string &chunk)
+    {
+        chunks_.push_back(chunk);
+        return srs_success;
+    }
+};
+
+VOID TEST(ProtocolJsonTest, SrsJsonWriter)
+{
+    srs_error_t err;
+
+    // Same text as the SrsJsonObject::dumps().
+    if (true) {
+        SrsJsonWriter jw;
+        jw.object_start();
+        jw.key("code");
+        jw.integer(0);
+        jw.key("name");
+        jw.str("a\"b\n");
+        jw.key("alive");
+        jw.number(1.5);
+        jw.key("arr");
+        jw.array_start();
+        jw.boolean(true);
+        jw.null();
+        jw.object_start();
+        jw.object_end();
+        jw.array_start();
+        jw.array_end();
+        jw.array_end();
+        jw.key("raw");
+        jw.raw("[1,2]");
+        jw.object_end();
+
+        std::string expect = "{\"code\":0,\"name\":\"a\\\"b\\n\",\"alive\":1.50,\"arr\":[true,null,{},[]],\"raw\":[1,2]}";
+        EXPECT_STREQ(expect.c_str(), jw.buffer().c_str());
+
+        // The text is valid JSON.
+        SrsJsonAny *json = SrsJsonAny::loads(jw.buffer());
+        EXPECT_TRUE(json != NULL);
+        srs_freep(json);
+    }
+
+    // Flush to sink in chunks.
+    if (true) {
+        MockJsonSink sink;
+        SrsJsonWriter jw(&sink, 8);
+        jw.array_start();
+        HELPER_EXPECT_SUCCESS(jw.flush());
+        EXPECT_EQ(0, (int)sink.chunks_.size());
+
+        jw.str("0123456789");
+        HELPER_EXPECT_SUCCESS(jw.flush());
+        EXPECT_EQ(1, (int)sink.chunks_.size());
+        EXPECT_TRUE(jw.buffer().empty());
+
+        // The comma is kept across chunks.
+        jw.integer(1);
+        jw.array_end();
+        HELPER_EXPECT_SUCCESS(jw.flush(true));
+        EXPECT_EQ(2, (int)sink.chunks_.size());
+        EXPECT_STREQ("[\"0123456789\"", sink.chunks_[0].c_str());
+        EXPECT_STREQ(",1]", sink.chunks_[1].c_str());
+    }
+}
+
 VOID TEST(ProtocolRawAvcTest, SrsRawH264StreamBasic)
 {
     SrsRawH264Stream h264;
@@ -1298,6 +1370,92 @@ VOID TEST(ProtocolRtcStunTest, SrsStunPacketEncode)
     EXPECT_TRUE(true);
 }
 
+// Build the binding request with USERNAME, then decode it.
+static srs_error_t mock_stun_binding_request(SrsStunPacket *r, const std::string &username, const std::string &tid)
+{
+    char buf[256];
+    SrsBuffer stream(buf, sizeof(buf));
+    stream.write_2bytes(BindingRequest);
+    stream.write_2bytes(0);
+    stream.write_4bytes(kStunMagicCookie);
+    stream.write_string(tid);
+    stream.write_2bytes(Username);
+    stream.write_2bytes(username.size());
+    stream.write_string(username);
+    while (stream.pos() % 4 != 0) {
+        stream.write_1bytes(0);
+    }
+    stream.write_2bytes(UseCandidate);
+    stream.write_2bytes(0);
+    buf[2] = ((stream.pos() - 20) >> 8) & 0xFF;
+    buf[3] = (stream.pos() - 20) & 0xFF;
+
+    return r->decode(buf, stream.pos());
+}
+
+// Encode the response by SrsStunPacket, the same as previous session.
+static srs_error_t mock_stun_binding_response(SrsStunPacket *r, const std::string &pwd, uint32_t addr, uint16_t port, std::string &v)
+{
+    SrsStunPacket res;
+    res.set_message_type(BindingResponse);
+    res.set_local_ufrag(r->get_remote_ufrag());
+    res.set_remote_ufrag(r->get_local_ufrag());
+    res.set_transcation_id(r->get_transcation_id());
+    res.set_mapped_address(addr);
+    res.set_mapped_port(port);
+
+    char buf[1460];
+    SrsBuffer stream(buf, sizeof(buf));
+    srs_error_t err = res.encode(pwd, &stream);
+    v = std::string(buf, stream.pos());
+    return err;
+}
+
+VOID TEST(ProtocolRtcStunTest, SrsStunBindingResponderSameAsPacket)
+{
+    srs_error_t err = srs_success;
+
+    SrsStunBindingResponder responder;
+
+    // The username changes for ICE restart, and the pwd changes as well.
+    const char *usernames[] = {"s4f2k1:abCD", "s4f2k1:abCD", "x9y8z7w6:longer-remote-ufrag", "x9y8z7w6:longer-remote-ufrag"};
+    const char *pwds[] = {"pwd-0123456789abcdef0123456789", "pwd-0123456789abcdef0123456789", "pwd-0123456789abcdef0123456789", "new-pwd"};
+    for (int i = 0; i < 4; i++) {
+        SrsStunPacket r;
+        std::string tid = std::string("tid-0000000") + char('0' + i);
+        HELPER_EXPECT_SUCCESS(mock_stun_binding_request(&r, usernames[i], tid));
+        EXPECT_TRUE(r.get_use_candidate());
+
+        uint32_t addr = 0xC0A80001 + i;
+        uint16_t port = 50000 + i;
+        std::string expect;
+        HELPER_EXPECT_SUCCESS(mock_stun_binding_response(&r, pwds[i], addr, port, expect));
+
+        char buf[1460];
+        SrsBuffer stream(buf, sizeof(buf));
+        HELPER_EXPECT_SUCCESS(responder.encode(&r, pwds[i], addr, port, &stream));
+        EXPECT_EQ(expect.size(), (size_t)stream.pos());
+        EXPECT_TRUE(expect == std::string(buf, stream.pos()));
+
+        // The response is a valid binding response with the same transaction id.
+        SrsStunPacket res;
+        HELPER_EXPECT_SUCCESS(res.decode(buf, stream.pos()));
+        EXPECT_TRUE(res.is_binding_response());
+        EXPECT_STREQ(tid.c_str(), res.get_transcation_id().c_str());
+        EXPECT_STREQ(usernames[i], res.get_username().c_str());
+    }
+
+    // Fail if no space for the response.
+    if (true) {
+        SrsStunPacket r;
+        HELPER_EXPECT_SUCCESS(mock_stun_binding_request(&r, "s4f2k1:abCD", "tid-00000000"));
+
+        char buf[32];
+        SrsBuffer stream(buf, sizeof(buf));
+        HELPER_EXPECT_FAILED(responder.encode(&r, "pwd", 0x7f000001, 8000, &stream));
+    }
+}
+
 VOID TEST(ProtocolSdpTest, SrsSdpBasic)
 {
     SrsSdp sdp;